@@ -55,7 +55,7 @@
 #include "../src/prng.h"
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
+#include <windows.h>
 
 void fft_test()
 {
@@ -93,8 +93,8 @@ void fft_test()
         printf("FFT produced wrong data -- ERROR\n");
 
     // cleanup
-    free(fft);
-    free(signal);
+    brahe_free(fft);
+    brahe_free(signal);
 }
 
 void pretty_test()
@@ -115,8 +115,8 @@ void pretty_test()
 
         printf("\n%ld\n%s\n%s\n",x[i], c, t);
 
-        free(t);
-        free(c);
+        brahe_free(t);
+        brahe_free(c);
     }
 }
 
@@ -234,12 +234,13 @@ void gcf_test()
 
 double test_prng(brahe_prng_type_t prng_type)
 {
-    uint32_t total, dummy;
+    uint32_t total;
+    volatile uint32_t sink = 0;
     size_t i;
     double n, l, s;
     int counts[NUM_BUCKETS];
     brahe_prng_state_t prng_state;
-    clock_t start, stop;
+    LARGE_INTEGER start, stop, freq;
 
     // banner
     printf("\n<<<<------------------------>>>>\n");
@@ -356,20 +357,21 @@ double test_prng(brahe_prng_type_t prng_type)
     printf("      total = %10d\n", total);
 
     // get starting time
-    start = clock();
+    QueryPerformanceCounter(&start);
 
     // test generation speed
     for (i = 0; i < PRNG_TEST_SIZE; ++i)
-        dummy = brahe_prng_next(&prng_state);
+        sink ^= brahe_prng_next(&prng_state);
 
     // calculate run time
-    stop = clock();
+    QueryPerformanceCounter(&stop);
+    QueryPerformanceFrequency(&freq);
 
     // free resources
     brahe_prng_free(&prng_state);
 
     // done
-    return (double)(stop - start) / (double)CLOCKS_PER_SEC;
+    return (double)(stop.QuadPart - start.QuadPart) / (double)freq.QuadPart;
 }
 
 int _tmain(int argc, _TCHAR* argv[])
@@ -0,0 +1,268 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+#include "dispatch.h"
+#include <string.h>
+#include <ctype.h>
+
+#if defined(BRAHE_HAVE_X86_DISPATCH) && !defined(_MSC_VER)
+#include <cpuid.h>
+#endif
+
+static const char * isa_names[] =
+{
+    "scalar", "sse2", "avx2", "avx512", "neon"
+};
+
+static const char * kernel_names[BRAHE_KERNEL_COUNT] =
+{
+    "minmax_sum", "sum_sq_dev", "fft_pass", "mt_twist", "mt_temper", "round_nearest",
+    "minmax_sum_f", "sum_sq_dev_f", "fft_pass_f"
+};
+
+static brahe_isa_t detected = BRAHE_ISA_SCALAR;
+static brahe_isa_t active = BRAHE_ISA_SCALAR;
+static brahe_kernels_t kernels;
+
+#if defined(BRAHE_HAVE_X86_DISPATCH)
+// cpuid leaf and subleaf; false if the leaf does not exist
+static bool cpuid(const unsigned int leaf, const unsigned int subleaf, unsigned int regs[4])
+{
+#if defined(_MSC_VER)
+    int r[4];
+
+    __cpuid(r, 0);
+
+    if ((unsigned int)r[0] < leaf)
+        return false;
+
+    __cpuidex(r, (int)leaf, (int)subleaf);
+    regs[0] = (unsigned int)r[0];
+    regs[1] = (unsigned int)r[1];
+    regs[2] = (unsigned int)r[2];
+    regs[3] = (unsigned int)r[3];
+    return true;
+#else
+    if (__get_cpuid_max(0, NULL) < leaf)
+        return false;
+
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+    return true;
+#endif
+}
+
+// register state the operating system saves on a context switch
+static uint64_t xgetbv0(void)
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned int lo, hi;
+    __asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((uint64_t)hi << 32) | lo;
+#endif
+}
+#endif
+
+static brahe_isa_t detect(void)
+{
+    brahe_isa_t result = BRAHE_ISA_SCALAR;
+
+#if defined(BRAHE_HAVE_X86_DISPATCH)
+    unsigned int regs1[4], regs7[4];
+    uint64_t xcr0;
+
+    if (!cpuid(1, 0, regs1))
+        return result;
+
+    // edx bit 26
+    if (regs1[3] & (1U << 26))
+        result = BRAHE_ISA_SSE2;
+
+    // ecx: OSXSAVE (27), AVX (28) and FMA (12), with XMM and YMM state enabled
+    if (((regs1[2] & (1U << 27)) == 0) || ((regs1[2] & (1U << 28)) == 0) || ((regs1[2] & (1U << 12)) == 0))
+        return result;
+
+    xcr0 = xgetbv0();
+
+    if ((xcr0 & 0x06) != 0x06)
+        return result;
+
+    // leaf 7 ebx: AVX2 (5) and AVX-512F (16)
+    if (!cpuid(7, 0, regs7) || ((regs7[1] & (1U << 5)) == 0))
+        return result;
+
+    result = BRAHE_ISA_AVX2;
+
+    // AVX-512 also needs opmask and ZMM state enabled
+    if ((regs7[1] & (1U << 16)) && ((xcr0 & 0xE0) == 0xE0))
+        result = BRAHE_ISA_AVX512;
+#elif defined(BRAHE_HAVE_SSE2)
+    result = BRAHE_ISA_SSE2;
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+    result = BRAHE_ISA_NEON;
+#endif
+
+    return result;
+}
+
+// the instruction set named by BRAHE_ISA, or the detected one
+static brahe_isa_t requested(void)
+{
+    const char * env = getenv("BRAHE_ISA");
+    char name[16];
+    size_t i;
+
+    if ((env == NULL) || (strlen(env) >= sizeof(name)))
+        return detected;
+
+    for (i = 0; (env[i] != 0) && (i < sizeof(name) - 1); ++i)
+        name[i] = (char)tolower((unsigned char)env[i]);
+
+    name[i] = 0;
+
+    for (i = 0; i < sizeof(isa_names) / sizeof(isa_names[0]); ++i)
+    {
+        if (!strcmp(name, isa_names[i]))
+            return (brahe_isa_t)i;
+    }
+
+    return detected;
+}
+
+static void bind(void)
+{
+    brahe_isa_t request;
+
+    detected = detect();
+    request = requested();
+
+    // a request can only lower the ceiling within the processor's own family
+    if (request == BRAHE_ISA_SCALAR)
+        active = BRAHE_ISA_SCALAR;
+    else if ((request == BRAHE_ISA_NEON) || (detected == BRAHE_ISA_NEON))
+        active = detected;
+    else
+        active = (request < detected) ? request : detected;
+
+    brahe_bind_kernels_scalar(&kernels);
+
+#if defined(BRAHE_HAVE_SSE2)
+    if ((active >= BRAHE_ISA_SSE2) && (active != BRAHE_ISA_NEON))
+        brahe_bind_kernels_sse2(&kernels);
+#endif
+
+#if defined(BRAHE_HAVE_X86_DISPATCH)
+    if ((active >= BRAHE_ISA_AVX2) && (active != BRAHE_ISA_NEON))
+        brahe_bind_kernels_avx2(&kernels);
+
+    if (active == BRAHE_ISA_AVX512)
+        brahe_bind_kernels_avx512(&kernels);
+#endif
+}
+
+#if defined(BRAHE_HAVE_PTHREADS)
+static pthread_once_t bind_once = PTHREAD_ONCE_INIT;
+#else
+static bool bound = false;
+#endif
+
+const brahe_kernels_t * brahe_kernels(void)
+{
+#if defined(BRAHE_HAVE_PTHREADS)
+    pthread_once(&bind_once, bind);
+#else
+    if (!bound)
+    {
+        bind();
+        bound = true;
+    }
+#endif
+
+    return &kernels;
+}
+
+brahe_isa_t brahe_isa_detected(void)
+{
+    brahe_kernels();
+    return detected;
+}
+
+brahe_isa_t brahe_isa_active(void)
+{
+    brahe_kernels();
+    return active;
+}
+
+const char * brahe_isa_name(const brahe_isa_t isa)
+{
+    if ((size_t)isa < sizeof(isa_names) / sizeof(isa_names[0]))
+        return isa_names[isa];
+
+    return "unknown";
+}
+
+bool brahe_kernel_info(const size_t index, const char ** name, brahe_isa_t * isa)
+{
+    const brahe_kernels_t * k = brahe_kernels();
+
+    if (index >= BRAHE_KERNEL_COUNT)
+        return false;
+
+    if (name != NULL)
+        *name = kernel_names[index];
+
+    if (isa != NULL)
+        *isa = k->m_isa[index];
+
+    return true;
+}
@@ -0,0 +1,138 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+#if !defined(LIBBRAHE_DISPATCH_H)
+#define LIBBRAHE_DISPATCH_H
+
+#include "internal.h"
+
+/*
+    Run-time dispatch. The hot inner loops of the library are kernels,
+    reached through a table of function pointers that is bound once, on
+    first use, to the best variant the processor supports. Each instruction
+    set's variants live in their own file, compiled for that instruction
+    set whatever the compiler's baseline, and only ever called when the
+    processor has it. Setting the environment variable BRAHE_ISA to scalar,
+    sse2, avx2 or avx512 lowers the ceiling, for testing and comparison.
+*/
+
+//! Kernels, as indices into brahe_kernels_t::m_isa
+typedef enum
+{
+    BRAHE_KERNEL_MINMAX_SUM,
+    BRAHE_KERNEL_SUM_SQ_DEV,
+    BRAHE_KERNEL_FFT_PASS,
+    BRAHE_KERNEL_MT_TWIST,
+    BRAHE_KERNEL_MT_TEMPER,
+    BRAHE_KERNEL_ROUND_NEAREST,
+    BRAHE_KERNEL_MINMAX_SUM_F,
+    BRAHE_KERNEL_SUM_SQ_DEV_F,
+    BRAHE_KERNEL_FFT_PASS_F,
+    BRAHE_KERNEL_COUNT
+}
+brahe_kernel_t;
+
+typedef struct
+{
+    // minimum, maximum and sum of n values; min and max skip NaN, but NaN
+    // propagates into the sum; no values give DBL_MAX, -DBL_MAX and 0
+    void (*m_minmax_sum)(const double * data, const size_t n, double * min, double * max, double * sum);
+
+    // sum of squared differences from mean
+    double (*m_sum_sq_dev)(const double * data, const size_t n, const double mean);
+
+    // one radix-2 pass of butterflies spanning half elements, over split
+    // complex data; w holds the half twiddle factors for the pass
+    void (*m_fft_pass)(double * re, double * im, const size_t n, const size_t half, const double * wr, const double * wi);
+
+    // regenerate the 624 words of Mersenne Twister state
+    void (*m_mt_twist)(uint32_t * m);
+
+    // temper n words of Mersenne Twister state into output
+    void (*m_mt_temper)(const uint32_t * m, uint32_t * out, const size_t n);
+
+    // brahe_round_nearest over an array
+    void (*m_round_nearest)(const double * in, double * out, const size_t n);
+
+    // single-precision data; the reductions accumulate in double
+    void (*m_minmax_sum_f)(const float * data, const size_t n, double * min, double * max, double * sum);
+    double (*m_sum_sq_dev_f)(const float * data, const size_t n, const double mean);
+    void (*m_fft_pass_f)(float * re, float * im, const size_t n, const size_t half, const float * wr, const float * wi);
+
+    // the instruction set of each bound kernel
+    brahe_isa_t m_isa[BRAHE_KERNEL_COUNT];
+}
+brahe_kernels_t;
+
+// the kernels bound for this process
+const brahe_kernels_t * brahe_kernels(void);
+
+// binders: each replaces the kernels it implements
+void brahe_bind_kernels_scalar(brahe_kernels_t * k);
+
+#if defined(BRAHE_HAVE_SSE2)
+void brahe_bind_kernels_sse2(brahe_kernels_t * k);
+#endif
+
+#if defined(BRAHE_HAVE_X86_DISPATCH)
+void brahe_bind_kernels_avx2(brahe_kernels_t * k);
+void brahe_bind_kernels_avx512(brahe_kernels_t * k);
+#endif
+
+// Mersenne Twister parameters
+#define BRAHE_MT_N 624
+#define BRAHE_MT_M 397
+#define BRAHE_MT_MATRIX_A 0x9908b0dfUL
+#define BRAHE_MT_UPPER_MASK 0x80000000UL
+#define BRAHE_MT_LOWER_MASK 0x7fffffffUL
+
+#endif
@@ -0,0 +1,561 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+// CPU affinity and sched_getaffinity are GNU extensions
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "internal.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(BRAHE_HAVE_PTHREADS) && defined(__linux__)
+#include <sched.h>
+#define HAVE_AFFINITY
+#endif
+
+/*
+    Parallel loops. A loop over n elements is cut into chunks of a fixed
+    grain, and each worker starts with an equal, contiguous share of the
+    chunks. A worker takes chunks from the front of its share; one that runs
+    out steals the back half of another's remaining share, trying workers on
+    its own NUMA node first. Shares are [lo, hi) pairs of chunk numbers packed
+    in one word, so owners and thieves claim chunks with a compare-and-swap
+    and never block each other. Chunk boundaries depend only on n and the
+    grain, which is what keeps results independent of the number of threads.
+*/
+
+// arrays smaller than this are not worth waking the workers for
+#define DEFAULT_THRESHOLD 65536
+
+#if defined(BRAHE_HAVE_PTHREADS)
+
+#define RANGE(lo, hi) (((uint64_t)(hi) << 32) | (uint64_t)(lo))
+#define RANGE_LO(r)   ((size_t)((r) & 0xFFFFFFFFu))
+#define RANGE_HI(r)   ((size_t)((r) >> 32))
+
+// chunk numbers must fit in half a range
+#define MAX_CHUNKS ((size_t)0xFFFFFFFFu)
+
+// highest NUMA node number looked for
+#define MAX_NODES 1024
+
+struct pool_s;
+
+typedef struct
+{
+    uint64_t        m_range; // chunks not yet taken
+    struct pool_s * m_pool;
+    size_t          m_index;
+    int             m_node;  // NUMA node, or -1 if unknown
+    int             m_cpu;   // CPU the worker is pinned to, or -1
+}
+worker_t;
+
+// each worker's share gets its own cache line
+typedef union
+{
+    worker_t m_worker;
+    char     m_line[64];
+}
+worker_slot_t;
+
+typedef struct pool_s
+{
+    pthread_mutex_t   m_lock;       // guards the fields below it
+    pthread_cond_t    m_wake;       // a loop was posted, or the pool is stopping
+    pthread_cond_t    m_idle;       // the last worker finished a loop
+    pthread_mutex_t   m_turn;       // held by the thread running a loop
+    uint64_t          m_generation; // loops posted
+    size_t            m_busy;       // started threads still in the current loop
+    bool              m_stop;
+    brahe_task_t      m_task;       // the current loop
+    void *            m_context;
+    size_t            m_n;
+    size_t            m_grain;
+    size_t            m_workers;    // started threads, plus the caller
+    worker_slot_t *   m_slots;
+    pthread_t *       m_threads;    // m_threads[i] runs worker i + 1
+    brahe_allocator_t m_allocator;  // source of the pool's memory
+}
+pool_t;
+
+// set in pool threads, and in a caller while it runs a loop, so that
+// loops nested in tasks run on the thread that reaches them
+static __thread bool in_pool = false;
+
+static void run_chunk(pool_t * pool, const size_t chunk, const size_t worker)
+{
+    size_t begin = chunk * pool->m_grain;
+    size_t end = (pool->m_n - begin > pool->m_grain) ? begin + pool->m_grain : pool->m_n;
+
+    pool->m_task(pool->m_context, begin, end, worker);
+}
+
+// take the first chunk of a worker's own share
+static bool take_chunk(worker_t * self, size_t * chunk)
+{
+    uint64_t r = __atomic_load_n(&self->m_range, __ATOMIC_ACQUIRE);
+
+    while (RANGE_LO(r) < RANGE_HI(r))
+    {
+        if (__atomic_compare_exchange_n(&self->m_range, &r, RANGE(RANGE_LO(r) + 1, RANGE_HI(r)),
+                                        false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            *chunk = RANGE_LO(r);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// move the back half of another worker's share into an empty one, and take
+// its first chunk
+static bool steal_chunk(pool_t * pool, worker_t * self, size_t * chunk)
+{
+    size_t k, pass, lo, hi, half;
+    worker_t * victim;
+    uint64_t r;
+
+    // same node first; when nodes are unknown, everyone is on the same node
+    for (pass = 0; pass < 2; ++pass)
+    {
+        for (k = 1; k < pool->m_workers; ++k)
+        {
+            victim = &pool->m_slots[(self->m_index + k) % pool->m_workers].m_worker;
+
+            if ((pass == 0) != (victim->m_node == self->m_node))
+                continue;
+
+            r = __atomic_load_n(&victim->m_range, __ATOMIC_ACQUIRE);
+
+            while ((lo = RANGE_LO(r)) < (hi = RANGE_HI(r)))
+            {
+                half = (hi - lo + 1) / 2;
+
+                if (__atomic_compare_exchange_n(&victim->m_range, &r, RANGE(lo, hi - half),
+                                                false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+                {
+                    __atomic_store_n(&self->m_range, RANGE(hi - half + 1, hi), __ATOMIC_RELEASE);
+                    *chunk = hi - half;
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+static void run_worker(pool_t * pool, const size_t index)
+{
+    worker_t * self = &pool->m_slots[index].m_worker;
+    size_t chunk;
+
+    while (take_chunk(self, &chunk) || steal_chunk(pool, self, &chunk))
+        run_chunk(pool, chunk, index);
+}
+
+static void * worker_main(void * arg)
+{
+    worker_t * self = (worker_t *)arg;
+    pool_t * pool = self->m_pool;
+    uint64_t seen = 0;
+
+    in_pool = true;
+    pthread_mutex_lock(&pool->m_lock);
+
+    for (;;)
+    {
+        while (!pool->m_stop && (pool->m_generation == seen))
+            pthread_cond_wait(&pool->m_wake, &pool->m_lock);
+
+        if (pool->m_stop)
+            break;
+
+        seen = pool->m_generation;
+        pthread_mutex_unlock(&pool->m_lock);
+
+        run_worker(pool, self->m_index);
+
+        pthread_mutex_lock(&pool->m_lock);
+
+        if (--pool->m_busy == 0)
+            pthread_cond_signal(&pool->m_idle);
+    }
+
+    pthread_mutex_unlock(&pool->m_lock);
+    return NULL;
+}
+
+#if defined(HAVE_AFFINITY)
+
+// mark the numbers in a sysfs list such as "0-3,8-11" that are below limit
+static void read_list(const char * path, int * marks, const unsigned int limit, const int value)
+{
+    unsigned int lo, hi, i;
+    int c;
+    FILE * f = fopen(path, "r");
+
+    if (f == NULL)
+        return;
+
+    while (fscanf(f, "%u", &lo) == 1)
+    {
+        hi = lo;
+        c = fgetc(f);
+
+        if ((c == '-') && (fscanf(f, "%u", &hi) == 1))
+            c = fgetc(f);
+
+        for (i = lo; (i <= hi) && (i < limit); ++i)
+            marks[i] = value;
+
+        if (c != ',')
+            break;
+    }
+
+    fclose(f);
+}
+
+// the CPUs this process may run on, grouped by NUMA node; returns how many
+static size_t cpu_order(int * order, int * node_of)
+{
+    int online[MAX_NODES], cpu_node[CPU_SETSIZE];
+    char path[64];
+    cpu_set_t allowed;
+    size_t count = 0;
+    int cpu, node, last = -1;
+
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        return 0;
+
+    for (node = 0; node < MAX_NODES; ++node)
+        online[node] = 0;
+
+    for (cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        cpu_node[cpu] = -1;
+
+    read_list("/sys/devices/system/node/online", online, MAX_NODES, 1);
+
+    for (node = 0; node < MAX_NODES; ++node)
+    {
+        if (online[node])
+        {
+            sprintf(path, "/sys/devices/system/node/node%d/cpulist", node);
+            read_list(path, cpu_node, CPU_SETSIZE, node);
+            last = node;
+        }
+    }
+
+    // CPUs of unknown node go last
+    for (node = 0; node <= last + 1; ++node)
+    {
+        for (cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            int n = (cpu_node[cpu] >= 0) ? cpu_node[cpu] : last + 1;
+
+            if ((n == node) && CPU_ISSET(cpu, &allowed))
+            {
+                order[count] = cpu;
+                node_of[count] = cpu_node[cpu];
+                ++count;
+            }
+        }
+    }
+
+    return count;
+}
+
+#endif
+
+static void stop_pool(pool_t * pool)
+{
+    brahe_allocator_t a = pool->m_allocator;
+    size_t i;
+
+    pthread_mutex_lock(&pool->m_lock);
+    pool->m_stop = true;
+    pthread_cond_broadcast(&pool->m_wake);
+    pthread_mutex_unlock(&pool->m_lock);
+
+    for (i = 1; i < pool->m_workers; ++i)
+        pthread_join(pool->m_threads[i - 1], NULL);
+
+    pthread_cond_destroy(&pool->m_idle);
+    pthread_cond_destroy(&pool->m_wake);
+    pthread_mutex_destroy(&pool->m_turn);
+    pthread_mutex_destroy(&pool->m_lock);
+
+    brahe_release(&a, pool->m_threads);
+    brahe_release(&a, pool->m_slots);
+    brahe_release(&a, pool);
+}
+
+// start a pool of threads - 1 threads; NULL if not even one could be started
+static pool_t * start_pool(const size_t threads, const unsigned int flags)
+{
+    brahe_allocator_t a = *brahe_allocator();
+    pool_t * pool = (pool_t *)brahe_allocate(&a, sizeof(pool_t), BRAHE_DEFAULT_ALIGN);
+    size_t i;
+#if defined(HAVE_AFFINITY)
+    int order[CPU_SETSIZE], node_of[CPU_SETSIZE];
+    size_t cpus = 0;
+#endif
+
+    if (pool == NULL)
+        return NULL;
+
+    memset(pool, 0, sizeof(pool_t));
+    pool->m_allocator = a;
+    pool->m_slots   = (worker_slot_t *)brahe_allocate(&a, sizeof(worker_slot_t) * threads, BRAHE_SIMD_ALIGN);
+    pool->m_threads = (pthread_t *)brahe_allocate(&a, sizeof(pthread_t) * (threads - 1), BRAHE_DEFAULT_ALIGN);
+
+    if ((pool->m_slots == NULL) || (pool->m_threads == NULL))
+    {
+        brahe_release(&a, pool->m_threads);
+        brahe_release(&a, pool->m_slots);
+        brahe_release(&a, pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->m_lock, NULL);
+    pthread_mutex_init(&pool->m_turn, NULL);
+    pthread_cond_init(&pool->m_wake, NULL);
+    pthread_cond_init(&pool->m_idle, NULL);
+
+#if defined(HAVE_AFFINITY)
+    if (flags & BRAHE_EXEC_PIN_THREADS)
+        cpus = cpu_order(order, node_of);
+#else
+    (void)flags;
+#endif
+
+    for (i = 0; i < threads; ++i)
+    {
+        worker_t * w = &pool->m_slots[i].m_worker;
+
+        w->m_range = 0;
+        w->m_pool  = pool;
+        w->m_index = i;
+        w->m_node  = -1;
+        w->m_cpu   = -1;
+
+#if defined(HAVE_AFFINITY)
+        // the caller is not pinned, but is counted on the first CPU's node
+        if (cpus > 0)
+        {
+            w->m_node = node_of[i % cpus];
+
+            if (i > 0)
+                w->m_cpu = order[i % cpus];
+        }
+#endif
+    }
+
+    // the caller is worker 0; if a thread cannot be started, the pool
+    // makes do with those that were
+    for (pool->m_workers = 1; pool->m_workers < threads; ++pool->m_workers)
+    {
+        worker_t * w = &pool->m_slots[pool->m_workers].m_worker;
+
+        if (pthread_create(&pool->m_threads[pool->m_workers - 1], NULL, worker_main, w) != 0)
+            break;
+
+#if defined(HAVE_AFFINITY)
+        if (w->m_cpu >= 0)
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(w->m_cpu, &set);
+            pthread_setaffinity_np(pool->m_threads[pool->m_workers - 1], sizeof(set), &set);
+        }
+#endif
+    }
+
+    if (pool->m_workers == 1)
+    {
+        stop_pool(pool);
+        return NULL;
+    }
+
+    return pool;
+}
+
+#endif
+
+bool brahe_exec_init(brahe_exec_t * exec, const size_t threads, const unsigned int flags)
+{
+    size_t n = threads;
+
+    if (exec == NULL)
+        return false;
+
+    exec->m_threshold = DEFAULT_THRESHOLD;
+    exec->m_pool = NULL;
+
+#if defined(BRAHE_HAVE_PTHREADS)
+    if (n == 0)
+    {
+#if defined(HAVE_AFFINITY)
+        cpu_set_t allowed;
+
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0)
+            n = (size_t)CPU_COUNT(&allowed);
+#endif
+
+        if (n == 0)
+        {
+            long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+            n = (cpus > 0) ? (size_t)cpus : 1;
+        }
+    }
+
+    if (n > 1)
+    {
+        pool_t * pool = start_pool(n, flags);
+
+        if (pool == NULL)
+            return false;
+
+        exec->m_pool = pool;
+        n = pool->m_workers;
+    }
+#else
+    // no thread support; the calling thread does all the work
+    (void)flags;
+    n = 1;
+#endif
+
+    exec->m_threads = (n > 0) ? n : 1;
+    return true;
+}
+
+void brahe_exec_free(brahe_exec_t * exec)
+{
+    if (exec == NULL)
+        return;
+
+#if defined(BRAHE_HAVE_PTHREADS)
+    if (exec->m_pool != NULL)
+        stop_pool((pool_t *)exec->m_pool);
+#endif
+
+    exec->m_pool = NULL;
+    exec->m_threads = 1;
+}
+
+size_t brahe_exec_threads(const brahe_exec_t * exec)
+{
+    return (exec != NULL) ? exec->m_threads : 1;
+}
+
+void brahe_exec_set_threshold(brahe_exec_t * exec, const size_t n)
+{
+    if (exec != NULL)
+        exec->m_threshold = n;
+}
+
+void brahe_exec_for(const brahe_exec_t * exec, const size_t n, const size_t grain, brahe_task_t task, void * context)
+{
+    size_t chunks, c, begin;
+
+    if ((n == 0) || (grain == 0))
+        return;
+
+    chunks = (n - 1) / grain + 1;
+
+#if defined(BRAHE_HAVE_PTHREADS)
+    if ((exec != NULL) && (exec->m_pool != NULL) && (n >= exec->m_threshold) && (chunks > 1)
+     && (chunks <= MAX_CHUNKS) && !in_pool)
+    {
+        pool_t * pool = (pool_t *)exec->m_pool;
+        size_t w;
+
+        pthread_mutex_lock(&pool->m_turn);
+
+        for (w = 0; w < pool->m_workers; ++w)
+            pool->m_slots[w].m_worker.m_range = RANGE(chunks * w / pool->m_workers, chunks * (w + 1) / pool->m_workers);
+
+        pthread_mutex_lock(&pool->m_lock);
+        pool->m_task    = task;
+        pool->m_context = context;
+        pool->m_n       = n;
+        pool->m_grain   = grain;
+        pool->m_busy    = pool->m_workers - 1;
+        ++pool->m_generation;
+        pthread_cond_broadcast(&pool->m_wake);
+        pthread_mutex_unlock(&pool->m_lock);
+
+        in_pool = true;
+        run_worker(pool, 0);
+        in_pool = false;
+
+        pthread_mutex_lock(&pool->m_lock);
+
+        while (pool->m_busy > 0)
+            pthread_cond_wait(&pool->m_idle, &pool->m_lock);
+
+        pthread_mutex_unlock(&pool->m_lock);
+        pthread_mutex_unlock(&pool->m_turn);
+        return;
+    }
+#else
+    (void)exec;
+#endif
+
+    // the same chunks, in order, on this thread
+    for (c = 0, begin = 0; c < chunks; ++c, begin += grain)
+        task(context, begin, (n - begin > grain) ? begin + grain : n, 0);
+}
@@ -51,6 +51,7 @@
 */
 
 #include "mathtools.h"
+#include "internal.h"
 
 // lowest common denominator
 uint64_t brahe_lcm(const uint64_t x, const uint64_t y)
@@ -68,17 +69,102 @@ uint64_t brahe_lcm(const uint64_t x, const uint64_t y)
     return result;
 }
 
+// lowest common multiple, reporting overflow
+bool brahe_lcm_checked(const uint64_t x, const uint64_t y, uint64_t * result)
+{
+    if (result == NULL)
+        return false;
+
+    if ((x == 0) || (y == 0))
+    {
+        *result = 0;
+        return true;
+    }
+
+    if (!brahe_mul_checked(x / brahe_gcf(x,y), y, result))
+    {
+        *result = 0;
+        return false;
+    }
+
+    return true;
+}
+
+/*
+    Binary GCD (Stein's algorithm). Common factors of two are removed
+    together, then the odd values are reduced by subtraction, with the
+    factors of two each difference picks up stripped by a single shift. No
+    division is needed, which matters where 64-bit division is slow.
+
+    The trailing zeros of y - x and of |y - x| are the same, so the shift
+    for the next step is found while the minimum and difference are still
+    being selected; the compiler turns both selections into conditional
+    moves, leaving no unpredictable branches in the loop.
+*/
+
 // greatest common multiple
 uint64_t brahe_gcf(uint64_t x, uint64_t y)
 {
-    uint64_t temp;
+    int shift, zeros;
+    uint64_t diff;
+
+    if (x == 0)
+        return y;
+
+    if (y == 0)
+        return x;
+
+    shift = brahe_ctz64(x | y);
+    x >>= brahe_ctz64(x);
+    y >>= brahe_ctz64(y);
+
+    // both odd from here on
+    while (x != y)
+    {
+        diff  = (x > y) ? x - y : y - x;
+        zeros = brahe_ctz64(y - x);
+        x = (x < y) ? x : y;
+        y = diff >> zeros;
+    }
+
+    return x << shift;
+}
+
+// greatest common factor of an array
+uint64_t brahe_gcf_array(const uint64_t * values, const size_t n)
+{
+    size_t i;
+    uint64_t result = 0;
+
+    if (values == NULL)
+        return 0;
+
+    // nothing divides further once the result is 1
+    for (i = 0; (i < n) && (result != 1); ++i)
+        result = brahe_gcf(result, values[i]);
 
-    while (y != 0)
+    return result;
+}
+
+// lowest common multiple of an array, reporting overflow
+bool brahe_lcm_array(const uint64_t * values, const size_t n, uint64_t * result)
+{
+    size_t i;
+
+    if ((values == NULL) || (result == NULL))
+        return false;
+
+    *result = (n > 0) ? 1 : 0;
+
+    for (i = 0; i < n; ++i)
     {
-        temp = x % y;
-        x = y;
-        y = temp;
+        if (!brahe_lcm_checked(*result, values[i], result))
+            return false;
+
+        // zero is a multiple of everything
+        if (*result == 0)
+            break;
     }
 
-    return x;
+    return true;
 }
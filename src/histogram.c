@@ -0,0 +1,618 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+#include "mathtools.h"
+#include "internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+    Histograms. Counts are stored with an underflow slot before the bins and
+    an overflow slot after them, so every value maps to a slot without
+    branching: bin indexes are clamped, not tested.
+
+    Bulk additions spread consecutive values over several lanes of
+    sub-counts, so that runs of values in the same bin do not serialize on
+    a single counter through store-to-load forwarding; the lanes are folded
+    into the main counts at the end of each call.
+*/
+
+// number of sub-histograms used by bulk additions
+#define LANES 4
+
+// largest run of values counted in 32-bit lanes before folding
+#define LANE_LIMIT ((size_t)1 << 30)
+
+// most bins whose slot and lane arrays have sizes that fit in a size_t
+#define MAX_BINS (SIZE_MAX / (LANES * sizeof(uint64_t)) - 2)
+
+// HDR histograms use the leading bits of the binary representation of a value
+static uint64_t double_bits(const double x)
+{
+    uint64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    return bits;
+}
+
+static double bits_double(const uint64_t bits)
+{
+    double x;
+    memcpy(&x, &bits, sizeof(x));
+    return x;
+}
+
+// common initialization once the layout is known
+static bool histogram_alloc(brahe_histogram_t * hist, const brahe_histogram_type_t type, const size_t bins)
+{
+    hist->m_slots = NULL;
+    hist->m_lanes = NULL;
+
+    if (bins > MAX_BINS)
+        return false;
+
+    hist->m_type  = type;
+    hist->m_bins  = bins;
+    hist->m_total = 0;
+    hist->m_allocator = *brahe_allocator();
+    hist->m_slots = (uint64_t *)brahe_allocate(&hist->m_allocator, sizeof(uint64_t) * (bins + 2), BRAHE_DEFAULT_ALIGN);
+    hist->m_lanes = (uint32_t *)brahe_allocate(&hist->m_allocator, sizeof(uint32_t) * LANES * (bins + 2), BRAHE_DEFAULT_ALIGN);
+
+    if ((hist->m_slots == NULL) || (hist->m_lanes == NULL))
+    {
+        brahe_release(&hist->m_allocator, hist->m_slots);
+        brahe_release(&hist->m_allocator, hist->m_lanes);
+        hist->m_slots = NULL;
+        hist->m_lanes = NULL;
+        return false;
+    }
+
+    memset(hist->m_slots, 0, sizeof(uint64_t) * (bins + 2));
+    memset(hist->m_lanes, 0, sizeof(uint32_t) * LANES * (bins + 2));
+    return true;
+}
+
+bool brahe_histogram_init_linear(brahe_histogram_t * hist, const double lo, const double hi, const size_t bins)
+{
+    if ((hist == NULL) || (bins == 0) || !(lo < hi))
+        return false;
+
+    hist->m_lo = lo;
+    hist->m_hi = hi;
+    hist->m_scale = (double)bins / (hi - lo);
+    hist->m_shift = 0;
+    hist->m_offset = 0;
+
+    return histogram_alloc(hist, BRAHE_HISTOGRAM_LINEAR, bins);
+}
+
+bool brahe_histogram_init_log(brahe_histogram_t * hist, const double lo, const double hi, const size_t bins)
+{
+    if ((hist == NULL) || (bins == 0) || !(lo > 0.0) || !(lo < hi))
+        return false;
+
+    hist->m_lo = lo;
+    hist->m_hi = hi;
+    hist->m_scale = (double)bins / log(hi / lo);
+    hist->m_shift = 0;
+    hist->m_offset = 0;
+
+    return histogram_alloc(hist, BRAHE_HISTOGRAM_LOG, bins);
+}
+
+bool brahe_histogram_init_hdr(brahe_histogram_t * hist, const double lo, const double hi, const unsigned int precision)
+{
+    uint64_t first, last;
+
+    if ((hist == NULL) || !(lo >= DBL_MIN) || !(lo < hi) || (hi > DBL_MAX) || (precision > 20))
+        return false;
+
+    // bins are the distinct values of the top (12 + precision) bits of a
+    // double, from the power of two at or below lo to the bin holding hi
+    hist->m_shift = 52 - precision;
+    first = double_bits(lo) >> hist->m_shift;
+    last  = double_bits(hi) >> hist->m_shift;
+
+    // hi is exclusive; a bin starting exactly at hi is not needed
+    if ((last << hist->m_shift) == double_bits(hi))
+        --last;
+
+    hist->m_offset = first;
+    hist->m_lo = bits_double(first << hist->m_shift);
+    hist->m_hi = bits_double((last + 1) << hist->m_shift);
+    hist->m_scale = 0.0;
+
+    return histogram_alloc(hist, BRAHE_HISTOGRAM_HDR, (size_t)(last - first + 1));
+}
+
+void brahe_histogram_free(brahe_histogram_t * hist)
+{
+    if (hist != NULL)
+    {
+        brahe_release(&hist->m_allocator, hist->m_slots);
+        brahe_release(&hist->m_allocator, hist->m_lanes);
+        hist->m_slots = NULL;
+        hist->m_lanes = NULL;
+        hist->m_bins = 0;
+        hist->m_total = 0;
+    }
+}
+
+void brahe_histogram_clear(brahe_histogram_t * hist)
+{
+    if ((hist != NULL) && (hist->m_slots != NULL))
+    {
+        memset(hist->m_slots, 0, sizeof(uint64_t) * (hist->m_bins + 2));
+        hist->m_total = 0;
+    }
+}
+
+// slot for a value: 0 for underflow, 1..bins for the bins, bins + 1 for overflow or NaN
+static size_t slot_of(const brahe_histogram_t * hist, const double x)
+{
+    double top = (double)hist->m_bins;
+    double t;
+
+    if (hist->m_type == BRAHE_HISTOGRAM_HDR)
+    {
+        // negative values and NaN would alias other bit patterns, so
+        // classify against the range first
+        t = (double)(int64_t)((double_bits(x) >> hist->m_shift) - hist->m_offset);
+        t = (x >= hist->m_lo) ? t : -1.0;
+        t = (x < hist->m_hi) ? t : top;
+    }
+    else
+    {
+        if (hist->m_type == BRAHE_HISTOGRAM_LINEAR)
+            t = (x - hist->m_lo) * hist->m_scale;
+        else if (x < hist->m_lo)
+            t = -1.0; // includes zero and negative values, which have no logarithm
+        else
+            t = log(x / hist->m_lo) * hist->m_scale;
+
+        // written so that NaN lands in the overflow slot
+        t = (t < top) ? t : top;
+        t = (t >= 0.0) ? t : -1.0;
+    }
+
+    return (size_t)(int64_t)(t + 1.0);
+}
+
+void brahe_histogram_add(brahe_histogram_t * hist, const double x)
+{
+    if ((hist != NULL) && (hist->m_slots != NULL))
+    {
+        ++hist->m_slots[slot_of(hist, x)];
+        ++hist->m_total;
+    }
+}
+
+#if defined(BRAHE_HAVE_SSE2)
+// slots for two linear-histogram values at once
+static void linear_slots2(const brahe_histogram_t * hist, const double * x, size_t * slots)
+{
+    __m128d t = _mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(x), _mm_set1_pd(hist->m_lo)), _mm_set1_pd(hist->m_scale));
+    __m128d top = _mm_set1_pd((double)hist->m_bins);
+    __m128d below = _mm_set1_pd(-1.0);
+    __m128i s;
+
+    // same clamping as slot_of, as masks; NaN compares false and becomes top
+    __m128d in = _mm_cmplt_pd(t, top);
+    t = _mm_or_pd(_mm_and_pd(in, t), _mm_andnot_pd(in, top));
+    in = _mm_cmpge_pd(t, _mm_setzero_pd());
+    t = _mm_or_pd(_mm_and_pd(in, t), _mm_andnot_pd(in, below));
+
+    s = _mm_cvttpd_epi32(_mm_add_pd(t, _mm_set1_pd(1.0)));
+    slots[0] = (size_t)_mm_cvtsi128_si32(s);
+    slots[1] = (size_t)_mm_cvtsi128_si32(_mm_srli_si128(s, 4));
+}
+#endif
+
+void brahe_histogram_add_n(brahe_histogram_t * hist, const double * data, const size_t n)
+{
+    size_t i, j, start, end, slots;
+    uint32_t * lanes;
+
+    if ((hist == NULL) || (hist->m_slots == NULL) || (data == NULL))
+        return;
+
+    slots = hist->m_bins + 2;
+
+    // folding lanes costs O(bins); not worth it for a handful of values
+    if (n < slots)
+    {
+        for (i = 0; i < n; ++i)
+            ++hist->m_slots[slot_of(hist, data[i])];
+
+        hist->m_total += n;
+        return;
+    }
+
+    lanes = hist->m_lanes;
+
+    for (start = 0; start < n; start = end)
+    {
+        end = (n - start > LANE_LIMIT) ? start + LANE_LIMIT : n;
+        i = start;
+
+#if defined(BRAHE_HAVE_SSE2)
+        // linear bins fit in 32-bit indexes for any sensible bin count
+        if ((hist->m_type == BRAHE_HISTOGRAM_LINEAR) && (hist->m_bins < (size_t)INT32_MAX))
+        {
+            size_t s[4];
+
+            for (; i + 4 <= end; i += 4)
+            {
+                linear_slots2(hist, data + i, s);
+                linear_slots2(hist, data + i + 2, s + 2);
+                ++lanes[s[0]];
+                ++lanes[slots + s[1]];
+                ++lanes[2 * slots + s[2]];
+                ++lanes[3 * slots + s[3]];
+            }
+        }
+#endif
+
+        for (; i + 4 <= end; i += 4)
+        {
+            size_t s0 = slot_of(hist, data[i]);
+            size_t s1 = slot_of(hist, data[i + 1]);
+            size_t s2 = slot_of(hist, data[i + 2]);
+            size_t s3 = slot_of(hist, data[i + 3]);
+            ++lanes[s0];
+            ++lanes[slots + s1];
+            ++lanes[2 * slots + s2];
+            ++lanes[3 * slots + s3];
+        }
+
+        for (; i < end; ++i)
+            ++lanes[slot_of(hist, data[i])];
+
+        // fold the lanes into the main counts and clear them for next time
+        for (j = 0; j < slots; ++j)
+        {
+            hist->m_slots[j] += (uint64_t)lanes[j] + lanes[slots + j] + lanes[2 * slots + j] + lanes[3 * slots + j];
+            lanes[j] = lanes[slots + j] = lanes[2 * slots + j] = lanes[3 * slots + j] = 0;
+        }
+    }
+
+    hist->m_total += n;
+}
+
+const uint64_t * brahe_histogram_counts(const brahe_histogram_t * hist)
+{
+    return ((hist != NULL) && (hist->m_slots != NULL)) ? hist->m_slots + 1 : NULL;
+}
+
+uint64_t brahe_histogram_underflow(const brahe_histogram_t * hist)
+{
+    return ((hist != NULL) && (hist->m_slots != NULL)) ? hist->m_slots[0] : 0;
+}
+
+uint64_t brahe_histogram_overflow(const brahe_histogram_t * hist)
+{
+    return ((hist != NULL) && (hist->m_slots != NULL)) ? hist->m_slots[hist->m_bins + 1] : 0;
+}
+
+uint64_t brahe_histogram_total(const brahe_histogram_t * hist)
+{
+    return (hist != NULL) ? hist->m_total : 0;
+}
+
+double brahe_histogram_edge(const brahe_histogram_t * hist, const size_t i)
+{
+    double result = 0.0;
+
+    if ((hist != NULL) && (i <= hist->m_bins))
+    {
+        switch (hist->m_type)
+        {
+            case BRAHE_HISTOGRAM_LINEAR:
+                result = (i == hist->m_bins) ? hist->m_hi : hist->m_lo + (double)i / hist->m_scale;
+                break;
+
+            case BRAHE_HISTOGRAM_LOG:
+                result = (i == hist->m_bins) ? hist->m_hi : hist->m_lo * exp((double)i / hist->m_scale);
+                break;
+
+            case BRAHE_HISTOGRAM_HDR:
+                result = bits_double((hist->m_offset + i) << hist->m_shift);
+                break;
+        }
+    }
+
+    return result;
+}
+
+bool brahe_histogram_merge(brahe_histogram_t * hist, const brahe_histogram_t * other)
+{
+    size_t i;
+
+    if ((hist == NULL) || (other == NULL) || (hist->m_slots == NULL) || (other->m_slots == NULL)
+    ||  (hist->m_type != other->m_type) || (hist->m_bins != other->m_bins)
+    ||  (hist->m_lo != other->m_lo) || (hist->m_hi != other->m_hi))
+        return false;
+
+    for (i = 0; i < hist->m_bins + 2; ++i)
+        hist->m_slots[i] += other->m_slots[i];
+
+    hist->m_total += other->m_total;
+
+    return true;
+}
+
+double brahe_histogram_quantile(const brahe_histogram_t * hist, const double q)
+{
+    size_t i;
+    double target, cumulative, lo, hi;
+
+    if ((hist == NULL) || (hist->m_slots == NULL) || (hist->m_total == 0) || !(q >= 0.0) || !(q <= 1.0))
+#if defined(_MSC_VER)
+        return 0.0;
+#else
+        return NAN;
+#endif
+
+    target = q * (double)hist->m_total;
+    cumulative = (double)hist->m_slots[0];
+
+    // anything in the underflow slot is only known to be below the range
+    if ((cumulative > 0.0) && (target <= cumulative))
+        return hist->m_lo;
+
+    for (i = 0; i < hist->m_bins; ++i)
+    {
+        double count = (double)hist->m_slots[i + 1];
+
+        if ((count > 0.0) && (target <= cumulative + count))
+        {
+            // assume values are spread evenly through the bin
+            lo = brahe_histogram_edge(hist, i);
+            hi = brahe_histogram_edge(hist, i + 1);
+            return lo + (hi - lo) * (target - cumulative) / count;
+        }
+
+        cumulative += count;
+    }
+
+    return hist->m_hi;
+}
+
+/*
+    Serialized form, all integers as unsigned LEB128 varints and doubles as
+    eight little-endian bytes:
+
+        "BH1" type bins lo hi shift nonzero { gap count }...
+
+    where each nonzero slot (including underflow and overflow) is recorded as
+    its distance from the previous one and its count.
+*/
+
+static size_t put_varint(uint8_t * buffer, size_t pos, const size_t len, uint64_t x)
+{
+    do
+    {
+        uint8_t byte = (uint8_t)(x & 0x7F);
+        x >>= 7;
+
+        if (x != 0)
+            byte |= 0x80;
+
+        if (pos < len)
+            buffer[pos] = byte;
+
+        ++pos;
+    }
+    while (x != 0);
+
+    return pos;
+}
+
+static size_t put_double(uint8_t * buffer, size_t pos, const size_t len, const double x)
+{
+    int b;
+    uint64_t bits = double_bits(x);
+
+    for (b = 0; b < 8; ++b, ++pos)
+    {
+        if (pos < len)
+            buffer[pos] = (uint8_t)(bits >> (8 * b));
+    }
+
+    return pos;
+}
+
+static bool get_varint(const uint8_t * buffer, size_t * pos, const size_t len, uint64_t * x)
+{
+    int shift = 0;
+
+    *x = 0;
+
+    while ((*pos < len) && (shift < 64))
+    {
+        uint8_t byte = buffer[(*pos)++];
+        *x |= (uint64_t)(byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0)
+            return true;
+
+        shift += 7;
+    }
+
+    return false;
+}
+
+static bool get_double(const uint8_t * buffer, size_t * pos, const size_t len, double * x)
+{
+    int b;
+    uint64_t bits = 0;
+
+    if (len - *pos < 8)
+        return false;
+
+    for (b = 0; b < 8; ++b)
+        bits |= (uint64_t)buffer[(*pos)++] << (8 * b);
+
+    *x = bits_double(bits);
+    return true;
+}
+
+size_t brahe_histogram_serialize(const brahe_histogram_t * hist, uint8_t * buffer, size_t len)
+{
+    size_t i, last, pos = 0;
+    uint64_t nonzero = 0;
+
+    if ((hist == NULL) || (hist->m_slots == NULL))
+        return 0;
+
+    // with no buffer, only measure
+    if (buffer == NULL)
+        len = 0;
+
+    for (i = 0; i < hist->m_bins + 2; ++i)
+    {
+        if (hist->m_slots[i] != 0)
+            ++nonzero;
+    }
+
+    pos = put_varint(buffer, pos, len, 'B');
+    pos = put_varint(buffer, pos, len, 'H');
+    pos = put_varint(buffer, pos, len, '1');
+    pos = put_varint(buffer, pos, len, (uint64_t)hist->m_type);
+    pos = put_varint(buffer, pos, len, (uint64_t)hist->m_bins);
+    pos = put_double(buffer, pos, len, hist->m_lo);
+    pos = put_double(buffer, pos, len, hist->m_hi);
+    pos = put_varint(buffer, pos, len, (uint64_t)hist->m_shift);
+    pos = put_varint(buffer, pos, len, nonzero);
+
+    for (i = 0, last = 0; i < hist->m_bins + 2; ++i)
+    {
+        if (hist->m_slots[i] != 0)
+        {
+            pos = put_varint(buffer, pos, len, (uint64_t)(i - last));
+            pos = put_varint(buffer, pos, len, hist->m_slots[i]);
+            last = i;
+        }
+    }
+
+    return pos;
+}
+
+bool brahe_histogram_deserialize(brahe_histogram_t * hist, const uint8_t * buffer, const size_t len)
+{
+    size_t pos = 0, slot = 0;
+    uint64_t magic[3], type, bins, shift, nonzero, gap, count, i;
+    double lo, hi;
+    bool ok;
+
+    if ((hist == NULL) || (buffer == NULL))
+        return false;
+
+    ok = get_varint(buffer, &pos, len, &magic[0])
+      && get_varint(buffer, &pos, len, &magic[1])
+      && get_varint(buffer, &pos, len, &magic[2])
+      && (magic[0] == 'B') && (magic[1] == 'H') && (magic[2] == '1')
+      && get_varint(buffer, &pos, len, &type)
+      && get_varint(buffer, &pos, len, &bins)
+      && get_double(buffer, &pos, len, &lo)
+      && get_double(buffer, &pos, len, &hi)
+      && get_varint(buffer, &pos, len, &shift)
+      && get_varint(buffer, &pos, len, &nonzero);
+
+    // every nonzero slot takes at least two bytes, so a buffer cannot claim
+    // more of them than it holds; this also bounds bins before allocating
+    if (!ok || (bins > MAX_BINS) || (nonzero > bins + 2) || (nonzero > (len - pos) / 2))
+        return false;
+
+    switch (type)
+    {
+        case BRAHE_HISTOGRAM_LINEAR:
+            ok = brahe_histogram_init_linear(hist, lo, hi, (size_t)bins);
+            break;
+
+        case BRAHE_HISTOGRAM_LOG:
+            ok = brahe_histogram_init_log(hist, lo, hi, (size_t)bins);
+            break;
+
+        case BRAHE_HISTOGRAM_HDR:
+            ok = (shift <= 52) && brahe_histogram_init_hdr(hist, lo, hi, (unsigned int)(52 - shift));
+            break;
+
+        default:
+            ok = false;
+    }
+
+    if (!ok)
+        return false;
+
+    // an HDR range must reproduce the same bins
+    if (hist->m_bins != bins)
+    {
+        brahe_histogram_free(hist);
+        return false;
+    }
+
+    for (i = 0; i < nonzero; ++i)
+    {
+        if (!get_varint(buffer, &pos, len, &gap) || !get_varint(buffer, &pos, len, &count)
+        ||  (gap > bins + 1 - slot))
+        {
+            brahe_histogram_free(hist);
+            return false;
+        }
+
+        slot += (size_t)gap;
+        hist->m_slots[slot] += count;
+        hist->m_total += count;
+    }
+
+    return true;
+}
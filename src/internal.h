@@ -0,0 +1,332 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+/*
+    Internal definitions shared by the library sources; this header is not
+    installed and is not part of the public interface.
+*/
+
+#if !defined(LIBBRAHE_INTERNAL_H)
+#define LIBBRAHE_INTERNAL_H
+
+#include "mathtools.h"
+#include <stdlib.h>
+
+#if defined(_MSC_VER)
+#include <malloc.h>
+#include <intrin.h>
+#endif
+
+// inline functions, for compilers that predate C99
+#if defined(_MSC_VER)
+#define BRAHE_INLINE static __inline
+#else
+#define BRAHE_INLINE static inline
+#endif
+
+// SSE2 is part of the x86-64 baseline; 32-bit x86 must ask for it
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define BRAHE_HAVE_SSE2
+#include <emmintrin.h>
+#if defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+#endif
+
+// functions built for instruction sets beyond the compiler's baseline,
+// chosen at run time; see dispatch.h
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || (__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))
+#define BRAHE_HAVE_X86_DISPATCH
+#define BRAHE_TARGET(isa) __attribute__((target(isa)))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#define BRAHE_HAVE_X86_DISPATCH
+#define BRAHE_TARGET(isa)
+#endif
+
+// POSIX threads, everywhere but Windows
+#if !defined(_MSC_VER) && !defined(BRAHE_NO_THREADS)
+#define BRAHE_HAVE_PTHREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+// counters and probes, when built with BRAHE_INSTRUMENT
+#include "metrics.h"
+
+// memory aligned for vector loads; release with brahe_aligned_free
+BRAHE_INLINE void * brahe_aligned_malloc(const size_t size, const size_t alignment)
+{
+#if defined(_MSC_VER)
+    return _aligned_malloc(size, alignment);
+#else
+    void * result = NULL;
+
+    if (posix_memalign(&result, alignment, size) != 0)
+        result = NULL;
+
+    return result;
+#endif
+}
+
+BRAHE_INLINE void brahe_aligned_free(void * p)
+{
+#if defined(_MSC_VER)
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+// alignment used for arrays the library allocates for SIMD processing
+#define BRAHE_SIMD_ALIGN 64
+
+// alignment of arrays of double and smaller, as malloc provides
+#define BRAHE_DEFAULT_ALIGN 16
+
+// the allocator installed by brahe_set_allocator
+const brahe_allocator_t * brahe_allocator(void);
+
+BRAHE_INLINE void * brahe_allocate(const brahe_allocator_t * a, const size_t size, const size_t alignment)
+{
+    void * p = a->alloc(size, alignment, a->context);
+
+    if (p != NULL)
+        BRAHE_METRIC_ALLOCATED(size);
+
+    return p;
+}
+
+BRAHE_INLINE void brahe_release(const brahe_allocator_t * a, void * p)
+{
+    if (p != NULL)
+        a->free(p, a->context);
+}
+
+// Neumaier's variant of Kahan summation; the true sum is *sum + *comp
+BRAHE_INLINE void brahe_compensated_add(double * sum, double * comp, const double x)
+{
+    double t = *sum + x;
+
+    if (fabs(*sum) >= fabs(x))
+        *comp += (*sum - t) + x;
+    else
+        *comp += (x - t) + *sum;
+
+    *sum = t;
+}
+
+// statistics of a stream, merged a block at a time (Chan, Golub and LeVeque)
+typedef struct
+{
+    uint64_t m_n;
+    double   m_min;
+    double   m_max;
+    double   m_mean;
+    double   m_m2;   // sum of squared differences from the mean
+}
+brahe_running_stats_t;
+
+// merge the statistics of a block of n values into s
+BRAHE_INLINE void brahe_running_merge(brahe_running_stats_t * s, const uint64_t n, const double min, const double max,
+                                      const double mean, const double m2)
+{
+    if (s->m_n == 0)
+    {
+        s->m_min  = min;
+        s->m_max  = max;
+        s->m_mean = mean;
+        s->m_m2   = m2;
+    }
+    else
+    {
+        double total = (double)(s->m_n + n);
+        double delta = mean - s->m_mean;
+
+        if (min < s->m_min)
+            s->m_min = min;
+
+        if (max > s->m_max)
+            s->m_max = max;
+
+        s->m_mean += delta * ((double)n / total);
+        s->m_m2   += m2 + delta * delta * ((double)s->m_n * (double)n / total);
+    }
+
+    s->m_n += n;
+}
+
+// process elements [begin, end) of a parallel loop, as worker number
+// <i>worker</i>, which is less than brahe_exec_threads
+typedef void (*brahe_task_t)(void * context, const size_t begin, const size_t end, const size_t worker);
+
+// run a task over [0, n) in chunks of <i>grain</i> elements (the last may be
+// shorter), on the workers of <i>exec</i>; chunks run in order on the calling
+// thread when exec is NULL, has no threads, or n is below its threshold
+void brahe_exec_for(const brahe_exec_t * exec, const size_t n, const size_t grain, brahe_task_t task, void * context);
+
+// a seed for one segment of a long seeded sequence; splitmix64 keeps
+// neighbouring segments unrelated
+BRAHE_INLINE uint32_t brahe_segment_seed(const uint32_t seed, const size_t segment)
+{
+    uint64_t z = ((uint64_t)seed << 32) + (uint64_t)segment + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+
+    // zero asks brahe_prng_init for an unpredictable seed
+    return ((uint32_t)z != 0) ? (uint32_t)z : 1;
+}
+
+// number of trailing zero bits in a nonzero value
+BRAHE_INLINE int brahe_ctz64(const uint64_t x)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return (int)index;
+#else
+    int n = 0;
+    uint64_t v = x;
+
+    while ((v & 1) == 0)
+    {
+        v >>= 1;
+        ++n;
+    }
+
+    return n;
+#endif
+}
+
+// number of leading zero bits in a nonzero value
+BRAHE_INLINE int brahe_clz64(const uint64_t x)
+{
+#if defined(__GNUC__)
+    return __builtin_clzll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, x);
+    return 63 - (int)index;
+#else
+    int n = 0;
+    uint64_t v = x;
+
+    while ((v & 0x8000000000000000ULL) == 0)
+    {
+        v <<= 1;
+        ++n;
+    }
+
+    return n;
+#endif
+}
+
+// x * y, or false if the product does not fit in 64 bits
+BRAHE_INLINE bool brahe_mul_checked(const uint64_t x, const uint64_t y, uint64_t * product)
+{
+#if defined(__GNUC__) && (__GNUC__ >= 5)
+    return !__builtin_mul_overflow(x, y, product);
+#else
+    if ((y != 0) && (x > UINT64_MAX / y))
+        return false;
+
+    *product = x * y;
+    return true;
+#endif
+}
+
+// full 128-bit product of two 64-bit values; returns the low half
+BRAHE_INLINE uint64_t brahe_mul_wide(const uint64_t x, const uint64_t y, uint64_t * hi)
+{
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 p = (unsigned __int128)x * y;
+    *hi = (uint64_t)(p >> 64);
+    return (uint64_t)p;
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return _umul128(x, y, hi);
+#else
+    // schoolbook multiplication on 32-bit halves
+    uint64_t xl = x & 0xFFFFFFFFU, xh = x >> 32;
+    uint64_t yl = y & 0xFFFFFFFFU, yh = y >> 32;
+    uint64_t ll = xl * yl, lh = xl * yh, hl = xh * yl, hh = xh * yh;
+    uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFFU) + (hl & 0xFFFFFFFFU);
+
+    *hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+    return (mid << 32) | (ll & 0xFFFFFFFFU);
+#endif
+}
+
+#if defined(BRAHE_HAVE_SSE2)
+// round to nearest, ties to even, as brahe_round_nearest does; SSE4.1
+// roundpd or, with SSE2 alone, adding and subtracting 2^52 (which relies
+// on the default rounding mode)
+BRAHE_INLINE __m128d brahe_round_pd(const __m128d x)
+{
+#if defined(__SSE4_1__)
+    return _mm_round_pd(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+#else
+    const __m128d sign = _mm_set1_pd(-0.0);
+    const __m128d big  = _mm_set1_pd(4503599627370496.0);
+    __m128d ax = _mm_andnot_pd(sign, x);
+    __m128d r  = _mm_sub_pd(_mm_add_pd(ax, big), big);
+    __m128d small = _mm_cmplt_pd(ax, big);
+
+    // values of 2^52 and up, infinities and NaN are already integral
+    r = _mm_or_pd(_mm_and_pd(small, r), _mm_andnot_pd(small, ax));
+    return _mm_or_pd(r, _mm_and_pd(sign, x));
+#endif
+}
+#endif
+
+#endif
@@ -0,0 +1,506 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+#include "dispatch.h"
+
+/*
+    Portable and SSE2 kernels. SSE2 is part of the x86-64 baseline, so its
+    kernels need no special compilation; the wider sets are in
+    kernels_avx2.c and kernels_avx512.c. Every variant of a kernel computes
+    the same thing, though reductions may associate their sums differently.
+*/
+
+//-----------------------------------------------------------------------------
+// portable C
+//-----------------------------------------------------------------------------
+
+/*
+    The scalar reductions and butterflies are written once, as macros, and
+    instantiated for double and float. Reductions accumulate in double
+    whatever the element type.
+*/
+
+#define DEFINE_MINMAX_SUM(name, real)                                                       \
+    static void name(const real * data, const size_t n, double * min, double * max, double * sum) \
+    {                                                                                       \
+        size_t i;                                                                           \
+        double lo = DBL_MAX, hi = -DBL_MAX, total = 0.0;                                    \
+                                                                                            \
+        for (i = 0; i < n; ++i)                                                             \
+        {                                                                                   \
+            if (data[i] < lo)                                                               \
+                lo = data[i];                                                               \
+                                                                                            \
+            if (data[i] > hi)                                                               \
+                hi = data[i];                                                               \
+                                                                                            \
+            total += data[i];                                                               \
+        }                                                                                   \
+                                                                                            \
+        *min = lo;                                                                          \
+        *max = hi;                                                                          \
+        *sum = total;                                                                       \
+    }
+
+#define DEFINE_SUM_SQ_DEV(name, real)                                                       \
+    static double name(const real * data, const size_t n, const double mean)                \
+    {                                                                                       \
+        size_t i;                                                                           \
+        double diff, total = 0.0;                                                           \
+                                                                                            \
+        for (i = 0; i < n; ++i)                                                             \
+        {                                                                                   \
+            diff = data[i] - mean;                                                          \
+            total += diff * diff;                                                           \
+        }                                                                                   \
+                                                                                            \
+        return total;                                                                       \
+    }
+
+#define DEFINE_FFT_PASS(name, real)                                                         \
+    static void name(real * re, real * im, const size_t n, const size_t half, const real * wr, const real * wi) \
+    {                                                                                       \
+        size_t start, j, a, b;                                                              \
+        real tr, ti;                                                                        \
+                                                                                            \
+        for (start = 0; start < n; start += 2 * half)                                       \
+        {                                                                                   \
+            for (j = 0; j < half; ++j)                                                      \
+            {                                                                               \
+                a = start + j;                                                              \
+                b = a + half;                                                               \
+                                                                                            \
+                tr = re[b] * wr[j] - im[b] * wi[j];                                         \
+                ti = re[b] * wi[j] + im[b] * wr[j];                                         \
+                                                                                            \
+                re[b] = re[a] - tr;                                                         \
+                im[b] = im[a] - ti;                                                         \
+                re[a] += tr;                                                                \
+                im[a] += ti;                                                                \
+            }                                                                               \
+        }                                                                                   \
+    }
+
+DEFINE_MINMAX_SUM(minmax_sum_scalar, double)
+DEFINE_MINMAX_SUM(minmax_sum_f_scalar, float)
+DEFINE_SUM_SQ_DEV(sum_sq_dev_scalar, double)
+DEFINE_SUM_SQ_DEV(sum_sq_dev_f_scalar, float)
+DEFINE_FFT_PASS(fft_pass_scalar, double)
+DEFINE_FFT_PASS(fft_pass_f_scalar, float)
+
+static void mt_twist_scalar(uint32_t * m)
+{
+    static const uint32_t mag01[2] = { 0, BRAHE_MT_MATRIX_A };
+    size_t kk;
+    uint32_t y;
+
+    for (kk = 0; kk < BRAHE_MT_N - BRAHE_MT_M; ++kk)
+    {
+        y = (m[kk] & BRAHE_MT_UPPER_MASK) | (m[kk + 1] & BRAHE_MT_LOWER_MASK);
+        m[kk] = m[kk + BRAHE_MT_M] ^ (y >> 1) ^ mag01[y & 0x1];
+    }
+
+    for (; kk < BRAHE_MT_N - 1; ++kk)
+    {
+        y = (m[kk] & BRAHE_MT_UPPER_MASK) | (m[kk + 1] & BRAHE_MT_LOWER_MASK);
+        m[kk] = m[kk - (BRAHE_MT_N - BRAHE_MT_M)] ^ (y >> 1) ^ mag01[y & 0x1];
+    }
+
+    y = (m[BRAHE_MT_N - 1] & BRAHE_MT_UPPER_MASK) | (m[0] & BRAHE_MT_LOWER_MASK);
+    m[BRAHE_MT_N - 1] = m[BRAHE_MT_M - 1] ^ (y >> 1) ^ mag01[y & 0x1];
+}
+
+static void mt_temper_scalar(const uint32_t * m, uint32_t * out, const size_t n)
+{
+    size_t i;
+    uint32_t y;
+
+    for (i = 0; i < n; ++i)
+    {
+        y = m[i];
+        y ^= (y >> 11);
+        y ^= (y <<  7) & 0x9d2c5680UL;
+        y ^= (y << 15) & 0xefc60000UL;
+        y ^= (y >> 18);
+        out[i] = y;
+    }
+}
+
+static void round_nearest_scalar(const double * in, double * out, const size_t n)
+{
+    size_t i;
+
+    for (i = 0; i < n; ++i)
+        out[i] = brahe_round_nearest(in[i]);
+}
+
+void brahe_bind_kernels_scalar(brahe_kernels_t * k)
+{
+    size_t i;
+
+    k->m_minmax_sum = minmax_sum_scalar;
+    k->m_sum_sq_dev = sum_sq_dev_scalar;
+    k->m_fft_pass = fft_pass_scalar;
+    k->m_mt_twist = mt_twist_scalar;
+    k->m_mt_temper = mt_temper_scalar;
+    k->m_round_nearest = round_nearest_scalar;
+    k->m_minmax_sum_f = minmax_sum_f_scalar;
+    k->m_sum_sq_dev_f = sum_sq_dev_f_scalar;
+    k->m_fft_pass_f = fft_pass_f_scalar;
+
+    for (i = 0; i < BRAHE_KERNEL_COUNT; ++i)
+        k->m_isa[i] = BRAHE_ISA_SCALAR;
+}
+
+//-----------------------------------------------------------------------------
+// SSE2
+//-----------------------------------------------------------------------------
+
+#if defined(BRAHE_HAVE_SSE2)
+
+static void minmax_sum_sse2(const double * data, const size_t n, double * min, double * max, double * sum)
+{
+    size_t i = 0;
+    double lo, hi, total, t[2];
+    __m128d vlo = _mm_set1_pd(DBL_MAX), vhi = _mm_set1_pd(-DBL_MAX);
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+
+    // two sums, to hide the latency of addition
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128d x0 = _mm_loadu_pd(data + i);
+        __m128d x1 = _mm_loadu_pd(data + i + 2);
+
+        // min and max return their second operand for NaN, which skips it
+        vlo = _mm_min_pd(x1, _mm_min_pd(x0, vlo));
+        vhi = _mm_max_pd(x1, _mm_max_pd(x0, vhi));
+        s0 = _mm_add_pd(s0, x0);
+        s1 = _mm_add_pd(s1, x1);
+    }
+
+    _mm_storeu_pd(t, vlo);
+    lo = (t[0] < t[1]) ? t[0] : t[1];
+    _mm_storeu_pd(t, vhi);
+    hi = (t[0] > t[1]) ? t[0] : t[1];
+    _mm_storeu_pd(t, _mm_add_pd(s0, s1));
+    total = t[0] + t[1];
+
+    for (; i < n; ++i)
+    {
+        if (data[i] < lo)
+            lo = data[i];
+
+        if (data[i] > hi)
+            hi = data[i];
+
+        total += data[i];
+    }
+
+    *min = lo;
+    *max = hi;
+    *sum = total;
+}
+
+static double sum_sq_dev_sse2(const double * data, const size_t n, const double mean)
+{
+    size_t i = 0;
+    double diff, total, t[2];
+    __m128d m = _mm_set1_pd(mean);
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128d d0 = _mm_sub_pd(_mm_loadu_pd(data + i), m);
+        __m128d d1 = _mm_sub_pd(_mm_loadu_pd(data + i + 2), m);
+
+        s0 = _mm_add_pd(s0, _mm_mul_pd(d0, d0));
+        s1 = _mm_add_pd(s1, _mm_mul_pd(d1, d1));
+    }
+
+    _mm_storeu_pd(t, _mm_add_pd(s0, s1));
+    total = t[0] + t[1];
+
+    for (; i < n; ++i)
+    {
+        diff = data[i] - mean;
+        total += diff * diff;
+    }
+
+    return total;
+}
+
+static void fft_pass_sse2(double * re, double * im, const size_t n, const size_t half, const double * wr, const double * wi)
+{
+    size_t start, j;
+
+    if (half < 2)
+    {
+        fft_pass_scalar(re, im, n, half, wr, wi);
+        return;
+    }
+
+    for (start = 0; start < n; start += 2 * half)
+    {
+        double * ra = re + start, * ia = im + start;
+        double * rb = ra + half, * ib = ia + half;
+
+        for (j = 0; j < half; j += 2)
+        {
+            __m128d c = _mm_loadu_pd(wr + j), s = _mm_loadu_pd(wi + j);
+            __m128d xr = _mm_loadu_pd(rb + j), xi = _mm_loadu_pd(ib + j);
+            __m128d tr = _mm_sub_pd(_mm_mul_pd(xr, c), _mm_mul_pd(xi, s));
+            __m128d ti = _mm_add_pd(_mm_mul_pd(xr, s), _mm_mul_pd(xi, c));
+            __m128d ar = _mm_loadu_pd(ra + j), ai = _mm_loadu_pd(ia + j);
+
+            _mm_storeu_pd(rb + j, _mm_sub_pd(ar, tr));
+            _mm_storeu_pd(ib + j, _mm_sub_pd(ai, ti));
+            _mm_storeu_pd(ra + j, _mm_add_pd(ar, tr));
+            _mm_storeu_pd(ia + j, _mm_add_pd(ai, ti));
+        }
+    }
+}
+
+// single precision: values are widened to double, two lanes at a time,
+// before they are compared or summed, so results match the scalar kernel
+static void minmax_sum_f_sse2(const float * data, const size_t n, double * min, double * max, double * sum)
+{
+    size_t i = 0;
+    double lo, hi, total, t[2];
+    __m128d vlo = _mm_set1_pd(DBL_MAX), vhi = _mm_set1_pd(-DBL_MAX);
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(data + i);
+        __m128d x0 = _mm_cvtps_pd(x);
+        __m128d x1 = _mm_cvtps_pd(_mm_movehl_ps(x, x));
+
+        vlo = _mm_min_pd(x1, _mm_min_pd(x0, vlo));
+        vhi = _mm_max_pd(x1, _mm_max_pd(x0, vhi));
+        s0 = _mm_add_pd(s0, x0);
+        s1 = _mm_add_pd(s1, x1);
+    }
+
+    _mm_storeu_pd(t, vlo);
+    lo = (t[0] < t[1]) ? t[0] : t[1];
+    _mm_storeu_pd(t, vhi);
+    hi = (t[0] > t[1]) ? t[0] : t[1];
+    _mm_storeu_pd(t, _mm_add_pd(s0, s1));
+    total = t[0] + t[1];
+
+    for (; i < n; ++i)
+    {
+        if (data[i] < lo)
+            lo = data[i];
+
+        if (data[i] > hi)
+            hi = data[i];
+
+        total += data[i];
+    }
+
+    *min = lo;
+    *max = hi;
+    *sum = total;
+}
+
+static double sum_sq_dev_f_sse2(const float * data, const size_t n, const double mean)
+{
+    size_t i = 0;
+    double diff, total, t[2];
+    __m128d m = _mm_set1_pd(mean);
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(data + i);
+        __m128d d0 = _mm_sub_pd(_mm_cvtps_pd(x), m);
+        __m128d d1 = _mm_sub_pd(_mm_cvtps_pd(_mm_movehl_ps(x, x)), m);
+
+        s0 = _mm_add_pd(s0, _mm_mul_pd(d0, d0));
+        s1 = _mm_add_pd(s1, _mm_mul_pd(d1, d1));
+    }
+
+    _mm_storeu_pd(t, _mm_add_pd(s0, s1));
+    total = t[0] + t[1];
+
+    for (; i < n; ++i)
+    {
+        diff = data[i] - mean;
+        total += diff * diff;
+    }
+
+    return total;
+}
+
+static void fft_pass_f_sse2(float * re, float * im, const size_t n, const size_t half, const float * wr, const float * wi)
+{
+    size_t start, j;
+
+    if (half < 4)
+    {
+        fft_pass_f_scalar(re, im, n, half, wr, wi);
+        return;
+    }
+
+    for (start = 0; start < n; start += 2 * half)
+    {
+        float * ra = re + start, * ia = im + start;
+        float * rb = ra + half, * ib = ia + half;
+
+        for (j = 0; j < half; j += 4)
+        {
+            __m128 c = _mm_loadu_ps(wr + j), s = _mm_loadu_ps(wi + j);
+            __m128 xr = _mm_loadu_ps(rb + j), xi = _mm_loadu_ps(ib + j);
+            __m128 tr = _mm_sub_ps(_mm_mul_ps(xr, c), _mm_mul_ps(xi, s));
+            __m128 ti = _mm_add_ps(_mm_mul_ps(xr, s), _mm_mul_ps(xi, c));
+            __m128 ar = _mm_loadu_ps(ra + j), ai = _mm_loadu_ps(ia + j);
+
+            _mm_storeu_ps(rb + j, _mm_sub_ps(ar, tr));
+            _mm_storeu_ps(ib + j, _mm_sub_ps(ai, ti));
+            _mm_storeu_ps(ra + j, _mm_add_ps(ar, tr));
+            _mm_storeu_ps(ia + j, _mm_add_ps(ai, ti));
+        }
+    }
+}
+
+// four words of the twist at kk, reading the word M ahead (or behind) from src
+BRAHE_INLINE void mt_twist4_sse2(uint32_t * m, const size_t kk, const uint32_t * src)
+{
+    const __m128i upper = _mm_set1_epi32((int)BRAHE_MT_UPPER_MASK);
+    const __m128i lower = _mm_set1_epi32((int)BRAHE_MT_LOWER_MASK);
+    const __m128i matrix = _mm_set1_epi32((int)BRAHE_MT_MATRIX_A);
+
+    __m128i y = _mm_or_si128(_mm_and_si128(_mm_loadu_si128((const __m128i *)(m + kk)), upper),
+                             _mm_and_si128(_mm_loadu_si128((const __m128i *)(m + kk + 1)), lower));
+    __m128i mag = _mm_and_si128(_mm_srai_epi32(_mm_slli_epi32(y, 31), 31), matrix);
+
+    _mm_storeu_si128((__m128i *)(m + kk),
+                     _mm_xor_si128(_mm_xor_si128(_mm_loadu_si128((const __m128i *)src), _mm_srli_epi32(y, 1)), mag));
+}
+
+static void mt_twist_sse2(uint32_t * m)
+{
+    static const uint32_t mag01[2] = { 0, BRAHE_MT_MATRIX_A };
+    size_t kk = 0;
+    uint32_t y;
+
+    // words ahead of kk are still old, and those M - N behind are already new
+    for (; kk + 4 <= BRAHE_MT_N - BRAHE_MT_M; kk += 4)
+        mt_twist4_sse2(m, kk, m + kk + BRAHE_MT_M);
+
+    for (; kk < BRAHE_MT_N - BRAHE_MT_M; ++kk)
+    {
+        y = (m[kk] & BRAHE_MT_UPPER_MASK) | (m[kk + 1] & BRAHE_MT_LOWER_MASK);
+        m[kk] = m[kk + BRAHE_MT_M] ^ (y >> 1) ^ mag01[y & 0x1];
+    }
+
+    for (; kk + 4 <= BRAHE_MT_N - 1; kk += 4)
+        mt_twist4_sse2(m, kk, m + kk - (BRAHE_MT_N - BRAHE_MT_M));
+
+    // the last word wraps around to the first
+    for (; kk < BRAHE_MT_N; ++kk)
+    {
+        y = (m[kk] & BRAHE_MT_UPPER_MASK) | (m[(kk + 1) % BRAHE_MT_N] & BRAHE_MT_LOWER_MASK);
+        m[kk] = m[kk - (BRAHE_MT_N - BRAHE_MT_M)] ^ (y >> 1) ^ mag01[y & 0x1];
+    }
+}
+
+static void mt_temper_sse2(const uint32_t * m, uint32_t * out, const size_t n)
+{
+    const __m128i b = _mm_set1_epi32((int)0x9d2c5680UL);
+    const __m128i c = _mm_set1_epi32((int)0xefc60000UL);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i y = _mm_loadu_si128((const __m128i *)(m + i));
+
+        y = _mm_xor_si128(y, _mm_srli_epi32(y, 11));
+        y = _mm_xor_si128(y, _mm_and_si128(_mm_slli_epi32(y, 7), b));
+        y = _mm_xor_si128(y, _mm_and_si128(_mm_slli_epi32(y, 15), c));
+        y = _mm_xor_si128(y, _mm_srli_epi32(y, 18));
+        _mm_storeu_si128((__m128i *)(out + i), y);
+    }
+
+    mt_temper_scalar(m + i, out + i, n - i);
+}
+
+static void round_nearest_sse2(const double * in, double * out, const size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 2 <= n; i += 2)
+        _mm_storeu_pd(out + i, brahe_round_pd(_mm_loadu_pd(in + i)));
+
+    round_nearest_scalar(in + i, out + i, n - i);
+}
+
+void brahe_bind_kernels_sse2(brahe_kernels_t * k)
+{
+    size_t i;
+
+    k->m_minmax_sum = minmax_sum_sse2;
+    k->m_sum_sq_dev = sum_sq_dev_sse2;
+    k->m_fft_pass = fft_pass_sse2;
+    k->m_mt_twist = mt_twist_sse2;
+    k->m_mt_temper = mt_temper_sse2;
+    k->m_round_nearest = round_nearest_sse2;
+    k->m_minmax_sum_f = minmax_sum_f_sse2;
+    k->m_sum_sq_dev_f = sum_sq_dev_f_sse2;
+    k->m_fft_pass_f = fft_pass_f_sse2;
+
+    for (i = 0; i < BRAHE_KERNEL_COUNT; ++i)
+        k->m_isa[i] = BRAHE_ISA_SSE2;
+}
+
+#endif
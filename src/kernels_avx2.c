@@ -0,0 +1,411 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+#include "dispatch.h"
+
+/*
+    AVX2 kernels. Each function is compiled for AVX2 and FMA, whatever the
+    compiler's baseline, and is only bound when the processor has both.
+*/
+
+#if defined(BRAHE_HAVE_X86_DISPATCH)
+
+#include <immintrin.h>
+
+#define KERNEL_TARGET BRAHE_TARGET("avx2,fma")
+
+KERNEL_TARGET static double hmin_avx2(const __m256d x)
+{
+    __m128d t = _mm_min_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+    return _mm_cvtsd_f64(_mm_min_sd(t, _mm_unpackhi_pd(t, t)));
+}
+
+KERNEL_TARGET static double hmax_avx2(const __m256d x)
+{
+    __m128d t = _mm_max_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+    return _mm_cvtsd_f64(_mm_max_sd(t, _mm_unpackhi_pd(t, t)));
+}
+
+KERNEL_TARGET static double hsum_avx2(const __m256d x)
+{
+    __m128d t = _mm_add_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(t, _mm_unpackhi_pd(t, t)));
+}
+
+KERNEL_TARGET static void minmax_sum_avx2(const double * data, const size_t n, double * min, double * max, double * sum)
+{
+    size_t i = 0;
+    double lo, hi, total;
+    __m256d vlo = _mm256_set1_pd(DBL_MAX), vhi = _mm256_set1_pd(-DBL_MAX);
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256d x0 = _mm256_loadu_pd(data + i);
+        __m256d x1 = _mm256_loadu_pd(data + i + 4);
+
+        // min and max return their second operand for NaN, which skips it
+        vlo = _mm256_min_pd(x1, _mm256_min_pd(x0, vlo));
+        vhi = _mm256_max_pd(x1, _mm256_max_pd(x0, vhi));
+        s0 = _mm256_add_pd(s0, x0);
+        s1 = _mm256_add_pd(s1, x1);
+    }
+
+    lo = hmin_avx2(vlo);
+    hi = hmax_avx2(vhi);
+    total = hsum_avx2(_mm256_add_pd(s0, s1));
+
+    for (; i < n; ++i)
+    {
+        if (data[i] < lo)
+            lo = data[i];
+
+        if (data[i] > hi)
+            hi = data[i];
+
+        total += data[i];
+    }
+
+    *min = lo;
+    *max = hi;
+    *sum = total;
+}
+
+KERNEL_TARGET static double sum_sq_dev_avx2(const double * data, const size_t n, const double mean)
+{
+    size_t i = 0;
+    double diff, total;
+    __m256d m = _mm256_set1_pd(mean);
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256d d0 = _mm256_sub_pd(_mm256_loadu_pd(data + i), m);
+        __m256d d1 = _mm256_sub_pd(_mm256_loadu_pd(data + i + 4), m);
+
+        s0 = _mm256_fmadd_pd(d0, d0, s0);
+        s1 = _mm256_fmadd_pd(d1, d1, s1);
+    }
+
+    total = hsum_avx2(_mm256_add_pd(s0, s1));
+
+    for (; i < n; ++i)
+    {
+        diff = data[i] - mean;
+        total += diff * diff;
+    }
+
+    return total;
+}
+
+KERNEL_TARGET static void fft_pass_avx2(double * re, double * im, const size_t n, const size_t half, const double * wr, const double * wi)
+{
+    size_t start, j;
+
+    if (half < 4)
+    {
+        // the first passes are too narrow for a full vector
+        for (start = 0; start < n; start += 2 * half)
+        {
+            for (j = 0; j < half; ++j)
+            {
+                size_t a = start + j, b = a + half;
+                double tr = re[b] * wr[j] - im[b] * wi[j];
+                double ti = re[b] * wi[j] + im[b] * wr[j];
+
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+
+        return;
+    }
+
+    for (start = 0; start < n; start += 2 * half)
+    {
+        double * ra = re + start, * ia = im + start;
+        double * rb = ra + half, * ib = ia + half;
+
+        for (j = 0; j < half; j += 4)
+        {
+            __m256d c = _mm256_loadu_pd(wr + j), s = _mm256_loadu_pd(wi + j);
+            __m256d xr = _mm256_loadu_pd(rb + j), xi = _mm256_loadu_pd(ib + j);
+            __m256d tr = _mm256_fmsub_pd(xr, c, _mm256_mul_pd(xi, s));
+            __m256d ti = _mm256_fmadd_pd(xr, s, _mm256_mul_pd(xi, c));
+            __m256d ar = _mm256_loadu_pd(ra + j), ai = _mm256_loadu_pd(ia + j);
+
+            _mm256_storeu_pd(rb + j, _mm256_sub_pd(ar, tr));
+            _mm256_storeu_pd(ib + j, _mm256_sub_pd(ai, ti));
+            _mm256_storeu_pd(ra + j, _mm256_add_pd(ar, tr));
+            _mm256_storeu_pd(ia + j, _mm256_add_pd(ai, ti));
+        }
+    }
+}
+
+// single precision: values are widened to double, four lanes at a time,
+// before they are compared or summed, so results match the scalar kernel
+KERNEL_TARGET static void minmax_sum_f_avx2(const float * data, const size_t n, double * min, double * max, double * sum)
+{
+    size_t i = 0;
+    double lo, hi, total;
+    __m256d vlo = _mm256_set1_pd(DBL_MAX), vhi = _mm256_set1_pd(-DBL_MAX);
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(data + i);
+        __m256d x0 = _mm256_cvtps_pd(_mm256_castps256_ps128(x));
+        __m256d x1 = _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1));
+
+        vlo = _mm256_min_pd(x1, _mm256_min_pd(x0, vlo));
+        vhi = _mm256_max_pd(x1, _mm256_max_pd(x0, vhi));
+        s0 = _mm256_add_pd(s0, x0);
+        s1 = _mm256_add_pd(s1, x1);
+    }
+
+    lo = hmin_avx2(vlo);
+    hi = hmax_avx2(vhi);
+    total = hsum_avx2(_mm256_add_pd(s0, s1));
+
+    for (; i < n; ++i)
+    {
+        if (data[i] < lo)
+            lo = data[i];
+
+        if (data[i] > hi)
+            hi = data[i];
+
+        total += data[i];
+    }
+
+    *min = lo;
+    *max = hi;
+    *sum = total;
+}
+
+KERNEL_TARGET static double sum_sq_dev_f_avx2(const float * data, const size_t n, const double mean)
+{
+    size_t i = 0;
+    double diff, total;
+    __m256d m = _mm256_set1_pd(mean);
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(data + i);
+        __m256d d0 = _mm256_sub_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(x)), m);
+        __m256d d1 = _mm256_sub_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)), m);
+
+        s0 = _mm256_fmadd_pd(d0, d0, s0);
+        s1 = _mm256_fmadd_pd(d1, d1, s1);
+    }
+
+    total = hsum_avx2(_mm256_add_pd(s0, s1));
+
+    for (; i < n; ++i)
+    {
+        diff = data[i] - mean;
+        total += diff * diff;
+    }
+
+    return total;
+}
+
+KERNEL_TARGET static void fft_pass_f_avx2(float * re, float * im, const size_t n, const size_t half, const float * wr, const float * wi)
+{
+    size_t start, j;
+
+    if (half < 8)
+    {
+        // the first passes are too narrow for a full vector
+        for (start = 0; start < n; start += 2 * half)
+        {
+            for (j = 0; j < half; ++j)
+            {
+                size_t a = start + j, b = a + half;
+                float tr = re[b] * wr[j] - im[b] * wi[j];
+                float ti = re[b] * wi[j] + im[b] * wr[j];
+
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+
+        return;
+    }
+
+    for (start = 0; start < n; start += 2 * half)
+    {
+        float * ra = re + start, * ia = im + start;
+        float * rb = ra + half, * ib = ia + half;
+
+        for (j = 0; j < half; j += 8)
+        {
+            __m256 c = _mm256_loadu_ps(wr + j), s = _mm256_loadu_ps(wi + j);
+            __m256 xr = _mm256_loadu_ps(rb + j), xi = _mm256_loadu_ps(ib + j);
+            __m256 tr = _mm256_fmsub_ps(xr, c, _mm256_mul_ps(xi, s));
+            __m256 ti = _mm256_fmadd_ps(xr, s, _mm256_mul_ps(xi, c));
+            __m256 ar = _mm256_loadu_ps(ra + j), ai = _mm256_loadu_ps(ia + j);
+
+            _mm256_storeu_ps(rb + j, _mm256_sub_ps(ar, tr));
+            _mm256_storeu_ps(ib + j, _mm256_sub_ps(ai, ti));
+            _mm256_storeu_ps(ra + j, _mm256_add_ps(ar, tr));
+            _mm256_storeu_ps(ia + j, _mm256_add_ps(ai, ti));
+        }
+    }
+}
+
+// eight words of the twist at kk, reading the word M ahead (or behind) from src
+KERNEL_TARGET static void mt_twist8_avx2(uint32_t * m, const size_t kk, const uint32_t * src)
+{
+    const __m256i upper = _mm256_set1_epi32((int)BRAHE_MT_UPPER_MASK);
+    const __m256i lower = _mm256_set1_epi32((int)BRAHE_MT_LOWER_MASK);
+    const __m256i matrix = _mm256_set1_epi32((int)BRAHE_MT_MATRIX_A);
+
+    __m256i y = _mm256_or_si256(_mm256_and_si256(_mm256_loadu_si256((const __m256i *)(m + kk)), upper),
+                                _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(m + kk + 1)), lower));
+    __m256i mag = _mm256_and_si256(_mm256_srai_epi32(_mm256_slli_epi32(y, 31), 31), matrix);
+
+    _mm256_storeu_si256((__m256i *)(m + kk),
+                        _mm256_xor_si256(_mm256_xor_si256(_mm256_loadu_si256((const __m256i *)src), _mm256_srli_epi32(y, 1)), mag));
+}
+
+KERNEL_TARGET static void mt_twist_avx2(uint32_t * m)
+{
+    static const uint32_t mag01[2] = { 0, BRAHE_MT_MATRIX_A };
+    size_t kk = 0;
+    uint32_t y;
+
+    // words ahead of kk are still old, and those M - N behind are already new
+    for (; kk + 8 <= BRAHE_MT_N - BRAHE_MT_M; kk += 8)
+        mt_twist8_avx2(m, kk, m + kk + BRAHE_MT_M);
+
+    for (; kk < BRAHE_MT_N - BRAHE_MT_M; ++kk)
+    {
+        y = (m[kk] & BRAHE_MT_UPPER_MASK) | (m[kk + 1] & BRAHE_MT_LOWER_MASK);
+        m[kk] = m[kk + BRAHE_MT_M] ^ (y >> 1) ^ mag01[y & 0x1];
+    }
+
+    for (; kk + 8 <= BRAHE_MT_N - 1; kk += 8)
+        mt_twist8_avx2(m, kk, m + kk - (BRAHE_MT_N - BRAHE_MT_M));
+
+    // the last word wraps around to the first
+    for (; kk < BRAHE_MT_N; ++kk)
+    {
+        y = (m[kk] & BRAHE_MT_UPPER_MASK) | (m[(kk + 1) % BRAHE_MT_N] & BRAHE_MT_LOWER_MASK);
+        m[kk] = m[kk - (BRAHE_MT_N - BRAHE_MT_M)] ^ (y >> 1) ^ mag01[y & 0x1];
+    }
+}
+
+KERNEL_TARGET static void mt_temper_avx2(const uint32_t * m, uint32_t * out, const size_t n)
+{
+    const __m256i b = _mm256_set1_epi32((int)0x9d2c5680UL);
+    const __m256i c = _mm256_set1_epi32((int)0xefc60000UL);
+    size_t i = 0;
+    uint32_t y;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(m + i));
+
+        v = _mm256_xor_si256(v, _mm256_srli_epi32(v, 11));
+        v = _mm256_xor_si256(v, _mm256_and_si256(_mm256_slli_epi32(v, 7), b));
+        v = _mm256_xor_si256(v, _mm256_and_si256(_mm256_slli_epi32(v, 15), c));
+        v = _mm256_xor_si256(v, _mm256_srli_epi32(v, 18));
+        _mm256_storeu_si256((__m256i *)(out + i), v);
+    }
+
+    for (; i < n; ++i)
+    {
+        y = m[i];
+        y ^= (y >> 11);
+        y ^= (y <<  7) & 0x9d2c5680UL;
+        y ^= (y << 15) & 0xefc60000UL;
+        y ^= (y >> 18);
+        out[i] = y;
+    }
+}
+
+KERNEL_TARGET static void round_nearest_avx2(const double * in, double * out, const size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(out + i, _mm256_round_pd(_mm256_loadu_pd(in + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+
+    for (; i < n; ++i)
+        out[i] = brahe_round_nearest(in[i]);
+}
+
+void brahe_bind_kernels_avx2(brahe_kernels_t * k)
+{
+    size_t i;
+
+    k->m_minmax_sum = minmax_sum_avx2;
+    k->m_sum_sq_dev = sum_sq_dev_avx2;
+    k->m_fft_pass = fft_pass_avx2;
+    k->m_mt_twist = mt_twist_avx2;
+    k->m_mt_temper = mt_temper_avx2;
+    k->m_round_nearest = round_nearest_avx2;
+    k->m_minmax_sum_f = minmax_sum_f_avx2;
+    k->m_sum_sq_dev_f = sum_sq_dev_f_avx2;
+    k->m_fft_pass_f = fft_pass_f_avx2;
+
+    for (i = 0; i < BRAHE_KERNEL_COUNT; ++i)
+        k->m_isa[i] = BRAHE_ISA_AVX2;
+}
+
+#endif
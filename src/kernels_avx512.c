@@ -0,0 +1,323 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+#include "dispatch.h"
+
+/*
+    AVX-512 kernels, compiled for AVX-512 Foundation whatever the
+    compiler's baseline and only bound when the processor has it. The
+    twist and temper loops are not here: sixteen lanes gain little over
+    eight on 624 words, so the AVX2 variants remain bound for them.
+*/
+
+#if defined(BRAHE_HAVE_X86_DISPATCH)
+
+#include <immintrin.h>
+
+#define KERNEL_TARGET BRAHE_TARGET("avx512f")
+
+KERNEL_TARGET static void minmax_sum_avx512(const double * data, const size_t n, double * min, double * max, double * sum)
+{
+    size_t i = 0;
+    double lo, hi, total;
+    __m512d vlo = _mm512_set1_pd(DBL_MAX), vhi = _mm512_set1_pd(-DBL_MAX);
+    __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512d x0 = _mm512_loadu_pd(data + i);
+        __m512d x1 = _mm512_loadu_pd(data + i + 8);
+
+        // min and max return their second operand for NaN, which skips it
+        vlo = _mm512_min_pd(x1, _mm512_min_pd(x0, vlo));
+        vhi = _mm512_max_pd(x1, _mm512_max_pd(x0, vhi));
+        s0 = _mm512_add_pd(s0, x0);
+        s1 = _mm512_add_pd(s1, x1);
+    }
+
+    lo = _mm512_reduce_min_pd(vlo);
+    hi = _mm512_reduce_max_pd(vhi);
+    total = _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+
+    for (; i < n; ++i)
+    {
+        if (data[i] < lo)
+            lo = data[i];
+
+        if (data[i] > hi)
+            hi = data[i];
+
+        total += data[i];
+    }
+
+    *min = lo;
+    *max = hi;
+    *sum = total;
+}
+
+KERNEL_TARGET static double sum_sq_dev_avx512(const double * data, const size_t n, const double mean)
+{
+    size_t i = 0;
+    double diff, total;
+    __m512d m = _mm512_set1_pd(mean);
+    __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512d d0 = _mm512_sub_pd(_mm512_loadu_pd(data + i), m);
+        __m512d d1 = _mm512_sub_pd(_mm512_loadu_pd(data + i + 8), m);
+
+        s0 = _mm512_fmadd_pd(d0, d0, s0);
+        s1 = _mm512_fmadd_pd(d1, d1, s1);
+    }
+
+    total = _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+
+    for (; i < n; ++i)
+    {
+        diff = data[i] - mean;
+        total += diff * diff;
+    }
+
+    return total;
+}
+
+// single precision: values are widened to double, eight lanes at a time,
+// before they are compared or summed, so results match the scalar kernel
+KERNEL_TARGET static void minmax_sum_f_avx512(const float * data, const size_t n, double * min, double * max, double * sum)
+{
+    size_t i = 0;
+    double lo, hi, total;
+    __m512d vlo = _mm512_set1_pd(DBL_MAX), vhi = _mm512_set1_pd(-DBL_MAX);
+    __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512d x0 = _mm512_cvtps_pd(_mm256_loadu_ps(data + i));
+        __m512d x1 = _mm512_cvtps_pd(_mm256_loadu_ps(data + i + 8));
+
+        vlo = _mm512_min_pd(x1, _mm512_min_pd(x0, vlo));
+        vhi = _mm512_max_pd(x1, _mm512_max_pd(x0, vhi));
+        s0 = _mm512_add_pd(s0, x0);
+        s1 = _mm512_add_pd(s1, x1);
+    }
+
+    lo = _mm512_reduce_min_pd(vlo);
+    hi = _mm512_reduce_max_pd(vhi);
+    total = _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+
+    for (; i < n; ++i)
+    {
+        if (data[i] < lo)
+            lo = data[i];
+
+        if (data[i] > hi)
+            hi = data[i];
+
+        total += data[i];
+    }
+
+    *min = lo;
+    *max = hi;
+    *sum = total;
+}
+
+KERNEL_TARGET static double sum_sq_dev_f_avx512(const float * data, const size_t n, const double mean)
+{
+    size_t i = 0;
+    double diff, total;
+    __m512d m = _mm512_set1_pd(mean);
+    __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m512d d0 = _mm512_sub_pd(_mm512_cvtps_pd(_mm256_loadu_ps(data + i)), m);
+        __m512d d1 = _mm512_sub_pd(_mm512_cvtps_pd(_mm256_loadu_ps(data + i + 8)), m);
+
+        s0 = _mm512_fmadd_pd(d0, d0, s0);
+        s1 = _mm512_fmadd_pd(d1, d1, s1);
+    }
+
+    total = _mm512_reduce_add_pd(_mm512_add_pd(s0, s1));
+
+    for (; i < n; ++i)
+    {
+        diff = data[i] - mean;
+        total += diff * diff;
+    }
+
+    return total;
+}
+
+KERNEL_TARGET static void fft_pass_avx512(double * re, double * im, const size_t n, const size_t half, const double * wr, const double * wi)
+{
+    size_t start, j;
+
+    if (half < 8)
+    {
+        // the first passes are too narrow for a full vector
+        for (start = 0; start < n; start += 2 * half)
+        {
+            for (j = 0; j < half; ++j)
+            {
+                size_t a = start + j, b = a + half;
+                double tr = re[b] * wr[j] - im[b] * wi[j];
+                double ti = re[b] * wi[j] + im[b] * wr[j];
+
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+
+        return;
+    }
+
+    for (start = 0; start < n; start += 2 * half)
+    {
+        double * ra = re + start, * ia = im + start;
+        double * rb = ra + half, * ib = ia + half;
+
+        for (j = 0; j < half; j += 8)
+        {
+            __m512d c = _mm512_loadu_pd(wr + j), s = _mm512_loadu_pd(wi + j);
+            __m512d xr = _mm512_loadu_pd(rb + j), xi = _mm512_loadu_pd(ib + j);
+            __m512d tr = _mm512_fmsub_pd(xr, c, _mm512_mul_pd(xi, s));
+            __m512d ti = _mm512_fmadd_pd(xr, s, _mm512_mul_pd(xi, c));
+            __m512d ar = _mm512_loadu_pd(ra + j), ai = _mm512_loadu_pd(ia + j);
+
+            _mm512_storeu_pd(rb + j, _mm512_sub_pd(ar, tr));
+            _mm512_storeu_pd(ib + j, _mm512_sub_pd(ai, ti));
+            _mm512_storeu_pd(ra + j, _mm512_add_pd(ar, tr));
+            _mm512_storeu_pd(ia + j, _mm512_add_pd(ai, ti));
+        }
+    }
+}
+
+KERNEL_TARGET static void fft_pass_f_avx512(float * re, float * im, const size_t n, const size_t half, const float * wr, const float * wi)
+{
+    size_t start, j;
+
+    if (half < 16)
+    {
+        // the first passes are too narrow for a full vector
+        for (start = 0; start < n; start += 2 * half)
+        {
+            for (j = 0; j < half; ++j)
+            {
+                size_t a = start + j, b = a + half;
+                float tr = re[b] * wr[j] - im[b] * wi[j];
+                float ti = re[b] * wi[j] + im[b] * wr[j];
+
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+
+        return;
+    }
+
+    for (start = 0; start < n; start += 2 * half)
+    {
+        float * ra = re + start, * ia = im + start;
+        float * rb = ra + half, * ib = ia + half;
+
+        for (j = 0; j < half; j += 16)
+        {
+            __m512 c = _mm512_loadu_ps(wr + j), s = _mm512_loadu_ps(wi + j);
+            __m512 xr = _mm512_loadu_ps(rb + j), xi = _mm512_loadu_ps(ib + j);
+            __m512 tr = _mm512_fmsub_ps(xr, c, _mm512_mul_ps(xi, s));
+            __m512 ti = _mm512_fmadd_ps(xr, s, _mm512_mul_ps(xi, c));
+            __m512 ar = _mm512_loadu_ps(ra + j), ai = _mm512_loadu_ps(ia + j);
+
+            _mm512_storeu_ps(rb + j, _mm512_sub_ps(ar, tr));
+            _mm512_storeu_ps(ib + j, _mm512_sub_ps(ai, ti));
+            _mm512_storeu_ps(ra + j, _mm512_add_ps(ar, tr));
+            _mm512_storeu_ps(ia + j, _mm512_add_ps(ai, ti));
+        }
+    }
+}
+
+KERNEL_TARGET static void round_nearest_avx512(const double * in, double * out, const size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+        _mm512_storeu_pd(out + i, _mm512_roundscale_pd(_mm512_loadu_pd(in + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+
+    for (; i < n; ++i)
+        out[i] = brahe_round_nearest(in[i]);
+}
+
+void brahe_bind_kernels_avx512(brahe_kernels_t * k)
+{
+    k->m_minmax_sum = minmax_sum_avx512;
+    k->m_sum_sq_dev = sum_sq_dev_avx512;
+    k->m_fft_pass = fft_pass_avx512;
+    k->m_round_nearest = round_nearest_avx512;
+    k->m_minmax_sum_f = minmax_sum_f_avx512;
+    k->m_sum_sq_dev_f = sum_sq_dev_f_avx512;
+    k->m_fft_pass_f = fft_pass_f_avx512;
+
+    k->m_isa[BRAHE_KERNEL_MINMAX_SUM] = BRAHE_ISA_AVX512;
+    k->m_isa[BRAHE_KERNEL_SUM_SQ_DEV] = BRAHE_ISA_AVX512;
+    k->m_isa[BRAHE_KERNEL_FFT_PASS] = BRAHE_ISA_AVX512;
+    k->m_isa[BRAHE_KERNEL_ROUND_NEAREST] = BRAHE_ISA_AVX512;
+    k->m_isa[BRAHE_KERNEL_MINMAX_SUM_F] = BRAHE_ISA_AVX512;
+    k->m_isa[BRAHE_KERNEL_SUM_SQ_DEV_F] = BRAHE_ISA_AVX512;
+    k->m_isa[BRAHE_KERNEL_FFT_PASS_F] = BRAHE_ISA_AVX512;
+}
+
+#endif
@@ -0,0 +1,676 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+// file offsets are 64 bits wide even on 32-bit systems
+#if !defined(_FILE_OFFSET_BITS)
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include "mathtools.h"
+#include "internal.h"
+#include "dispatch.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/*
+    Sample files. A file is read through a window of a few hundred pages
+    that is mapped, advised as sequential, consumed and unmapped before the
+    next one is mapped, so the library holds at most one window per reader
+    however large the file; the kernel's read-ahead and page cache do the
+    I/O. Window offsets are multiples of the page size (the allocation
+    granularity on Windows), which every sample size divides, so samples
+    never straddle windows.
+*/
+
+// pages in a mapped window
+#define WINDOW_PAGES 256
+
+// samples decoded at a time when they cannot be used in place
+#define DECODE_BLOCK 1024
+
+// samples encoded at a time for output
+#define ENCODE_BLOCK 4096
+
+// float64 and float32 samples can be passed to the kernels in place
+#if (defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)) || defined(_WIN32)
+#define NATIVE_LITTLE_ENDIAN
+#endif
+
+typedef struct
+{
+#if defined(_WIN32)
+    HANDLE   m_file;
+    HANDLE   m_mapping;
+#else
+    int      m_fd;
+#endif
+    brahe_sample_type_t m_type;
+    size_t   m_size;    // bytes per sample
+    uint64_t m_length;  // bytes of whole samples in the file
+    uint64_t m_granule; // mapping offsets are multiples of this
+    size_t   m_window;  // bytes mapped at a time
+    uint64_t m_pos;     // file offset of the next window
+    uint64_t m_limit;   // file offset of the end of the requested samples
+    void *   m_map;     // current mapping, or NULL
+    size_t   m_map_len;
+    const uint8_t * m_cur; // next sample in the mapping
+    const uint8_t * m_end; // end of the samples in the mapping
+    bool     m_failed;  // a mapping could not be made
+}
+sample_reader_t;
+
+static size_t sample_size(const brahe_sample_type_t type)
+{
+    switch (type)
+    {
+        case BRAHE_SAMPLE_FLOAT64:
+            return 8;
+        case BRAHE_SAMPLE_FLOAT32:
+            return 4;
+        case BRAHE_SAMPLE_INT16:
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+// value of a little-endian sample; the byte assembly compiles to a plain
+// load on little-endian processors
+BRAHE_INLINE double sample_value(const uint8_t * p, const brahe_sample_type_t type)
+{
+    switch (type)
+    {
+        case BRAHE_SAMPLE_FLOAT64:
+        {
+            uint64_t u = (uint64_t)p[0]         | ((uint64_t)p[1] << 8)
+                       | ((uint64_t)p[2] << 16) | ((uint64_t)p[3] << 24)
+                       | ((uint64_t)p[4] << 32) | ((uint64_t)p[5] << 40)
+                       | ((uint64_t)p[6] << 48) | ((uint64_t)p[7] << 56);
+            double x;
+            memcpy(&x, &u, sizeof(x));
+            return x;
+        }
+        case BRAHE_SAMPLE_FLOAT32:
+        {
+            uint32_t u = (uint32_t)p[0]         | ((uint32_t)p[1] << 8)
+                       | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+            float x;
+            memcpy(&x, &u, sizeof(x));
+            return (double)x;
+        }
+        default:
+            return (double)(int16_t)(uint16_t)(p[0] | (p[1] << 8));
+    }
+}
+
+// store x as a little-endian sample; integers are rounded and saturated
+BRAHE_INLINE void store_sample(uint8_t * p, const double x, const brahe_sample_type_t type)
+{
+    switch (type)
+    {
+        case BRAHE_SAMPLE_FLOAT64:
+        {
+            uint64_t u;
+            int i;
+            memcpy(&u, &x, sizeof(u));
+
+            for (i = 0; i < 8; ++i, u >>= 8)
+                p[i] = (uint8_t)u;
+
+            break;
+        }
+        case BRAHE_SAMPLE_FLOAT32:
+        {
+            float f = (float)x;
+            uint32_t u;
+            int i;
+            memcpy(&u, &f, sizeof(u));
+
+            for (i = 0; i < 4; ++i, u >>= 8)
+                p[i] = (uint8_t)u;
+
+            break;
+        }
+        default:
+        {
+            int16_t v;
+
+            if (x != x)
+                v = 0;
+            else if (x <= -32768.0)
+                v = -32768;
+            else if (x >= 32767.0)
+                v = 32767;
+            else
+                v = (int16_t)floor(x + 0.5);
+
+            p[0] = (uint8_t)((uint16_t)v);
+            p[1] = (uint8_t)((uint16_t)v >> 8);
+            break;
+        }
+    }
+}
+
+static void reader_unmap(sample_reader_t * r)
+{
+    if (r->m_map != NULL)
+    {
+#if defined(_WIN32)
+        UnmapViewOfFile(r->m_map);
+#else
+        munmap(r->m_map, r->m_map_len);
+#endif
+        r->m_map = NULL;
+    }
+
+    r->m_cur = NULL;
+    r->m_end = NULL;
+}
+
+// open a sample file for reading, positioned at its first sample
+static bool reader_open(sample_reader_t * r, const char * path, const brahe_sample_type_t type)
+{
+    uint64_t length;
+
+    memset(r, 0, sizeof(*r));
+    r->m_type = type;
+    r->m_size = sample_size(type);
+
+    if (r->m_size == 0)
+        return false;
+
+#if defined(_WIN32)
+    {
+        SYSTEM_INFO info;
+        LARGE_INTEGER size;
+
+        // denying write access keeps the file from shrinking under the mapping
+        r->m_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+        if (r->m_file == INVALID_HANDLE_VALUE)
+            return false;
+
+        if (!GetFileSizeEx(r->m_file, &size))
+        {
+            CloseHandle(r->m_file);
+            return false;
+        }
+
+        length = (uint64_t)size.QuadPart;
+
+        // an empty file cannot be mapped, and has nothing to map
+        if (length > 0)
+        {
+            r->m_mapping = CreateFileMapping(r->m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+            if (r->m_mapping == NULL)
+            {
+                CloseHandle(r->m_file);
+                return false;
+            }
+        }
+
+        GetSystemInfo(&info);
+        r->m_granule = info.dwAllocationGranularity;
+    }
+#else
+    {
+        struct stat st;
+        long page;
+
+        r->m_fd = open(path, O_RDONLY);
+
+        if (r->m_fd < 0)
+            return false;
+
+        if ((fstat(r->m_fd, &st) != 0) || !S_ISREG(st.st_mode))
+        {
+            close(r->m_fd);
+            return false;
+        }
+
+        length = (uint64_t)st.st_size;
+        page = sysconf(_SC_PAGESIZE);
+        r->m_granule = (page > 0) ? (uint64_t)page : 4096;
+
+#if defined(POSIX_FADV_SEQUENTIAL)
+        posix_fadvise(r->m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    }
+#endif
+
+    // a trailing partial sample is ignored
+    r->m_length = length - length % r->m_size;
+    r->m_window = (size_t)r->m_granule * WINDOW_PAGES;
+    r->m_limit  = r->m_length;
+    return true;
+}
+
+static void reader_close(sample_reader_t * r)
+{
+    reader_unmap(r);
+
+#if defined(_WIN32)
+    if (r->m_mapping != NULL)
+        CloseHandle(r->m_mapping);
+
+    CloseHandle(r->m_file);
+#else
+    close(r->m_fd);
+#endif
+}
+
+// number of whole samples in an open file
+static uint64_t reader_samples(const sample_reader_t * r)
+{
+    return r->m_length / r->m_size;
+}
+
+// restrict reading to count samples starting at sample first; count 0
+// means all samples to the end of the file. Fails if the file is shorter.
+static bool reader_select(sample_reader_t * r, const uint64_t first, const uint64_t count)
+{
+    uint64_t total = reader_samples(r);
+
+    if ((first >= total) || (count > total - first))
+        return false;
+
+    reader_unmap(r);
+    r->m_pos   = first * r->m_size;
+    r->m_limit = (count == 0) ? r->m_length : (first + count) * r->m_size;
+    return true;
+}
+
+// map bytes [pos, pos + len) of the file, replacing any earlier mapping;
+// returns a pointer to the byte at pos
+static const uint8_t * reader_map(sample_reader_t * r, const uint64_t pos, const size_t len)
+{
+    uint64_t base = pos - pos % r->m_granule;
+    size_t   span = (size_t)(pos - base) + len;
+
+    reader_unmap(r);
+
+#if defined(_WIN32)
+    r->m_map = MapViewOfFile(r->m_mapping, FILE_MAP_READ, (DWORD)(base >> 32), (DWORD)base, span);
+
+    if (r->m_map == NULL)
+    {
+        r->m_failed = true;
+        return NULL;
+    }
+#else
+    r->m_map = mmap(NULL, span, PROT_READ, MAP_PRIVATE, r->m_fd, (off_t)base);
+
+    if (r->m_map == MAP_FAILED)
+    {
+        r->m_map = NULL;
+        r->m_failed = true;
+        return NULL;
+    }
+
+#if defined(MADV_SEQUENTIAL)
+    madvise(r->m_map, span, MADV_SEQUENTIAL);
+#endif
+#endif
+
+    r->m_map_len = span;
+    return (const uint8_t *)r->m_map + (size_t)(pos - base);
+}
+
+// map the next window of selected samples; returns the number of samples
+// it holds, or 0 at the end of the selection or if mapping failed
+static size_t reader_fill(sample_reader_t * r)
+{
+    uint64_t left = r->m_limit - r->m_pos;
+    size_t   len  = r->m_window - (size_t)(r->m_pos % r->m_granule);
+
+    if (left == 0)
+    {
+        reader_unmap(r);
+        return 0;
+    }
+
+    if (len > left)
+        len = (size_t)left;
+
+    r->m_cur = reader_map(r, r->m_pos, len);
+
+    if (r->m_cur == NULL)
+        return 0;
+
+    r->m_end  = r->m_cur + len;
+    r->m_pos += len;
+    return len / r->m_size;
+}
+
+// next selected sample; 0 past the end of the selection
+BRAHE_INLINE double reader_next(sample_reader_t * r)
+{
+    double x;
+
+    if ((r->m_cur == r->m_end) && (reader_fill(r) == 0))
+        return 0.0;
+
+    x = sample_value(r->m_cur, r->m_type);
+    r->m_cur += r->m_size;
+    return x;
+}
+
+static void running_add(brahe_running_stats_t * s, const double * data, const size_t n)
+{
+    const brahe_kernels_t * k = brahe_kernels();
+    double min, max, sum, mean;
+
+    k->m_minmax_sum(data, n, &min, &max, &sum);
+    mean = sum / (double)n;
+    brahe_running_merge(s, n, min, max, mean, k->m_sum_sq_dev(data, n, mean));
+}
+
+#if defined(NATIVE_LITTLE_ENDIAN)
+static void running_add_f(brahe_running_stats_t * s, const float * data, const size_t n)
+{
+    const brahe_kernels_t * k = brahe_kernels();
+    double min, max, sum, mean;
+
+    k->m_minmax_sum_f(data, n, &min, &max, &sum);
+    mean = sum / (double)n;
+    brahe_running_merge(s, n, min, max, mean, k->m_sum_sq_dev_f(data, n, mean));
+}
+#endif
+
+// statistics for samples in a file
+bool brahe_get_statistics_file(const char * path, const brahe_sample_type_t type, const uint64_t first, const uint64_t count,
+                               brahe_statistics * stats)
+{
+    sample_reader_t r;
+    brahe_running_stats_t s;
+    double buffer[DECODE_BLOCK];
+    uint64_t expected;
+    size_t avail, i, m;
+    bool result = false;
+
+    if ((path == NULL) || (stats == NULL) || !reader_open(&r, path, type))
+        return false;
+
+    if (reader_select(&r, first, count))
+    {
+        expected = (r.m_limit - r.m_pos) / r.m_size;
+        memset(&s, 0, sizeof(s));
+
+        BRAHE_PROBE2(statistics, expected, r.m_size);
+        BRAHE_METRIC_BEGIN(BRAHE_METRIC_GET_STATISTICS_FILE, expected);
+
+        while ((avail = reader_fill(&r)) > 0)
+        {
+#if defined(NATIVE_LITTLE_ENDIAN)
+            // windows are page aligned, so the samples are aligned too
+            if (type == BRAHE_SAMPLE_FLOAT64)
+            {
+                running_add(&s, (const double *)r.m_cur, avail);
+                continue;
+            }
+
+            if (type == BRAHE_SAMPLE_FLOAT32)
+            {
+                running_add_f(&s, (const float *)r.m_cur, avail);
+                continue;
+            }
+#endif
+
+            for (; avail > 0; avail -= m)
+            {
+                m = (avail < DECODE_BLOCK) ? avail : DECODE_BLOCK;
+
+                for (i = 0; i < m; ++i, r.m_cur += r.m_size)
+                    buffer[i] = sample_value(r.m_cur, type);
+
+                running_add(&s, buffer, m);
+            }
+        }
+
+        if (!r.m_failed && (s.m_n == expected))
+        {
+            stats->min      = s.m_min;
+            stats->max      = s.m_max;
+            stats->mean     = s.m_mean;
+            stats->variance = s.m_m2 / (double)(s.m_n - 1);
+            stats->sigma    = sqrt(stats->variance);
+            result = true;
+        }
+
+        BRAHE_METRIC_END();
+    }
+
+    reader_close(&r);
+    return result;
+}
+
+// open the output of a moving average; on POSIX systems, refuse to
+// truncate the input, which would pull the mapped pages out from under us
+static FILE * open_output(const char * path, const sample_reader_t * input)
+{
+#if defined(_WIN32)
+    // the input was opened without write sharing, so this fails for it
+    (void)input;
+    return fopen(path, "wb");
+#else
+    struct stat in_st, out_st;
+    FILE * out;
+    int fd = open(path, O_WRONLY | O_CREAT, 0666);
+
+    if (fd < 0)
+        return NULL;
+
+    if ((fstat(input->m_fd, &in_st) != 0) || (fstat(fd, &out_st) != 0)
+     || ((in_st.st_dev == out_st.st_dev) && (in_st.st_ino == out_st.st_ino))
+     || (ftruncate(fd, 0) != 0))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    out = fdopen(fd, "wb");
+
+    if (out == NULL)
+        close(fd);
+
+    return out;
+#endif
+}
+
+// moving average of samples in a file, written to another file
+bool brahe_moving_average_file(const char * in_path, const brahe_sample_type_t in_type, const size_t distance,
+                               const char * out_path, const brahe_sample_type_t out_type)
+{
+    sample_reader_t head, tail;
+    uint8_t buffer[ENCODE_BLOCK * 8];
+    size_t out_size = sample_size(out_type);
+    size_t fill = 0;
+    uint64_t i, n, d, lo, hi;
+    double sum = 0.0, comp = 0.0;
+    FILE * out;
+    bool result = false;
+
+    if ((in_path == NULL) || (out_path == NULL) || (out_size == 0))
+        return false;
+
+    if (!reader_open(&head, in_path, in_type))
+        return false;
+
+    n = reader_samples(&head);
+
+    if ((n == 0) || !reader_open(&tail, in_path, in_type))
+    {
+        reader_close(&head);
+        return false;
+    }
+
+    out = open_output(out_path, &head);
+
+    if (out != NULL)
+    {
+        BRAHE_METRIC_BEGIN(BRAHE_METRIC_MOVING_AVERAGE_FILE, n);
+
+        // the same compensated running sum as brahe_moving_average_into,
+        // with one reader at each edge of the window
+        d = (distance < n) ? distance : n - 1;
+
+        for (hi = 0; hi <= d; ++hi)
+            brahe_compensated_add(&sum,&comp,reader_next(&head));
+
+        lo = 0;
+        hi = d;
+        result = true;
+
+        for (i = 0; i < n; ++i)
+        {
+            store_sample(buffer + fill * out_size, (sum + comp) / (double)(hi - lo + 1), out_type);
+
+            if (++fill == ENCODE_BLOCK)
+            {
+                if (fwrite(buffer, out_size, fill, out) != fill)
+                {
+                    result = false;
+                    break;
+                }
+
+                fill = 0;
+            }
+
+            if (hi + 1 < n)
+            {
+                brahe_compensated_add(&sum,&comp,reader_next(&head));
+                ++hi;
+            }
+
+            if (i >= d)
+            {
+                brahe_compensated_add(&sum,&comp,-reader_next(&tail));
+                ++lo;
+            }
+        }
+
+        if (result && (fill > 0) && (fwrite(buffer, out_size, fill, out) != fill))
+            result = false;
+
+        if (fclose(out) != 0)
+            result = false;
+
+        if (head.m_failed || tail.m_failed)
+            result = false;
+
+        BRAHE_METRIC_END();
+    }
+
+    reader_close(&tail);
+    reader_close(&head);
+    return result;
+}
+
+// fft of a section of a file
+bool brahe_simple_fft_file(const char * path, const brahe_sample_type_t type, const uint64_t first, const size_t n,
+                           double * out, double * work)
+{
+    const brahe_allocator_t * a = brahe_allocator();
+    sample_reader_t r;
+    const uint8_t * p;
+    double * data = NULL;
+    size_t i;
+    bool result = false;
+
+    if ((path == NULL) || (out == NULL) || (work == NULL) || (n < 2))
+        return false;
+
+    if (!reader_open(&r, path, type))
+        return false;
+
+    // the whole section is mapped at once; it must fit in the address space
+    if (((uint64_t)n <= SIZE_MAX / r.m_size) && reader_select(&r, first, n)
+     && ((p = reader_map(&r, r.m_pos, n * r.m_size)) != NULL))
+    {
+        BRAHE_METRIC_BEGIN(BRAHE_METRIC_SIMPLE_FFT, n);
+
+#if defined(NATIVE_LITTLE_ENDIAN)
+        if (type == BRAHE_SAMPLE_FLOAT64)
+            result = brahe_simple_fft_into((const double *)p, n, out, work);
+        else
+#endif
+        if (n <= SIZE_MAX / sizeof(double))
+        {
+            data = (double *)brahe_allocate(a, sizeof(double) * n, BRAHE_DEFAULT_ALIGN);
+
+            if (data != NULL)
+            {
+                for (i = 0; i < n; ++i, p += r.m_size)
+                    data[i] = sample_value(p, type);
+
+                result = brahe_simple_fft_into(data, n, out, work);
+                brahe_release(a, data);
+            }
+        }
+
+        BRAHE_METRIC_END();
+    }
+
+    reader_close(&r);
+    return result;
+}
@@ -83,6 +83,121 @@ typedef __int8           int8_t;
 #include <stdint.h>
 #endif
 
+//-----------------------------------------------------------------------------
+// Memory
+//-----------------------------------------------------------------------------
+
+//! Memory allocation hooks
+/*!
+    The library obtains all of its memory through these functions, so an
+    application can supply arenas, pools or huge pages. Objects with an
+    init function (histograms, sketches, windows, PRNG states and so on)
+    keep the allocator that was installed when they were initialized, and
+    return their memory to it when freed.
+*/
+typedef struct
+{
+    //! allocate <i>size</i> bytes aligned to <i>alignment</i>, a power of two; NULL on failure
+    void * (*alloc)(const size_t size, const size_t alignment, void * context);
+    //! release memory obtained from alloc; never called with NULL
+    void (*free)(void * p, void * context);
+    //! passed to alloc and free
+    void * context;
+}
+brahe_allocator_t;
+
+//! Install an allocator
+/*!
+    Replaces the allocator used for subsequent allocations. Not thread-safe:
+    install an allocator before other threads use the library. Arrays
+    returned by allocating functions must be released with brahe_free
+    before the allocator that supplied them is replaced.
+    \param allocator the new allocator, which is copied; NULL restores the default
+    \return false if <i>allocator</i> lacks a function
+*/
+bool brahe_set_allocator(const brahe_allocator_t * allocator);
+
+//! The installed allocator
+/*!
+    \return a copy of the allocator in use, for chaining to it
+*/
+brahe_allocator_t brahe_get_allocator(void);
+
+//! Release an array returned by the library
+/*!
+    Frees memory returned by functions such as brahe_simple_fft and
+    brahe_pretty_int through the installed allocator. With the default
+    allocator on POSIX systems, free() is equivalent.
+    \param p memory returned by the library; may be NULL
+*/
+void brahe_free(void * p);
+
+//-----------------------------------------------------------------------------
+// Parallel execution
+//-----------------------------------------------------------------------------
+
+//! Options for brahe_exec_init
+typedef enum
+{
+    //! pin each worker thread to its own CPU, grouping workers by NUMA node
+    BRAHE_EXEC_PIN_THREADS = 1
+}
+brahe_exec_flags_t;
+
+//! Execution context for functions that can split their work across threads
+/*!
+    A pool of worker threads that functions ending in _exec use to process
+    large arrays. Work is divided into fixed-size chunks that are shared out
+    evenly and stolen by idle workers, so the results of a function do not
+    depend on how many threads computed them. Passing NULL, or a context
+    with one thread, runs the work on the calling thread. A context runs
+    one function at a time; concurrent calls from several threads wait
+    their turn. Fields are private.
+*/
+typedef struct
+{
+    size_t m_threads;   // workers, counting the calling thread
+    size_t m_threshold; // smallest array worth splitting
+    void * m_pool;      // worker threads, or NULL when there are none
+}
+brahe_exec_t;
+
+//! Initialize an execution context
+/*!
+    Starts <i>threads</i> - 1 worker threads; the thread that calls an _exec
+    function is the remaining worker. Pinned workers are placed one per CPU
+    on the CPUs the process may use, taking each NUMA node's CPUs in turn,
+    and look for work to steal on their own node first. Without thread
+    support, the context runs everything on the calling thread.
+    \param exec object to be initialized
+    \param threads number of workers; 0 for one per available CPU
+    \param flags a combination of brahe_exec_flags_t values
+    \return <i>true</i> if successful, <i>false</i> if failed
+*/
+bool brahe_exec_init(brahe_exec_t * exec, const size_t threads, const unsigned int flags);
+
+//! Stop the threads of an execution context
+/*!
+    \param exec object to be freed
+*/
+void brahe_exec_free(brahe_exec_t * exec);
+
+//! Number of workers in an execution context
+/*!
+    \param exec an execution context; may be NULL
+    \return workers, counting the calling thread
+*/
+size_t brahe_exec_threads(const brahe_exec_t * exec);
+
+//! Set the smallest array an execution context splits across threads
+/*!
+    Smaller arrays are processed on the calling thread, in the same chunks,
+    so the results are unchanged. The default is 65536 elements.
+    \param exec an execution context
+    \param n number of elements
+*/
+void brahe_exec_set_threshold(brahe_exec_t * exec, const size_t n);
+
 //-----------------------------------------------------------------------------
 // Rounding
 //-----------------------------------------------------------------------------
@@ -103,28 +218,278 @@ double brahe_round_nearest(const double x);
 */
 double brahe_sigdig(const double x, const uint16_t n);
 
+//! Round an array to nearest values
+/*!
+    Rounds each element as brahe_round_nearest does, using hardware
+    rounding where available. Results are identical to the scalar function.
+    \param in values to be rounded
+    \param out array that receives the results; may be the same as <i>in</i>
+    \param n number of elements in <i>in</i> and <i>out</i>
+    \return true if successful, false if an argument is invalid
+*/
+bool brahe_round_nearest_v(const double * in, double * out, const size_t n);
+
+//! Set number of significant digits in an array of values
+/*!
+    Rounds each element as brahe_sigdig does, using a table of powers of
+    ten in place of per-value calls to log10 and pow. Results are identical
+    to the scalar function.
+    \param in values to be rounded
+    \param out array that receives the results; may be the same as <i>in</i>
+    \param n number of elements in <i>in</i> and <i>out</i>
+    \param digits number of significant digits
+    \return true if successful, false if an argument is invalid
+*/
+bool brahe_sigdig_v(const double * in, double * out, const size_t n, const uint16_t digits);
+
 //-----------------------------------------------------------------------------
 // Lowest Common Multple (LCM) and Lowest Common Denominator (GCD)
 //-----------------------------------------------------------------------------
 
 //! Lowest common multiple
 /*!
-    Calculates the lowest common multiple for two values.
+    Calculates the lowest common multiple for two values. A result too large
+    for 64 bits wraps around; use brahe_lcm_checked to detect this.
     \param x first value
     \param y second value
     \return The lowest common multiple for <i>x</i> and <i>y</i>
 */
 uint64_t brahe_lcm(const uint64_t x, const uint64_t y);
 
+//! Lowest common multiple, with overflow detection
+/*!
+    Calculates the lowest common multiple for two values, reporting whether
+    it fits in 64 bits. The multiple of zero and any value is zero.
+    \param x first value
+    \param y second value
+    \param result receives the lowest common multiple, or 0 on overflow
+    \return true if successful, false if the result overflows or <i>result</i> is NULL
+*/
+bool brahe_lcm_checked(const uint64_t x, const uint64_t y, uint64_t * result);
+
+//! Lowest common multiple of an array
+/*!
+    Folds brahe_lcm_checked over an array, stopping at the first overflow.
+    \param values array of values
+    \param n number of elements in <i>values</i>
+    \param result receives the lowest common multiple (0 for an empty array or on overflow)
+    \return true if successful, false if the result overflows or an argument is invalid
+*/
+bool brahe_lcm_array(const uint64_t * values, const size_t n, uint64_t * result);
+
 //! Greatest common factor (denominator)
 /*!
-    Calculates the greatest common factor for two values.
+    Calculates the greatest common factor for two values, with the binary
+    (Stein) algorithm.
     \param x first value
     \param y second value
     \return The greatest common factor for <i>x</i> and <i>y</i>
 */
 uint64_t brahe_gcf(uint64_t x, uint64_t y);
 
+//! Greatest common factor of an array
+/*!
+    Calculates the greatest common factor of all elements of an array,
+    stopping early once it reaches 1. Zero elements are ignored.
+    \param values array of values
+    \param n number of elements in <i>values</i>
+    \return The greatest common factor of the elements, or 0 if all are zero
+*/
+uint64_t brahe_gcf_array(const uint64_t * values, const size_t n);
+
+//-----------------------------------------------------------------------------
+// Modular arithmetic and primes
+//-----------------------------------------------------------------------------
+
+//! Extended greatest common factor
+/*!
+    Finds the greatest common factor g of <i>a</i> and <i>b</i>, along with
+    coefficients such that a*x + b*y = g.
+    \param a first value
+    \param b second value
+    \param x receives the coefficient of <i>a</i>; may be NULL
+    \param y receives the coefficient of <i>b</i>; may be NULL
+    \return The non-negative greatest common factor of <i>a</i> and <i>b</i>;
+            0, with both coefficients 0, when that factor is 2^63 (each of
+            <i>a</i> and <i>b</i> is 0 or INT64_MIN, and not both 0)
+*/
+int64_t brahe_xgcd(const int64_t a, const int64_t b, int64_t * x, int64_t * y);
+
+//! Modular inverse
+/*!
+    Finds x such that a*x = 1 (mod m).
+    \param a value to be inverted
+    \param m modulus, at least 2
+    \param inverse receives the inverse, in [0,m)
+    \return true if successful, false if <i>a</i> and <i>m</i> are not coprime or an argument is invalid
+*/
+bool brahe_modinv(const uint64_t a, const uint64_t m, uint64_t * inverse);
+
+//! Modular multiplication
+/*!
+    \param a first factor
+    \param b second factor
+    \param m modulus
+    \return a*b mod m, computed without overflow; 0 if <i>m</i> is 0
+*/
+uint64_t brahe_mulmod(const uint64_t a, const uint64_t b, const uint64_t m);
+
+//! Modular exponentiation
+/*!
+    Uses Montgomery multiplication for odd moduli.
+    \param base value to be raised to a power
+    \param exponent power
+    \param m modulus
+    \return base^exponent mod m; 0 if <i>m</i> is less than 2
+*/
+uint64_t brahe_powmod(const uint64_t base, uint64_t exponent, const uint64_t m);
+
+//! Montgomery multiplication context
+/*!
+    Holds the constants for fast multiplication modulo one odd value.
+    Values must be converted to Montgomery form with brahe_montgomery_to
+    before multiplying, and back with brahe_montgomery_from. Fields are
+    private.
+*/
+typedef struct
+{
+    uint64_t m_modulus; // odd modulus
+    uint64_t m_ninv;    // -modulus^-1 mod 2^64
+    uint64_t m_one;     // 2^64 mod modulus, which is 1 in Montgomery form
+    uint64_t m_r2;      // 2^128 mod modulus
+}
+brahe_montgomery_t;
+
+//! Initialize a Montgomery context
+/*!
+    \param ctx object to be initialized
+    \param m modulus; must be odd and at least 3
+    \return true if successful, false if an argument is invalid
+*/
+bool brahe_montgomery_init(brahe_montgomery_t * ctx, const uint64_t m);
+
+//! Convert a value to Montgomery form
+/*!
+    \param ctx a Montgomery context
+    \param a any value
+    \return <i>a</i> in Montgomery form
+*/
+uint64_t brahe_montgomery_to(const brahe_montgomery_t * ctx, const uint64_t a);
+
+//! Convert a value from Montgomery form
+/*!
+    \param ctx a Montgomery context
+    \param a a value in Montgomery form
+    \return the ordinary value of <i>a</i>, in [0,m)
+*/
+uint64_t brahe_montgomery_from(const brahe_montgomery_t * ctx, const uint64_t a);
+
+//! Multiply in Montgomery form
+/*!
+    \param ctx a Montgomery context
+    \param a a value in Montgomery form
+    \param b a value in Montgomery form
+    \return the product of <i>a</i> and <i>b</i>, in Montgomery form
+*/
+uint64_t brahe_montgomery_mul(const brahe_montgomery_t * ctx, const uint64_t a, const uint64_t b);
+
+//! Exponentiation in Montgomery form
+/*!
+    \param ctx a Montgomery context
+    \param a a value in Montgomery form
+    \param exponent power
+    \return a^exponent, in Montgomery form
+*/
+uint64_t brahe_montgomery_pow(const brahe_montgomery_t * ctx, const uint64_t a, uint64_t exponent);
+
+//! Barrett reduction context
+/*!
+    Holds the constants for fast reduction modulo one value below 2^32.
+    Values need no conversion. Fields are private.
+*/
+typedef struct
+{
+    uint64_t m_modulus; // modulus
+    uint64_t m_mu;      // floor((2^64 - 1) / modulus)
+}
+brahe_barrett_t;
+
+//! Initialize a Barrett context
+/*!
+    \param ctx object to be initialized
+    \param m modulus, at least 2
+    \return true if successful, false if an argument is invalid
+*/
+bool brahe_barrett_init(brahe_barrett_t * ctx, const uint32_t m);
+
+//! Reduce a value with Barrett's method
+/*!
+    \param ctx a Barrett context
+    \param x any value
+    \return x mod m
+*/
+uint32_t brahe_barrett_reduce(const brahe_barrett_t * ctx, const uint64_t x);
+
+//! Multiply with Barrett reduction
+/*!
+    \param ctx a Barrett context
+    \param a first factor
+    \param b second factor
+    \return a*b mod m
+*/
+uint32_t brahe_barrett_mul(const brahe_barrett_t * ctx, const uint32_t a, const uint32_t b);
+
+//! Primality test
+/*!
+    Deterministic Miller-Rabin test, exact for every 64-bit value.
+    \param n value to be tested
+    \return true if <i>n</i> is prime
+*/
+bool brahe_is_prime(const uint64_t n);
+
+//! Modular multiplication of arrays
+/*!
+    \param a first factors
+    \param b second factors
+    \param n number of elements in <i>a</i>, <i>b</i> and <i>result</i>
+    \param m modulus
+    \param result receives a[i]*b[i] mod m; may be the same as <i>a</i> or <i>b</i>
+    \return true if successful, false if an argument is invalid
+*/
+bool brahe_mulmod_array(const uint64_t * a, const uint64_t * b, const size_t n, const uint64_t m, uint64_t * result);
+
+//! Modular exponentiation of an array
+/*!
+    \param bases values to be raised to a power
+    \param n number of elements in <i>bases</i> and <i>result</i>
+    \param exponent power
+    \param m modulus
+    \param result receives bases[i]^exponent mod m; may be the same as <i>bases</i>
+    \return true if successful, false if an argument is invalid
+*/
+bool brahe_powmod_array(const uint64_t * bases, const size_t n, const uint64_t exponent, const uint64_t m, uint64_t * result);
+
+//! Modular inverses of an array
+/*!
+    Inverts every element with a single modular inversion (Montgomery's
+    batch inversion), at the cost of three multiplications per element.
+    \param values values to be inverted
+    \param n number of elements in <i>values</i> and <i>result</i>
+    \param m modulus, at least 2
+    \param result receives the inverses; must not be the same as <i>values</i>
+    \return true if successful, false if any value is not coprime with <i>m</i> or an argument is invalid
+*/
+bool brahe_modinv_array(const uint64_t * values, const size_t n, const uint64_t m, uint64_t * result);
+
+//! Primality test of an array
+/*!
+    \param values values to be tested
+    \param n number of elements in <i>values</i> and <i>result</i>
+    \param result receives true for each prime value
+    \return true if successful, false if an argument is invalid
+*/
+bool brahe_is_prime_array(const uint64_t * values, const size_t n, bool * result);
+
 //-----------------------------------------------------------------------------
 // Logarithms
 //-----------------------------------------------------------------------------
@@ -161,15 +526,196 @@ typedef enum brahe_pretty_format_t
 }
 brahe_pretty_format;
 
+//! Most groups a 64-bit value can be divided into
+#define BRAHE_PRETTY_MAX_GROUPS 19
+
+//! Longest group separator, in bytes
+#define BRAHE_PRETTY_MAX_SEPARATOR 8
+
+//! Words for spelling out integers
+/*!
+    Words are joined by single spaces. Languages that name numbers the way
+    English does -- a count of hundreds, tens joined to ones, and a name
+    for each group above the lowest -- can be described here.
+*/
+typedef struct
+{
+    //! the word for 0
+    const char * zero;
+    //! placed before negative values
+    const char * negative;
+    //! follows a count of hundreds
+    const char * hundred;
+    //! words for 0 through 19; the first is never used
+    const char * ones[20];
+    //! words for twenty through ninety
+    const char * tens[8];
+    //! joins tens to ones, as in "forty-two"
+    const char * hyphen;
+    //! follows a group name when anything nonzero comes after it
+    const char * group_separator;
+    //! names of the groups above the lowest, from the smallest; unused entries are NULL
+    const char * powers[BRAHE_PRETTY_MAX_GROUPS - 1];
+}
+brahe_pretty_words_t;
+
+//! A measured word
+typedef struct
+{
+    const char * m_text;
+    size_t       m_len;
+}
+brahe_pretty_word_t;
+
+//! Compiled description of how to pretty-print integers
+/*!
+    Built once by brahe_pretty_locale_init and then shared freely; it holds
+    no pointers of its own except to the words it was built from, which
+    must outlive it.
+*/
+typedef struct
+{
+    char          m_separator[BRAHE_PRETTY_MAX_SEPARATOR];      // group separator, not terminated
+    size_t        m_separator_len;                              // bytes in the separator
+    size_t        m_groups;                                     // groups covering the widest value
+    unsigned char m_group_digits[BRAHE_PRETTY_MAX_GROUPS];      // digits in each group, lowest first
+    unsigned char m_separators[BRAHE_PRETTY_MAX_GROUPS + 1];    // separators in a value of n digits
+    bool          m_thousands;                                  // groups of three and a one-byte separator
+    bool          m_text;                                       // values can be spelled out
+    brahe_pretty_word_t m_zero;
+    brahe_pretty_word_t m_negative;
+    brahe_pretty_word_t m_hundred;
+    brahe_pretty_word_t m_hyphen;
+    brahe_pretty_word_t m_group_separator;
+    brahe_pretty_word_t m_ones[20];
+    brahe_pretty_word_t m_tens[8];
+    brahe_pretty_word_t m_powers[BRAHE_PRETTY_MAX_GROUPS - 1];
+}
+brahe_pretty_locale_t;
+
+//! Compile a locale for pretty-printing integers
+/*!
+    The grouping pattern lists group sizes from the lowest group up,
+    separated by semicolons, with the last size repeating: "3" gives
+    1,234,567 and "3;2" gives the Indian 12,34,567. An empty pattern
+    turns grouping off. Integers have no fractional part, so a locale has
+    no decimal mark. Text is available when <i>words</i> is given, every
+    group has at most three digits, and every group above the lowest has a
+    name.
+    \param loc locale to be initialized
+    \param separator placed between groups, up to BRAHE_PRETTY_MAX_SEPARATOR bytes of UTF-8
+    \param grouping group sizes, each from 1 to 9
+    \param words words for text, or NULL for digits only; referenced, not copied
+    \return true if successful, false for a bad separator or pattern
+ */
+bool brahe_pretty_locale_init(brahe_pretty_locale_t * loc, const char * separator, const char * grouping, const brahe_pretty_words_t * words);
+
+//! The built-in U.S. English locale
+/*!
+    Used by every pretty-printing function without a locale argument.
+    \return the compiled en_US locale
+ */
+const brahe_pretty_locale_t * brahe_pretty_locale_en_us(void);
+
+//! The built-in U.S. English words
+/*!
+    For building locales that differ from en_US only in their digits.
+    \return the words used by the en_US locale
+ */
+const brahe_pretty_words_t * brahe_pretty_words_english(void);
+
 //! Turn a 64-bit integer into a pretty string
 /*!
     Returns a nicely formatted strong for a given 64-bit integer.
     \param n number to be formatted
     \param fmt specifies format, as text or comma-delimited
-    \return an allocated string containing the generated text
+    \return an allocated string containing the generated text, to be
+            released with brahe_free
  */
 char * brahe_pretty_int(int64_t n, brahe_pretty_format fmt);
 
+//! Turn a 64-bit integer into a pretty string, in a caller's buffer
+/*!
+    Writes the same string as brahe_pretty_int into <i>buffer</i>, without
+    allocating. Output that does not fit is truncated, but always
+    terminated. Call with a NULL <i>buffer</i> to find the size needed.
+    \param n number to be formatted
+    \param fmt specifies format, as text or comma-delimited
+    \param buffer destination, or NULL
+    \param len size of <i>buffer</i> in characters
+    \return length of the complete string, not counting the terminator; 0 for an invalid format
+ */
+size_t brahe_pretty_int_r(int64_t n, brahe_pretty_format fmt, char * buffer, size_t len);
+
+//! Turn a 64-bit integer into a pretty string for a locale, in a caller's buffer
+/*!
+    As brahe_pretty_int_r, with digits grouped and words chosen by
+    <i>loc</i>; BRAHE_PRETTY_COMMA uses the locale's separator.
+    \param n number to be formatted
+    \param fmt specifies format, as text or grouped digits
+    \param loc compiled locale
+    \param buffer destination, or NULL
+    \param len size of <i>buffer</i> in characters
+    \return length of the complete string, not counting the terminator; 0 for an invalid format, or text the locale cannot produce
+ */
+size_t brahe_pretty_int_l(int64_t n, brahe_pretty_format fmt, const brahe_pretty_locale_t * loc, char * buffer, size_t len);
+
+//! Size of the arena needed to format an array of integers
+/*!
+    Counts every string brahe_pretty_int_array would write for
+    <i>values</i>, including their terminators.
+    \param values integers to be formatted
+    \param n number of elements in <i>values</i>
+    \param fmt specifies format, as text or comma-delimited
+    \return bytes needed in the arena; 0 for an invalid format
+ */
+size_t brahe_pretty_int_array_size(const int64_t * values, size_t n, brahe_pretty_format fmt);
+
+//! Size of the arena needed to format an array of integers for a locale
+/*!
+    As brahe_pretty_int_array_size, for brahe_pretty_int_array_l.
+    \param values integers to be formatted
+    \param n number of elements in <i>values</i>
+    \param fmt specifies format, as text or grouped digits
+    \param loc compiled locale
+    \return bytes needed in the arena; 0 for an invalid format
+ */
+size_t brahe_pretty_int_array_size_l(const int64_t * values, size_t n, brahe_pretty_format fmt, const brahe_pretty_locale_t * loc);
+
+//! Turn an array of 64-bit integers into pretty strings in one arena
+/*!
+    Writes the strings for <i>values</i> one after another into
+    <i>arena</i>, each with its terminator, and without allocating.
+    String <i>i</i> begins at <i>arena</i> + <i>offsets</i>[i]. Formatting
+    stops at the first value that does not fit; the return value says how
+    many were written, and <i>offsets</i>[count] holds the bytes used, so a
+    caller can drain the arena and continue from there. Bytes past that
+    point are unspecified.
+    \param values integers to be formatted
+    \param n number of elements in <i>values</i>
+    \param fmt specifies format, as text or comma-delimited
+    \param arena destination for the strings
+    \param arena_len size of <i>arena</i> in bytes
+    \param offsets room for n + 1 offsets into <i>arena</i>
+    \return number of values formatted
+ */
+size_t brahe_pretty_int_array(const int64_t * values, size_t n, brahe_pretty_format fmt, char * arena, size_t arena_len, size_t * offsets);
+
+//! Turn an array of 64-bit integers into pretty strings for a locale, in one arena
+/*!
+    As brahe_pretty_int_array, with digits grouped and words chosen by
+    <i>loc</i>.
+    \param values integers to be formatted
+    \param n number of elements in <i>values</i>
+    \param fmt specifies format, as text or grouped digits
+    \param loc compiled locale
+    \param arena destination for the strings
+    \param arena_len size of <i>arena</i> in bytes
+    \param offsets room for n + 1 offsets into <i>arena</i>
+    \return number of values formatted
+ */
+size_t brahe_pretty_int_array_l(const int64_t * values, size_t n, brahe_pretty_format fmt, const brahe_pretty_locale_t * loc, char * arena, size_t arena_len, size_t * offsets);
+
 //-----------------------------------------------------------------------------
 // Statistical functions
 //-----------------------------------------------------------------------------
@@ -192,113 +738,1224 @@ brahe_statistics;
 
 //! statistics for array of double
 /*!
-    Calculate several common statistics for an array of doubles.
+    Calculate several common statistics for an array of doubles. The
+    minimum and maximum ignore NaN, but any NaN in the data makes the mean,
+    variance and standard deviation NaN.
     \param data array of double values
     \param n number of elements in data
     \return statistics for data
  */
-brahe_statistics brahe_get_statistics(double * data, size_t n);
+brahe_statistics brahe_get_statistics(const double * data, const size_t n);
 
-//! Moving average
+//! statistics for array of float
 /*!
-    Computes the moving average for an array. The returned buffer
-    must be freed by the calling code.
-    \param data array of double values to be averaged
+    Single-precision version of brahe_get_statistics. The values are
+    accumulated in double, so the results are as accurate as for doubles.
+    \param data array of float values
     \param n number of elements in data
-    \param distance number elements to average before and after an element in <i>data</i>
-    \return an allocated <i>n</i>-length array containing the moving average of corresponding elements in <i>data</i>
-*/
-double * brahe_moving_average(const double * data, const int n, const int distance);
+    \return statistics for data
+ */
+brahe_statistics brahe_get_statistics_f(const float * data, const size_t n);
 
-//-----------------------------------------------------------------------------
-// Digital Signal Processing
-//-----------------------------------------------------------------------------
+//! statistics for array of double, computed in parallel
+/*!
+    Calculates the statistics brahe_get_statistics does, dividing the array
+    among the workers of an execution context. The results may differ from
+    brahe_get_statistics in the last few bits, but do not depend on the
+    number of threads.
+    \param exec an execution context; NULL calls brahe_get_statistics
+    \param data array of double values
+    \param n number of elements in data
+    \return statistics for data
+ */
+brahe_statistics brahe_get_statistics_exec(const brahe_exec_t * exec, const double * data, const size_t n);
 
-//! Simple real-to-real fft (arbitrary length)
+//! Quantile of an array, by selection
 /*!
-     A simple real-to-real FFT for arbitrary-length data. This is not intended
-     to replace dedicated libraries such as FFTW. The caller is responsible
-     for freeing the memory used by the array returned by this function.
-     /param data input array
-     /param n length of data
-     /return an allocated array containing the real FFT of data
+    Finds the <i>q</i> quantile of an array in O(n) time, without sorting or
+    copying it, by introselect. Values between order statistics are linearly
+    interpolated, so the result for <i>q</i> = 0.5 is the usual median.
+    The array is reordered. The data must not contain NaN.
+    \param data array of double values; reordered by this function
+    \param n number of elements in data
+    \param q quantile to find, in the range [0,1]
+    \return the <i>q</i> quantile of <i>data</i>; NAN if <i>n</i> is 0 or <i>q</i> is out of range
 */
-double * brahe_simple_fft(const double * data, const int n);
+double brahe_quantile(double * data, const size_t n, const double q);
 
-//! Simple real-to-real fft (power of 2 length)
+//! Median of an array, by selection
 /*!
-     A simple real-to-real FFT for power of 2-length data. This is not intended
-     to replace dedicated libraries such as FFTW. The caller is responsible
-     for freeing the memory used by the array returned by this function.
-     /param data input array
-     /param n length of data
-     /return an allocated array containing the real FFT of data
+    Equivalent to brahe_quantile with <i>q</i> = 0.5. The array is reordered.
+    \param data array of double values; reordered by this function
+    \param n number of elements in data
+    \return the median of <i>data</i>; NAN if <i>n</i> is 0
 */
-double * brahe_simple_fft2(const double * data, const int n);
+double brahe_median(double * data, const size_t n);
 
-//! Sine wave definition
+//! Several quantiles of an array, by selection
 /*!
-     Defines the characteristics of a sine wave.
+    Finds several quantiles at once, partitioning the array only as far as
+    needed to place every required order statistic. Faster than repeated
+    calls to brahe_quantile. The array is reordered. The data must not
+    contain NaN. Up to 32 quantiles are found without allocating memory.
+    \param data array of double values; reordered by this function
+    \param n number of elements in data
+    \param q array of quantiles to find, each in the range [0,1], in any order
+    \param m number of elements in q
+    \param result array of <i>m</i> elements that receives the quantiles corresponding to <i>q</i>
+    \return <i>true</i> if successful, <i>false</i> if an argument is invalid or memory is exhausted
 */
+bool brahe_quantiles(double * data, const size_t n, const double * q, const size_t m, double * result);
+
+//! A level of a quantile sketch (private)
 typedef struct
 {
-    //! wavelength
-    double wavelength;
-    //! arbitrary wave amplitude
-    double amplitude;
+    double * m_items;
+    size_t   m_size;
+    size_t   m_alloc;
 }
-brahe_wave_factor_t;
+brahe_sketch_level_t;
 
-//! Sine wave based artificial signal generator.
+//! Mergeable streaming quantile sketch
 /*!
-    Generates an array of doubles by combining sine waves. The primary
-    purpose is to produce an artificial signal with known properties,
-    for testing signal analysis applications. The caller is responsible
-    for freeing the memory used by the array returned by this function.
-    \param factors defines properties of the sine waves to be combined
-    \param factor_n number of elements in factors
-    \param array_n number of elements in the output array
-    \return an allocated array containg values generated from the given factors
+    Estimates quantiles of a stream too large to keep, using the KLL
+    algorithm. Memory grows with the logarithm of the stream length, and
+    sketches built on separate parts of a stream can be merged. Fields are
+    private.
 */
-double * brahe_make_sinusoid(const brahe_wave_factor_t * factors, const size_t factor_n, const size_t array_n);
+typedef struct
+{
+    size_t                 m_k;           // accuracy parameter
+    size_t                 m_levels;      // levels in use
+    size_t                 m_level_alloc; // levels allocated
+    brahe_sketch_level_t * m_level;       // items retained at each level
+    size_t                 m_size;        // items retained over all levels
+    size_t                 m_max_size;    // retained items that trigger compaction
+    uint64_t               m_count;       // items added
+    uint64_t               m_random;      // state for choosing which items to keep
+    double                 m_min;         // smallest item added
+    double                 m_max;         // largest item added
+    brahe_allocator_t      m_allocator;   // source of the levels and their items
+}
+brahe_quantile_sketch_t;
 
-//! Apply noise to a signal
+//! Initialize a quantile sketch
 /*!
-    Adds a percentage of noise to a signal. If "noise" is set to 0.1 (for example)
-    each value will be adjust to between 90% and 110% of its original value. This
-    function changes the existing values in the array.
-    \param a array containing signal data
-    \param n number of samples in signal
-    \param noise percentage of noise
+    Creates an empty sketch. Larger values of <i>k</i> give more accurate
+    quantiles at the cost of memory; the rank error is about 1.7/<i>k</i>
+    (under 1% for the typical <i>k</i> of 200). Sketches to be merged should
+    use the same <i>k</i>.
+    \param sketch object to be initialized
+    \param k accuracy parameter, at least 8
+    \return <i>true</i> if successful, <i>false</i> if failed
 */
-void brahe_add_noise(double * a, const size_t n, double noise);
+bool brahe_quantile_sketch_init(brahe_quantile_sketch_t * sketch, const size_t k);
 
-//-----------------------------------------------------------------------------
-// Trigonometry
-//-----------------------------------------------------------------------------
-//! Hyperbolic arcsine
+//! Free resources used by a quantile sketch
 /*!
-    Calculates sinh<sup>-1</sup>.
-    \param x a value
-    \return inverse hyperbolic sine of <i>x</i>
+    \param sketch object to be freed
 */
-double brahe_asinh(const double x);
+void brahe_quantile_sketch_free(brahe_quantile_sketch_t * sketch);
 
-//! Hyperbolic arccosine
+//! Add a value to a quantile sketch
 /*!
-    Calculates cosh<sup>-1</sup>.
-    \param x a value
-    \return inverse hyperbolic cosine of <i>x</i>
+    \param sketch a quantile sketch
+    \param x value to add; must not be NaN
+    \return <i>true</i> if successful, <i>false</i> if memory is exhausted
 */
-double brahe_acosh(const double x);
+bool brahe_quantile_sketch_add(brahe_quantile_sketch_t * sketch, const double x);
 
-//! Hyperbolic arctangent
+//! Add several values to a quantile sketch
 /*!
-    Calculates tanh<sup>-1</sup>.
-    \param x a value
-    \return inverse hyperbolic tangent of <i>x</i>
+    \param sketch a quantile sketch
+    \param data array of values; must not contain NaN
+    \param n number of elements in data
+    \return <i>true</i> if successful, <i>false</i> if memory is exhausted
 */
-double brahe_atanh(const double x);
+bool brahe_quantile_sketch_add_n(brahe_quantile_sketch_t * sketch, const double * data, const size_t n);
+
+//! Merge one quantile sketch into another
+/*!
+    After merging, <i>sketch</i> summarizes the values added to both
+    sketches. <i>other</i> is unchanged.
+    \param sketch sketch that receives the merged summary
+    \param other sketch to be merged into <i>sketch</i>
+    \return <i>true</i> if successful, <i>false</i> if memory is exhausted
+*/
+bool brahe_quantile_sketch_merge(brahe_quantile_sketch_t * sketch, const brahe_quantile_sketch_t * other);
+
+//! Number of values summarized by a quantile sketch
+/*!
+    \param sketch a quantile sketch
+    \return number of values added to the sketch, including merged sketches
+*/
+uint64_t brahe_quantile_sketch_count(const brahe_quantile_sketch_t * sketch);
+
+//! Estimate a quantile from a sketch
+/*!
+    Returns a value from the stream whose rank approximates <i>q</i>. The
+    minimum and maximum (<i>q</i> = 0 and 1) are exact.
+    \param sketch a quantile sketch
+    \param q quantile to estimate, in the range [0,1]
+    \return the estimated quantile; NAN if the sketch is empty or <i>q</i> is out of range
+*/
+double brahe_quantile_sketch_query(const brahe_quantile_sketch_t * sketch, const double q);
+
+//! Bin layouts for histograms
+typedef enum
+{
+    //! bins of equal width over [lo,hi)
+    BRAHE_HISTOGRAM_LINEAR = 0,
+    //! bins of equal width in log(x) over [lo,hi), lo > 0
+    BRAHE_HISTOGRAM_LOG,
+    //! log-linear bins: each power of two is split into 2^precision equal bins
+    BRAHE_HISTOGRAM_HDR
+}
+brahe_histogram_type_t;
+
+//! Histogram with under- and overflow counts
+/*!
+    Counts values into bins. Values below the range are counted as underflow;
+    values at or above the top of the range, and NaN, are counted as
+    overflow. Histograms with the same layout can be merged. Fields are
+    private.
+*/
+typedef struct
+{
+    brahe_histogram_type_t m_type;
+    size_t     m_bins;      // number of bins, excluding under- and overflow
+    double     m_lo;        // bottom of the range
+    double     m_hi;        // top of the range
+    double     m_scale;     // bins per unit (linear) or per unit of log (log)
+    uint64_t   m_offset;    // bit pattern of the first bin (HDR)
+    unsigned int m_shift;   // bits dropped to find a bin (HDR)
+    uint64_t   m_total;     // values added
+    uint64_t * m_slots;     // underflow, bins, overflow
+    uint32_t * m_lanes;     // sub-counts used by bulk additions
+    brahe_allocator_t m_allocator; // source of m_slots and m_lanes
+}
+brahe_histogram_t;
+
+//! Initialize a histogram with linear bins
+/*!
+    \param hist object to be initialized
+    \param lo bottom of the range
+    \param hi top of the range (exclusive); must be greater than <i>lo</i>
+    \param bins number of bins
+    \return true if successful, false if the arguments are invalid or allocation failed
+*/
+bool brahe_histogram_init_linear(brahe_histogram_t * hist, const double lo, const double hi, const size_t bins);
+
+//! Initialize a histogram with logarithmic bins
+/*!
+    \param hist object to be initialized
+    \param lo bottom of the range; must be greater than zero
+    \param hi top of the range (exclusive); must be greater than <i>lo</i>
+    \param bins number of bins
+    \return true if successful, false if the arguments are invalid or allocation failed
+*/
+bool brahe_histogram_init_log(brahe_histogram_t * hist, const double lo, const double hi, const size_t bins);
+
+//! Initialize a histogram with log-linear (HDR) bins
+/*!
+    Each power of two in the range is divided into 2^<i>precision</i> bins
+    of equal width, so every bin is within a relative width of
+    2^-<i>precision</i>. Bins are found directly from the bits of a value.
+    The range is widened to whole bins.
+    \param hist object to be initialized
+    \param lo bottom of the range; must be a positive normal number
+    \param hi top of the range (exclusive); must be greater than <i>lo</i>
+    \param precision number of bits of sub-bin precision, at most 20
+    \return true if successful, false if the arguments are invalid or allocation failed
+*/
+bool brahe_histogram_init_hdr(brahe_histogram_t * hist, const double lo, const double hi, const unsigned int precision);
+
+//! Free resources used by a histogram
+/*!
+    \param hist object to be freed
+*/
+void brahe_histogram_free(brahe_histogram_t * hist);
+
+//! Reset all counts in a histogram to zero
+/*!
+    \param hist a histogram
+*/
+void brahe_histogram_clear(brahe_histogram_t * hist);
+
+//! Add a value to a histogram
+/*!
+    \param hist a histogram
+    \param x value to be counted
+*/
+void brahe_histogram_add(brahe_histogram_t * hist, const double x);
+
+//! Add several values to a histogram
+/*!
+    Counts the same as calling brahe_histogram_add for each value, but is
+    considerably faster for large arrays.
+    \param hist a histogram
+    \param data values to be counted
+    \param n number of elements in data
+*/
+void brahe_histogram_add_n(brahe_histogram_t * hist, const double * data, const size_t n);
+
+//! Bin counts of a histogram
+/*!
+    \param hist a histogram
+    \return pointer to the counts of the bins, excluding under- and overflow
+*/
+const uint64_t * brahe_histogram_counts(const brahe_histogram_t * hist);
+
+//! Number of values below the range of a histogram
+/*!
+    \param hist a histogram
+    \return the underflow count
+*/
+uint64_t brahe_histogram_underflow(const brahe_histogram_t * hist);
+
+//! Number of values above the range of a histogram, or NaN
+/*!
+    \param hist a histogram
+    \return the overflow count
+*/
+uint64_t brahe_histogram_overflow(const brahe_histogram_t * hist);
+
+//! Number of values added to a histogram
+/*!
+    \param hist a histogram
+    \return total count, including under- and overflow
+*/
+uint64_t brahe_histogram_total(const brahe_histogram_t * hist);
+
+//! Lower edge of a histogram bin
+/*!
+    \param hist a histogram
+    \param i bin index; the number of bins gives the top of the range
+    \return the lower edge of bin <i>i</i>
+*/
+double brahe_histogram_edge(const brahe_histogram_t * hist, const size_t i);
+
+//! Merge one histogram into another
+/*!
+    \param hist histogram that receives the counts
+    \param other histogram to be added to <i>hist</i>; must have the same layout
+    \return true if successful, false if the layouts differ
+*/
+bool brahe_histogram_merge(brahe_histogram_t * hist, const brahe_histogram_t * other);
+
+//! Estimate a quantile from a histogram
+/*!
+    Interpolates linearly within the bin that holds the quantile. Quantiles
+    falling in the underflow or overflow counts return the bottom or top of
+    the range.
+    \param hist a histogram
+    \param q quantile to estimate, in the range [0,1]
+    \return the estimated quantile; NAN if the histogram is empty or <i>q</i> is out of range
+*/
+double brahe_histogram_quantile(const brahe_histogram_t * hist, const double q);
+
+//! Serialize a histogram
+/*!
+    Writes the layout and nonzero counts of a histogram in a compact,
+    portable form. Call with a NULL <i>buffer</i> to find the size needed.
+    \param hist a histogram
+    \param buffer destination, or NULL
+    \param len length of <i>buffer</i> in bytes
+    \return number of bytes needed; nothing past <i>len</i> is written
+*/
+size_t brahe_histogram_serialize(const brahe_histogram_t * hist, uint8_t * buffer, const size_t len);
+
+//! Deserialize a histogram
+/*!
+    Initializes <i>hist</i> from the output of brahe_histogram_serialize.
+    \param hist object to be initialized
+    \param buffer serialized histogram
+    \param len length of <i>buffer</i> in bytes
+    \return true if successful, false if the data is malformed or allocation failed
+*/
+bool brahe_histogram_deserialize(brahe_histogram_t * hist, const uint8_t * buffer, const size_t len);
+
+//! Moving average
+/*!
+    Computes the moving average for an array. The returned buffer
+    must be released with brahe_free.
+    \param data array of double values to be averaged
+    \param n number of elements in data
+    \param distance number elements to average before and after an element in <i>data</i>
+    \return an allocated <i>n</i>-length array containing the moving average of corresponding elements in <i>data</i>
+*/
+double * brahe_moving_average(const double * data, const size_t n, const size_t distance);
+
+//! Moving average into a caller-supplied buffer
+/*!
+    Computes the same moving average as brahe_moving_average, writing the
+    results to <i>result</i> instead of an allocated buffer. A compensated
+    running sum makes the cost O(n), independent of <i>distance</i>.
+    \param data array of double values to be averaged
+    \param n number of elements in data
+    \param distance number elements to average before and after an element in <i>data</i>
+    \param result array of at least <i>n</i> elements that receives the averages; must not overlap <i>data</i>
+    \return <i>true</i> if successful, <i>false</i> if an argument is invalid
+*/
+bool brahe_moving_average_into(const double * data, const size_t n, const size_t distance, double * result);
+
+//! Moving average of floats into a caller-supplied buffer
+/*!
+    Single-precision version of brahe_moving_average_into; the running sum
+    is kept in double.
+    \param data array of float values to be averaged
+    \param n number of elements in data
+    \param distance number elements to average before and after an element in <i>data</i>
+    \param result array of at least <i>n</i> elements that receives the averages; must not overlap <i>data</i>
+    \return <i>true</i> if successful, <i>false</i> if an argument is invalid
+*/
+bool brahe_moving_average_into_f(const float * data, const size_t n, const size_t distance, float * result);
+
+//! Moving average into a caller-supplied buffer, using a vectorized prefix sum
+/*!
+    Computes the same values as brahe_moving_average_into, as a SIMD prefix sum
+    over the changes in window sum. The sum is recomputed exactly at the start of
+    each block of several windows, which bounds rounding drift; results may differ
+    from brahe_moving_average_into in the last few bits.
+    \param data array of double values to be averaged
+    \param n number of elements in data
+    \param distance number elements to average before and after an element in <i>data</i>
+    \param result array of at least <i>n</i> elements that receives the averages; must not overlap <i>data</i>
+    \return <i>true</i> if successful, <i>false</i> if an argument is invalid
+*/
+bool brahe_moving_average_prefix_into(const double * data, const size_t n, const size_t distance, double * result);
+
+//! Moving average into a caller-supplied buffer, computed in parallel
+/*!
+    Computes the same moving average as brahe_moving_average_into, dividing
+    the array among the workers of an execution context. Each piece starts
+    from an exactly computed window sum, so results may differ from
+    brahe_moving_average_into in the last few bits, but do not depend on the
+    number of threads.
+    \param exec an execution context; NULL calls brahe_moving_average_into
+    \param data array of double values to be averaged
+    \param n number of elements in data
+    \param distance number elements to average before and after an element in <i>data</i>
+    \param result array of at least <i>n</i> elements that receives the averages; must not overlap <i>data</i>
+    \return <i>true</i> if successful, <i>false</i> if an argument is invalid
+*/
+bool brahe_moving_average_into_exec(const brahe_exec_t * exec, const double * data, const size_t n, const size_t distance,
+                                    double * result);
+
+//! Exponentially weighted moving averages and variances for many series
+/*!
+    Tracks the exponentially weighted mean and variance of <i>n</i> series
+    that are sampled together. Values are stored as a structure of arrays,
+    aligned for SIMD, and every series is updated in a single pass.
+    Fields are private.
+*/
+typedef struct
+{
+    size_t   m_n;               // number of series
+    double   m_alpha;           // weight of the newest sample
+    bool     m_bias_correction; // correct for the warm-up period
+    uint64_t m_updates;         // updates since initialization or reset
+    double   m_weight;          // total weight of samples, for bias correction
+    double * m_mean;            // n weighted means
+    double * m_var;             // n weighted variances
+    brahe_allocator_t m_allocator; // source of m_mean and m_var
+}
+brahe_ewma_bank_t;
+
+//! Initialize a bank of exponentially weighted moving averages
+/*!
+    Allocates state for <i>n</i> series. Each update moves a mean toward
+    the new sample by <i>alpha</i> times their difference. With bias
+    correction, early estimates are normalized by the total weight of the
+    samples seen so far, so they are unbiased averages from the first update
+    on; without it, the first sample seeds each series and later updates
+    use <i>alpha</i> unchanged.
+    \param bank object to be initialized
+    \param n number of series
+    \param alpha smoothing factor, in the range (0,1]
+    \param bias_correction <i>true</i> to correct estimates during warm-up
+    \return <i>true</i> if successful, <i>false</i> if failed
+*/
+bool brahe_ewma_bank_init(brahe_ewma_bank_t * bank, const size_t n, const double alpha, const bool bias_correction);
+
+//! Free resources used by a bank of moving averages
+/*!
+    \param bank object to be freed
+*/
+void brahe_ewma_bank_free(brahe_ewma_bank_t * bank);
+
+//! Restart all series in a bank
+/*!
+    Discards the history of every series, keeping the bank's memory.
+    \param bank object to be reset
+*/
+void brahe_ewma_bank_reset(brahe_ewma_bank_t * bank);
+
+//! Update every series in a bank
+/*!
+    Adds one sample to each series.
+    \param bank a bank of moving averages
+    \param x array of <i>n</i> samples, one per series; 16-byte alignment gives the fastest loads
+*/
+void brahe_ewma_bank_update(brahe_ewma_bank_t * bank, const double * x);
+
+//! Current means of a bank
+/*!
+    \param bank a bank of moving averages
+    \return array of <i>n</i> weighted means, owned by the bank
+*/
+const double * brahe_ewma_bank_means(const brahe_ewma_bank_t * bank);
+
+//! Current variances of a bank
+/*!
+    \param bank a bank of moving averages
+    \return array of <i>n</i> weighted variances, owned by the bank
+*/
+const double * brahe_ewma_bank_variances(const brahe_ewma_bank_t * bank);
+
+//! State for statistics over a trailing window of a data stream
+/*!
+    Holds the most recent samples of a stream in a fixed ring buffer, along
+    with the incremental state needed to report their statistics. Memory use
+    is fixed when the window is initialized. Fields are private.
+*/
+typedef struct
+{
+    size_t     m_capacity; // window length
+    size_t     m_count;    // samples currently in the window
+    uint64_t   m_total;    // samples pushed since initialization or reset
+    double *   m_ring;     // the last m_capacity samples
+    double     m_mean;     // mean of the window
+    double     m_m2;       // sum of squared differences from the mean
+    uint64_t * m_minq;     // monotonic deque of sample numbers for the minimum
+    size_t     m_min_head;
+    size_t     m_min_size;
+    uint64_t * m_maxq;     // monotonic deque of sample numbers for the maximum
+    size_t     m_max_head;
+    size_t     m_max_size;
+    brahe_allocator_t m_allocator; // source of m_ring
+}
+brahe_moving_window_t;
+
+//! Initialize a moving window
+/*!
+    Allocates a window that reports statistics for the last <i>length</i>
+    samples pushed into it.
+    \param window object to be initialized
+    \param length number of samples in the window
+    \return <i>true</i> if successful, <i>false</i> if failed
+*/
+bool brahe_moving_window_init(brahe_moving_window_t * window, const size_t length);
+
+//! Free resources used by a moving window
+/*!
+    \param window object to be freed
+*/
+void brahe_moving_window_free(brahe_moving_window_t * window);
+
+//! Empty a moving window
+/*!
+    Discards all samples, keeping the window's memory for reuse.
+    \param window object to be reset
+*/
+void brahe_moving_window_reset(brahe_moving_window_t * window);
+
+//! Add a sample to a moving window
+/*!
+    Adds a sample, discarding the oldest one if the window is full.
+    Amortized cost is O(1), independent of the window length.
+    \param window a moving window
+    \param x new sample
+*/
+void brahe_moving_window_push(brahe_moving_window_t * window, const double x);
+
+//! Add several samples to a moving window
+/*!
+    Equivalent to calling brahe_moving_window_push for each element of <i>data</i>.
+    \param window a moving window
+    \param data array of samples, oldest first
+    \param n number of elements in data
+*/
+void brahe_moving_window_push_n(brahe_moving_window_t * window, const double * data, const size_t n);
+
+//! Number of samples in a moving window
+/*!
+    \param window a moving window
+    \return number of samples currently in the window, at most its length
+*/
+size_t brahe_moving_window_count(const brahe_moving_window_t * window);
+
+//! Statistics for the samples in a moving window
+/*!
+    Returns minimum, maximum, mean, sample variance, and standard deviation for
+    the samples currently in the window. All fields are zero for an empty
+    window; variance and sigma are zero for a window holding one sample.
+    \param window a moving window
+    \return statistics for the window's samples
+*/
+brahe_statistics brahe_moving_window_statistics(const brahe_moving_window_t * window);
+
+//-----------------------------------------------------------------------------
+// Digital Signal Processing
+//-----------------------------------------------------------------------------
+
+//! Simple real-to-real fft (arbitrary length)
+/*!
+     A simple real-to-real FFT for arbitrary-length data, zero-padded to the
+     next power of 2. This is not intended to replace dedicated libraries
+     such as FFTW. Release the returned array with brahe_free.
+     /param data input array
+     /param n length of data, at least 2
+     /return an allocated array of half the padded length, containing the
+             magnitudes of the real FFT of data; NULL on failure
+*/
+double * brahe_simple_fft(const double * data, const size_t n);
+
+//! Simple real-to-real fft (power of 2 length)
+/*!
+     A simple real-to-real FFT for power of 2-length data. This is not intended
+     to replace dedicated libraries such as FFTW. Release the returned array
+     with brahe_free.
+     /param data input array
+     /param n length of data, a power of 2 of at least 2
+     /return an allocated array of n / 2 magnitudes of the real FFT of data;
+             NULL on failure
+*/
+double * brahe_simple_fft2(const double * data, const size_t n);
+
+//! Workspace for brahe_simple_fft_into
+/*!
+     \param n length of data
+     \return the number of doubles of workspace needed to transform <i>n</i> values
+*/
+size_t brahe_simple_fft_work_size(const size_t n);
+
+//! Simple real-to-real fft into caller memory (arbitrary length)
+/*!
+     Computes what brahe_simple_fft does without allocating.
+     \param data input array
+     \param n length of data, at least 2
+     \param out receives half the padded length of magnitudes
+     \param work brahe_simple_fft_work_size(<i>n</i>) doubles of scratch space
+     \return true if successful, false if an argument is invalid
+*/
+bool brahe_simple_fft_into(const double * data, const size_t n, double * out, double * work);
+
+//! Simple real-to-real fft of floats into caller-supplied buffers
+/*!
+     Single-precision version of brahe_simple_fft_into, with butterflies in
+     float at twice the vector width. <i>work</i> holds
+     brahe_simple_fft_work_size(n) floats.
+     /param data input array
+     /param n length of data, at least 2
+     /param out array of half the padded length that receives the magnitudes
+     /param work scratch array of brahe_simple_fft_work_size(n) floats
+     /return true if successful, false if an argument is invalid
+*/
+bool brahe_simple_fft_into_f(const float * data, const size_t n, float * out, float * work);
+
+//! Simple real-to-real fft into caller memory (power of 2 length)
+/*!
+     Computes what brahe_simple_fft2 does without allocating.
+     \param data input array
+     \param n length of data, a power of 2 of at least 2
+     \param out receives <i>n</i> / 2 magnitudes
+     \param work brahe_simple_fft_work_size(<i>n</i>) doubles of scratch space
+     \return true if successful, false if an argument is invalid
+*/
+bool brahe_simple_fft2_into(const double * data, const size_t n, double * out, double * work);
+
+//! Simple real-to-real fft into caller memory, computed in parallel
+/*!
+     Computes what brahe_simple_fft_into does, dividing the work among the
+     workers of an execution context. Passes spanning more than a few
+     thousand elements use a scalar loop, so results may differ from
+     brahe_simple_fft_into in the last bit, but do not depend on the number
+     of threads.
+     \param exec an execution context; NULL calls brahe_simple_fft_into
+     \param data input array
+     \param n length of data, at least 2
+     \param out receives half the padded length of magnitudes
+     \param work brahe_simple_fft_work_size(<i>n</i>) doubles of scratch space
+     \return true if successful, false if an argument is invalid
+*/
+bool brahe_simple_fft_into_exec(const brahe_exec_t * exec, const double * data, const size_t n, double * out, double * work);
+
+//! Sine wave definition
+/*!
+     Defines the characteristics of a sine wave.
+*/
+typedef struct
+{
+    //! wavelength
+    double wavelength;
+    //! arbitrary wave amplitude
+    double amplitude;
+}
+brahe_wave_factor_t;
+
+//! Sine wave based artificial signal generator.
+/*!
+    Generates an array of doubles by combining sine waves. The primary
+    purpose is to produce an artificial signal with known properties,
+    for testing signal analysis applications. Release the returned array
+    with brahe_free.
+    \param factors defines properties of the sine waves to be combined
+    \param factor_n number of elements in factors
+    \param array_n number of elements in the output array
+    \return an allocated array containg values generated from the given factors
+*/
+double * brahe_make_sinusoid(const brahe_wave_factor_t * factors, const size_t factor_n, const size_t array_n);
+
+//! Sine wave based artificial signal generator, into a caller-supplied buffer
+/*!
+    Generates the same signal as brahe_make_sinusoid without allocating.
+    Waves are advanced by a rotation recurrence that is restarted from
+    exact values every few hundred samples, rather than calling sin() for
+    every sample.
+    \param factors defines properties of the sine waves to be combined
+    \param factor_n number of elements in factors
+    \param result array of <i>array_n</i> elements that receives the signal
+    \param array_n number of elements in the output array
+    \return true if successful, false if an argument is invalid
+*/
+bool brahe_make_sinusoid_into(const brahe_wave_factor_t * factors, const size_t factor_n, double * result, const size_t array_n);
+
+//! Sine wave based artificial signal generator with phase offsets
+/*!
+    Like brahe_make_sinusoid_into, but each wave starts at a given phase;
+    sample <i>i</i> of wave <i>n</i> is
+    amplitude * sin(phases[n] + i * PI / wavelength).
+    \param factors defines properties of the sine waves to be combined
+    \param phases starting phase of each wave in radians, or NULL for all zero
+    \param factor_n number of elements in factors and phases
+    \param result array of <i>array_n</i> elements that receives the signal
+    \param array_n number of elements in the output array
+    \return true if successful, false if an argument is invalid
+*/
+bool brahe_make_sinusoid_phased_into(const brahe_wave_factor_t * factors, const double * phases, const size_t factor_n,
+                                     double * result, const size_t array_n);
+
+//! Create a single-precision sinusoid in a caller-supplied buffer
+/*!
+    Single-precision version of brahe_make_sinusoid_into; the waves are
+    computed in double and rounded once, as they are stored.
+    \param factors defines properties of the sine waves to be combined
+    \param factor_n number of elements in factors
+    \param result array of <i>array_n</i> elements that receives the signal
+    \param array_n number of elements in the output array
+    \return true if successful, false if an argument is invalid
+*/
+bool brahe_make_sinusoid_into_f(const brahe_wave_factor_t * factors, const size_t factor_n, float * result, const size_t array_n);
+
+//! Create a single-precision sinusoid with given phases
+/*!
+    Single-precision version of brahe_make_sinusoid_phased_into.
+    \param factors defines properties of the sine waves to be combined
+    \param phases starting phase of each wave in radians, or NULL for all zero
+    \param factor_n number of elements in factors and phases
+    \param result array of <i>array_n</i> elements that receives the signal
+    \param array_n number of elements in the output array
+    \return true if successful, false if an argument is invalid
+*/
+bool brahe_make_sinusoid_phased_into_f(const brahe_wave_factor_t * factors, const double * phases, const size_t factor_n,
+                                       float * result, const size_t array_n);
+
+//! Sine wave based artificial signal generator with phase offsets, computed in parallel
+/*!
+    Computes what brahe_make_sinusoid_phased_into does, dividing the signal
+    among the workers of an execution context; the results are identical.
+    \param exec an execution context; may be NULL
+    \param factors defines properties of the sine waves to be combined
+    \param phases starting phase of each wave in radians, or NULL for all zero
+    \param factor_n number of elements in factors and phases
+    \param result array of <i>array_n</i> elements that receives the signal
+    \param array_n number of elements in the output array
+    \return true if successful, false if an argument is invalid
+*/
+bool brahe_make_sinusoid_phased_into_exec(const brahe_exec_t * exec, const brahe_wave_factor_t * factors, const double * phases,
+                                          const size_t factor_n, double * result, const size_t array_n);
+
+//! Apply noise to a signal
+/*!
+    Adds a percentage of noise to a signal. If "noise" is set to 0.1 (for example)
+    each value will be adjust to between 90% and 110% of its original value. This
+    function changes the existing values in the array. The generator is seeded
+    unpredictably; use brahe_add_noise_r or brahe_add_noise_seeded for
+    reproducible noise.
+    \param a array containing signal data
+    \param n number of samples in signal
+    \param noise percentage of noise
+*/
+void brahe_add_noise(double * a, const size_t n, double noise);
+
+//! Apply noise to a single-precision signal
+/*!
+    Single-precision version of brahe_add_noise.
+    \param a array containing signal data
+    \param n number of samples in signal
+    \param noise percentage of noise
+*/
+void brahe_add_noise_f(float * a, const size_t n, double noise);
+
+//! Kinds of noise that can be applied to a signal
+typedef enum
+{
+    //! add noise * u, with u uniform in [-1,1)
+    BRAHE_NOISE_UNIFORM = 0,
+    //! add noise * z, with z standard normal
+    BRAHE_NOISE_GAUSSIAN,
+    //! multiply by 1 + noise * u, with u uniform in [-1,1)
+    BRAHE_NOISE_MULTIPLICATIVE
+}
+brahe_noise_type_t;
+
+//! Apply reproducible noise to a signal, using several threads
+/*!
+    The signal is divided into fixed segments, each given noise from its own
+    generator seeded from <i>seed</i> and the segment's position. The result
+    depends only on the arguments, not on the number of threads.
+    \param a array containing signal data
+    \param n number of samples in signal
+    \param type kind of noise
+    \param noise scale of the noise
+    \param seed seed for the noise; must be nonzero for reproducible results
+    \param threads number of threads to use; 0 uses one per processor
+    \return true if successful, false if an argument is invalid or resources were not available
+*/
+bool brahe_add_noise_seeded(double * a, const size_t n, const brahe_noise_type_t type, const double noise,
+                            const uint32_t seed, size_t threads);
+
+//! Apply reproducible noise to a single-precision signal, using several threads
+/*!
+    Single-precision version of brahe_add_noise_seeded. The variates are
+    the same as for a double signal with the same arguments.
+    \param a array containing signal data
+    \param n number of samples in signal
+    \param type kind of noise
+    \param noise scale of the noise
+    \param seed seed for the noise; must be nonzero for reproducible results
+    \param threads number of threads to use; 0 uses one per processor
+    \return true if successful, false if an argument is invalid or resources were not available
+*/
+bool brahe_add_noise_seeded_f(float * a, const size_t n, const brahe_noise_type_t type, const double noise,
+                              const uint32_t seed, size_t threads);
+
+//! Apply reproducible noise to a signal, on the workers of an execution context
+/*!
+    Gives the same result as brahe_add_noise_seeded, using an existing
+    execution context instead of starting threads for the call.
+    \param exec an execution context; NULL applies the noise on the calling thread
+    \param a array containing signal data
+    \param n number of samples in signal
+    \param type kind of noise
+    \param noise scale of the noise
+    \param seed seed for the noise; must be nonzero for reproducible results
+    \return true if successful, false if an argument is invalid
+*/
+bool brahe_add_noise_seeded_exec(const brahe_exec_t * exec, double * a, const size_t n, const brahe_noise_type_t type,
+                                 const double noise, const uint32_t seed);
+
+//! A term of a streaming signal (private)
+typedef struct
+{
+    int      m_shape;       // kind of wave
+    double   m_amplitude;   // peak value
+    double   m_phase;       // position within the current cycle, in [0,1)
+    double   m_start_step;  // cycles per sample (at the start of a chirp)
+    double   m_end_step;    // cycles per sample at the end of a chirp
+    uint64_t m_sweep;       // samples in one chirp sweep
+    uint64_t m_sweep_pos;   // position within the current sweep
+}
+brahe_signal_term_t;
+
+//! Streaming artificial signal generator
+/*!
+    Produces an unbounded signal, chunk by chunk, from a sum of sine,
+    square, sawtooth and chirp waves plus optional noise. Phase carries
+    across chunks, so consecutive chunks form one continuous signal.
+    Wavelengths follow brahe_wave_factor_t: a wave advances PI / wavelength
+    radians per sample. Generating samples does not allocate. Fields are
+    private.
+*/
+typedef struct
+{
+    brahe_signal_term_t * m_terms;      // waves making up the signal
+    size_t                m_count;      // number of terms
+    size_t                m_capacity;   // maximum number of terms
+    uint64_t              m_position;   // samples generated so far
+    brahe_noise_type_t    m_noise_type; // kind of noise
+    double                m_noise;      // scale of noise; zero for none
+    void *                m_prng;       // generator for noise
+    brahe_allocator_t     m_allocator;  // source of m_terms and m_prng
+}
+brahe_signal_t;
+
+//! Initialize a signal generator
+/*!
+    \param signal object to be initialized
+    \param max_terms maximum number of waves in the signal
+    \param seed seed for noise; zero for an unpredictable seed
+    \return true if successful, false if an argument is invalid or allocation failed
+*/
+bool brahe_signal_init(brahe_signal_t * signal, const size_t max_terms, const uint32_t seed);
+
+//! Free resources used by a signal generator
+/*!
+    \param signal object to be freed
+*/
+void brahe_signal_free(brahe_signal_t * signal);
+
+//! Add a sine wave to a signal
+/*!
+    \param signal a signal generator
+    \param factor wavelength and amplitude of the wave
+    \param phase starting phase in radians
+    \return true if successful, false if an argument is invalid or the signal is full
+*/
+bool brahe_signal_add_sine(brahe_signal_t * signal, const brahe_wave_factor_t * factor, const double phase);
+
+//! Add a square wave to a signal
+/*!
+    The wave is +amplitude for the first half of each cycle and -amplitude
+    for the second, in step with a sine of the same phase. It is not
+    band-limited.
+    \param signal a signal generator
+    \param factor wavelength and amplitude of the wave
+    \param phase starting phase in radians
+    \return true if successful, false if an argument is invalid or the signal is full
+*/
+bool brahe_signal_add_square(brahe_signal_t * signal, const brahe_wave_factor_t * factor, const double phase);
+
+//! Add a sawtooth wave to a signal
+/*!
+    The wave rises from -amplitude to +amplitude over each cycle. It is not
+    band-limited.
+    \param signal a signal generator
+    \param factor wavelength and amplitude of the wave
+    \param phase starting phase in radians
+    \return true if successful, false if an argument is invalid or the signal is full
+*/
+bool brahe_signal_add_saw(brahe_signal_t * signal, const brahe_wave_factor_t * factor, const double phase);
+
+//! Add a repeating chirp to a signal
+/*!
+    Adds a sine wave whose frequency changes linearly from that of
+    <i>start_wavelength</i> to that of <i>end_wavelength</i> over
+    <i>sweep</i> samples, then starts over, with continuous phase.
+    \param signal a signal generator
+    \param amplitude peak value of the wave
+    \param start_wavelength wavelength at the start of each sweep
+    \param end_wavelength wavelength approached at the end of each sweep
+    \param sweep number of samples in each sweep
+    \return true if successful, false if an argument is invalid or the signal is full
+*/
+bool brahe_signal_add_chirp(brahe_signal_t * signal, const double amplitude, const double start_wavelength,
+                            const double end_wavelength, const uint64_t sweep);
+
+//! Set the noise applied to a signal
+/*!
+    \param signal a signal generator
+    \param type kind of noise
+    \param noise scale of the noise; zero for none
+    \return true if successful, false if an argument is invalid
+*/
+bool brahe_signal_set_noise(brahe_signal_t * signal, const brahe_noise_type_t type, const double noise);
+
+//! Generate the next samples of a signal
+/*!
+    \param signal a signal generator
+    \param out array that receives <i>n</i> samples
+    \param n number of samples to generate
+    \return true if successful, false if an argument is invalid
+*/
+bool brahe_signal_generate(brahe_signal_t * signal, double * out, const size_t n);
+
+//! Number of samples generated by a signal generator
+/*!
+    \param signal a signal generator
+    \return samples generated since initialization
+*/
+uint64_t brahe_signal_position(const brahe_signal_t * signal);
+
+//-----------------------------------------------------------------------------
+// Sample files
+//-----------------------------------------------------------------------------
+
+//! Encodings of raw sample files
+/*!
+    Sample files have no header; they hold consecutive little-endian
+    samples of one type. A trailing partial sample is ignored.
+*/
+typedef enum
+{
+    //! IEEE 754 double precision
+    BRAHE_SAMPLE_FLOAT64,
+    //! IEEE 754 single precision
+    BRAHE_SAMPLE_FLOAT32,
+    //! signed 16-bit integers
+    BRAHE_SAMPLE_INT16
+}
+brahe_sample_type_t;
+
+//! Statistics for the samples in a file
+/*!
+    Calculates the statistics brahe_get_statistics does, for a range of
+    samples in a file. The file is memory mapped a window of pages at a time
+    and read sequentially, so memory use does not grow with the file. The
+    results may differ from brahe_get_statistics in the last few bits. As
+    with any mapped file, another process truncating it during the call
+    raises SIGBUS on POSIX systems.
+    \param path name of the file
+    \param type encoding of the samples
+    \param first number of the first sample to include
+    \param count number of samples to include; 0 for all from <i>first</i> on
+    \param stats receives the statistics
+    \return <i>true</i> if successful, <i>false</i> if an argument is invalid, the file cannot be read, or it holds fewer samples than requested
+*/
+bool brahe_get_statistics_file(const char * path, const brahe_sample_type_t type, const uint64_t first, const uint64_t count,
+                               brahe_statistics * stats);
+
+//! Moving average of the samples in a file, written to another file
+/*!
+    Computes the moving average brahe_moving_average_into does, for every
+    sample in a file, streaming the input through memory-mapped windows and
+    the output through a small buffer. For float64 files written as float64,
+    the results are identical to brahe_moving_average_into. Integer output
+    is rounded and saturated.
+    \param in_path name of the input file
+    \param in_type encoding of the input samples
+    \param distance number elements to average before and after each sample
+    \param out_path name of the output file, which is created or replaced; must not be the input file
+    \param out_type encoding of the output samples
+    \return <i>true</i> if successful, <i>false</i> if an argument is invalid or a file cannot be read or written; the output is then incomplete
+*/
+bool brahe_moving_average_file(const char * in_path, const brahe_sample_type_t in_type, const size_t distance,
+                               const char * out_path, const brahe_sample_type_t out_type);
+
+//! Simple real-to-real fft of a section of a file
+/*!
+    Computes what brahe_simple_fft_into does for <i>n</i> samples of a file.
+    The section is mapped as a whole, so it must fit in the address space;
+    a spectrum of a larger file can be built from the spectra of sections.
+    \param path name of the file
+    \param type encoding of the samples
+    \param first number of the first sample of the section
+    \param n number of samples in the section, at least 2
+    \param out receives half the padded length of magnitudes
+    \param work brahe_simple_fft_work_size(<i>n</i>) doubles of scratch space
+    \return <i>true</i> if successful, <i>false</i> if an argument is invalid, the file cannot be read, or it holds fewer samples than requested
+*/
+bool brahe_simple_fft_file(const char * path, const brahe_sample_type_t type, const uint64_t first, const size_t n,
+                           double * out, double * work);
+
+//-----------------------------------------------------------------------------
+// Trigonometry
+//-----------------------------------------------------------------------------
+//! Hyperbolic arcsine
+/*!
+    Calculates sinh<sup>-1</sup>, accurately near zero and without overflow
+    for large values.
+    \param x a value
+    \return inverse hyperbolic sine of <i>x</i>
+*/
+double brahe_asinh(const double x);
+
+//! Hyperbolic arccosine
+/*!
+    Calculates cosh<sup>-1</sup>, accurately near one and without overflow
+    for large values.
+    \param x a value
+    \return inverse hyperbolic cosine of <i>x</i>; NAN if <i>x</i> is less than 1
+*/
+double brahe_acosh(const double x);
+
+//! Hyperbolic arctangent
+/*!
+    Calculates tanh<sup>-1</sup>, accurately near zero.
+    \param x a value
+    \return inverse hyperbolic tangent of <i>x</i>; NAN if |<i>x</i>| is greater than 1
+*/
+double brahe_atanh(const double x);
+
+//! Hyperbolic arcsine of an array
+/*!
+    Calculates sinh<sup>-1</sup> of each element, with SIMD instructions
+    where available. Results are within 2 ULP of the exact value.
+    \param in values
+    \param out array that receives the results; may be the same as <i>in</i>
+    \param n number of elements in <i>in</i> and <i>out</i>
+    \return true if successful, false if an argument is invalid
+*/
+bool brahe_asinh_v(const double * in, double * out, const size_t n);
+
+//! Hyperbolic arccosine of an array
+/*!
+    Calculates cosh<sup>-1</sup> of each element, with SIMD instructions
+    where available. Results are within 2.5 ULP of the exact value; elements
+    less than 1 give NAN.
+    \param in values
+    \param out array that receives the results; may be the same as <i>in</i>
+    \param n number of elements in <i>in</i> and <i>out</i>
+    \return true if successful, false if an argument is invalid
+*/
+bool brahe_acosh_v(const double * in, double * out, const size_t n);
+
+//! Hyperbolic arctangent of an array
+/*!
+    Calculates tanh<sup>-1</sup> of each element, with SIMD instructions
+    where available. Results are within 2 ULP of the exact value; elements
+    outside [-1,1] give NAN.
+    \param in values
+    \param out array that receives the results; may be the same as <i>in</i>
+    \param n number of elements in <i>in</i> and <i>out</i>
+    \return true if successful, false if an argument is invalid
+*/
+bool brahe_atanh_v(const double * in, double * out, const size_t n);
+
+//! Hyperbolic arcsine of an array of floats
+/*!
+    Single-precision version of brahe_asinh_v, four lanes at a time with
+    SSE2. Results are within 2 ULP of the exact value.
+    \param in values
+    \param out array that receives the results; may be the same as <i>in</i>
+    \param n number of elements in <i>in</i> and <i>out</i>
+    \return true if successful, false if an argument is invalid
+*/
+bool brahe_asinh_v_f(const float * in, float * out, const size_t n);
+
+//! Hyperbolic arccosine of an array of floats
+/*!
+    Single-precision version of brahe_acosh_v. Results are within 2 ULP of
+    the exact value; elements less than 1 give NAN.
+    \param in values
+    \param out array that receives the results; may be the same as <i>in</i>
+    \param n number of elements in <i>in</i> and <i>out</i>
+    \return true if successful, false if an argument is invalid
+*/
+bool brahe_acosh_v_f(const float * in, float * out, const size_t n);
+
+//! Hyperbolic arctangent of an array of floats
+/*!
+    Single-precision version of brahe_atanh_v. Results are within 2 ULP of
+    the exact value; elements outside [-1,1] give NAN.
+    \param in values
+    \param out array that receives the results; may be the same as <i>in</i>
+    \param n number of elements in <i>in</i> and <i>out</i>
+    \return true if successful, false if an argument is invalid
+*/
+bool brahe_atanh_v_f(const float * in, float * out, const size_t n);
+
+//-----------------------------------------------------------------------------
+// Processor dispatch
+//-----------------------------------------------------------------------------
+
+//! Instruction sets the library can use, in increasing order of capability
+typedef enum
+{
+    //! portable C
+    BRAHE_ISA_SCALAR,
+    //! x86 SSE2
+    BRAHE_ISA_SSE2,
+    //! x86 AVX2 with FMA
+    BRAHE_ISA_AVX2,
+    //! x86 AVX-512 Foundation
+    BRAHE_ISA_AVX512,
+    //! ARM NEON
+    BRAHE_ISA_NEON
+}
+brahe_isa_t;
+
+//! Best instruction set the processor and operating system support
+/*!
+    \return the detected instruction set
+*/
+brahe_isa_t brahe_isa_detected(void);
+
+//! Instruction set the library is using
+/*!
+    The detected instruction set, unless the environment variable BRAHE_ISA
+    names a lesser one (scalar, sse2, avx2, avx512 or neon). Requests beyond
+    what the processor supports are ignored. Fixed on first use.
+    \return the active instruction set
+*/
+brahe_isa_t brahe_isa_active(void);
+
+//! Name of an instruction set
+/*!
+    \param isa an instruction set
+    \return its name, as used by BRAHE_ISA; "unknown" for an invalid value
+*/
+const char * brahe_isa_name(const brahe_isa_t isa);
+
+//! Describe one of the library's dispatched kernels
+/*!
+    Kernels are the inner loops that have variants for several instruction
+    sets; each is bound to the best variant allowed by the active
+    instruction set. Enumerate them by calling with increasing
+    <i>index</i> until this returns false.
+    \param index kernel number, from 0
+    \param name receives the kernel's name; may be NULL
+    \param isa receives the instruction set of its bound variant; may be NULL
+    \return true if <i>index</i> names a kernel
+*/
+bool brahe_kernel_info(const size_t index, const char ** name, brahe_isa_t * isa);
+
+//-----------------------------------------------------------------------------
+// Instrumentation
+//-----------------------------------------------------------------------------
+
+//! Activity of one of the library's functions
+/*!
+    Counts for one function, or one family of functions such as the
+    quantile functions, since the library was loaded or the metrics were
+    last reset. A function called by another measured function, on the same
+    thread, is counted as part of its caller; work the library spreads over
+    its own threads is counted once, by the call that started it.
+*/
+typedef struct
+{
+    //! function name, without the brahe_ prefix; "other" counts allocations outside measured functions
+    const char * name;
+    //! number of calls that did work; calls rejecting their arguments are not counted
+    uint64_t calls;
+    //! number of values processed
+    uint64_t elements;
+    //! bytes allocated through the installed allocator
+    uint64_t bytes_allocated;
+    //! wall-clock time spent in the calls, in nanoseconds
+    uint64_t nanoseconds;
+}
+brahe_metric_t;
+
+//! Whether the library was built with instrumentation
+/*!
+    Metrics are only gathered by a library configured with
+    --enable-instrumentation (or compiled with BRAHE_INSTRUMENT defined),
+    which also provides USDT probes in the libbrahe provider: prng_init
+    (algorithm, seed), fft_execute (length, padded length, element size)
+    and statistics (length, element size). Otherwise the library carries
+    no instrumentation at all.
+    \return true if metrics are being gathered
+*/
+bool brahe_metrics_enabled(void);
+
+//! Take a snapshot of the library's metrics
+/*!
+    Sums the counters of every thread that has used the library, including
+    threads that have since exited. Safe to call while other threads use the
+    library; their latest updates may or may not be included.
+    \param metrics array that receives the metrics; may be NULL if <i>n</i> is 0
+    \param n number of elements in <i>metrics</i>
+    \return number of metrics available, which may exceed <i>n</i>; 0 if the library is not instrumented
+*/
+size_t brahe_metrics_snapshot(brahe_metric_t * metrics, const size_t n);
+
+//! Reset the library's metrics
+/*!
+    Later snapshots count from this moment.
+*/
+void brahe_metrics_reset(void);
 
 //-----------------------------------------------------------------------------
 // Constants
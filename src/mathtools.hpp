@@ -0,0 +1,270 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+#if !defined(LIBBRAHE_MATHTOOLS_HPP)
+#define LIBBRAHE_MATHTOOLS_HPP
+
+/*
+    C++20 interface to the array functions in mathtools.h, for double and,
+    where the library has them, float. Inputs are any contiguous range
+    (std::span, std::vector, std::array or a built-in array) and are read
+    in place; outputs are spans the caller owns, so nothing is copied or
+    allocated. Lengths are size_t throughout. Each call goes straight to
+    the C function for its element type, and so to the same dispatched
+    SIMD kernels.
+
+    Functions return false, or NAN, for the conditions the C functions
+    reject, and also when an output span is shorter than required.
+*/
+
+#include "mathtools.h"
+
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <type_traits>
+
+namespace brahe
+{
+    //! Element types with array kernels
+    template <typename T>
+    concept real = std::same_as<T, double> || std::same_as<T, float>;
+
+    //! A contiguous, sized range of a real type, such as std::vector<double>
+    template <typename R>
+    concept real_range = std::ranges::contiguous_range<R>
+                      && std::ranges::sized_range<R>
+                      && real<std::remove_cv_t<std::ranges::range_value_t<R>>>;
+
+    //! A real_range whose elements can be modified
+    template <typename R>
+    concept mutable_real_range = real_range<R>
+                              && !std::is_const_v<std::remove_reference_t<std::ranges::range_reference_t<R>>>;
+
+    //! The element type of a real_range
+    template <real_range R>
+    using real_t = std::remove_cv_t<std::ranges::range_value_t<R>>;
+
+    namespace detail
+    {
+        // the C entry points for each element type
+        template <typename T>
+        struct kernels;
+
+        template <>
+        struct kernels<double>
+        {
+            static brahe_statistics statistics(const double * data, std::size_t n) { return brahe_get_statistics(data, n); }
+            static double quantile(double * data, std::size_t n, double q) { return brahe_quantile(data, n, q); }
+            static bool quantiles(double * data, std::size_t n, const double * q, std::size_t m, double * result) { return brahe_quantiles(data, n, q, m, result); }
+            static bool moving_average(const double * data, std::size_t n, std::size_t distance, double * result) { return brahe_moving_average_into(data, n, distance, result); }
+            static std::size_t fft_work_size(std::size_t n) { return brahe_simple_fft_work_size(n); }
+            static bool fft(const double * data, std::size_t n, double * out, double * work) { return brahe_simple_fft_into(data, n, out, work); }
+            static bool round_nearest(const double * in, double * out, std::size_t n) { return brahe_round_nearest_v(in, out, n); }
+            static bool sigdig(const double * in, double * out, std::size_t n, std::uint16_t digits) { return brahe_sigdig_v(in, out, n, digits); }
+            static bool asinh(const double * in, double * out, std::size_t n) { return brahe_asinh_v(in, out, n); }
+            static bool acosh(const double * in, double * out, std::size_t n) { return brahe_acosh_v(in, out, n); }
+            static bool atanh(const double * in, double * out, std::size_t n) { return brahe_atanh_v(in, out, n); }
+        };
+
+        // single precision has no selection, rounding or sigdig functions
+        template <>
+        struct kernels<float>
+        {
+            static brahe_statistics statistics(const float * data, std::size_t n) { return brahe_get_statistics_f(data, n); }
+            static bool moving_average(const float * data, std::size_t n, std::size_t distance, float * result) { return brahe_moving_average_into_f(data, n, distance, result); }
+            static std::size_t fft_work_size(std::size_t n) { return brahe_simple_fft_work_size(n); }
+            static bool fft(const float * data, std::size_t n, float * out, float * work) { return brahe_simple_fft_into_f(data, n, out, work); }
+            static bool asinh(const float * in, float * out, std::size_t n) { return brahe_asinh_v_f(in, out, n); }
+            static bool acosh(const float * in, float * out, std::size_t n) { return brahe_acosh_v_f(in, out, n); }
+            static bool atanh(const float * in, float * out, std::size_t n) { return brahe_atanh_v_f(in, out, n); }
+        };
+
+        template <real_range R>
+        inline std::span<const real_t<R>> view(const R & r) noexcept
+        {
+            return std::span<const real_t<R>>(std::ranges::data(r), std::ranges::size(r));
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    // Statistics
+    //-------------------------------------------------------------------------
+
+    //! Statistics for a range; see brahe_get_statistics
+    template <real_range R>
+    inline brahe_statistics get_statistics(const R & data)
+    {
+        const auto in = detail::view(data);
+        return detail::kernels<real_t<R>>::statistics(in.data(), in.size());
+    }
+
+    //! Quantile by selection, reordering <i>data</i>; see brahe_quantile
+    template <mutable_real_range R>
+    inline double quantile(R && data, const double q)
+    {
+        return detail::kernels<real_t<R>>::quantile(std::ranges::data(data), std::ranges::size(data), q);
+    }
+
+    //! Median by selection, reordering <i>data</i>; see brahe_median
+    template <mutable_real_range R>
+    inline double median(R && data)
+    {
+        return quantile(data, 0.5);
+    }
+
+    //! Several quantiles by selection, reordering <i>data</i>; see brahe_quantiles
+    template <mutable_real_range R>
+    inline bool quantiles(R && data, std::span<const double> q, std::span<double> result)
+    {
+        if (result.size() < q.size())
+            return false;
+
+        return detail::kernels<real_t<R>>::quantiles(std::ranges::data(data), std::ranges::size(data), q.data(), q.size(), result.data());
+    }
+
+    //! Moving average into <i>result</i>, which must not overlap <i>data</i>; see brahe_moving_average_into
+    template <real_range R>
+    inline bool moving_average(const R & data, const std::size_t distance, std::span<real_t<R>> result)
+    {
+        const auto in = detail::view(data);
+
+        if (result.size() < in.size())
+            return false;
+
+        return detail::kernels<real_t<R>>::moving_average(in.data(), in.size(), distance, result.data());
+    }
+
+    //-------------------------------------------------------------------------
+    // Digital Signal Processing
+    //-------------------------------------------------------------------------
+
+    //! Number of magnitudes simple_fft produces for <i>n</i> inputs; 0 if <i>n</i> is too small or too large
+    constexpr std::size_t simple_fft_size(const std::size_t n) noexcept
+    {
+        if ((n < 2) || (n > (std::numeric_limits<std::size_t>::max() / 2 + 1)))
+            return 0;
+
+        return std::bit_ceil(n) / 2;
+    }
+
+    //! Number of work elements simple_fft needs for <i>n</i> inputs; see brahe_simple_fft_work_size
+    template <real T>
+    inline std::size_t simple_fft_work_size(const std::size_t n)
+    {
+        return detail::kernels<T>::fft_work_size(n);
+    }
+
+    //! FFT magnitudes into <i>out</i>, of at least simple_fft_size elements, using <i>work</i>; see brahe_simple_fft_into
+    template <real_range R>
+    inline bool simple_fft(const R & data, std::span<real_t<R>> out, std::span<real_t<R>> work)
+    {
+        using T = real_t<R>;
+        const auto in = detail::view(data);
+        const std::size_t size = simple_fft_size(in.size());
+
+        if ((size == 0) || (out.size() < size) || (work.size() < simple_fft_work_size<T>(in.size())))
+            return false;
+
+        return detail::kernels<T>::fft(in.data(), in.size(), out.data(), work.data());
+    }
+
+    //-------------------------------------------------------------------------
+    // Elementwise functions; <i>out</i> may be the same memory as <i>in</i>
+    //-------------------------------------------------------------------------
+
+    //! Round to nearest; see brahe_round_nearest_v
+    template <real_range R>
+    inline bool round_nearest(const R & in, std::span<real_t<R>> out)
+    {
+        const auto v = detail::view(in);
+        return (out.size() >= v.size()) && detail::kernels<real_t<R>>::round_nearest(v.data(), out.data(), v.size());
+    }
+
+    //! Round to significant digits; see brahe_sigdig_v
+    template <real_range R>
+    inline bool sigdig(const R & in, std::span<real_t<R>> out, const std::uint16_t digits)
+    {
+        const auto v = detail::view(in);
+        return (out.size() >= v.size()) && detail::kernels<real_t<R>>::sigdig(v.data(), out.data(), v.size(), digits);
+    }
+
+    //! Hyperbolic arcsine; see brahe_asinh_v
+    template <real_range R>
+    inline bool asinh(const R & in, std::span<real_t<R>> out)
+    {
+        const auto v = detail::view(in);
+        return (out.size() >= v.size()) && detail::kernels<real_t<R>>::asinh(v.data(), out.data(), v.size());
+    }
+
+    //! Hyperbolic arccosine; see brahe_acosh_v
+    template <real_range R>
+    inline bool acosh(const R & in, std::span<real_t<R>> out)
+    {
+        const auto v = detail::view(in);
+        return (out.size() >= v.size()) && detail::kernels<real_t<R>>::acosh(v.data(), out.data(), v.size());
+    }
+
+    //! Hyperbolic arctangent; see brahe_atanh_v
+    template <real_range R>
+    inline bool atanh(const R & in, std::span<real_t<R>> out)
+    {
+        const auto v = detail::view(in);
+        return (out.size() >= v.size()) && detail::kernels<real_t<R>>::atanh(v.data(), out.data(), v.size());
+    }
+}
+
+#endif
@@ -0,0 +1,115 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+#include "internal.h"
+
+/*
+    The default allocator is malloc, or the aligned allocator when more
+    than malloc's alignment is asked for. On POSIX systems both release
+    with free(), so arrays from the library can still be freed directly;
+    Windows needs _aligned_malloc throughout, and brahe_free.
+*/
+
+static void * default_alloc(const size_t size, const size_t alignment, void * context)
+{
+    (void)context;
+
+#if defined(_MSC_VER)
+    return brahe_aligned_malloc(size, (alignment < BRAHE_DEFAULT_ALIGN) ? BRAHE_DEFAULT_ALIGN : alignment);
+#else
+    if (alignment <= BRAHE_DEFAULT_ALIGN)
+        return malloc(size);
+
+    return brahe_aligned_malloc(size, alignment);
+#endif
+}
+
+static void default_free(void * p, void * context)
+{
+    (void)context;
+
+    brahe_aligned_free(p);
+}
+
+static brahe_allocator_t allocator = { default_alloc, default_free, NULL };
+
+bool brahe_set_allocator(const brahe_allocator_t * a)
+{
+    if (a == NULL)
+    {
+        allocator.alloc = default_alloc;
+        allocator.free = default_free;
+        allocator.context = NULL;
+        return true;
+    }
+
+    if ((a->alloc == NULL) || (a->free == NULL))
+        return false;
+
+    allocator = *a;
+    return true;
+}
+
+brahe_allocator_t brahe_get_allocator(void)
+{
+    return allocator;
+}
+
+const brahe_allocator_t * brahe_allocator(void)
+{
+    return &allocator;
+}
+
+void brahe_free(void * p)
+{
+    brahe_release(&allocator, p);
+}
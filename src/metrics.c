@@ -0,0 +1,348 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+#include "internal.h"
+
+#if defined(BRAHE_INSTRUMENT)
+
+#include <string.h>
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+static const char * const metric_names[BRAHE_METRIC_COUNT] =
+{
+    "prng_init",
+    "get_statistics",
+    "get_statistics_f",
+    "get_statistics_file",
+    "quantile",
+    "moving_average",
+    "moving_average_f",
+    "moving_average_file",
+    "simple_fft",
+    "simple_fft_f",
+    "make_sinusoid",
+    "make_sinusoid_f",
+    "add_noise",
+    "add_noise_f",
+    "inverse_hyperbolic_v",
+    "inverse_hyperbolic_v_f",
+    "other"
+};
+
+typedef struct
+{
+    uint64_t m_calls;
+    uint64_t m_elements;
+    uint64_t m_bytes;
+    uint64_t m_nanoseconds;
+}
+metric_counts_t;
+
+// the counters of one thread
+typedef struct metric_thread_s
+{
+    metric_counts_t m_counts[BRAHE_METRIC_COUNT];
+
+    // nesting of measured calls, and the outermost one
+    unsigned int      m_depth;
+    brahe_metric_id_t m_id;
+    bool              m_timed;
+    uint64_t          m_start;
+
+    // false once the owning thread has exited; the block, with its counts,
+    // is then handed to the next new thread
+    bool m_live;
+
+    struct metric_thread_s * m_next;
+}
+metric_thread_t;
+
+/*
+    Only the owning thread writes its counters, so an update needs no
+    read-modify-write instruction; relaxed atomic loads and stores just keep
+    a concurrent snapshot from seeing a torn value.
+*/
+#if defined(__GNUC__)
+#define COUNTER_LOAD(p)    __atomic_load_n((p), __ATOMIC_RELAXED)
+#define COUNTER_ADD(p, x)  __atomic_store_n((p), __atomic_load_n((p), __ATOMIC_RELAXED) + (x), __ATOMIC_RELAXED)
+#else
+#define COUNTER_LOAD(p)    (*(volatile uint64_t *)(p))
+#define COUNTER_ADD(p, x)  (*(volatile uint64_t *)(p) += (x))
+#endif
+
+// every thread's counters, and the totals at the last reset
+static metric_thread_t * registry = NULL;
+static metric_counts_t baseline[BRAHE_METRIC_COUNT];
+
+#if defined(BRAHE_HAVE_PTHREADS)
+
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t exit_key;
+static __thread metric_thread_t * self = NULL;
+
+#define REGISTRY_LOCK()   pthread_mutex_lock(&registry_lock)
+#define REGISTRY_UNLOCK() pthread_mutex_unlock(&registry_lock)
+
+static void thread_exit(void * arg)
+{
+    REGISTRY_LOCK();
+    ((metric_thread_t *)arg)->m_live = false;
+    REGISTRY_UNLOCK();
+}
+
+static void create_key(void)
+{
+    pthread_key_create(&exit_key, thread_exit);
+}
+
+static metric_thread_t * this_thread(void)
+{
+    metric_thread_t * t = self;
+
+    if (t != NULL)
+        return t;
+
+    pthread_once(&key_once, create_key);
+    REGISTRY_LOCK();
+
+    for (t = registry; (t != NULL) && t->m_live; t = t->m_next)
+        ;
+
+    // not from the installed allocator, which is one of the things measured
+    if (t == NULL)
+    {
+        t = (metric_thread_t *)calloc(1, sizeof(metric_thread_t));
+
+        if (t != NULL)
+        {
+            t->m_next = registry;
+            registry = t;
+        }
+    }
+
+    if (t != NULL)
+        t->m_live = true;
+
+    REGISTRY_UNLOCK();
+
+    if (t != NULL)
+    {
+        pthread_setspecific(exit_key, t);
+        self = t;
+    }
+
+    return t;
+}
+
+#else
+
+// without thread support, one set of counters serves every caller
+static metric_thread_t only;
+
+#define REGISTRY_LOCK()   ((void)0)
+#define REGISTRY_UNLOCK() ((void)0)
+
+static metric_thread_t * this_thread(void)
+{
+    registry = &only;
+    return &only;
+}
+
+#endif
+
+// monotonic time, in nanoseconds
+static uint64_t now(void)
+{
+#if defined(_MSC_VER)
+    LARGE_INTEGER count, frequency;
+
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&frequency);
+    return (uint64_t)((double)count.QuadPart * (1.0e9 / (double)frequency.QuadPart));
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+void brahe_metric_begin(const brahe_metric_id_t id, const uint64_t elements)
+{
+    metric_thread_t * t = this_thread();
+
+    if ((t != NULL) && (t->m_depth++ == 0))
+    {
+        COUNTER_ADD(&t->m_counts[id].m_calls, 1);
+        COUNTER_ADD(&t->m_counts[id].m_elements, elements);
+        t->m_id = id;
+        t->m_timed = true;
+        t->m_start = now();
+    }
+}
+
+void brahe_metric_join(const brahe_metric_id_t id)
+{
+    metric_thread_t * t = this_thread();
+
+    if ((t != NULL) && (t->m_depth++ == 0))
+    {
+        t->m_id = id;
+        t->m_timed = false;
+    }
+}
+
+void brahe_metric_end(void)
+{
+    metric_thread_t * t = this_thread();
+
+    // a thread whose counters could not be allocated at the start of the
+    // call may have them by its end
+    if ((t == NULL) || (t->m_depth == 0))
+        return;
+
+    if ((--t->m_depth == 0) && t->m_timed)
+        COUNTER_ADD(&t->m_counts[t->m_id].m_nanoseconds, now() - t->m_start);
+}
+
+void brahe_metric_allocated(const size_t bytes)
+{
+    metric_thread_t * t = this_thread();
+
+    if (t != NULL)
+        COUNTER_ADD(&t->m_counts[(t->m_depth > 0) ? t->m_id : BRAHE_METRIC_OTHER].m_bytes, bytes);
+}
+
+// sum of every thread's counters; the registry must be locked
+static void sum_counts(metric_counts_t * totals)
+{
+    const metric_thread_t * t;
+    size_t i;
+
+    memset(totals, 0, sizeof(metric_counts_t) * BRAHE_METRIC_COUNT);
+
+    for (t = registry; t != NULL; t = t->m_next)
+    {
+        for (i = 0; i < BRAHE_METRIC_COUNT; ++i)
+        {
+            totals[i].m_calls       += COUNTER_LOAD(&t->m_counts[i].m_calls);
+            totals[i].m_elements    += COUNTER_LOAD(&t->m_counts[i].m_elements);
+            totals[i].m_bytes       += COUNTER_LOAD(&t->m_counts[i].m_bytes);
+            totals[i].m_nanoseconds += COUNTER_LOAD(&t->m_counts[i].m_nanoseconds);
+        }
+    }
+}
+
+bool brahe_metrics_enabled(void)
+{
+    return true;
+}
+
+size_t brahe_metrics_snapshot(brahe_metric_t * metrics, const size_t n)
+{
+    metric_counts_t totals[BRAHE_METRIC_COUNT];
+    size_t i;
+
+    if ((metrics == NULL) || (n == 0))
+        return BRAHE_METRIC_COUNT;
+
+    REGISTRY_LOCK();
+    sum_counts(totals);
+
+    for (i = 0; (i < n) && (i < BRAHE_METRIC_COUNT); ++i)
+    {
+        metrics[i].name            = metric_names[i];
+        metrics[i].calls           = totals[i].m_calls - baseline[i].m_calls;
+        metrics[i].elements        = totals[i].m_elements - baseline[i].m_elements;
+        metrics[i].bytes_allocated = totals[i].m_bytes - baseline[i].m_bytes;
+        metrics[i].nanoseconds     = totals[i].m_nanoseconds - baseline[i].m_nanoseconds;
+    }
+
+    REGISTRY_UNLOCK();
+    return BRAHE_METRIC_COUNT;
+}
+
+void brahe_metrics_reset(void)
+{
+    // counters are only ever written by their own threads; a reset moves
+    // the point snapshots count from instead
+    REGISTRY_LOCK();
+    sum_counts(baseline);
+    REGISTRY_UNLOCK();
+}
+
+#else
+
+bool brahe_metrics_enabled(void)
+{
+    return false;
+}
+
+size_t brahe_metrics_snapshot(brahe_metric_t * metrics, const size_t n)
+{
+    (void)metrics;
+    (void)n;
+
+    return 0;
+}
+
+void brahe_metrics_reset(void)
+{
+}
+
+#endif
@@ -0,0 +1,142 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+#if !defined(LIBBRAHE_METRICS_H)
+#define LIBBRAHE_METRICS_H
+
+/*
+    Instrumentation. Building with BRAHE_INSTRUMENT defined (configure
+    --enable-instrumentation) counts the calls, elements, allocated bytes
+    and elapsed time of the library's main functions, and adds USDT probes
+    that perf, bpftrace and SystemTap can attach to. Without it the macros
+    below expand to nothing and the metrics functions report no metrics.
+
+    Counters live in a block owned by each thread, written only by that
+    thread, and are summed when a snapshot is taken. A function called by
+    another measured function, on the same thread, is part of its caller:
+    only the outermost call is counted and timed, and memory allocated
+    anywhere within it is charged to it.
+
+    This header is included by internal.h.
+*/
+
+//! Measured functions, as indices into the snapshot
+typedef enum
+{
+    BRAHE_METRIC_PRNG_INIT,
+    BRAHE_METRIC_GET_STATISTICS,
+    BRAHE_METRIC_GET_STATISTICS_F,
+    BRAHE_METRIC_GET_STATISTICS_FILE,
+    BRAHE_METRIC_QUANTILE,
+    BRAHE_METRIC_MOVING_AVERAGE,
+    BRAHE_METRIC_MOVING_AVERAGE_F,
+    BRAHE_METRIC_MOVING_AVERAGE_FILE,
+    BRAHE_METRIC_SIMPLE_FFT,
+    BRAHE_METRIC_SIMPLE_FFT_F,
+    BRAHE_METRIC_MAKE_SINUSOID,
+    BRAHE_METRIC_MAKE_SINUSOID_F,
+    BRAHE_METRIC_ADD_NOISE,
+    BRAHE_METRIC_ADD_NOISE_F,
+    BRAHE_METRIC_INVERSE_HYPERBOLIC,
+    BRAHE_METRIC_INVERSE_HYPERBOLIC_F,
+    // allocations made outside any measured function
+    BRAHE_METRIC_OTHER,
+    BRAHE_METRIC_COUNT
+}
+brahe_metric_id_t;
+
+#if defined(BRAHE_INSTRUMENT)
+
+// enter a measured function, processing <i>elements</i> values
+void brahe_metric_begin(const brahe_metric_id_t id, const uint64_t elements);
+
+// enter a measured function's work on another thread; it was already
+// counted, and timed, by the call that handed the work over
+void brahe_metric_join(const brahe_metric_id_t id);
+
+// leave a function entered with brahe_metric_begin or brahe_metric_join
+void brahe_metric_end(void);
+
+// charge an allocation to the current function
+void brahe_metric_allocated(const size_t bytes);
+
+#define BRAHE_METRIC_BEGIN(id, elements) brahe_metric_begin((id), (uint64_t)(elements))
+#define BRAHE_METRIC_JOIN(id)            brahe_metric_join(id)
+#define BRAHE_METRIC_END()               brahe_metric_end()
+#define BRAHE_METRIC_ALLOCATED(bytes)    brahe_metric_allocated(bytes)
+
+// USDT probes, in the libbrahe provider
+#if defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define BRAHE_HAVE_SDT
+#endif
+#endif
+
+#else
+
+#define BRAHE_METRIC_BEGIN(id, elements) ((void)0)
+#define BRAHE_METRIC_JOIN(id)            ((void)0)
+#define BRAHE_METRIC_END()               ((void)0)
+#define BRAHE_METRIC_ALLOCATED(bytes)    ((void)0)
+
+#endif
+
+#if defined(BRAHE_HAVE_SDT)
+#define BRAHE_PROBE2(name, a, b)    DTRACE_PROBE2(libbrahe, name, a, b)
+#define BRAHE_PROBE3(name, a, b, c) DTRACE_PROBE3(libbrahe, name, a, b, c)
+#else
+#define BRAHE_PROBE2(name, a, b)    ((void)0)
+#define BRAHE_PROBE3(name, a, b, c) ((void)0)
+#endif
+
+#endif
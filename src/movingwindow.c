@@ -0,0 +1,254 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+#include "mathtools.h"
+#include "internal.h"
+#include <stdlib.h>
+
+/*
+    Trailing-window statistics. The last m_capacity samples live in a ring
+    buffer; mean and variance are updated incrementally as samples enter
+    and leave, and are recomputed from the ring each time it wraps so that
+    rounding error cannot accumulate without bound. Minimum and maximum come
+    from monotonic deques of sample numbers, which give amortized O(1)
+    updates: each sample is pushed and popped at most once.
+*/
+
+// index into a deque stored as a ring of capacity elements
+#define DEQUE_AT(w, head, k) (((head) + (k)) % (w)->m_capacity)
+
+// value of a sample by its sequence number; valid while the sample is in the window
+#define SAMPLE(w, seq) ((w)->m_ring[(size_t)((seq) % (w)->m_capacity)])
+
+bool brahe_moving_window_init(brahe_moving_window_t * window, const size_t length)
+{
+    bool result = false;
+
+    if ((window != NULL) && (length > 0))
+    {
+        // one block holds the ring and both deques
+        window->m_allocator = *brahe_allocator();
+        window->m_ring = (double *)brahe_allocate(&window->m_allocator, length * (sizeof(double) + 2 * sizeof(uint64_t)), BRAHE_DEFAULT_ALIGN);
+
+        if (window->m_ring != NULL)
+        {
+            window->m_capacity = length;
+            window->m_minq = (uint64_t *)(window->m_ring + length);
+            window->m_maxq = window->m_minq + length;
+            brahe_moving_window_reset(window);
+            result = true;
+        }
+    }
+
+    return result;
+}
+
+void brahe_moving_window_free(brahe_moving_window_t * window)
+{
+    if (window != NULL)
+    {
+        brahe_release(&window->m_allocator, window->m_ring);
+        window->m_ring = NULL;
+        window->m_minq = NULL;
+        window->m_maxq = NULL;
+        window->m_capacity = 0;
+        window->m_count = 0;
+    }
+}
+
+void brahe_moving_window_reset(brahe_moving_window_t * window)
+{
+    if (window != NULL)
+    {
+        window->m_count    = 0;
+        window->m_total    = 0;
+        window->m_mean     = 0.0;
+        window->m_m2       = 0.0;
+        window->m_min_head = 0;
+        window->m_min_size = 0;
+        window->m_max_head = 0;
+        window->m_max_size = 0;
+    }
+}
+
+// recompute mean and sum of squared deviations from the ring
+static void resync(brahe_moving_window_t * window)
+{
+    size_t i;
+    double mean = 0.0, m2 = 0.0;
+
+    for (i = 0; i < window->m_count; ++i)
+        mean += window->m_ring[i];
+
+    mean /= (double)window->m_count;
+
+    for (i = 0; i < window->m_count; ++i)
+    {
+        double diff = window->m_ring[i] - mean;
+        m2 += diff * diff;
+    }
+
+    window->m_mean = mean;
+    window->m_m2 = m2;
+}
+
+void brahe_moving_window_push(brahe_moving_window_t * window, const double x)
+{
+    uint64_t seq;
+    size_t slot;
+
+    if ((window == NULL) || (window->m_ring == NULL))
+        return;
+
+    seq  = window->m_total++;
+    slot = (size_t)(seq % window->m_capacity);
+
+    // mean and variance (Welford, with removal once the window is full)
+    if (window->m_count < window->m_capacity)
+    {
+        double delta = x - window->m_mean;
+        ++window->m_count;
+        window->m_mean += delta / (double)window->m_count;
+        window->m_m2 += delta * (x - window->m_mean);
+    }
+    else
+    {
+        double old  = window->m_ring[slot];
+        double mean = window->m_mean + (x - old) / (double)window->m_count;
+        window->m_m2 += (x - old) * ((x - mean) + (old - window->m_mean));
+        window->m_mean = mean;
+
+        if (window->m_m2 < 0.0)
+            window->m_m2 = 0.0;
+    }
+
+    window->m_ring[slot] = x;
+
+    // the ring just wrapped; discard accumulated rounding error
+    if ((slot == window->m_capacity - 1) && (window->m_count == window->m_capacity))
+        resync(window);
+
+    // drop samples that have left the window from the front of each deque
+    if (seq >= window->m_capacity)
+    {
+        uint64_t oldest = seq - window->m_capacity + 1;
+
+        if ((window->m_min_size > 0) && (window->m_minq[window->m_min_head] < oldest))
+        {
+            window->m_min_head = DEQUE_AT(window, window->m_min_head, 1);
+            --window->m_min_size;
+        }
+
+        if ((window->m_max_size > 0) && (window->m_maxq[window->m_max_head] < oldest))
+        {
+            window->m_max_head = DEQUE_AT(window, window->m_max_head, 1);
+            --window->m_max_size;
+        }
+    }
+
+    // drop samples that can never again be the minimum or maximum from the back
+    while ((window->m_min_size > 0)
+       &&  (SAMPLE(window, window->m_minq[DEQUE_AT(window, window->m_min_head, window->m_min_size - 1)]) >= x))
+        --window->m_min_size;
+
+    window->m_minq[DEQUE_AT(window, window->m_min_head, window->m_min_size)] = seq;
+    ++window->m_min_size;
+
+    while ((window->m_max_size > 0)
+       &&  (SAMPLE(window, window->m_maxq[DEQUE_AT(window, window->m_max_head, window->m_max_size - 1)]) <= x))
+        --window->m_max_size;
+
+    window->m_maxq[DEQUE_AT(window, window->m_max_head, window->m_max_size)] = seq;
+    ++window->m_max_size;
+}
+
+void brahe_moving_window_push_n(brahe_moving_window_t * window, const double * data, const size_t n)
+{
+    size_t i;
+
+    if (data != NULL)
+    {
+        for (i = 0; i < n; ++i)
+            brahe_moving_window_push(window, data[i]);
+    }
+}
+
+size_t brahe_moving_window_count(const brahe_moving_window_t * window)
+{
+    return (window != NULL) ? window->m_count : 0;
+}
+
+brahe_statistics brahe_moving_window_statistics(const brahe_moving_window_t * window)
+{
+    brahe_statistics stats;
+
+    stats.min = 0.0;
+    stats.max = 0.0;
+    stats.mean = 0.0;
+    stats.variance = 0.0;
+    stats.sigma = 0.0;
+
+    if ((window != NULL) && (window->m_count > 0))
+    {
+        stats.min  = SAMPLE(window, window->m_minq[window->m_min_head]);
+        stats.max  = SAMPLE(window, window->m_maxq[window->m_max_head]);
+        stats.mean = window->m_mean;
+
+        if (window->m_count > 1)
+        {
+            stats.variance = window->m_m2 / (double)(window->m_count - 1);
+            stats.sigma = sqrt(stats.variance);
+        }
+    }
+
+    return stats;
+}
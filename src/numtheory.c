@@ -0,0 +1,483 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+#include "mathtools.h"
+#include "internal.h"
+
+/*
+    Modular arithmetic on 64-bit integers. General operations work for any
+    modulus; Montgomery contexts speed up repeated work modulo one odd
+    value, and Barrett contexts do the same for moduli below 2^32.
+*/
+
+// extended Euclid on signed values
+int64_t brahe_xgcd(const int64_t a, const int64_t b, int64_t * x, int64_t * y)
+{
+    int64_t old_r = a, r = b, old_s = 1, s = 0, old_t = 0, t = 1, q, temp;
+
+    while (r != 0)
+    {
+        // stop before the step that leaves no remainder; its quotient and
+        // coefficients are discarded, and overflow when a or b is INT64_MIN
+        if ((r == -1) || (old_r % r == 0))
+        {
+            old_r = r;
+            old_s = s;
+            old_t = t;
+            break;
+        }
+
+        q = old_r / r;
+
+        temp = old_r - q * r; old_r = r; r = temp;
+        temp = old_s - q * s; old_s = s; s = temp;
+        temp = old_t - q * t; old_t = t; t = temp;
+    }
+
+    // a divisor of 2^63 has no positive representation
+    if (old_r == INT64_MIN)
+    {
+        old_r = 0;
+        old_s = 0;
+        old_t = 0;
+    }
+
+    // make the divisor positive
+    if (old_r < 0)
+    {
+        old_r = -old_r;
+        old_s = -old_s;
+        old_t = -old_t;
+    }
+
+    if (x != NULL)
+        *x = old_s;
+
+    if (y != NULL)
+        *y = old_t;
+
+    return old_r;
+}
+
+// modular inverse, for any modulus
+bool brahe_modinv(const uint64_t a, const uint64_t m, uint64_t * inverse)
+{
+    // Euclid on (m, a); the coefficients of a alternate in sign and never
+    // exceed m in magnitude, so only magnitudes are kept
+    uint64_t old_r, r, old_s = 0, s = 1, q, temp;
+    bool negative = true;
+
+    if ((inverse == NULL) || (m < 2))
+        return false;
+
+    old_r = m;
+    r = a % m;
+
+    while (r != 0)
+    {
+        q = old_r / r;
+
+        temp = old_r - q * r; old_r = r; r = temp;
+        temp = old_s + q * s; old_s = s; s = temp;
+        negative = !negative;
+    }
+
+    // not coprime
+    if (old_r != 1)
+        return false;
+
+    *inverse = (negative && (old_s != 0)) ? m - old_s : old_s;
+    return true;
+}
+
+// a * b mod m, for any modulus
+uint64_t brahe_mulmod(const uint64_t a, const uint64_t b, const uint64_t m)
+{
+#if defined(__SIZEOF_INT128__)
+    if (m == 0)
+        return 0;
+
+    return (uint64_t)(((unsigned __int128)a * b) % m);
+#else
+    // shift and add, keeping every partial result below m
+    uint64_t x, y, result = 0;
+
+    if (m == 0)
+        return 0;
+
+    x = a % m;
+    y = b % m;
+
+    while (y != 0)
+    {
+        if (y & 1)
+            result = (result >= m - x) ? result - (m - x) : result + x;
+
+        x = (x >= m - x) ? x - (m - x) : x + x;
+        y >>= 1;
+    }
+
+    return result;
+#endif
+}
+
+// base^exponent mod m, for any modulus
+uint64_t brahe_powmod(const uint64_t base, uint64_t exponent, const uint64_t m)
+{
+    uint64_t result, b;
+
+    if (m < 2)
+        return 0;
+
+    // Montgomery arithmetic is much faster where it applies
+    if (m & 1)
+    {
+        brahe_montgomery_t ctx;
+        brahe_montgomery_init(&ctx, m);
+        return brahe_montgomery_from(&ctx, brahe_montgomery_pow(&ctx, brahe_montgomery_to(&ctx, base), exponent));
+    }
+
+    result = 1;
+    b = base % m;
+
+    while (exponent != 0)
+    {
+        if (exponent & 1)
+            result = brahe_mulmod(result, b, m);
+
+        b = brahe_mulmod(b, b, m);
+        exponent >>= 1;
+    }
+
+    return result;
+}
+
+/*
+    Montgomery multiplication represents a as aR mod m, with R = 2^64. A
+    product of two such values is reduced by REDC, which replaces division
+    by m with two multiplications and a shift.
+*/
+
+// (hi:lo) / R mod m, for hi:lo < mR
+BRAHE_INLINE uint64_t redc(const brahe_montgomery_t * ctx, const uint64_t hi, const uint64_t lo)
+{
+    uint64_t u = lo * ctx->m_ninv;
+    uint64_t uh, result;
+    bool carry;
+
+    // lo + low(u * m) is zero modulo 2^64, carrying one unless lo is zero
+    brahe_mul_wide(u, ctx->m_modulus, &uh);
+    result = hi + uh;
+    carry = (result < hi);
+
+    if (lo != 0)
+    {
+        ++result;
+        carry = carry || (result == 0);
+    }
+
+    if (carry || (result >= ctx->m_modulus))
+        result -= ctx->m_modulus;
+
+    return result;
+}
+
+bool brahe_montgomery_init(brahe_montgomery_t * ctx, const uint64_t m)
+{
+    uint64_t inv, r;
+    int i;
+
+    if ((ctx == NULL) || ((m & 1) == 0) || (m < 3))
+        return false;
+
+    // Newton's iteration doubles the correct low bits of m^-1 each time,
+    // starting from 3 (m * m = 1 mod 8 for odd m)
+    inv = m;
+
+    for (i = 0; i < 5; ++i)
+        inv *= 2 - m * inv;
+
+    ctx->m_modulus = m;
+    ctx->m_ninv = (uint64_t)0 - inv;
+
+    // R mod m and R^2 mod m
+    r = ((uint64_t)0 - m) % m;
+    ctx->m_one = r;
+    ctx->m_r2 = brahe_mulmod(r, r, m);
+
+    return true;
+}
+
+uint64_t brahe_montgomery_to(const brahe_montgomery_t * ctx, const uint64_t a)
+{
+    uint64_t hi, lo = brahe_mul_wide(a % ctx->m_modulus, ctx->m_r2, &hi);
+    return redc(ctx, hi, lo);
+}
+
+uint64_t brahe_montgomery_from(const brahe_montgomery_t * ctx, const uint64_t a)
+{
+    return redc(ctx, 0, a);
+}
+
+uint64_t brahe_montgomery_mul(const brahe_montgomery_t * ctx, const uint64_t a, const uint64_t b)
+{
+    uint64_t hi, lo = brahe_mul_wide(a, b, &hi);
+    return redc(ctx, hi, lo);
+}
+
+uint64_t brahe_montgomery_pow(const brahe_montgomery_t * ctx, const uint64_t a, uint64_t exponent)
+{
+    uint64_t result = ctx->m_one, b = a;
+
+    while (exponent != 0)
+    {
+        if (exponent & 1)
+            result = brahe_montgomery_mul(ctx, result, b);
+
+        b = brahe_montgomery_mul(ctx, b, b);
+        exponent >>= 1;
+    }
+
+    return result;
+}
+
+/*
+    Barrett reduction for moduli below 2^32: products fit in 64 bits, and
+    the quotient is estimated from the high half of the product with
+    floor(2^64 / m), which is never too large and at most one too small.
+*/
+
+bool brahe_barrett_init(brahe_barrett_t * ctx, const uint32_t m)
+{
+    if ((ctx == NULL) || (m < 2))
+        return false;
+
+    ctx->m_modulus = m;
+    ctx->m_mu = UINT64_MAX / m;
+
+    return true;
+}
+
+uint32_t brahe_barrett_reduce(const brahe_barrett_t * ctx, const uint64_t x)
+{
+    uint64_t q, r;
+
+    brahe_mul_wide(x, ctx->m_mu, &q);
+    r = x - q * ctx->m_modulus;
+
+    return (uint32_t)((r >= ctx->m_modulus) ? r - ctx->m_modulus : r);
+}
+
+uint32_t brahe_barrett_mul(const brahe_barrett_t * ctx, const uint32_t a, const uint32_t b)
+{
+    return brahe_barrett_reduce(ctx, (uint64_t)a * b);
+}
+
+/*
+    Miller-Rabin with the seven bases found by Jim Sinclair, which give no
+    false positives for any 64-bit value.
+*/
+
+static const uint64_t SMALL_PRIMES[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+
+static const uint64_t WITNESSES[] = { 2, 325, 9375, 28178, 450775, 9780504, 1795265022 };
+
+bool brahe_is_prime(const uint64_t n)
+{
+    size_t i;
+    int s, j;
+    uint64_t d, x, minus_one;
+    brahe_montgomery_t ctx;
+
+    if (n < 2)
+        return false;
+
+    for (i = 0; i < sizeof(SMALL_PRIMES) / sizeof(SMALL_PRIMES[0]); ++i)
+    {
+        if (n % SMALL_PRIMES[i] == 0)
+            return (n == SMALL_PRIMES[i]);
+    }
+
+    // anything left below 41 * 41 is prime
+    if (n < 1681)
+        return true;
+
+    s = brahe_ctz64(n - 1);
+    d = (n - 1) >> s;
+
+    brahe_montgomery_init(&ctx, n);
+    minus_one = n - ctx.m_one;
+
+    for (i = 0; i < sizeof(WITNESSES) / sizeof(WITNESSES[0]); ++i)
+    {
+        // a witness that is a multiple of n proves nothing
+        if (WITNESSES[i] % n == 0)
+            continue;
+
+        x = brahe_montgomery_pow(&ctx, brahe_montgomery_to(&ctx, WITNESSES[i]), d);
+
+        if ((x == ctx.m_one) || (x == minus_one))
+            continue;
+
+        for (j = 1; j < s; ++j)
+        {
+            x = brahe_montgomery_mul(&ctx, x, x);
+
+            if (x == minus_one)
+                break;
+        }
+
+        if (j == s)
+            return false;
+    }
+
+    return true;
+}
+
+// batch forms
+
+bool brahe_mulmod_array(const uint64_t * a, const uint64_t * b, const size_t n, const uint64_t m, uint64_t * result)
+{
+    size_t i;
+
+    if ((a == NULL) || (b == NULL) || (result == NULL) || (m == 0))
+        return false;
+
+    if ((m & 1) && (m > 1))
+    {
+        // one conversion in each direction: (aR)(b)/R = ab
+        brahe_montgomery_t ctx;
+        brahe_montgomery_init(&ctx, m);
+
+        for (i = 0; i < n; ++i)
+            result[i] = brahe_montgomery_mul(&ctx, brahe_montgomery_to(&ctx, a[i]), b[i] % m);
+    }
+    else
+    {
+        for (i = 0; i < n; ++i)
+            result[i] = brahe_mulmod(a[i], b[i], m);
+    }
+
+    return true;
+}
+
+bool brahe_powmod_array(const uint64_t * bases, const size_t n, const uint64_t exponent, const uint64_t m, uint64_t * result)
+{
+    size_t i;
+
+    if ((bases == NULL) || (result == NULL) || (m == 0))
+        return false;
+
+    if ((m & 1) && (m > 1))
+    {
+        // the context is set up once for the whole array
+        brahe_montgomery_t ctx;
+        brahe_montgomery_init(&ctx, m);
+
+        for (i = 0; i < n; ++i)
+            result[i] = brahe_montgomery_from(&ctx, brahe_montgomery_pow(&ctx, brahe_montgomery_to(&ctx, bases[i]), exponent));
+    }
+    else
+    {
+        for (i = 0; i < n; ++i)
+            result[i] = brahe_powmod(bases[i], exponent, m);
+    }
+
+    return true;
+}
+
+bool brahe_modinv_array(const uint64_t * values, const size_t n, const uint64_t m, uint64_t * result)
+{
+    size_t i;
+    uint64_t inv, t;
+
+    if ((values == NULL) || (result == NULL) || (m < 2))
+        return false;
+
+    if (n == 0)
+        return true;
+
+    // Montgomery's trick: invert the product of all values once, then
+    // peel off one inverse at a time; result holds the prefix products
+    result[0] = values[0] % m;
+
+    for (i = 1; i < n; ++i)
+        result[i] = brahe_mulmod(result[i - 1], values[i], m);
+
+    // the product is invertible only if every value is
+    if (!brahe_modinv(result[n - 1], m, &inv))
+        return false;
+
+    for (i = n - 1; i > 0; --i)
+    {
+        t = brahe_mulmod(inv, result[i - 1], m);
+        inv = brahe_mulmod(inv, values[i], m);
+        result[i] = t;
+    }
+
+    result[0] = inv;
+
+    return true;
+}
+
+bool brahe_is_prime_array(const uint64_t * values, const size_t n, bool * result)
+{
+    size_t i;
+
+    if ((values == NULL) || (result == NULL))
+        return false;
+
+    for (i = 0; i < n; ++i)
+        result[i] = brahe_is_prime(values[i]);
+
+    return true;
+}
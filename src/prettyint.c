@@ -51,240 +51,716 @@
 */
 
 #include "mathtools.h"
+#include "internal.h"
 #include <string.h>
-#include <stdio.h>
 #include <stdlib.h>
 
-/* strings used in text output */
+/*
+    Both formats write their output in a single pass into the caller's
+    buffer. Text is appended through a writer that keeps counting once the
+    buffer is full, so the return value is always the full length, as with
+    snprintf. Digits are produced two at a time from a table of pairs.
+    Magnitudes are handled as unsigned values, so INT64_MIN needs no
+    special case.
+
+    Everything a locale varies -- separator, group sizes, words -- is
+    compiled once into a brahe_pretty_locale_t: group sizes are expanded
+    to cover the widest value, separator counts are tabulated by digit
+    count, and every word is measured. Grouped lengths are therefore known
+    before any digit is produced, and digits go straight to their final
+    place. The built-in en_US locale is compiled by the same code.
+*/
 
-static char digit[] =
+/* U.S. English words */
+static const brahe_pretty_words_t english_words =
 {
-    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9'
+    "zero",
+    "negative",
+    "hundred",
+    {
+        "", "one", "two", "three", "four", "five",
+        "six", "seven", "eight", "nine", "ten",
+        "eleven", "twelve", "thirteen", "fourteen", "fifteen",
+        "sixteen", "seventeen", "eighteen", "nineteen"
+    },
+    {
+        "twenty", "thirty", "forty", "fifty",
+        "sixty", "seventy", "eighty", "ninety"
+    },
+    "-",
+    ", ",
+    {
+        "thousand", "million", "billion", "trillion", "quadrillion", "quintillion"
+    }
 };
 
-static char * ones[] =
+/* the two-digit strings "00" through "99" */
+static const char digit_pairs[] =
+    "00010203040506070809" "10111213141516171819" "20212223242526272829" "30313233343536373839" "40414243444546474849"
+    "50515253545556575859" "60616263646566676869" "70717273747576777879" "80818283848586878889" "90919293949596979899";
+
+/* powers of ten that fit in 64 bits */
+static const uint64_t pow10_table[20] =
 {
-     "", "one", "two", "three", "four", "five",
-     "six", "seven", "eight", "nine", "ten",
-     "eleven", "twelve", "thirteen", "fourteen", "fifteen",
-     "sixteen", "seventeen", "eighteen", "nineteen"
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+    10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
 };
 
-static char * tens[] =
+/* decimal digits in the largest magnitude, 2^63 */
+#define MAX_DIGITS 19
+
+/* longest grouped 64-bit value: sign, digits, and a separator between each */
+#define MAX_GROUPED (1 + MAX_DIGITS + (MAX_DIGITS - 1) * BRAHE_PRETTY_MAX_SEPARATOR)
+
+/* bounded output; pos counts every character, written or not */
+typedef struct
 {
-     "twenty", "thirty", "forty", "fifty",
-     "sixty", "seventy", "eighty", "ninety"
-};
+    char * m_buffer;
+    size_t m_len;
+    size_t m_pos;
+}
+writer_t;
 
-static char * powers[] =
+static void append(writer_t * w, const brahe_pretty_word_t * word)
 {
-     "thousand", "million", "billion", "trillion", "quadrillion", "quintillion", "sextillion"
-};
+    size_t i;
+
+    if (w->m_pos + word->m_len < w->m_len)
+        memcpy(w->m_buffer + w->m_pos, word->m_text, word->m_len);
+    else
+    {
+        for (i = 0; i < word->m_len; ++i)
+        {
+            if (w->m_pos + i + 1 < w->m_len)
+                w->m_buffer[w->m_pos + i] = word->m_text[i];
+        }
+    }
+
+    w->m_pos += word->m_len;
+}
+
+static void append_char(writer_t * w, const char c)
+{
+    if (w->m_pos + 1 < w->m_len)
+        w->m_buffer[w->m_pos] = c;
+
+    ++w->m_pos;
+}
+
+/* terminate the output, truncated if need be */
+static size_t finish(writer_t * w)
+{
+    if (w->m_len > 0)
+        w->m_buffer[(w->m_pos < w->m_len) ? w->m_pos : w->m_len - 1] = 0;
+
+    return w->m_pos;
+}
 
-/* Creates a new string by combining two others */
-static char * strapp(char * front, const char * back)
+static uint64_t magnitude(const int64_t n)
 {
-    char * result = NULL;
+    return (n < 0) ? (uint64_t)0 - (uint64_t)n : (uint64_t)n;
+}
+
+/* removes the lowest group of the given size from m and returns it;
+   constant divisors let the usual sizes avoid a hardware divide */
+BRAHE_INLINE unsigned int split_group(uint64_t * m, const unsigned int digits)
+{
+    unsigned int group;
+
+    switch (digits)
+    {
+        case 2:
+            group = (unsigned int)(*m % 100);
+            *m /= 100;
+            break;
+
+        case 3:
+            group = (unsigned int)(*m % 1000);
+            *m /= 1000;
+            break;
+
+        case 4:
+            group = (unsigned int)(*m % 10000);
+            *m /= 10000;
+            break;
+
+        default:
+            group = (unsigned int)(*m % pow10_table[digits]);
+            *m /= pow10_table[digits];
+            break;
+    }
+
+    return group;
+}
+
+static void measure(brahe_pretty_word_t * word, const char * text)
+{
+    word->m_text = (text != NULL) ? text : "";
+    word->m_len = strlen(word->m_text);
+}
+
+/*      Compiles a locale from a separator, a grouping pattern, and words
+ */
+
+bool brahe_pretty_locale_init(brahe_pretty_locale_t * loc, const char * separator, const char * grouping, const brahe_pretty_words_t * words)
+{
+    unsigned int digits = 0, total = 0, size;
+    size_t g, d, i;
+    const char * p = grouping;
+
+    if ((loc == NULL) || (separator == NULL) || (grouping == NULL))
+        return false;
+
+    memset(loc, 0, sizeof(brahe_pretty_locale_t));
+
+    loc->m_separator_len = strlen(separator);
+
+    if (loc->m_separator_len > BRAHE_PRETTY_MAX_SEPARATOR)
+        return false;
+
+    memcpy(loc->m_separator, separator, loc->m_separator_len);
 
-    if (front == NULL)
+    /* an empty pattern means no grouping */
+    if (*p == 0)
     {
-        if (back != NULL)
-            result = strdup(back);
+        loc->m_groups = 1;
+        loc->m_group_digits[0] = MAX_DIGITS;
     }
     else
     {
-        result = (char *)malloc(strlen(front) + strlen(back) + 1);
-        sprintf(result,"%s%s", front, back);
-        free(front);
+        /* sizes from the lowest group up; the last one repeats */
+        for (g = 0; total < MAX_DIGITS; ++g)
+        {
+            if (*p != 0)
+            {
+                if ((*p < '1') || (*p > '9'))
+                    return false;
+
+                digits = (unsigned int)(*p++ - '0');
+
+                if (*p == ';')
+                {
+                    if (*++p == 0)
+                        return false;
+                }
+                else if (*p != 0)
+                    return false;
+            }
+
+            loc->m_group_digits[g] = (unsigned char)digits;
+            total += digits;
+        }
+
+        loc->m_groups = g;
+    }
+
+    /* separators needed for each digit count */
+    for (d = 1, g = 0, size = loc->m_group_digits[0]; d <= MAX_DIGITS; ++d)
+    {
+        if (d > size)
+            size += loc->m_group_digits[++g];
+
+        loc->m_separators[d] = (unsigned char)g;
+    }
+
+    /* the common shape gets its own writer */
+    loc->m_thousands = (loc->m_separator_len == 1);
+
+    for (g = 0; g < loc->m_groups; ++g)
+    {
+        if (loc->m_group_digits[g] != 3)
+            loc->m_thousands = false;
+    }
+
+    /* text needs groups no wider than the hundreds, and a name for each */
+    if (words != NULL)
+    {
+        loc->m_text = true;
+
+        for (g = 0; g < loc->m_groups; ++g)
+        {
+            if (loc->m_group_digits[g] > 3)
+                loc->m_text = false;
+
+            if ((g > 0) && (words->powers[g - 1] == NULL))
+                loc->m_text = false;
+        }
+
+        measure(&loc->m_zero, words->zero);
+        measure(&loc->m_negative, words->negative);
+        measure(&loc->m_hundred, words->hundred);
+        measure(&loc->m_hyphen, words->hyphen);
+        measure(&loc->m_group_separator, words->group_separator);
+
+        for (i = 0; i < 20; ++i)
+            measure(&loc->m_ones[i], words->ones[i]);
+
+        for (i = 0; i < 8; ++i)
+            measure(&loc->m_tens[i], words->tens[i]);
+
+        for (i = 0; i < BRAHE_PRETTY_MAX_GROUPS - 1; ++i)
+            measure(&loc->m_powers[i], words->powers[i]);
     }
 
-    return result;
+    return true;
+}
+
+/*      The built-in U.S. English locale
+ */
+
+static brahe_pretty_locale_t en_us;
+
+static void build_en_us(void)
+{
+    brahe_pretty_locale_init(&en_us, ",", "3", &english_words);
 }
 
-static int64_t intpow10(int64_t p)
+#if defined(BRAHE_HAVE_PTHREADS)
+static pthread_once_t en_us_once = PTHREAD_ONCE_INIT;
+#else
+static bool en_us_ready = false;
+#endif
+
+const brahe_pretty_locale_t * brahe_pretty_locale_en_us(void)
 {
-    int64_t res;
-    for (res = 1; p--; res *= 10) ;
-    return res;
+#if defined(BRAHE_HAVE_PTHREADS)
+    pthread_once(&en_us_once, build_en_us);
+#else
+    if (!en_us_ready)
+    {
+        build_en_us();
+        en_us_ready = true;
+    }
+#endif
+
+    return &en_us;
 }
 
-static int64_t intlog10(int64_t l)
+const brahe_pretty_words_t * brahe_pretty_words_english(void)
 {
-    int p;
-    for (p = 18; !(l / intpow10(p)); --p) ;
-    return p;
+    return &english_words;
 }
 
-static char * format_text(int64_t n)
+static size_t format_text(const brahe_pretty_locale_t * loc, int64_t n, char * buffer, size_t len)
 {
-    int64_t temp;     /* value used to hold temporary values */
-    int64_t place;    /* which place we're at */
-    int64_t hundreds; /* the amount in the current place */
-    char * buffer = NULL;
+    int place, count;
+    unsigned int hundreds, temp;
+    unsigned int groups[BRAHE_PRETTY_MAX_GROUPS];
+    uint64_t m = magnitude(n);
+    writer_t w;
+
+    w.m_buffer = buffer;
+    w.m_len = len;
+    w.m_pos = 0;
 
     /* if the input is 0, the format is always the same */
-    if (n == 0)
+    if (m == 0)
     {
-        buffer = strapp(buffer,"zero");
-        return buffer;
+        append(&w, &loc->m_zero);
+        return finish(&w);
     }
 
-    /* if n is negative, say so, and get n's positive value */
+    /* if n is negative, say so */
     if (n < 0)
     {
-        buffer = strapp(buffer,"negative ");
-        n = -n;
+        append(&w, &loc->m_negative);
+        append_char(&w, ' ');
     }
 
-    /* find the highest 'place' in the number */
-    place = intlog10(n) / 3L;
+    /* split into groups, lowest first */
+    for (count = 0; m != 0; ++count)
+        groups[count] = split_group(&m, loc->m_group_digits[count]);
 
-    while (place >= 0)
+    for (place = count - 1; place >= 0; --place)
     {
-        /* find the "hundreds" amount of the current place */
-        temp = intpow10(place * 3L);
-        hundreds = n / temp;
+        hundreds = groups[place];
 
-        /* if it's not zero */
-        if (hundreds)
-        {
-            /* subtract the place amount from n */
-            n -= temp * hundreds;
+        /* zero groups say nothing */
+        if (hundreds == 0)
+            continue;
+
+        /* get the digits in the hundreds place */
+        temp = hundreds / 100;
 
-            /* get the digits in the hundreds place */
-            temp = hundreds / 100;
+        /* if there are hundreds, add their text to the buffer */
+        if (temp)
+        {
+            hundreds -= temp * 100;
+            append(&w, &loc->m_ones[temp]);
+            append_char(&w, ' ');
+            append(&w, &loc->m_hundred);
+        }
 
-            /* if there are hundreds, add their test to the buffer */
+        /* if hundreds still has a value */
+        if (hundreds)
+        {
             if (temp)
-            {
-                hundreds -= temp * 100;
-                buffer = strapp(buffer,ones[(int)temp]);
-                buffer = strapp(buffer," hundred");
-            }
+                append_char(&w, ' ');
 
-            /* if hundreds still has a value */
-            if (hundreds)
+            if (hundreds < 20)
+                /* use specific names like 'one' or 'eleven' */
+                append(&w, &loc->m_ones[hundreds]);
+            else
             {
-                if (temp)
-                    buffer = strapp(buffer," ");
+                /* the 'tens' spot */
+                append(&w, &loc->m_tens[hundreds / 10 - 2]);
 
-                if (hundreds < 20)
-                    /* use specific names like 'one' or 'eleven' */
-                    buffer = strapp(buffer,ones[(int)hundreds]);
-                else
+                /* if a number in the 'ones' spot */
+                if (hundreds % 10)
                 {
-                    temp = hundreds / 10;
-
-                    /* if a number in the 'tens' spot */
-                    if (temp)
-                    {
-                        hundreds -= temp * 10;
-                        buffer = strapp(buffer,tens[(int)temp-2]);
-                    }
-
-                    /* if a number in the 'ones' spot */
-                    if (hundreds)
-                    {
-                        buffer = strapp(buffer,"-");
-                        buffer = strapp(buffer,ones[(int)hundreds]);
-                    }
+                    append(&w, &loc->m_hyphen);
+                    append(&w, &loc->m_ones[hundreds % 10]);
                 }
             }
+        }
 
-            /* if this place is a thousand or more, display the place name */
-            if (place)
-            {
-                buffer = strapp(buffer," ");
-                buffer = strapp(buffer,powers[(int)place-1]);
+        /* if this is above the lowest group, display the group name */
+        if (place)
+        {
+            append_char(&w, ' ');
+            append(&w, &loc->m_powers[place - 1]);
 
-                /* if n still has value, put a comma */
-                if (n)
-                    buffer = strapp(buffer,", ");
+            /* if anything follows, separate it */
+            for (temp = 0; (int)temp < place; ++temp)
+            {
+                if (groups[temp])
+                {
+                    append(&w, &loc->m_group_separator);
+                    break;
+                }
             }
         }
-
-        /* go to the next decimal place */
-        --place;
     }
 
-    return buffer;
+    return finish(&w);
 }
 
-#define NEEDED64 26
+/* decimal digits in m; log10 estimated from the bit length, then corrected */
+BRAHE_INLINE size_t count_digits(uint64_t m)
+{
+    size_t t;
+
+    /* setting the low bit never changes the count, and makes 0 a digit */
+    m |= 1;
+    t = ((size_t)(64 - brahe_clz64(m)) * 1233) >> 12;
+    return t + (m >= pow10_table[t]);
+}
+
+/* characters in the grouped form of n */
+BRAHE_INLINE size_t grouped_length(const brahe_pretty_locale_t * loc, const int64_t n)
+{
+    size_t d = count_digits(magnitude(n));
+    return (n < 0) + d + loc->m_separators[d] * loc->m_separator_len;
+}
 
-static char * format_comma(int64_t n)
+/* writes n in groups of three with a one-byte separator, backward,
+   ending just before end; the shape of most locales */
+static void write_thousands(int64_t n, const char separator, char * end)
 {
-    int64_t x, t, p;
+    uint64_t m = magnitude(n);
+    unsigned int group;
+
+    /* whole groups of three, from the right, each preceded by a separator */
+    while (m >= 1000)
+    {
+        group = (unsigned int)(m % 1000);
+        m /= 1000;
 
-    char * result = (char *)malloc(NEEDED64);
-    char * r = result;
+        end -= 2;
+        memcpy(end, digit_pairs + 2 * (group % 100), 2);
+        *--end = (char)('0' + group / 100);
+        *--end = separator;
+    }
 
-    memset(result,0,NEEDED64);
+    /* the leading group has one to three digits */
+    group = (unsigned int)m;
 
-    /* if n is 0, the format is fixed */
-    if (n == 0)
+    if (group >= 100)
     {
-        *r++ = '0';
-        *r = 0;
-        return result;
+        end -= 2;
+        memcpy(end, digit_pairs + 2 * (group % 100), 2);
+        *--end = (char)('0' + group / 100);
     }
+    else if (group >= 10)
+    {
+        end -= 2;
+        memcpy(end, digit_pairs + 2 * group, 2);
+    }
+    else
+        *--end = (char)('0' + group);
 
     if (n < 0)
+        *--end = '-';
+}
+
+/* writes the grouped form of n backward, ending just before end */
+static void write_grouped(const brahe_pretty_locale_t * loc, int64_t n, char * end)
+{
+    uint64_t m = magnitude(n);
+    unsigned int group, digits;
+    size_t g;
+
+    if (loc->m_thousands)
+    {
+        write_thousands(n, loc->m_separator[0], end);
+        return;
+    }
+
+    /* whole groups, from the right, each preceded by a separator */
+    for (g = 0; (g + 1 < loc->m_groups) && (m >= pow10_table[loc->m_group_digits[g]]); ++g)
     {
-        /* put a negative sign in the r */
-        *r++ = '-';
+        digits = loc->m_group_digits[g];
+
+        /* the usual sizes have their own constant divisors */
+        switch (digits)
+        {
+            case 3:
+                group = (unsigned int)(m % 1000);
+                m /= 1000;
+                end -= 2;
+                memcpy(end, digit_pairs + 2 * (group % 100), 2);
+                *--end = (char)('0' + group / 100);
+                break;
+
+            case 2:
+                group = (unsigned int)(m % 100);
+                m /= 100;
+                end -= 2;
+                memcpy(end, digit_pairs + 2 * group, 2);
+                break;
+
+            default:
+                group = split_group(&m, digits);
+
+                for (; digits >= 2; digits -= 2)
+                {
+                    end -= 2;
+                    memcpy(end, digit_pairs + 2 * (group % 100), 2);
+                    group /= 100;
+                }
+
+                if (digits)
+                    *--end = (char)('0' + group);
+
+                break;
+        }
 
-        /* get the positive value of n */
-        n = -n;
+        if (loc->m_separator_len == 1)
+            *--end = loc->m_separator[0];
+        else
+        {
+            end -= loc->m_separator_len;
+            memcpy(end, loc->m_separator, loc->m_separator_len);
+        }
     }
 
-    /* loop thru each decimal place in n */
-    for (p = intlog10(n); p >= 0; --p)
+    /* the leading group, without padding */
+    while (m >= 100)
     {
-        x = intpow10(p);
+        end -= 2;
+        memcpy(end, digit_pairs + 2 * (m % 100), 2);
+        m /= 100;
+    }
 
-        /* get the value of the current digit */
-        t = n / x;
+    if (m >= 10)
+    {
+        end -= 2;
+        memcpy(end, digit_pairs + 2 * m, 2);
+    }
+    else
+        *--end = (char)('0' + m);
 
-        /* remove the digit being displayed from n */
-        n -= t * x;
+    if (n < 0)
+        *--end = '-';
+}
 
-        /* insert the proper digit */
-        *r++ = digit[(int)t];
+static size_t format_grouped(const brahe_pretty_locale_t * loc, int64_t n, char * buffer, size_t len)
+{
+    char digits[MAX_GROUPED];
+    size_t size = grouped_length(loc, n);
 
-        /* place a comma after every third digit */
-        if (!(p % 3) && p)
-            *r++ = ',';
+    if (size < len)
+    {
+        /* fits; write in place */
+        write_grouped(loc, n, buffer + size);
+        buffer[size] = 0;
     }
+    else if (len > 0)
+    {
+        /* copy what fits, and terminate; len - 1 < size <= MAX_GROUPED,
+           and the clamp only shows the compiler that bound */
+        size_t copy = (len - 1 < MAX_GROUPED) ? len - 1 : MAX_GROUPED;
 
-    *r = 0;
+        write_grouped(loc, n, digits + size);
+        memcpy(buffer, digits, copy);
+        buffer[copy] = 0;
+    }
 
-    return result;
+    return size;
 }
 
-/*      Formats a int32_t integer into a strings
+/*      Formats a 64-bit integer into a caller's buffer, for a locale
+ */
+
+size_t brahe_pretty_int_l(int64_t n, brahe_pretty_format fmt, const brahe_pretty_locale_t * loc, char * buffer, size_t len)
+{
+    /* no buffer, so only measure */
+    if (buffer == NULL)
+        len = 0;
+
+    if (loc != NULL)
+    {
+        switch (fmt)
+        {
+            case BRAHE_PRETTY_TEXT: /* text in the locale's words */
+                if (loc->m_text)
+                    return format_text(loc, n, buffer, len);
+                break;
+
+            case BRAHE_PRETTY_COMMA: /* grouped digits */
+                return format_grouped(loc, n, buffer, len);
+
+            default :
+                break;
+        }
+    }
+
+    if (len > 0)
+        buffer[0] = 0;
+
+    return 0;
+}
+
+/*      Formats a 64-bit integer into a caller's buffer
             comma delimited -- 1,234,567,890
             english text    -- nine thousand, two hundred eleven
-        Returns a string that must be free'd by caller
+        Returns the length of the complete string
+ */
+
+size_t brahe_pretty_int_r(int64_t n, brahe_pretty_format fmt, char * buffer, size_t len)
+{
+    return brahe_pretty_int_l(n, fmt, brahe_pretty_locale_en_us(), buffer, len);
+}
+
+/*      Formats a 64-bit integer into a strings
+            comma delimited -- 1,234,567,890
+            english text    -- nine thousand, two hundred eleven
+        Returns a string to be released with brahe_free
  */
 
 char * brahe_pretty_int(int64_t n, brahe_pretty_format fmt)
 {
     char * str = NULL;
+    size_t size;
+
+    if ((fmt != BRAHE_PRETTY_TEXT) && (fmt != BRAHE_PRETTY_COMMA))
+        return NULL;
+
+    size = brahe_pretty_int_r(n, fmt, NULL, 0) + 1;
+    str = (char *)brahe_allocate(brahe_allocator(), size, 1);
+
+    if (str != NULL)
+        brahe_pretty_int_r(n, fmt, str, size);
+
+    return str;
+}
+
+/*      Bytes needed to format an array of integers for a locale,
+        terminators included
+ */
+
+size_t brahe_pretty_int_array_size_l(const int64_t * values, size_t n, brahe_pretty_format fmt, const brahe_pretty_locale_t * loc)
+{
+    size_t i, total = 0;
+
+    if ((values == NULL) || (loc == NULL))
+        return 0;
 
     switch (fmt)
     {
-        case BRAHE_PRETTY_TEXT: /* U.S. english text */
-            str = format_text(n);
+        case BRAHE_PRETTY_TEXT:
+            if (loc->m_text)
+            {
+                for (i = 0; i < n; ++i)
+                    total += format_text(loc, values[i], NULL, 0) + 1;
+            }
             break;
 
-        case BRAHE_PRETTY_COMMA: /* comma delimited */
-            str = format_comma(n);
+        case BRAHE_PRETTY_COMMA:
+            for (i = 0; i < n; ++i)
+                total += grouped_length(loc, values[i]) + 1;
             break;
 
-        default :
-            return 0;
-    };
+        default:
+            break;
+    }
 
-    return str;
+    return total;
+}
+
+size_t brahe_pretty_int_array_size(const int64_t * values, size_t n, brahe_pretty_format fmt)
+{
+    return brahe_pretty_int_array_size_l(values, n, fmt, brahe_pretty_locale_en_us());
+}
+
+/*      Formats an array of integers into one arena, each string terminated
+        and its start recorded in offsets; stops at the first value that
+        does not fit. Returns the number of values written.
+ */
+
+size_t brahe_pretty_int_array_l(const int64_t * values, size_t n, brahe_pretty_format fmt, const brahe_pretty_locale_t * loc, char * arena, size_t arena_len, size_t * offsets)
+{
+    size_t i = 0, size, pos = 0;
+
+    if ((values == NULL) || (loc == NULL) || (arena == NULL) || (offsets == NULL))
+        return 0;
+
+    switch (fmt)
+    {
+        case BRAHE_PRETTY_TEXT:
+            if (!loc->m_text)
+                break;
+
+            for (i = 0; i < n; ++i)
+            {
+                size = format_text(loc, values[i], arena + pos, arena_len - pos);
+
+                if (size >= arena_len - pos)
+                    break;
+
+                offsets[i] = pos;
+                pos += size + 1;
+            }
+            break;
+
+        case BRAHE_PRETTY_COMMA:
+            for (i = 0; i < n; ++i)
+            {
+                size = grouped_length(loc, values[i]);
+
+                if (size >= arena_len - pos)
+                    break;
+
+                offsets[i] = pos;
+                write_grouped(loc, values[i], arena + pos + size);
+                arena[pos + size] = 0;
+                pos += size + 1;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    /* the end of the last string written */
+    offsets[i] = pos;
+
+    return i;
+}
+
+size_t brahe_pretty_int_array(const int64_t * values, size_t n, brahe_pretty_format fmt, char * arena, size_t arena_len, size_t * offsets)
+{
+    return brahe_pretty_int_array_l(values, n, fmt, brahe_pretty_locale_en_us(), arena, arena_len, offsets);
 }
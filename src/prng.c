@@ -51,6 +51,7 @@
 */
 
 #include "prng.h"
+#include "dispatch.h"
 
 #if defined(_MSC_VER)
 #pragma warning (disable: 4996)
@@ -82,9 +83,6 @@ static bool mtwister_init(brahe_prng_state_t * prng_state)
 
     if (prng_state != NULL)
     {
-        // allocate space for values
-        prng_state->m_data1 = malloc(sizeof(uint32_t) * N);
-
         if (prng_state->m_data1 != NULL)
         {
             // convenience pointer
@@ -107,42 +105,18 @@ static bool mtwister_init(brahe_prng_state_t * prng_state)
 
 static uint32_t mtwister_next(brahe_prng_state_t * prng_state)
 {
-    // Period parameters
-    static const size_t N = 624;
-    static const size_t M = 397;
-    static const uint32_t UPPER_MASK = 0x80000000UL;
-    static const uint32_t LOWER_MASK = 0x7fffffffUL;
-
     // what we compute
     uint32_t result = 0;
 
-    // variable names match those in original example
-    const uint32_t mag01[2] = { 0, 0x9908b0dfUL };
-    size_t   kk;
-
     if ((prng_state != NULL) && (prng_state->m_data1 != NULL))
     {
         // convenience pointer
         uint32_t * m = (uint32_t *)prng_state->m_data1;
 
         // Generate N words at a time
-        if (prng_state->m_i >= N)
+        if (prng_state->m_i >= BRAHE_MT_N)
         {
-            for (kk=0; kk < N-M; kk++)
-            {
-                result = (m[kk] & UPPER_MASK) | (m[kk+1] & LOWER_MASK);
-                m[kk] = m[kk + M] ^ (result >> 1) ^ mag01[result & 0x1];
-            }
-
-            for ( ; kk < N-1; kk++)
-            {
-                result = (m[kk] & UPPER_MASK) | (m[kk+1] & LOWER_MASK);
-                m[kk] = m[kk+(M-N)] ^ (result >> 1) ^ mag01[result & 0x1];
-            }
-
-            result = (m[N-1] & UPPER_MASK) | (m[0]&LOWER_MASK);
-            m[N-1] = m[M-1] ^ (result >> 1) ^ mag01[result & 0x1];
-
+            brahe_kernels()->m_mt_twist(m);
             prng_state->m_i = 0;
         }
 
@@ -158,6 +132,32 @@ static uint32_t mtwister_next(brahe_prng_state_t * prng_state)
     return result;
 }
 
+// whole blocks of state are twisted and tempered straight into values
+static void mtwister_fill(brahe_prng_state_t * prng_state, uint32_t * values, const size_t n)
+{
+    const brahe_kernels_t * k = brahe_kernels();
+    uint32_t * m = (uint32_t *)prng_state->m_data1;
+    size_t count, done = 0;
+
+    while (done < n)
+    {
+        if (prng_state->m_i >= BRAHE_MT_N)
+        {
+            k->m_mt_twist(m);
+            prng_state->m_i = 0;
+        }
+
+        count = BRAHE_MT_N - prng_state->m_i;
+
+        if (count > n - done)
+            count = n - done;
+
+        k->m_mt_temper(m + prng_state->m_i, values + done, count);
+        prng_state->m_i += count;
+        done += count;
+    }
+}
+
 /*
     The popular "Keep It Simple Stupid" psuedorandom number generator.
     It has a period of around 2^125, which is shorter than most other
@@ -174,9 +174,6 @@ static bool kiss_init(brahe_prng_state_t * prng_state)
 
     if (prng_state != NULL)
     {
-        // allocate space for values
-        prng_state->m_data1 = malloc(sizeof(uint32_t) * 4);
-
         if (prng_state->m_data1 != NULL)
         {
             uint32_t * m = (uint32_t *)prng_state->m_data1;
@@ -226,9 +223,6 @@ static bool mwc_init(brahe_prng_state_t * prng_state, const size_t N)
 
     if (prng_state != NULL)
     {
-        // allocate space for values
-        prng_state->m_data1 = malloc(sizeof(uint32_t) * N);
-
         if (prng_state->m_data1 != NULL)
         {
             // convenience pointer
@@ -408,11 +402,10 @@ static bool isaac_init(brahe_prng_state_t * prng_state)
         prng_state->m_c = 0;
         prng_state->m_i = 0;
 
-        prng_state->m_data1 = malloc(sizeof(uint32_t) * 256);
-
         if (prng_state->m_data1 != NULL)
         {
-            prng_state->m_data2 = malloc(sizeof(uint32_t) * 256);
+            // the result table follows the state in one block
+            prng_state->m_data2 = (uint32_t *)prng_state->m_data1 + 256;
 
             if (prng_state->m_data2 != NULL)
             {
@@ -478,6 +471,7 @@ static bool isaac_init(brahe_prng_state_t * prng_state)
                 }
 
                 isaac_next_batch(prng_state);
+                result = true;
             }
         }
     }
@@ -508,81 +502,163 @@ static uint32_t isaac_next(brahe_prng_state_t * prng_state)
     Generic functions used by all of the generators implemented above.
 */
 
-// Initialize a psuedo-random number generator
-bool brahe_prng_init(brahe_prng_state_t * prng_state, const brahe_prng_type_t type, const uint32_t seed)
+// words of state for each algorithm
+static size_t state_words(const brahe_prng_type_t type)
+{
+    switch (type)
+    {
+        case BRAHE_PRNG_MARSENNE_TWISTER:
+            return 624;
+
+        case BRAHE_PRNG_KISS:
+            return 4;
+
+        case BRAHE_PRNG_MWC1038:
+            return 1038;
+
+        case BRAHE_PRNG_CMWC4096:
+            return 4096;
+
+        case BRAHE_PRNG_ISAAC:
+            return 512;
+    }
+
+    return 0;
+}
+
+// Initialize a generator in memory already set aside in m_data1
+static bool prng_setup(brahe_prng_state_t * prng_state, const brahe_prng_type_t type, const uint32_t seed)
 {
     bool result = false;
 
     // set the seed
-    if (prng_state != NULL)
+    if (seed > 0)
+        prng_state->m_seed = seed;
+    else
     {
-        if (seed > 0)
-            prng_state->m_seed = seed;
-        else
-        {
 #if defined(_MSC_VER)
-            prng_state->m_seed = (uint32_t)time(NULL);
+        prng_state->m_seed = (uint32_t)time(NULL);
 #else
-            // first try to read /dev/urandom
-            int fd = open("/dev/urandom", O_RDONLY);
+        // first try to read /dev/urandom
+        int fd = open("/dev/urandom", O_RDONLY);
 
-            if (fd != -1)
-            {
-                uint32_t s = 0;
+        prng_state->m_seed = (uint32_t)time(NULL);
+
+        if (fd != -1)
+        {
+            uint32_t s = 0;
 
-                int n = read(fd, &s, 4);
-                close(fd);
+            int n = read(fd, &s, 4);
+            close(fd);
 
-                if (n == sizeof(uint32_t))
-                    prng_state->m_seed = s;
-                else
-                    prng_state->m_seed = (uint32_t)time(NULL);
-            }
-#endif
+            if (n == sizeof(uint32_t))
+                prng_state->m_seed = s;
         }
+#endif
+    }
 
-        // initialize based on type
-        prng_state->m_type = type;
-        prng_state->m_data1 = NULL;
-        prng_state->m_data2 = NULL;
+    BRAHE_PROBE2(prng_init, (int)type, prng_state->m_seed);
 
-        switch (prng_state->m_type)
-        {
-            case BRAHE_PRNG_MARSENNE_TWISTER:
-                result = mtwister_init(prng_state);
-                break;
+    // initialize based on type
+    prng_state->m_type = type;
+    prng_state->m_data2 = NULL;
 
-            case BRAHE_PRNG_KISS:
-                result = kiss_init(prng_state);
-                break;
+    switch (prng_state->m_type)
+    {
+        case BRAHE_PRNG_MARSENNE_TWISTER:
+            result = mtwister_init(prng_state);
+            break;
 
-            case BRAHE_PRNG_MWC1038:
-                result = mwc_init(prng_state,1038);
-                break;
+        case BRAHE_PRNG_KISS:
+            result = kiss_init(prng_state);
+            break;
 
-            case BRAHE_PRNG_CMWC4096:
-                result = mwc_init(prng_state,4096);
-                break;
+        case BRAHE_PRNG_MWC1038:
+            result = mwc_init(prng_state,1038);
+            break;
 
-            case BRAHE_PRNG_ISAAC:
-                result = isaac_init(prng_state);
-                break;
-        }
+        case BRAHE_PRNG_CMWC4096:
+            result = mwc_init(prng_state,4096);
+            break;
+
+        case BRAHE_PRNG_ISAAC:
+            result = isaac_init(prng_state);
+            break;
     }
 
     return result;
 }
 
+// Initialize a psuedo-random number generator
+bool brahe_prng_init(brahe_prng_state_t * prng_state, const brahe_prng_type_t type, const uint32_t seed)
+{
+    size_t words = state_words(type);
+    bool result;
+
+    if (prng_state == NULL)
+        return false;
+
+    prng_state->m_allocator = *brahe_allocator();
+    prng_state->m_data1 = NULL;
+    prng_state->m_data2 = NULL;
+
+    if (words == 0)
+        return false;
+
+    BRAHE_METRIC_BEGIN(BRAHE_METRIC_PRNG_INIT, words);
+
+    prng_state->m_data1 = brahe_allocate(&prng_state->m_allocator, sizeof(uint32_t) * words, BRAHE_DEFAULT_ALIGN);
+    result = (prng_state->m_data1 != NULL) && prng_setup(prng_state, type, seed);
+
+    if (!result)
+        brahe_prng_free(prng_state);
+
+    BRAHE_METRIC_END();
+    return result;
+}
+
+// Bytes of state needed by brahe_prng_init_into
+size_t brahe_prng_state_size(const brahe_prng_type_t type)
+{
+    return sizeof(uint32_t) * state_words(type);
+}
+
+// Initialize a psuedo-random number generator in caller memory
+bool brahe_prng_init_into(brahe_prng_state_t * prng_state, const brahe_prng_type_t type, const uint32_t seed, void * buffer, const size_t size)
+{
+    size_t needed = brahe_prng_state_size(type);
+    bool result;
+
+    if ((prng_state == NULL) || (buffer == NULL) || (needed == 0) || (size < needed))
+        return false;
+
+    BRAHE_METRIC_BEGIN(BRAHE_METRIC_PRNG_INIT, needed / sizeof(uint32_t));
+
+    // no free function: the memory is not ours to release
+    prng_state->m_allocator.alloc = NULL;
+    prng_state->m_allocator.free = NULL;
+    prng_state->m_allocator.context = NULL;
+    prng_state->m_data1 = buffer;
+
+    result = prng_setup(prng_state, type, seed);
+
+    if (!result)
+        prng_state->m_data1 = NULL;
+
+    BRAHE_METRIC_END();
+    return result;
+}
+
 // free resources
 void brahe_prng_free(brahe_prng_state_t * prng_state)
 {
     if (prng_state != NULL)
     {
-        if (prng_state->m_data1 != NULL)
-            free(prng_state->m_data1);
+        if ((prng_state->m_data1 != NULL) && (prng_state->m_allocator.free != NULL))
+            brahe_release(&prng_state->m_allocator, prng_state->m_data1);
 
-        if (prng_state->m_data2 != NULL)
-            free(prng_state->m_data2);
+        prng_state->m_data1 = NULL;
+        prng_state->m_data2 = NULL;
     }
 }
 
@@ -662,3 +738,105 @@ double brahe_prng_real53(brahe_prng_state_t * prng_state)
     uint32_t b = brahe_prng_next(prng_state) >> 6;
     return (double)(a * 67108864.0 + b) * (1.0 / 9007199254740992.0);
 }
+
+// Fill an array with the next integers in sequence
+void brahe_prng_fill(brahe_prng_state_t * prng_state, uint32_t * values, const size_t n)
+{
+    size_t i;
+
+    if ((prng_state == NULL) || (prng_state->m_data1 == NULL) || (values == NULL))
+        return;
+
+    // choose the algorithm once, rather than once per value
+    switch (prng_state->m_type)
+    {
+        case BRAHE_PRNG_MARSENNE_TWISTER:
+            mtwister_fill(prng_state, values, n);
+            break;
+
+        case BRAHE_PRNG_KISS:
+            for (i = 0; i < n; ++i)
+                values[i] = kiss_next(prng_state);
+            break;
+
+        case BRAHE_PRNG_MWC1038:
+            for (i = 0; i < n; ++i)
+                values[i] = mwc1038_next(prng_state);
+            break;
+
+        case BRAHE_PRNG_CMWC4096:
+            for (i = 0; i < n; ++i)
+                values[i] = cmwc4096_next(prng_state);
+            break;
+
+        case BRAHE_PRNG_ISAAC:
+            for (i = 0; i < n; ++i)
+                values[i] = isaac_next(prng_state);
+            break;
+
+        default:
+            for (i = 0; i < n; ++i)
+                values[i] = 0;
+    }
+}
+
+// values per independently seeded segment of a seeded fill
+#define FILL_SEGMENT ((size_t)1 << 16)
+
+typedef struct
+{
+    brahe_prng_type_t m_type;
+    uint32_t          m_seed;
+    uint32_t *        m_values;
+    uint8_t *         m_states;  // a generator's state for each worker
+    size_t            m_stride;  // bytes between workers' states
+    bool              m_ok;      // cleared by a segment that fails
+}
+fill_job_t;
+
+static void fill_task(void * context, const size_t begin, const size_t end, const size_t worker)
+{
+    fill_job_t * job = (fill_job_t *)context;
+    brahe_prng_state_t prng;
+
+    if (brahe_prng_init_into(&prng, job->m_type, brahe_segment_seed(job->m_seed, begin / FILL_SEGMENT),
+                             job->m_states + worker * job->m_stride, job->m_stride))
+    {
+        brahe_prng_fill(&prng, job->m_values + begin, end - begin);
+        brahe_prng_free(&prng);
+    }
+    else
+        job->m_ok = false;
+}
+
+bool brahe_prng_fill_seeded(const brahe_exec_t * exec, const brahe_prng_type_t type, const uint32_t seed,
+                            uint32_t * values, const size_t n)
+{
+    const brahe_allocator_t * a = brahe_allocator();
+    size_t size = brahe_prng_state_size(type);
+    size_t workers = brahe_exec_threads(exec);
+    fill_job_t job;
+
+    if ((values == NULL) || (size == 0))
+        return false;
+
+    // states a cache line apart, so workers do not share lines
+    job.m_stride = (size + BRAHE_SIMD_ALIGN - 1) & ~(size_t)(BRAHE_SIMD_ALIGN - 1);
+
+    if (workers > SIZE_MAX / job.m_stride)
+        return false;
+
+    job.m_states = (uint8_t *)brahe_allocate(a, job.m_stride * workers, BRAHE_SIMD_ALIGN);
+
+    if (job.m_states == NULL)
+        return false;
+
+    job.m_type   = type;
+    job.m_seed   = seed;
+    job.m_values = values;
+    job.m_ok     = true;
+    brahe_exec_for(exec, n, FILL_SEGMENT, fill_task, &job);
+
+    brahe_release(a, job.m_states);
+    return job.m_ok;
+}
@@ -85,6 +85,7 @@ typedef struct
     size_t            m_a;     // only used by some algorithms
     size_t            m_b;     // only used by some algorithms
     size_t            m_c;     // only used by some algorithms
+    brahe_allocator_t m_allocator; // source of m_data1; no free function for caller memory
 } brahe_prng_state_t;
 
 static uint32_t BRAHE_UNKNOWN_SEED = 0;
@@ -99,6 +100,29 @@ static uint32_t BRAHE_UNKNOWN_SEED = 0;
 */
 bool brahe_prng_init(brahe_prng_state_t * prng_state, const brahe_prng_type_t type, const uint32_t seed);
 
+//! Memory needed for a PRNG's state
+/*!
+    The size of buffer that brahe_prng_init_into requires for an algorithm.
+    \param type Algorithm to be used for a PRNG
+    \return bytes of state, or 0 for an unknown algorithm
+*/
+size_t brahe_prng_state_size(const brahe_prng_type_t type);
+
+//! Initialize a PRNG in caller-supplied memory
+/*!
+    Initializes a psuedo-random number generator as brahe_prng_init does,
+    keeping its state in <i>buffer</i> rather than allocating. The buffer
+    must be aligned for uint32_t and must outlive the generator;
+    brahe_prng_free does not release it.
+    \param prng_state Object to be initialized for a specific algorithm
+    \param type Algorithm to be used for this PRNG
+    \param seed Initialization seed
+    \param buffer memory for the generator's state
+    \param size bytes in <i>buffer</i>, at least brahe_prng_state_size(<i>type</i>)
+    \return <i>true</i> if successful, <i>false</i> if failed
+*/
+bool brahe_prng_init_into(brahe_prng_state_t * prng_state, const brahe_prng_type_t type, const uint32_t seed, void * buffer, const size_t size);
+
 //! Free resources used by PRNG
 /*!
     Frees the resources used by a PRNG
@@ -174,6 +198,60 @@ double brahe_prng_real3(brahe_prng_state_t * prng_state);
 */
 double brahe_prng_real53(brahe_prng_state_t * prng_state);
 
+//! Fill an array with the next integers in sequence
+/*!
+    Produces the same values as calling brahe_prng_next <i>n</i> times,
+    but selects the algorithm only once.
+    \param prng_state Object containing the state of a PRNG
+    \param values array that receives <i>n</i> pseudorandom values
+    \param n number of values to generate
+*/
+void brahe_prng_fill(brahe_prng_state_t * prng_state, uint32_t * values, const size_t n);
+
+//! Fill an array with reproducible values, in parallel
+/*!
+    The array is divided into fixed segments, each filled from its own
+    generator of the given algorithm, seeded from <i>seed</i> and the
+    segment's position. The values depend only on the arguments, not on the
+    number of threads, but differ from those of a single generator.
+    \param exec an execution context; NULL fills the array on the calling thread
+    \param type Algorithm to be used for each segment
+    \param seed seed for the values; must be nonzero for reproducible results
+    \param values array that receives <i>n</i> pseudorandom values
+    \param n number of values to generate
+    \return <i>true</i> if successful, <i>false</i> if an argument is invalid or resources were not available
+*/
+bool brahe_prng_fill_seeded(const brahe_exec_t * exec, const brahe_prng_type_t type, const uint32_t seed,
+                            uint32_t * values, const size_t n);
+
+//! Apply noise to a signal from a given generator
+/*!
+    Adds noise of the given kind to every element of a signal, drawing
+    values from <i>prng_state</i>, so that results can be reproduced.
+    \param prng_state Object containing the state of a PRNG
+    \param a array containing signal data
+    \param n number of samples in signal
+    \param type kind of noise
+    \param noise scale of the noise
+    \return <i>true</i> if successful, <i>false</i> if an argument is invalid
+*/
+bool brahe_add_noise_r(brahe_prng_state_t * prng_state, double * a, const size_t n,
+                       const brahe_noise_type_t type, const double noise);
+
+//! Apply noise to a single-precision signal from a given generator
+/*!
+    Single-precision version of brahe_add_noise_r; draws the same values
+    from <i>prng_state</i>.
+    \param prng_state Object containing the state of a PRNG
+    \param a array containing signal data
+    \param n number of samples in signal
+    \param type kind of noise
+    \param noise scale of the noise
+    \return <i>true</i> if successful, <i>false</i> if an argument is invalid
+*/
+bool brahe_add_noise_r_f(brahe_prng_state_t * prng_state, float * a, const size_t n,
+                         const brahe_noise_type_t type, const double noise);
+
 #if defined(__cplusplus)
 }
 #endif
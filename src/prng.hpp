@@ -0,0 +1,441 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+#if !defined(LIBBRAHE_PRNG_HPP)
+#define LIBBRAHE_PRNG_HPP
+
+/*
+    C++17 engines for the generators in prng.h. Each keeps its state inline
+    and is resolved at compile time, so calls inline completely; there is
+    no allocation, virtual call or switch on the algorithm. Every engine
+    satisfies UniformRandomBitGenerator, for use with <random>
+    distributions and std::shuffle, and produces the same sequence as
+    brahe_prng_init and brahe_prng_next for the same nonzero seed. A seed
+    of zero asks for an unpredictable seed, as it does in C.
+
+    Engines are move-only: copying one would silently duplicate its stream.
+*/
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+namespace brahe
+{
+    namespace detail
+    {
+        // Knuth's generator, which prng.c uses to expand a seed into state
+        constexpr std::uint32_t knuth(const std::uint32_t prev, const std::uint32_t i) noexcept
+        {
+            return 1812433253UL * (prev ^ (prev >> 30)) + i;
+        }
+
+        inline std::uint32_t resolve_seed(const std::uint32_t seed)
+        {
+            if (seed != 0)
+                return seed;
+
+            std::random_device device;
+            return static_cast<std::uint32_t>(device());
+        }
+
+        // what every engine shares: its result type, range and move-only semantics
+        class engine_base
+        {
+        public:
+            using result_type = std::uint32_t;
+
+            static constexpr result_type min() noexcept { return 0; }
+            static constexpr result_type max() noexcept { return 0xFFFFFFFFUL; }
+
+            engine_base(const engine_base &) = delete;
+            engine_base & operator = (const engine_base &) = delete;
+
+        protected:
+            engine_base() = default;
+            engine_base(engine_base &&) noexcept = default;
+            engine_base & operator = (engine_base &&) noexcept = default;
+            ~engine_base() = default;
+        };
+
+        // common seeding for the multiply-with-carry generators
+        template <std::size_t N>
+        inline void mwc_seed(std::array<std::uint32_t, N> & m, std::uint64_t & c, std::size_t & i, const std::uint32_t seed) noexcept
+        {
+            m[0] = seed;
+
+            for (std::size_t k = 1; k < N; ++k)
+                m[k] = knuth(m[k - 1], static_cast<std::uint32_t>(k));
+
+            c = m[N - 1] % 61137367UL;
+            i = N - 1;
+        }
+    }
+
+    //! Mersenne Twister (Matsumoto & Nishimura); BRAHE_PRNG_MARSENNE_TWISTER
+    class mt : public detail::engine_base
+    {
+    public:
+        explicit mt(const std::uint32_t seed = 0) { this->seed(seed); }
+        mt(mt &&) noexcept = default;
+        mt & operator = (mt &&) noexcept = default;
+
+        void seed(const std::uint32_t seed)
+        {
+            m_[0] = detail::resolve_seed(seed);
+
+            for (std::size_t k = 1; k < N; ++k)
+                m_[k] = detail::knuth(m_[k - 1], static_cast<std::uint32_t>(k));
+
+            i_ = N;
+        }
+
+        result_type operator () () noexcept
+        {
+            if (i_ >= N)
+                twist();
+
+            result_type y = m_[i_++];
+
+            y ^= (y >> 11);
+            y ^= (y <<  7) & 0x9d2c5680UL;
+            y ^= (y << 15) & 0xefc60000UL;
+            y ^= (y >> 18);
+
+            return y;
+        }
+
+        void discard(unsigned long long z) noexcept
+        {
+            for (; z > 0; --z)
+                (*this)();
+        }
+
+    private:
+        static constexpr std::size_t N = 624;
+        static constexpr std::size_t M = 397;
+
+        void twist() noexcept
+        {
+            constexpr std::uint32_t upper = 0x80000000UL;
+            constexpr std::uint32_t lower = 0x7fffffffUL;
+            constexpr std::uint32_t mag01[2] = { 0, 0x9908b0dfUL };
+
+            std::size_t kk = 0;
+            std::uint32_t y;
+
+            for (; kk < N - M; ++kk)
+            {
+                y = (m_[kk] & upper) | (m_[kk + 1] & lower);
+                m_[kk] = m_[kk + M] ^ (y >> 1) ^ mag01[y & 0x1];
+            }
+
+            for (; kk < N - 1; ++kk)
+            {
+                y = (m_[kk] & upper) | (m_[kk + 1] & lower);
+                m_[kk] = m_[kk + M - N] ^ (y >> 1) ^ mag01[y & 0x1];
+            }
+
+            y = (m_[N - 1] & upper) | (m_[0] & lower);
+            m_[N - 1] = m_[M - 1] ^ (y >> 1) ^ mag01[y & 0x1];
+
+            i_ = 0;
+        }
+
+        std::array<std::uint32_t, N> m_;
+        std::size_t i_;
+    };
+
+    //! Keep It Simple Stupid (Marsaglia); BRAHE_PRNG_KISS
+    class kiss : public detail::engine_base
+    {
+    public:
+        explicit kiss(const std::uint32_t seed = 0) { this->seed(seed); }
+        kiss(kiss &&) noexcept = default;
+        kiss & operator = (kiss &&) noexcept = default;
+
+        void seed(const std::uint32_t seed)
+        {
+            constexpr std::uint32_t K = 1812433253UL;
+            const std::uint32_t s = detail::resolve_seed(seed);
+
+            m_[0] = K * (s ^ (s >> 30)) + 1;
+            m_[1] = K * (m_[0] ^ (m_[0] >> 30)) + 2;
+            m_[2] = K * (m_[1] ^ (m_[1] >> 30)) + 3;
+            m_[3] = K * (m_[2] ^ (m_[2] >> 30)) + 5;
+        }
+
+        result_type operator () () noexcept
+        {
+            constexpr std::uint64_t A = 698769069ULL;
+
+            m_[1] = 69069 * m_[1] + 12345;
+            m_[2] ^= (m_[2] << 13);
+            m_[2] ^= (m_[2] >> 17);
+            m_[2] ^= (m_[2] <<  5);
+
+            const std::uint64_t temp = A * m_[3] + m_[0];
+            m_[0] = static_cast<std::uint32_t>(temp >> 32);
+            m_[3] = static_cast<std::uint32_t>(temp);
+
+            return m_[1] + m_[2] + m_[3];
+        }
+
+        void discard(unsigned long long z) noexcept
+        {
+            for (; z > 0; --z)
+                (*this)();
+        }
+
+    private:
+        std::array<std::uint32_t, 4> m_;
+    };
+
+    //! Multiply-with-carry, lag 1038 (Marsaglia); BRAHE_PRNG_MWC1038
+    class mwc1038 : public detail::engine_base
+    {
+    public:
+        explicit mwc1038(const std::uint32_t seed = 0) { this->seed(seed); }
+        mwc1038(mwc1038 &&) noexcept = default;
+        mwc1038 & operator = (mwc1038 &&) noexcept = default;
+
+        void seed(const std::uint32_t seed)
+        {
+            detail::mwc_seed(m_, c_, i_, detail::resolve_seed(seed));
+        }
+
+        result_type operator () () noexcept
+        {
+            constexpr std::uint64_t A = 611373678ULL;
+
+            const std::uint64_t temp = A * m_[i_] + c_;
+            c_ = temp >> 32;
+
+            if (--i_)
+                return m_[i_] = static_cast<std::uint32_t>(temp);
+
+            i_ = N - 1;
+            return m_[0] = static_cast<std::uint32_t>(temp);
+        }
+
+        void discard(unsigned long long z) noexcept
+        {
+            for (; z > 0; --z)
+                (*this)();
+        }
+
+    private:
+        static constexpr std::size_t N = 1038;
+
+        std::array<std::uint32_t, N> m_;
+        std::uint64_t c_;
+        std::size_t i_;
+    };
+
+    //! Complementary multiply-with-carry, lag 4096 (Marsaglia); BRAHE_PRNG_CMWC4096
+    class cmwc4096 : public detail::engine_base
+    {
+    public:
+        explicit cmwc4096(const std::uint32_t seed = 0) { this->seed(seed); }
+        cmwc4096(cmwc4096 &&) noexcept = default;
+        cmwc4096 & operator = (cmwc4096 &&) noexcept = default;
+
+        void seed(const std::uint32_t seed)
+        {
+            detail::mwc_seed(m_, c_, i_, detail::resolve_seed(seed));
+        }
+
+        result_type operator () () noexcept
+        {
+            constexpr std::uint64_t A = 18782ULL;
+            constexpr std::uint32_t R = 0xfffffffeUL;
+
+            i_ = (i_ + 1) & 4095;
+
+            const std::uint64_t temp = A * m_[i_] + c_;
+            c_ = temp >> 32;
+
+            std::uint32_t x = static_cast<std::uint32_t>(temp + c_);
+
+            if (x < c_)
+            {
+                ++x;
+                ++c_;
+            }
+
+            return m_[i_] = R - x;
+        }
+
+        void discard(unsigned long long z) noexcept
+        {
+            for (; z > 0; --z)
+                (*this)();
+        }
+
+    private:
+        std::array<std::uint32_t, 4096> m_;
+        std::uint64_t c_;
+        std::size_t i_;
+    };
+
+    //! Indirect, Shift, Accumulate, Add, and Count (Jenkins); BRAHE_PRNG_ISAAC
+    class isaac : public detail::engine_base
+    {
+    public:
+        explicit isaac(const std::uint32_t seed = 0) { this->seed(seed); }
+        isaac(isaac &&) noexcept = default;
+        isaac & operator = (isaac &&) noexcept = default;
+
+        void seed(const std::uint32_t seed)
+        {
+            std::uint32_t v[8];
+
+            a_ = b_ = c_ = 0;
+            results_.fill(0);
+            mem_.fill(0);
+
+            const std::uint32_t s = detail::resolve_seed(seed);
+
+            for (std::uint32_t & x : v)
+                x = s;
+
+            for (int k = 0; k < 4; ++k)
+                mix(v);
+
+            for (int pass = 0; pass < 2; ++pass)
+            {
+                const std::array<std::uint32_t, 256> & from = (pass == 0) ? results_ : mem_;
+
+                for (std::size_t k = 0; k < 256; k += 8)
+                {
+                    for (std::size_t j = 0; j < 8; ++j)
+                        v[j] += from[k + j];
+
+                    mix(v);
+
+                    for (std::size_t j = 0; j < 8; ++j)
+                        mem_[k + j] = v[j];
+                }
+            }
+
+            batch();
+        }
+
+        result_type operator () () noexcept
+        {
+            const result_type result = results_[i_];
+
+            if (i_ < 255)
+                ++i_;
+            else
+                batch();
+
+            return result;
+        }
+
+        void discard(unsigned long long z) noexcept
+        {
+            for (; z > 0; --z)
+                (*this)();
+        }
+
+    private:
+        static void mix(std::uint32_t (& v)[8]) noexcept
+        {
+            v[0] ^= v[1] << 11; v[3] += v[0]; v[1] += v[2];
+            v[1] ^= v[2] >>  2; v[4] += v[1]; v[2] += v[3];
+            v[2] ^= v[3] <<  8; v[5] += v[2]; v[3] += v[4];
+            v[3] ^= v[4] >> 16; v[6] += v[3]; v[4] += v[5];
+            v[4] ^= v[5] << 10; v[7] += v[4]; v[5] += v[6];
+            v[5] ^= v[6] >>  4; v[0] += v[5]; v[6] += v[7];
+            v[6] ^= v[7] <<  8; v[1] += v[6]; v[7] += v[0];
+            v[7] ^= v[0] >>  9; v[2] += v[7]; v[0] += v[1];
+        }
+
+        void batch() noexcept
+        {
+            ++c_;
+            b_ += c_;
+            i_ = 0;
+
+            for (std::size_t k = 0; k < 256; ++k)
+            {
+                const std::uint32_t x = mem_[k];
+
+                switch (k % 4)
+                {
+                    case 0: a_ ^= (a_ << 13); break;
+                    case 1: a_ ^= (a_ >>  6); break;
+                    case 2: a_ ^= (a_ <<  2); break;
+                    case 3: a_ ^= (a_ >> 16); break;
+                }
+
+                a_ = mem_[(k + 128) % 256] + a_;
+
+                const std::uint32_t y = static_cast<std::uint32_t>(mem_[(x >> 2) % 256] + a_ + b_);
+                mem_[k] = y;
+                b_ = static_cast<std::uint32_t>(mem_[(y >> 10) % 256] + x);
+                results_[k] = static_cast<std::uint32_t>(b_);
+            }
+        }
+
+        std::array<std::uint32_t, 256> results_;
+        std::array<std::uint32_t, 256> mem_;
+
+        // size_t, as in prng.c, whose wider accumulator feeds back through the shifts
+        std::size_t a_, b_, c_;
+        std::size_t i_;
+    };
+}
+
+#endif
@@ -0,0 +1,416 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+#include "mathtools.h"
+#include "internal.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+    A mergeable quantile sketch, after Karnin, Lang, and Liberty, "Optimal
+    Quantile Approximation in Streams" (2016). Items enter level 0; when a
+    level fills, it is sorted and every other item, starting at a random
+    offset, is promoted to the next level with twice the weight. Lower levels
+    get geometrically smaller capacities (a factor of 2/3 per level) so
+    memory grows only with the logarithm of the stream length. The rank
+    error is roughly 1.7/k with high probability.
+*/
+
+// capacity of level h when the sketch has m_levels levels
+static size_t level_capacity(const brahe_quantile_sketch_t * sketch, const size_t h)
+{
+    size_t depth = sketch->m_levels - h - 1;
+    double capacity = (double)sketch->m_k;
+
+    while (depth-- > 0)
+        capacity *= 2.0 / 3.0;
+
+    return (size_t)ceil(capacity) + 1;
+}
+
+// add a level at the top and recompute the size limit
+static bool grow(brahe_quantile_sketch_t * sketch)
+{
+    size_t h;
+
+    if (sketch->m_levels == sketch->m_level_alloc)
+    {
+        size_t alloc = sketch->m_level_alloc * 2;
+        brahe_sketch_level_t * levels = (brahe_sketch_level_t *)brahe_allocate(&sketch->m_allocator, sizeof(brahe_sketch_level_t) * alloc, BRAHE_DEFAULT_ALIGN);
+
+        if (levels == NULL)
+            return false;
+
+        memcpy(levels, sketch->m_level, sizeof(brahe_sketch_level_t) * sketch->m_levels);
+        brahe_release(&sketch->m_allocator, sketch->m_level);
+        sketch->m_level = levels;
+        sketch->m_level_alloc = alloc;
+    }
+
+    sketch->m_level[sketch->m_levels].m_items = NULL;
+    sketch->m_level[sketch->m_levels].m_size  = 0;
+    sketch->m_level[sketch->m_levels].m_alloc = 0;
+    ++sketch->m_levels;
+
+    sketch->m_max_size = 0;
+
+    for (h = 0; h < sketch->m_levels; ++h)
+        sketch->m_max_size += level_capacity(sketch, h);
+
+    return true;
+}
+
+// make room for n more items in a level
+static bool reserve(const brahe_allocator_t * allocator, brahe_sketch_level_t * level, const size_t n)
+{
+    if (level->m_size + n > level->m_alloc)
+    {
+        size_t alloc = (level->m_alloc > 0) ? level->m_alloc * 2 : 16;
+        double * items;
+
+        while (alloc < level->m_size + n)
+            alloc *= 2;
+
+        items = (double *)brahe_allocate(allocator, sizeof(double) * alloc, BRAHE_DEFAULT_ALIGN);
+
+        if (items == NULL)
+            return false;
+
+        if (level->m_size > 0)
+            memcpy(items, level->m_items, sizeof(double) * level->m_size);
+
+        brahe_release(allocator, level->m_items);
+        level->m_items = items;
+        level->m_alloc = alloc;
+    }
+
+    return true;
+}
+
+static int compare_double(const void * a, const void * b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// one random bit, from a xorshift generator private to the sketch
+static size_t random_bit(brahe_quantile_sketch_t * sketch)
+{
+    sketch->m_random ^= sketch->m_random << 13;
+    sketch->m_random ^= sketch->m_random >> 7;
+    sketch->m_random ^= sketch->m_random << 17;
+    return (size_t)(sketch->m_random >> 63);
+}
+
+// compact the lowest full level into the one above it
+static bool compress(brahe_quantile_sketch_t * sketch)
+{
+    size_t h, i, offset, pairs;
+
+    for (h = 0; h < sketch->m_levels; ++h)
+    {
+        brahe_sketch_level_t * level = &sketch->m_level[h];
+
+        if (level->m_size >= level_capacity(sketch, h))
+        {
+            if ((h + 1 == sketch->m_levels) && !grow(sketch))
+                return false;
+
+            // grow may have moved the levels
+            level = &sketch->m_level[h];
+            pairs = level->m_size / 2;
+
+            if (!reserve(&sketch->m_allocator, &sketch->m_level[h + 1], pairs))
+                return false;
+
+            qsort(level->m_items, level->m_size, sizeof(double), compare_double);
+            offset = random_bit(sketch);
+
+            for (i = 0; i < pairs; ++i)
+                sketch->m_level[h + 1].m_items[sketch->m_level[h + 1].m_size++] = level->m_items[2 * i + offset];
+
+            // an odd item out stays behind
+            if (level->m_size % 2 == 1)
+                level->m_items[0] = level->m_items[level->m_size - 1];
+
+            level->m_size %= 2;
+            sketch->m_size -= pairs;
+            return true;
+        }
+    }
+
+    return true;
+}
+
+bool brahe_quantile_sketch_init(brahe_quantile_sketch_t * sketch, const size_t k)
+{
+    bool result = false;
+
+    if ((sketch != NULL) && (k >= 8))
+    {
+        sketch->m_allocator = *brahe_allocator();
+        sketch->m_level = (brahe_sketch_level_t *)brahe_allocate(&sketch->m_allocator, sizeof(brahe_sketch_level_t) * 8, BRAHE_DEFAULT_ALIGN);
+
+        if (sketch->m_level != NULL)
+        {
+            sketch->m_k = k;
+            sketch->m_levels = 0;
+            sketch->m_level_alloc = 8;
+            sketch->m_size = 0;
+            sketch->m_count = 0;
+            sketch->m_random = 0x9E3779B97F4A7C15ULL;
+            sketch->m_min = 0.0;
+            sketch->m_max = 0.0;
+            result = grow(sketch);
+        }
+    }
+
+    return result;
+}
+
+void brahe_quantile_sketch_free(brahe_quantile_sketch_t * sketch)
+{
+    size_t h;
+
+    if ((sketch != NULL) && (sketch->m_level != NULL))
+    {
+        for (h = 0; h < sketch->m_levels; ++h)
+            brahe_release(&sketch->m_allocator, sketch->m_level[h].m_items);
+
+        brahe_release(&sketch->m_allocator, sketch->m_level);
+        sketch->m_level = NULL;
+        sketch->m_levels = 0;
+        sketch->m_size = 0;
+        sketch->m_count = 0;
+    }
+}
+
+bool brahe_quantile_sketch_add(brahe_quantile_sketch_t * sketch, const double x)
+{
+    brahe_sketch_level_t * level;
+
+    if ((sketch == NULL) || (sketch->m_level == NULL))
+        return false;
+
+    level = &sketch->m_level[0];
+
+    if (!reserve(&sketch->m_allocator, level, 1))
+        return false;
+
+    level->m_items[level->m_size++] = x;
+
+    if (sketch->m_count == 0)
+    {
+        sketch->m_min = x;
+        sketch->m_max = x;
+    }
+    else
+    {
+        if (x < sketch->m_min) sketch->m_min = x;
+        if (x > sketch->m_max) sketch->m_max = x;
+    }
+
+    ++sketch->m_count;
+    ++sketch->m_size;
+
+    if (sketch->m_size >= sketch->m_max_size)
+        return compress(sketch);
+
+    return true;
+}
+
+bool brahe_quantile_sketch_add_n(brahe_quantile_sketch_t * sketch, const double * data, const size_t n)
+{
+    size_t i;
+
+    if (data == NULL)
+        return false;
+
+    for (i = 0; i < n; ++i)
+    {
+        if (!brahe_quantile_sketch_add(sketch, data[i]))
+            return false;
+    }
+
+    return true;
+}
+
+bool brahe_quantile_sketch_merge(brahe_quantile_sketch_t * sketch, const brahe_quantile_sketch_t * other)
+{
+    size_t h, i;
+
+    if ((sketch == NULL) || (sketch->m_level == NULL) || (other == NULL) || (other->m_level == NULL))
+        return false;
+
+    if (other->m_count == 0)
+        return true;
+
+    while (sketch->m_levels < other->m_levels)
+    {
+        if (!grow(sketch))
+            return false;
+    }
+
+    // items keep the weight of their level
+    for (h = 0; h < other->m_levels; ++h)
+    {
+        brahe_sketch_level_t * level = &sketch->m_level[h];
+        const brahe_sketch_level_t * from = &other->m_level[h];
+
+        if (!reserve(&sketch->m_allocator, level, from->m_size))
+            return false;
+
+        for (i = 0; i < from->m_size; ++i)
+            level->m_items[level->m_size++] = from->m_items[i];
+
+        sketch->m_size += from->m_size;
+    }
+
+    if (sketch->m_count == 0)
+    {
+        sketch->m_min = other->m_min;
+        sketch->m_max = other->m_max;
+    }
+    else
+    {
+        if (other->m_min < sketch->m_min) sketch->m_min = other->m_min;
+        if (other->m_max > sketch->m_max) sketch->m_max = other->m_max;
+    }
+
+    sketch->m_count += other->m_count;
+
+    while (sketch->m_size >= sketch->m_max_size)
+    {
+        size_t before = sketch->m_size;
+
+        if (!compress(sketch) || (sketch->m_size == before))
+            break;
+    }
+
+    return true;
+}
+
+uint64_t brahe_quantile_sketch_count(const brahe_quantile_sketch_t * sketch)
+{
+    return (sketch != NULL) ? sketch->m_count : 0;
+}
+
+// an item retained by the sketch, with the number of stream items it represents
+typedef struct
+{
+    double   value;
+    uint64_t weight;
+}
+weighted_item;
+
+static int compare_weighted(const void * a, const void * b)
+{
+    return compare_double(&((const weighted_item *)a)->value, &((const weighted_item *)b)->value);
+}
+
+double brahe_quantile_sketch_query(const brahe_quantile_sketch_t * sketch, const double q)
+{
+#if defined(_MSC_VER)
+    double result = 0.0;
+#else
+    double result = NAN;
+#endif
+    size_t h, i, n = 0;
+    weighted_item * items;
+    uint64_t target, cumulative = 0;
+
+    if ((sketch == NULL) || (sketch->m_count == 0) || !(q >= 0.0) || !(q <= 1.0))
+        return result;
+
+    // the extremes are known exactly
+    if (q == 0.0)
+        return sketch->m_min;
+
+    if (q == 1.0)
+        return sketch->m_max;
+
+    items = (weighted_item *)brahe_allocate(&sketch->m_allocator, sizeof(weighted_item) * sketch->m_size, BRAHE_DEFAULT_ALIGN);
+
+    if (items == NULL)
+        return result;
+
+    for (h = 0; h < sketch->m_levels; ++h)
+    {
+        for (i = 0; i < sketch->m_level[h].m_size; ++i)
+        {
+            items[n].value = sketch->m_level[h].m_items[i];
+            items[n].weight = (uint64_t)1 << h;
+            ++n;
+        }
+    }
+
+    qsort(items, n, sizeof(weighted_item), compare_weighted);
+
+    // smallest retained item whose estimated rank reaches q
+    target = (uint64_t)ceil(q * (double)sketch->m_count);
+    result = items[n - 1].value;
+
+    for (i = 0; i < n; ++i)
+    {
+        cumulative += items[i].weight;
+
+        if (cumulative >= target)
+        {
+            result = items[i].value;
+            break;
+        }
+    }
+
+    brahe_release(&sketch->m_allocator, items);
+    return result;
+}
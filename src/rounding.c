@@ -51,6 +51,8 @@
 */
 
 #include "mathtools.h"
+#include "dispatch.h"
+#include <string.h>
 
 //  Rounds a value to nearest integer, rounding to even for exact fractions of 0.5.
 double brahe_round_nearest(const double x)
@@ -91,8 +93,9 @@ double brahe_sigdig(const double x, const uint16_t n)
 {
     double scale_factor, result;
 
-    // is asking for no digits, or more digits than in double, simply return x
-    if ((n == 0) || (n > DBL_DIG))
+    // is asking for no digits, or more digits than in double, simply return x;
+    // zero, infinity and NaN have no digits to round
+    if ((n == 0) || (n > DBL_DIG) || (x == 0.0) || !(fabs(x) <= DBL_MAX))
         result = x;
     else
     {
@@ -106,3 +109,141 @@ double brahe_sigdig(const double x, const uint16_t n)
 
     return result;
 }
+
+/*
+    Array versions. Both produce exactly what the scalar functions produce.
+    Rounding uses the hardware's round-to-nearest-even, either SSE4.1
+    roundpd or, with SSE2 alone, adding and subtracting 2^52 (which relies
+    on the default rounding mode). brahe_sigdig_v looks up the same powers
+    of ten that pow() gives brahe_sigdig, and finds the decimal exponent
+    from the binary one, deferring to log10 for values so close to a power
+    of ten that its rounding decides the answer.
+*/
+
+bool brahe_round_nearest_v(const double * in, double * out, const size_t n)
+{
+    if ((in == NULL) || (out == NULL))
+        return false;
+
+    brahe_kernels()->m_round_nearest(in, out, n);
+    return true;
+}
+
+// powers of ten from 10^-POW10_BIAS, as computed by pow()
+#define POW10_BIAS 308
+#define POW10_COUNT (POW10_BIAS + DBL_MAX_10_EXP + DBL_DIG + 1)
+
+static double pow10_table[POW10_COUNT];
+
+static void build_pow10_table(void)
+{
+    int i;
+
+    for (i = 0; i < POW10_COUNT; ++i)
+        pow10_table[i] = pow(10.0, (double)(i - POW10_BIAS));
+}
+
+#if defined(BRAHE_HAVE_PTHREADS)
+static pthread_once_t pow10_once = PTHREAD_ONCE_INIT;
+#else
+static bool pow10_ready = false;
+#endif
+
+static void ensure_pow10_table(void)
+{
+#if defined(BRAHE_HAVE_PTHREADS)
+    pthread_once(&pow10_once, build_pow10_table);
+#else
+    if (!pow10_ready)
+    {
+        build_pow10_table();
+        pow10_ready = true;
+    }
+#endif
+}
+
+// floor(log10(ax)) for a positive normal value, matching what log10 gives
+static int decimal_exponent(const double ax)
+{
+    // an estimate from the binary exponent is exact or one too small
+    uint64_t bits;
+    int e;
+
+    memcpy(&bits, &ax, sizeof(bits));
+    e = (int)floor((double)((int)(bits >> 52) - 1023) * 0.30102999566398120);
+
+    if (ax >= pow10_table[e + 1 + POW10_BIAS])
+        ++e;
+
+    // near a power of ten, the answer depends on how log10 rounds
+    if ((ax >= pow10_table[e + 1 + POW10_BIAS] * (1.0 - 4.0 * DBL_EPSILON))
+    ||  (ax <= pow10_table[e + POW10_BIAS] * (1.0 + 4.0 * DBL_EPSILON)))
+        e = (int)floor(log10(ax));
+
+    return e;
+}
+
+// values handled per pass
+#define SIGDIG_BLOCK 256
+
+bool brahe_sigdig_v(const double * in, double * out, const size_t n, const uint16_t digits)
+{
+    size_t i, j, count, special_n;
+    size_t special[SIGDIG_BLOCK];
+    double special_x[SIGDIG_BLOCK];
+    double scale[SIGDIG_BLOCK];
+
+    if ((in == NULL) || (out == NULL))
+        return false;
+
+    if ((digits == 0) || (digits > DBL_DIG))
+    {
+        if (out != in)
+            memmove(out, in, sizeof(double) * n);
+
+        return true;
+    }
+
+    ensure_pow10_table();
+
+    for (i = 0; i < n; i += count)
+    {
+        count = (n - i < SIGDIG_BLOCK) ? n - i : SIGDIG_BLOCK;
+        special_n = 0;
+
+        // find scale factors; zero, subnormals, infinity and NaN go to the scalar function
+        for (j = 0; j < count; ++j)
+        {
+            double ax = fabs(in[i + j]);
+
+            if ((ax >= DBL_MIN) && (ax <= DBL_MAX))
+                scale[j] = pow10_table[(int)digits - 1 - decimal_exponent(ax) + POW10_BIAS];
+            else
+            {
+                // kept aside, since out may be the same array as in
+                scale[j] = 1.0;
+                special[special_n] = j;
+                special_x[special_n++] = in[i + j];
+            }
+        }
+
+        // scale up, round, and scale down
+        j = 0;
+
+#if defined(BRAHE_HAVE_SSE2)
+        for (; j + 2 <= count; j += 2)
+        {
+            __m128d s = _mm_loadu_pd(scale + j);
+            _mm_storeu_pd(out + i + j, _mm_div_pd(brahe_round_pd(_mm_mul_pd(_mm_loadu_pd(in + i + j), s)), s));
+        }
+#endif
+
+        for (; j < count; ++j)
+            out[i + j] = brahe_round_nearest(in[i + j] * scale[j]) / scale[j];
+
+        for (j = 0; j < special_n; ++j)
+            out[i + special[j]] = brahe_sigdig(special_x[j], digits);
+    }
+
+    return true;
+}
@@ -0,0 +1,327 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+#include "mathtools.h"
+#include "internal.h"
+#include "prng.h"
+#include <string.h>
+#include <stdlib.h>
+
+/*
+    Streaming signal generator. Every term keeps its position within the
+    current cycle as a fraction in [0,1), so phase stays exact however long
+    the stream runs. Sines and chirps are advanced by rotation within a
+    block and restarted from exact values at the start of the next one;
+    a chirp also rotates its step, so its frequency changes linearly
+    without any per-sample sin() calls.
+*/
+
+// samples generated between exact evaluations
+#define SIGNAL_BLOCK 256
+
+#define TWO_PI (2.0 * BRAHE_PI)
+
+typedef enum
+{
+    SIGNAL_SINE = 0,
+    SIGNAL_SQUARE,
+    SIGNAL_SAW,
+    SIGNAL_CHIRP
+}
+signal_shape_t;
+
+// reduce a phase to [0,1)
+static double wrap_phase(const double p)
+{
+    return p - floor(p);
+}
+
+bool brahe_signal_init(brahe_signal_t * signal, const size_t max_terms, const uint32_t seed)
+{
+    if ((signal == NULL) || (max_terms == 0))
+        return false;
+
+    signal->m_allocator = *brahe_allocator();
+    signal->m_terms = (brahe_signal_term_t *)brahe_allocate(&signal->m_allocator, sizeof(brahe_signal_term_t) * max_terms, BRAHE_DEFAULT_ALIGN);
+    signal->m_prng  = brahe_allocate(&signal->m_allocator, sizeof(brahe_prng_state_t), BRAHE_DEFAULT_ALIGN);
+
+    if ((signal->m_terms == NULL) || (signal->m_prng == NULL)
+    ||  !brahe_prng_init((brahe_prng_state_t *)signal->m_prng, BRAHE_PRNG_KISS, seed))
+    {
+        brahe_release(&signal->m_allocator, signal->m_terms);
+        brahe_release(&signal->m_allocator, signal->m_prng);
+        signal->m_terms = NULL;
+        signal->m_prng = NULL;
+        return false;
+    }
+
+    signal->m_capacity = max_terms;
+    signal->m_count = 0;
+    signal->m_position = 0;
+    signal->m_noise_type = BRAHE_NOISE_UNIFORM;
+    signal->m_noise = 0.0;
+
+    return true;
+}
+
+void brahe_signal_free(brahe_signal_t * signal)
+{
+    if (signal != NULL)
+    {
+        if (signal->m_prng != NULL)
+            brahe_prng_free((brahe_prng_state_t *)signal->m_prng);
+
+        brahe_release(&signal->m_allocator, signal->m_prng);
+        brahe_release(&signal->m_allocator, signal->m_terms);
+        signal->m_prng = NULL;
+        signal->m_terms = NULL;
+        signal->m_count = 0;
+        signal->m_capacity = 0;
+    }
+}
+
+// append a term; the wavelength follows brahe_wave_factor_t, advancing PI / wavelength radians per sample
+static bool add_term(brahe_signal_t * signal, const int shape, const double amplitude,
+                     const double wavelength, const double end_wavelength, const uint64_t sweep, const double phase)
+{
+    brahe_signal_term_t * term;
+
+    if ((signal == NULL) || (signal->m_terms == NULL) || (signal->m_count == signal->m_capacity)
+    ||  !(wavelength > 0.0) || !(end_wavelength > 0.0))
+        return false;
+
+    term = &signal->m_terms[signal->m_count++];
+    term->m_shape       = shape;
+    term->m_amplitude   = amplitude;
+    term->m_phase       = wrap_phase(phase / TWO_PI);
+    term->m_start_step  = 0.5 / wavelength;
+    term->m_end_step    = 0.5 / end_wavelength;
+    term->m_sweep       = sweep;
+    term->m_sweep_pos   = 0;
+
+    return true;
+}
+
+bool brahe_signal_add_sine(brahe_signal_t * signal, const brahe_wave_factor_t * factor, const double phase)
+{
+    return (factor != NULL) && add_term(signal, SIGNAL_SINE, factor->amplitude, factor->wavelength, factor->wavelength, 0, phase);
+}
+
+bool brahe_signal_add_square(brahe_signal_t * signal, const brahe_wave_factor_t * factor, const double phase)
+{
+    return (factor != NULL) && add_term(signal, SIGNAL_SQUARE, factor->amplitude, factor->wavelength, factor->wavelength, 0, phase);
+}
+
+bool brahe_signal_add_saw(brahe_signal_t * signal, const brahe_wave_factor_t * factor, const double phase)
+{
+    return (factor != NULL) && add_term(signal, SIGNAL_SAW, factor->amplitude, factor->wavelength, factor->wavelength, 0, phase);
+}
+
+bool brahe_signal_add_chirp(brahe_signal_t * signal, const double amplitude, const double start_wavelength,
+                            const double end_wavelength, const uint64_t sweep)
+{
+    return (sweep > 0) && add_term(signal, SIGNAL_CHIRP, amplitude, start_wavelength, end_wavelength, sweep, 0.0);
+}
+
+bool brahe_signal_set_noise(brahe_signal_t * signal, const brahe_noise_type_t type, const double noise)
+{
+    if ((signal == NULL) || (type > BRAHE_NOISE_MULTIPLICATIVE))
+        return false;
+
+    signal->m_noise_type = type;
+    signal->m_noise = noise;
+
+    return true;
+}
+
+uint64_t brahe_signal_position(const brahe_signal_t * signal)
+{
+    return (signal != NULL) ? signal->m_position : 0;
+}
+
+// add a sine whose step grows by delta cycles per sample; delta is zero for a plain sine
+static double rotate_block(double * out, const size_t count, const double amplitude,
+                           const double phase, const double step, const double delta)
+{
+    size_t i;
+    double t;
+    double zr = cos(TWO_PI * phase) * amplitude;
+    double zi = sin(TWO_PI * phase) * amplitude;
+    double wr = cos(TWO_PI * step);
+    double wi = sin(TWO_PI * step);
+
+    if (delta == 0.0)
+    {
+        for (i = 0; i < count; ++i)
+        {
+            out[i] += zi;
+            t  = zr * wr - zi * wi;
+            zi = zr * wi + zi * wr;
+            zr = t;
+        }
+    }
+    else
+    {
+        double dr = cos(TWO_PI * delta);
+        double di = sin(TWO_PI * delta);
+
+        for (i = 0; i < count; ++i)
+        {
+            out[i] += zi;
+            t  = zr * wr - zi * wi;
+            zi = zr * wi + zi * wr;
+            zr = t;
+            t  = wr * dr - wi * di;
+            wi = wr * di + wi * dr;
+            wr = t;
+        }
+    }
+
+    // the phase after count samples: the steps form an arithmetic series
+    return wrap_phase(phase + (double)count * step + delta * 0.5 * (double)count * (double)(count - 1));
+}
+
+// add a naive (not band-limited) square or sawtooth wave
+static double shape_block(double * out, const size_t count, const int shape, const double amplitude,
+                          const double phase, const double step)
+{
+    size_t i;
+    double p = phase;
+
+    if (shape == SIGNAL_SQUARE)
+    {
+        for (i = 0; i < count; ++i)
+        {
+            out[i] += (p < 0.5) ? amplitude : -amplitude;
+            p += step;
+            p -= (double)(p >= 1.0);
+        }
+    }
+    else
+    {
+        for (i = 0; i < count; ++i)
+        {
+            out[i] += amplitude * (2.0 * p - 1.0);
+            p += step;
+            p -= (double)(p >= 1.0);
+        }
+    }
+
+    // rounding accumulates in the running phase, so start the next block afresh
+    return wrap_phase(phase + (double)count * step);
+}
+
+static void term_block(brahe_signal_term_t * term, double * out, size_t count)
+{
+    size_t part;
+    double delta;
+
+    switch (term->m_shape)
+    {
+        case SIGNAL_SINE:
+            term->m_phase = rotate_block(out, count, term->m_amplitude, term->m_phase, term->m_start_step, 0.0);
+            break;
+
+        case SIGNAL_SQUARE:
+        case SIGNAL_SAW:
+            term->m_phase = shape_block(out, count, term->m_shape, term->m_amplitude, term->m_phase, term->m_start_step);
+            break;
+
+        case SIGNAL_CHIRP:
+            delta = (term->m_end_step - term->m_start_step) / (double)term->m_sweep;
+
+            // the sweep restarts at its first frequency; keep blocks within one sweep
+            while (count > 0)
+            {
+                part = (term->m_sweep - term->m_sweep_pos < (uint64_t)count) ? (size_t)(term->m_sweep - term->m_sweep_pos) : count;
+
+                term->m_phase = rotate_block(out, part, term->m_amplitude, term->m_phase,
+                                             term->m_start_step + delta * (double)term->m_sweep_pos, delta);
+
+                term->m_sweep_pos += part;
+
+                if (term->m_sweep_pos == term->m_sweep)
+                    term->m_sweep_pos = 0;
+
+                out += part;
+                count -= part;
+            }
+
+            break;
+    }
+}
+
+bool brahe_signal_generate(brahe_signal_t * signal, double * out, const size_t n)
+{
+    size_t i, t, count;
+
+    if ((signal == NULL) || (signal->m_terms == NULL) || (out == NULL))
+        return false;
+
+    memset(out, 0, sizeof(double) * n);
+
+    // block by block, so the output stays in cache while each term is added
+    for (i = 0; i < n; i += SIGNAL_BLOCK)
+    {
+        count = (n - i < SIGNAL_BLOCK) ? n - i : SIGNAL_BLOCK;
+
+        for (t = 0; t < signal->m_count; ++t)
+            term_block(&signal->m_terms[t], out + i, count);
+    }
+
+    if (signal->m_noise != 0.0)
+        brahe_add_noise_r((brahe_prng_state_t *)signal->m_prng, out, n, signal->m_noise_type, signal->m_noise);
+
+    signal->m_position += n;
+
+    return true;
+}
@@ -50,131 +50,357 @@
           http:www.coyotegulch.com
 */
 
-#include "mathtools.h"
-#include <stdlib.h>
-#include <string.h>
+#include "dispatch.h"
 
-static int bitrev(const int j, const int nu)
+// smallest power of two of at least n
+static size_t pow2_size(const size_t n)
 {
-    int j2;
-    int j1 = j;
-    int k = 0;
-    int i;
+    size_t n2 = 1;
 
-    for (i = 1; i <= nu; i++)
-    {
-        j2 = j1 / 2;
-        k = 2 * k + j1 - 2 * j2;
-        j1 = j2;
+    while ((n2 < n) && (n2 <= ((size_t)-1) / 2))
+        n2 <<= 1;
+
+    return n2;
+}
+
+// magnitudes of the first n2 / 2 terms of the transform of x, zero-padded
+// from n to n2 values; work holds 4 * n2 elements. Written once for both
+// precisions; the twiddle factors are computed in double either way.
+#define DEFINE_FFT_MAGNITUDES(name, real, pass)                                         \
+    static void name(const real * x, const size_t n, const size_t n2, real * mag, real * work) \
+    {                                                                                   \
+        const brahe_kernels_t * kern = brahe_kernels();                                 \
+        size_t i, j, h, bit, quarter;                                                   \
+        real * xre = work;                                                              \
+        real * xim = work + n2;                                                         \
+        real * wr  = work + 2 * n2;                                                     \
+        real * wi  = work + 3 * n2;                                                     \
+        double arg;                                                                     \
+                                                                                        \
+        BRAHE_PROBE3(fft_execute, n, n2, sizeof(real));                                 \
+                                                                                        \
+        /* copy in bit-reversed order, stepping the reversed index j alongside i */     \
+        for (i = 0, j = 0; i < n2; ++i)                                                 \
+        {                                                                               \
+            xre[j] = (i < n) ? x[i] : (real)0;                                          \
+            xim[i] = 0;                                                                 \
+                                                                                        \
+            bit = n2 >> 1;                                                              \
+                                                                                        \
+            while (j & bit)                                                             \
+            {                                                                           \
+                j ^= bit;                                                               \
+                bit >>= 1;                                                              \
+            }                                                                           \
+                                                                                        \
+            j |= bit;                                                                   \
+        }                                                                               \
+                                                                                        \
+        /* twiddle factors: the pass spanning h elements uses w[h] through */           \
+        /* w[2h - 1]. The widest pass holds exp(-2 pi i k / n2) for k < n2 / 2, */      \
+        /* computed for the first quarter circle and rotated for the second; */         \
+        /* the narrower passes take every (n2 / 2h)th factor of it. */                  \
+        quarter = (n2 >= 4) ? n2 / 4 : 1;                                               \
+                                                                                        \
+        for (i = 0; i < quarter && i < n2 / 2; ++i)                                     \
+        {                                                                               \
+            arg = -BRAHE_TAU * (double)i / (double)n2;                                  \
+            wr[n2 / 2 + i] = (real)cos(arg);                                            \
+            wi[n2 / 2 + i] = (real)sin(arg);                                            \
+        }                                                                               \
+                                                                                        \
+        for (; i < n2 / 2; ++i)                                                         \
+        {                                                                               \
+            wr[n2 / 2 + i] =  wi[n2 / 2 + i - quarter];                                 \
+            wi[n2 / 2 + i] = -wr[n2 / 2 + i - quarter];                                 \
+        }                                                                               \
+                                                                                        \
+        for (h = 1; h < n2 / 2; h <<= 1)                                                \
+        {                                                                               \
+            for (j = 0; j < h; ++j)                                                     \
+            {                                                                           \
+                wr[h + j] = wr[n2 / 2 + j * (n2 / (2 * h))];                            \
+                wi[h + j] = wi[n2 / 2 + j * (n2 / (2 * h))];                            \
+            }                                                                           \
+        }                                                                               \
+                                                                                        \
+        for (h = 1; h < n2; h <<= 1)                                                    \
+            kern->pass(xre, xim, n2, h, wr + h, wi + h);                                \
+                                                                                        \
+        mag[0] = (real)(sqrt(xre[0] * xre[0] + xim[0] * xim[0]) / (double)n2);          \
+                                                                                        \
+        for (i = 1; i < n2 / 2; i++)                                                    \
+            mag[i] = (real)(2 * sqrt(xre[i] * xre[i] + xim[i] * xim[i]) / (double)n2);  \
     }
 
-    return k;
+DEFINE_FFT_MAGNITUDES(fft_magnitudes, double, m_fft_pass)
+DEFINE_FFT_MAGNITUDES(fft_magnitudes_f, float, m_fft_pass_f)
+
+size_t brahe_simple_fft_work_size(const size_t n)
+{
+    return 4 * pow2_size(n);
 }
 
-// assumes that the length of x is a power of 2
-double * brahe_simple_fft2(const double * x, const int n)
+bool brahe_simple_fft_into(const double * data, const size_t n, double * out, double * work)
 {
-    int i, l, r;
-    int k = 0;
-    int nu = (int)(log((double)n) / log(2.0)); // BRAHE_LOG_2);
-    int n2 = n / 2;
-    int nu1 = nu - 1;
-    double * xre = (double *)malloc(sizeof(double) * n);
-    double * xim = (double *)malloc(sizeof(double) * n);
-    double * mag = (double *)malloc(sizeof(double) * n / 2);
-    double tr, ti, p, arg, c, s;
-
-    if ((xre == NULL) || (xim == NULL) || (mag == NULL))
-        return NULL;
+    if ((data == NULL) || (out == NULL) || (work == NULL) || (n < 2))
+        return false;
+
+    BRAHE_METRIC_BEGIN(BRAHE_METRIC_SIMPLE_FFT, n);
+    fft_magnitudes(data, n, pow2_size(n), out, work);
+    BRAHE_METRIC_END();
+    return true;
+}
+
+bool brahe_simple_fft_into_f(const float * data, const size_t n, float * out, float * work)
+{
+    if ((data == NULL) || (out == NULL) || (work == NULL) || (n < 2))
+        return false;
+
+    BRAHE_METRIC_BEGIN(BRAHE_METRIC_SIMPLE_FFT_F, n);
+    fft_magnitudes_f(data, n, pow2_size(n), out, work);
+    BRAHE_METRIC_END();
+    return true;
+}
+
+bool brahe_simple_fft2_into(const double * data, const size_t n, double * out, double * work)
+{
+    if ((n & (n - 1)) != 0)
+        return false;
+
+    return brahe_simple_fft_into(data, n, out, work);
+}
+
+/*
+    Parallel transform. Before the pass spanning FFT_GRAIN elements, blocks
+    of that many elements are independent, so each task gathers a block in
+    bit-reversed order and runs the early passes on it while it is in cache.
+    The later passes are divided by butterfly and run with a scalar loop,
+    one parallel loop per pass. Twiddle factors and magnitudes are computed
+    by the same formulas as fft_magnitudes, in parallel.
+*/
+
+// elements per task of a parallel transform; a power of 2
+#define FFT_GRAIN 8192
 
-    for (i = 0; i < n; i++)
+typedef struct
+{
+    const double * m_x;
+    size_t         m_n;
+    size_t         m_n2;
+    size_t         m_quarter; // twiddle factors computed with cos and sin
+    size_t         m_half;    // span of the pass being run
+    double *       m_xre;
+    double *       m_xim;
+    double *       m_wr;
+    double *       m_wi;
+    double *       m_mag;
+}
+fft_job_t;
+
+// twiddle factors of the widest pass, for the first quarter circle...
+static void fft_twiddle_task(void * context, const size_t begin, const size_t end, const size_t worker)
+{
+    const fft_job_t * job = (const fft_job_t *)context;
+    size_t h = job->m_n2 / 2, i;
+    double arg;
+
+    (void)worker;
+
+    for (i = begin; i < end; ++i)
     {
-        xre[i] = x[i];
-        xim[i] = 0.0;
+        arg = -BRAHE_TAU * (double)i / (double)job->m_n2;
+        job->m_wr[h + i] = cos(arg);
+        job->m_wi[h + i] = sin(arg);
     }
+}
 
-    for (l = 1; l <= nu; l++)
-    {
-        while (k < n)
-        {
-            for (i = 1; i <= n2; i++)
-            {
-                p = bitrev(k >> nu1, nu);
-                arg = BRAHE_TAU * p / n;
-                c = cos(arg);
-                s = sin(arg);
-                tr = xre[k + n2] * c + xim[k + n2] * s;
-                ti = xim[k + n2] * c - xre[k + n2] * s;
-                xre[k + n2] = xre[k] - tr;
-                xim[k + n2] = xim[k] - ti;
-                xre[k] += tr;
-                xim[k] += ti;
-                k++;
-            }
-
-            k += n2;
-        }
+// ...and rotated for the second; elements are numbered from the quarter
+static void fft_rotate_task(void * context, const size_t begin, const size_t end, const size_t worker)
+{
+    const fft_job_t * job = (const fft_job_t *)context;
+    size_t h = job->m_n2 / 2, q = job->m_quarter, i;
 
-        k = 0;
-        nu1--;
-        n2 = n2 / 2;
+    (void)worker;
+
+    for (i = q + begin; i < q + end; ++i)
+    {
+        job->m_wr[h + i] =  job->m_wi[h + i - q];
+        job->m_wi[h + i] = -job->m_wr[h + i - q];
     }
+}
+
+// gather a block in bit-reversed order and run the passes within it
+static void fft_block_task(void * context, const size_t begin, const size_t end, const size_t worker)
+{
+    const brahe_kernels_t * kern = brahe_kernels();
+    const fft_job_t * job = (const fft_job_t *)context;
+    size_t n2 = job->m_n2, i, j, h, bit, rev;
 
-    k = 0;
+    (void)worker;
 
-    while (k < n)
+    // the element that belongs at begin, then stepping it as fft_magnitudes does
+    for (i = 0, bit = 1, rev = n2 >> 1; bit < n2; bit <<= 1, rev >>= 1)
     {
-        r = bitrev(k,nu);
+        if (begin & bit)
+            i |= rev;
+    }
+
+    for (j = begin; j < end; ++j)
+    {
+        job->m_xre[j] = (i < job->m_n) ? job->m_x[i] : 0.0;
+        job->m_xim[j] = 0.0;
 
-        if (r > k)
+        bit = n2 >> 1;
+
+        while (i & bit)
         {
-            tr = xre[k];
-            ti = xim[k];
-            xre[k] = xre[r];
-            xim[k] = xim[r];
-            xre[r] = tr;
-            xim[r] = ti;
+            i ^= bit;
+            bit >>= 1;
         }
 
-        k++;
+        i |= bit;
     }
 
-    mag[0] = sqrt(xre[0] * xre[0] + xim[0] * xim[0]) / n;
+    for (h = 1; h < end - begin; h <<= 1)
+        kern->m_fft_pass(job->m_xre + begin, job->m_xim + begin, end - begin, h, job->m_wr + h, job->m_wi + h);
+}
 
-    for (i = 1; i < n / 2; i++)
-        mag[i] = 2 * sqrt(xre[i] * xre[i] + xim[i] * xim[i]) / n;
+// butterflies [begin, end) of a pass spanning more than a block
+static void fft_pass_task(void * context, const size_t begin, const size_t end, const size_t worker)
+{
+    const fft_job_t * job = (const fft_job_t *)context;
+    const double * wr = job->m_wr + job->m_half;
+    const double * wi = job->m_wi + job->m_half;
+    double * re = job->m_xre;
+    double * im = job->m_xim;
+    size_t f, j, a, b;
+    double tr, ti;
 
-    free(xre);
-    free(xim);
+    (void)worker;
 
-    return mag;
+    for (f = begin; f < end; ++f)
+    {
+        j = f & (job->m_half - 1);
+        a = ((f - j) << 1) + j;
+        b = a + job->m_half;
+
+        tr = re[b] * wr[j] - im[b] * wi[j];
+        ti = re[b] * wi[j] + im[b] * wr[j];
+
+        re[b] = re[a] - tr;
+        im[b] = im[a] - ti;
+        re[a] += tr;
+        im[a] += ti;
+    }
 }
 
-double * brahe_simple_fft(const double * x, const int n)
+static void fft_magnitude_task(void * context, const size_t begin, const size_t end, const size_t worker)
 {
-    int i;
-    double * result = NULL;
+    const fft_job_t * job = (const fft_job_t *)context;
+    const double * xre = job->m_xre;
+    const double * xim = job->m_xim;
+    size_t i;
 
-    // create a source array that is a power of 2
-    int n2 = brahe_sizepow2(n);
+    (void)worker;
 
-    if (n2 != n)
+    for (i = begin; i < end; ++i)
     {
-        double * x2 = (double *)malloc(sizeof(double) * n2);
+        if (i == 0)
+            job->m_mag[0] = sqrt(xre[0] * xre[0] + xim[0] * xim[0]) / (double)job->m_n2;
+        else
+            job->m_mag[i] = 2 * sqrt(xre[i] * xre[i] + xim[i] * xim[i]) / (double)job->m_n2;
+    }
+}
 
-        if (x2 != NULL)
-        {
-            memcpy(x2,x,sizeof(double) * n);
+bool brahe_simple_fft_into_exec(const brahe_exec_t * exec, const double * data, const size_t n, double * out, double * work)
+{
+    fft_job_t job;
+    size_t n2, h, j;
+
+    if (exec == NULL)
+        return brahe_simple_fft_into(data, n, out, work);
 
-            for (i = n; i < n2; ++i)
-                x2[i] = 0.0;
+    if ((data == NULL) || (out == NULL) || (work == NULL) || (n < 2))
+        return false;
 
-            result = brahe_simple_fft2(x2,n2);
-            free(x2);
+    BRAHE_METRIC_BEGIN(BRAHE_METRIC_SIMPLE_FFT, n);
+
+    n2 = pow2_size(n);
+    BRAHE_PROBE3(fft_execute, n, n2, sizeof(double));
+
+    job.m_x       = data;
+    job.m_n       = n;
+    job.m_n2      = n2;
+    job.m_quarter = (n2 >= 4) ? n2 / 4 : 1;
+    job.m_xre     = work;
+    job.m_xim     = work + n2;
+    job.m_wr      = work + 2 * n2;
+    job.m_wi      = work + 3 * n2;
+    job.m_mag     = out;
+
+    brahe_exec_for(exec, (job.m_quarter < n2 / 2) ? job.m_quarter : n2 / 2, FFT_GRAIN, fft_twiddle_task, &job);
+
+    if (job.m_quarter < n2 / 2)
+        brahe_exec_for(exec, n2 / 2 - job.m_quarter, FFT_GRAIN, fft_rotate_task, &job);
+
+    for (h = 1; h < n2 / 2; h <<= 1)
+    {
+        for (j = 0; j < h; ++j)
+        {
+            job.m_wr[h + j] = job.m_wr[n2 / 2 + j * (n2 / (2 * h))];
+            job.m_wi[h + j] = job.m_wi[n2 / 2 + j * (n2 / (2 * h))];
         }
     }
+
+    brahe_exec_for(exec, n2, FFT_GRAIN, fft_block_task, &job);
+
+    for (job.m_half = FFT_GRAIN; job.m_half < n2; job.m_half <<= 1)
+        brahe_exec_for(exec, n2 / 2, FFT_GRAIN, fft_pass_task, &job);
+
+    brahe_exec_for(exec, n2 / 2, FFT_GRAIN, fft_magnitude_task, &job);
+
+    BRAHE_METRIC_END();
+    return true;
+}
+
+double * brahe_simple_fft(const double * x, const size_t n)
+{
+    const brahe_allocator_t * a = brahe_allocator();
+    double * mag, * work;
+    size_t n2;
+
+    if ((x == NULL) || (n < 2))
+        return NULL;
+
+    n2 = pow2_size(n);
+
+    if (n2 > SIZE_MAX / (4 * sizeof(double)))
+        return NULL;
+
+    BRAHE_METRIC_BEGIN(BRAHE_METRIC_SIMPLE_FFT, n);
+
+    mag  = (double *)brahe_allocate(a, sizeof(double) * (n2 / 2), BRAHE_DEFAULT_ALIGN);
+    work = (double *)brahe_allocate(a, sizeof(double) * 4 * n2, BRAHE_DEFAULT_ALIGN);
+
+    if ((mag != NULL) && (work != NULL))
+        fft_magnitudes(x, n, n2, mag, work);
     else
-        result = brahe_simple_fft2(x,n);
+    {
+        brahe_release(a, mag);
+        mag = NULL;
+    }
+
+    brahe_release(a, work);
+    BRAHE_METRIC_END();
+    return mag;
+}
+
+// lengths that are not powers of 2 are rejected
+double * brahe_simple_fft2(const double * x, const size_t n)
+{
+    if ((n & (n - 1)) != 0)
+        return NULL;
 
-    return result;
+    return brahe_simple_fft(x, n);
 }
@@ -51,63 +51,414 @@
 */
 
 #include "mathtools.h"
+#include "internal.h"
 #include "prng.h"
 #include <string.h>
 #include <stdlib.h>
 
+// samples generated by rotation between exact evaluations of sin and cos
+#define RESYNC_BLOCK 256
+
+// number of interleaved rotations per wave
+#define ROTATIONS 4
+
+/*
+    Each wave advances by a fixed angle per sample, so its value can be found
+    by rotating the pair (cos, sin) instead of calling sin(). ROTATIONS
+    independent rotations cover consecutive samples, each stepping by
+    ROTATIONS samples, so the multiply chains can overlap. Rounding error
+    grows with every rotation, so the rotations restart from exact values at
+    the start of every block.
+
+    The generators are written once, as macros, for double and float
+    output; the rotations themselves are always carried in double.
+*/
+#define DEFINE_ADD_WAVE_BLOCK(name, real)                                               \
+    static void name(real * result, const size_t first, const size_t count,            \
+                     const double f, const double phase, const double amplitude)        \
+    {                                                                                   \
+        size_t i, r;                                                                    \
+        double s[ROTATIONS], c[ROTATIONS];                                              \
+        double step_c = cos(f * ROTATIONS);                                             \
+        double step_s = sin(f * ROTATIONS);                                             \
+                                                                                        \
+        for (r = 0; r < ROTATIONS; ++r)                                                 \
+        {                                                                               \
+            double angle = phase + f * (double)(first + r);                             \
+            s[r] = sin(angle) * amplitude;                                              \
+            c[r] = cos(angle) * amplitude;                                              \
+        }                                                                               \
+                                                                                        \
+        for (i = 0; i + ROTATIONS <= count; i += ROTATIONS)                             \
+        {                                                                               \
+            for (r = 0; r < ROTATIONS; ++r)                                             \
+            {                                                                           \
+                double t = s[r];                                                        \
+                result[i + r] += (real)t;                                               \
+                s[r] = t * step_c + c[r] * step_s;                                      \
+                c[r] = c[r] * step_c - t * step_s;                                      \
+            }                                                                           \
+        }                                                                               \
+                                                                                        \
+        for (r = 0; i < count; ++i, ++r)                                                \
+            result[i] += (real)s[r];                                                    \
+    }
+
+#define DEFINE_MAKE_SINUSOID_PHASED_INTO(name, real, add_block, metric)                 \
+    bool name(const brahe_wave_factor_t * factors, const double * phases, const size_t factor_n, \
+              real * result, const size_t array_n)                                      \
+    {                                                                                   \
+        size_t i, n, count;                                                             \
+                                                                                        \
+        if ((factors == NULL) || (factor_n == 0) || (result == NULL) || (array_n == 0)) \
+            return false;                                                               \
+                                                                                        \
+        BRAHE_METRIC_BEGIN(metric, array_n);                                            \
+        memset(result, 0, sizeof(real) * array_n);                                      \
+                                                                                        \
+        /* block by block, so the output stays in cache while each wave is added */     \
+        for (i = 0; i < array_n; i += RESYNC_BLOCK)                                     \
+        {                                                                               \
+            count = (array_n - i < RESYNC_BLOCK) ? array_n - i : RESYNC_BLOCK;          \
+                                                                                        \
+            for (n = 0; n < factor_n; ++n)                                              \
+                add_block(result + i, i, count, BRAHE_PI / factors[n].wavelength,       \
+                          (phases != NULL) ? phases[n] : 0.0, factors[n].amplitude);    \
+        }                                                                               \
+                                                                                        \
+        BRAHE_METRIC_END();                                                             \
+        return true;                                                                    \
+    }
+
+DEFINE_ADD_WAVE_BLOCK(add_wave_block, double)
+DEFINE_ADD_WAVE_BLOCK(add_wave_block_f, float)
+DEFINE_MAKE_SINUSOID_PHASED_INTO(brahe_make_sinusoid_phased_into, double, add_wave_block, BRAHE_METRIC_MAKE_SINUSOID)
+DEFINE_MAKE_SINUSOID_PHASED_INTO(brahe_make_sinusoid_phased_into_f, float, add_wave_block_f, BRAHE_METRIC_MAKE_SINUSOID_F)
+
+bool brahe_make_sinusoid_into(const brahe_wave_factor_t * factors, const size_t factor_n, double * result, const size_t array_n)
+{
+    return brahe_make_sinusoid_phased_into(factors, NULL, factor_n, result, array_n);
+}
+
+bool brahe_make_sinusoid_into_f(const brahe_wave_factor_t * factors, const size_t factor_n, float * result, const size_t array_n)
+{
+    return brahe_make_sinusoid_phased_into_f(factors, NULL, factor_n, result, array_n);
+}
+
+// samples per task of a parallel sinusoid; a whole number of blocks, so
+// the result is the same as brahe_make_sinusoid_phased_into's
+#define SINUSOID_GRAIN (64 * RESYNC_BLOCK)
+
+typedef struct
+{
+    const brahe_wave_factor_t * m_factors;
+    const double *              m_phases;
+    size_t                      m_factor_n;
+    double *                    m_result;
+}
+sinusoid_job_t;
+
+static void sinusoid_task(void * context, const size_t begin, const size_t end, const size_t worker)
+{
+    const sinusoid_job_t * job = (const sinusoid_job_t *)context;
+    size_t i, n, count;
+
+    (void)worker;
+    memset(job->m_result + begin, 0, sizeof(double) * (end - begin));
+
+    for (i = begin; i < end; i += RESYNC_BLOCK)
+    {
+        count = (end - i < RESYNC_BLOCK) ? end - i : RESYNC_BLOCK;
+
+        for (n = 0; n < job->m_factor_n; ++n)
+            add_wave_block(job->m_result + i, i, count, BRAHE_PI / job->m_factors[n].wavelength,
+                           (job->m_phases != NULL) ? job->m_phases[n] : 0.0, job->m_factors[n].amplitude);
+    }
+}
+
+bool brahe_make_sinusoid_phased_into_exec(const brahe_exec_t * exec, const brahe_wave_factor_t * factors, const double * phases,
+                                          const size_t factor_n, double * result, const size_t array_n)
+{
+    sinusoid_job_t job;
+
+    if ((factors == NULL) || (factor_n == 0) || (result == NULL) || (array_n == 0))
+        return false;
+
+    BRAHE_METRIC_BEGIN(BRAHE_METRIC_MAKE_SINUSOID, array_n);
+
+    job.m_factors  = factors;
+    job.m_phases   = phases;
+    job.m_factor_n = factor_n;
+    job.m_result   = result;
+    brahe_exec_for(exec, array_n, SINUSOID_GRAIN, sinusoid_task, &job);
+
+    BRAHE_METRIC_END();
+    return true;
+}
+
 double * brahe_make_sinusoid(const brahe_wave_factor_t * factors, const size_t factor_n, const size_t array_n)
 {
-    size_t i, n;
     double * result = NULL;
 
     if ((array_n > 0) && (factor_n > 0) && (factors != NULL))
     {
-        result = (double *)malloc(sizeof(double) * array_n);
+        BRAHE_METRIC_BEGIN(BRAHE_METRIC_MAKE_SINUSOID, array_n);
+        result = (double *)brahe_allocate(brahe_allocator(), sizeof(double) * array_n, BRAHE_DEFAULT_ALIGN);
 
         if (result != NULL)
-        {
-            double * f = (double *)malloc(sizeof(double) * factor_n);
-            double * a = (double *)malloc(sizeof(double) * factor_n);
-
-            for (n = 0; n < factor_n; ++n)
-            {
-                f[n] = BRAHE_PI / factors[n].wavelength;
-                a[n] = 0.0;
-            }
-
-            for (i = 0; i < array_n; ++i)
-            {
-                for (n = 0; n < factor_n; ++n)
-                {
-                    result[i] += sin(a[n]) * factors[n].amplitude;
-                    a[n] += f[n];
-                }
-            }
-        }
+            brahe_make_sinusoid_into(factors, factor_n, result, array_n);
+
+        BRAHE_METRIC_END();
     }
 
     return result;
 }
 
-void brahe_add_noise(double * a, const size_t n, double noise)
+/*
+    Noise is generated in blocks: a block of raw integers from the PRNG, then
+    a block of variates, then one pass over the signal. Large seeded requests
+    are divided into fixed-size segments, each with its own generator seeded
+    from the caller's seed and the segment number, so the result does not
+    depend on how many threads did the work.
+*/
+
+// variates generated per block
+#define NOISE_BLOCK 256
+
+// signal elements per independently seeded segment
+#define NOISE_SEGMENT ((size_t)1 << 16)
+
+// convert raw integers to uniform values in [-1,1)
+static void uniform_block(const uint32_t * raw, double * u, const size_t n)
+{
+    size_t i = 0;
+
+#if defined(BRAHE_HAVE_SSE2)
+    // SSE2 only converts signed integers; flipping the top bit maps
+    // [0,2^32) onto [-2^31,2^31), which is exactly the range wanted
+    const __m128i flip = _mm_set1_epi32((int)0x80000000);
+    const __m128d scale = _mm_set1_pd(1.0 / 2147483648.0);
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(raw + i)), flip);
+        _mm_storeu_pd(u + i, _mm_mul_pd(_mm_cvtepi32_pd(x), scale));
+        _mm_storeu_pd(u + i + 2, _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(x, 8)), scale));
+    }
+#endif
+
+    for (; i < n; ++i)
+        u[i] = ((double)raw[i] - 2147483648.0) * (1.0 / 2147483648.0);
+}
+
+// convert pairs of raw integers to standard normal values (Box-Muller)
+static void gaussian_block(const uint32_t * raw, double * z, const size_t n)
 {
     size_t i;
 
-    if ((n > 0) && (a != NULL) && (noise > 0.0))
+    for (i = 0; i + 1 < n; i += 2)
     {
-        brahe_prng_state_t prng;
+        // (0,1), so the logarithm is finite
+        double u1 = ((double)raw[i] + 0.5) * (1.0 / 4294967296.0);
+        double u2 = (double)raw[i + 1] * (2.0 * BRAHE_PI / 4294967296.0);
+        double r  = sqrt(-2.0 * log(u1));
 
-        if (!brahe_prng_init(&prng,BRAHE_PRNG_KISS,BRAHE_UNKNOWN_SEED))
-            return;
+        z[i]     = r * cos(u2);
+        z[i + 1] = r * sin(u2);
+    }
+}
 
-        for (i = 0; i < n; ++i)
+// add noise to one block of the signal, and to a whole signal from one
+// generator; written once for both precisions, with variates in double
+#define DEFINE_NOISE(block_name, name, real, metric)                                    \
+    static void block_name(brahe_prng_state_t * prng, real * a, const size_t n,         \
+                           const brahe_noise_type_t type, const double noise)           \
+    {                                                                                   \
+        size_t i;                                                                       \
+        uint32_t raw[NOISE_BLOCK];                                                      \
+        double v[NOISE_BLOCK];                                                          \
+                                                                                        \
+        /* Gaussian values come in pairs */                                             \
+        brahe_prng_fill(prng, raw, (n + 1) & ~(size_t)1);                               \
+                                                                                        \
+        switch (type)                                                                   \
+        {                                                                               \
+            case BRAHE_NOISE_UNIFORM:                                                   \
+                uniform_block(raw, v, n);                                               \
+                                                                                        \
+                for (i = 0; i < n; ++i)                                                 \
+                    a[i] += (real)(noise * v[i]);                                       \
+                                                                                        \
+                break;                                                                  \
+                                                                                        \
+            case BRAHE_NOISE_GAUSSIAN:                                                  \
+                gaussian_block(raw, v, (n + 1) & ~(size_t)1);                           \
+                                                                                        \
+                for (i = 0; i < n; ++i)                                                 \
+                    a[i] += (real)(noise * v[i]);                                       \
+                                                                                        \
+                break;                                                                  \
+                                                                                        \
+            case BRAHE_NOISE_MULTIPLICATIVE:                                            \
+                uniform_block(raw, v, n);                                               \
+                                                                                        \
+                for (i = 0; i < n; ++i)                                                 \
+                    a[i] *= (real)(1.0 + noise * v[i]);                                 \
+                                                                                        \
+                break;                                                                  \
+        }                                                                               \
+    }                                                                                   \
+                                                                                        \
+    bool name(brahe_prng_state_t * prng, real * a, const size_t n,                      \
+              const brahe_noise_type_t type, const double noise)                        \
+    {                                                                                   \
+        size_t i;                                                                       \
+                                                                                        \
+        if ((prng == NULL) || (a == NULL) || (type > BRAHE_NOISE_MULTIPLICATIVE))       \
+            return false;                                                               \
+                                                                                        \
+        BRAHE_METRIC_BEGIN(metric, n);                                                  \
+                                                                                        \
+        for (i = 0; i < n; i += NOISE_BLOCK)                                            \
+            block_name(prng, a + i, (n - i < NOISE_BLOCK) ? n - i : NOISE_BLOCK, type, noise); \
+                                                                                        \
+        BRAHE_METRIC_END();                                                             \
+        return true;                                                                    \
+    }
+
+DEFINE_NOISE(noise_block, brahe_add_noise_r, double, BRAHE_METRIC_ADD_NOISE)
+DEFINE_NOISE(noise_block_f, brahe_add_noise_r_f, float, BRAHE_METRIC_ADD_NOISE_F)
+
+typedef struct
+{
+    void *             m_a;       // double or float signal
+    bool               m_single;  // true for float
+    brahe_noise_type_t m_type;
+    double             m_noise;
+    uint32_t           m_seed;
+    bool               m_ok;      // cleared by a segment that fails
+}
+noise_job_t;
+
+// noise for one segment; the loop's grain is NOISE_SEGMENT
+static void noise_task(void * context, const size_t begin, const size_t end, const size_t worker)
+{
+    noise_job_t * job = (noise_job_t *)context;
+    brahe_prng_state_t prng;
+    uint32_t state[4];
+
+    (void)worker;
+    BRAHE_METRIC_JOIN(job->m_single ? BRAHE_METRIC_ADD_NOISE_F : BRAHE_METRIC_ADD_NOISE);
+
+    if (brahe_prng_init_into(&prng, BRAHE_PRNG_KISS, brahe_segment_seed(job->m_seed, begin / NOISE_SEGMENT), state, sizeof(state)))
+    {
+        if (job->m_single)
+            brahe_add_noise_r_f(&prng, (float *)job->m_a + begin, end - begin, job->m_type, job->m_noise);
+        else
+            brahe_add_noise_r(&prng, (double *)job->m_a + begin, end - begin, job->m_type, job->m_noise);
+
+        brahe_prng_free(&prng);
+    }
+    else
+        job->m_ok = false;
+
+    BRAHE_METRIC_END();
+}
+
+// seeded noise for either precision
+static bool add_noise_seeded(const brahe_exec_t * exec, void * a, const bool single, const size_t n,
+                             const brahe_noise_type_t type, const double noise, const uint32_t seed)
+{
+    noise_job_t job;
+
+    if ((a == NULL) || (type > BRAHE_NOISE_MULTIPLICATIVE))
+        return false;
+
+    BRAHE_METRIC_BEGIN(single ? BRAHE_METRIC_ADD_NOISE_F : BRAHE_METRIC_ADD_NOISE, n);
+
+    job.m_a      = a;
+    job.m_single = single;
+    job.m_type   = type;
+    job.m_noise  = noise;
+    job.m_seed   = seed;
+    job.m_ok     = true;
+    brahe_exec_for(exec, n, NOISE_SEGMENT, noise_task, &job);
+
+    BRAHE_METRIC_END();
+    return job.m_ok;
+}
+
+// seeded noise on a pool of the given size, started for this call
+static bool add_noise_threads(void * a, const bool single, const size_t n, const brahe_noise_type_t type,
+                              const double noise, const uint32_t seed, const size_t threads)
+{
+    size_t segments = (n + NOISE_SEGMENT - 1) / NOISE_SEGMENT;
+    size_t workers = (threads > segments) ? segments : threads;
+    brahe_exec_t exec;
+    bool result;
+
+    // without a pool, the segments are simply processed in order
+    if ((segments < 2) || (workers == 1) || !brahe_exec_init(&exec, workers, 0))
+        return add_noise_seeded(NULL, a, single, n, type, noise, seed);
+
+    brahe_exec_set_threshold(&exec, 0);
+    result = add_noise_seeded(&exec, a, single, n, type, noise, seed);
+    brahe_exec_free(&exec);
+    return result;
+}
+
+bool brahe_add_noise_seeded(double * a, const size_t n, const brahe_noise_type_t type, const double noise,
+                            const uint32_t seed, size_t threads)
+{
+    return add_noise_threads(a, false, n, type, noise, seed, threads);
+}
+
+bool brahe_add_noise_seeded_f(float * a, const size_t n, const brahe_noise_type_t type, const double noise,
+                              const uint32_t seed, size_t threads)
+{
+    return add_noise_threads(a, true, n, type, noise, seed, threads);
+}
+
+bool brahe_add_noise_seeded_exec(const brahe_exec_t * exec, double * a, const size_t n, const brahe_noise_type_t type,
+                                 const double noise, const uint32_t seed)
+{
+    return add_noise_seeded(exec, a, false, n, type, noise, seed);
+}
+
+void brahe_add_noise(double * a, const size_t n, double noise)
+{
+    brahe_prng_state_t prng;
+    uint32_t state[4];
+
+    if ((n > 0) && (a != NULL) && (noise > 0.0))
+    {
+        BRAHE_METRIC_BEGIN(BRAHE_METRIC_ADD_NOISE, n);
+
+        if (brahe_prng_init_into(&prng,BRAHE_PRNG_KISS,BRAHE_UNKNOWN_SEED,state,sizeof(state)))
         {
-            double x = brahe_prng_real1(&prng) * noise;
+            brahe_add_noise_r(&prng, a, n, BRAHE_NOISE_MULTIPLICATIVE, noise);
+            brahe_prng_free(&prng);
+        }
 
-            if (1 == brahe_prng_next(&prng) % 2)
-                a[i] += x;
-            else
-                a[i] -= x;
+        BRAHE_METRIC_END();
+    }
+}
+
+void brahe_add_noise_f(float * a, const size_t n, double noise)
+{
+    brahe_prng_state_t prng;
+    uint32_t state[4];
+
+    if ((n > 0) && (a != NULL) && (noise > 0.0))
+    {
+        BRAHE_METRIC_BEGIN(BRAHE_METRIC_ADD_NOISE_F, n);
+
+        if (brahe_prng_init_into(&prng,BRAHE_PRNG_KISS,BRAHE_UNKNOWN_SEED,state,sizeof(state)))
+        {
+            brahe_add_noise_r_f(&prng, a, n, BRAHE_NOISE_MULTIPLICATIVE, noise);
+            brahe_prng_free(&prng);
         }
+
+        BRAHE_METRIC_END();
     }
 }
@@ -51,74 +51,745 @@
 */
 
 #include "mathtools.h"
+#include "dispatch.h"
 #include <stdlib.h>
 
 // basic statistics for an array of double
-brahe_statistics brahe_get_statistics(double * data, size_t n)
+brahe_statistics brahe_get_statistics(const double * data, const size_t n)
 {
-    size_t i;
+    const brahe_kernels_t * k = brahe_kernels();
     brahe_statistics stats;
 
+    BRAHE_PROBE2(statistics, n, sizeof(double));
+    BRAHE_METRIC_BEGIN(BRAHE_METRIC_GET_STATISTICS, n);
+
     // calculate max, average, and minimum fitness for the population
-    stats.max = DBL_MIN;
-    stats.min = DBL_MAX;
-    stats.mean = 0.0;
-    stats.variance = 0.0;
-    stats.sigma = 0.0;
+    k->m_minmax_sum(data, n, &stats.min, &stats.max, &stats.mean);
+    stats.mean /= (double)n;
 
-    for (i = 0; i < n; ++i)
-    {
-        // do we have a new maximum?
-        if (data[i] > stats.max)
-            stats.max = data[i];
+    stats.variance = k->m_sum_sq_dev(data, n, stats.mean) / (double)(n - 1);
 
-        // do we have a new minimum?
-        if (data[i] < stats.min)
-            stats.min = data[i];
+    // calculate 2 times the std. deviation (sigma)
+    stats.sigma = sqrt(stats.variance);
 
-        // accumulate for average
-        stats.mean += data[i];
-    }
+    BRAHE_METRIC_END();
+    return stats;
+}
 
-    stats.mean /= (double)n;
+// basic statistics for an array of float, accumulated in double
+brahe_statistics brahe_get_statistics_f(const float * data, const size_t n)
+{
+    const brahe_kernels_t * k = brahe_kernels();
+    brahe_statistics stats;
 
-    for (i = 0; i < n; ++i)
-    {
-        double diff = data[i] - stats.mean;
-        stats.variance += (diff * diff);
-    }
+    BRAHE_PROBE2(statistics, n, sizeof(float));
+    BRAHE_METRIC_BEGIN(BRAHE_METRIC_GET_STATISTICS_F, n);
 
-    stats.variance /= (double)(n - 1);
+    k->m_minmax_sum_f(data, n, &stats.min, &stats.max, &stats.mean);
+    stats.mean /= (double)n;
 
-    // calculate 2 times the std. deviation (sigma)
+    stats.variance = k->m_sum_sq_dev_f(data, n, stats.mean) / (double)(n - 1);
     stats.sigma = sqrt(stats.variance);
 
+    BRAHE_METRIC_END();
     return stats;
 }
 
-// Moving average
-double * brahe_moving_average(const double * data, const int n, const int distance)
+// elements per task of parallel statistics
+#define STATISTICS_GRAIN 65536
+
+typedef struct
+{
+    const double *          m_data;
+    brahe_running_stats_t * m_parts; // one per task, merged in order
+}
+statistics_job_t;
+
+static void statistics_task(void * context, const size_t begin, const size_t end, const size_t worker)
+{
+    const brahe_kernels_t * k = brahe_kernels();
+    const statistics_job_t * job = (const statistics_job_t *)context;
+    brahe_running_stats_t * part = job->m_parts + begin / STATISTICS_GRAIN;
+    double sum;
+
+    (void)worker;
+
+    k->m_minmax_sum(job->m_data + begin, end - begin, &part->m_min, &part->m_max, &sum);
+    part->m_n    = end - begin;
+    part->m_mean = sum / (double)part->m_n;
+    part->m_m2   = k->m_sum_sq_dev(job->m_data + begin, end - begin, part->m_mean);
+}
+
+// basic statistics for an array of double, computed in parallel
+brahe_statistics brahe_get_statistics_exec(const brahe_exec_t * exec, const double * data, const size_t n)
 {
-    double * result = (double *)malloc(sizeof(double) * n);
-    int i, x;
-    int m = n - distance;
+    const brahe_allocator_t * a = brahe_allocator();
+    size_t i, parts = (n + STATISTICS_GRAIN - 1) / STATISTICS_GRAIN;
+    brahe_running_stats_t total;
+    statistics_job_t job;
+    brahe_statistics stats;
+
+    if ((exec == NULL) || (n == 0))
+        return brahe_get_statistics(data, n);
+
+    job.m_data  = data;
+    job.m_parts = (brahe_running_stats_t *)brahe_allocate(a, sizeof(brahe_running_stats_t) * parts, BRAHE_DEFAULT_ALIGN);
+
+    if (job.m_parts == NULL)
+        return brahe_get_statistics(data, n);
+
+    BRAHE_PROBE2(statistics, n, sizeof(double));
+    BRAHE_METRIC_BEGIN(BRAHE_METRIC_GET_STATISTICS, n);
+
+    brahe_exec_for(exec, n, STATISTICS_GRAIN, statistics_task, &job);
+
+    total = job.m_parts[0];
+
+    for (i = 1; i < parts; ++i)
+        brahe_running_merge(&total, job.m_parts[i].m_n, job.m_parts[i].m_min, job.m_parts[i].m_max,
+                            job.m_parts[i].m_mean, job.m_parts[i].m_m2);
 
-    for (i = 0; i < n; ++i)
+    stats.min      = total.m_min;
+    stats.max      = total.m_max;
+    stats.mean     = total.m_mean;
+    stats.variance = total.m_m2 / (double)(n - 1);
+    stats.sigma    = sqrt(stats.variance);
+
+    brahe_release(a, job.m_parts);
+    BRAHE_METRIC_END();
+    return stats;
+}
+
+/*
+    Selection. brahe_quantile and friends use introselect: quickselect with
+    median-of-three pivots, falling back to median-of-medians pivots if the
+    partitioning goes badly, which bounds the worst case at O(n). Partitions
+    are three-way, so runs of equal values cost nothing extra.
+*/
+
+#define SWAP_DOUBLE(a, b) { double t_ = (a); (a) = (b); (b) = t_; }
+
+// small ranges are sorted directly
+#define SELECT_CUTOFF 16
+
+static void insertion_sort(double * a, const size_t lo, const size_t hi)
+{
+    size_t i, j;
+
+    for (i = lo + 1; i <= hi; ++i)
     {
-        double count = 0.0;
+        double x = a[i];
+
+        for (j = i; (j > lo) && (a[j - 1] > x); --j)
+            a[j] = a[j - 1];
+
+        a[j] = x;
+    }
+}
 
-        for (x = i - distance; x <= i + distance; ++x)
+static void select_kth(double * a, size_t lo, size_t hi, const size_t k, int depth);
+
+// median of the medians of groups of five, for a guaranteed-good pivot
+static double median_of_medians(double * a, const size_t lo, const size_t hi)
+{
+    size_t g, start, end, groups = 0;
+
+    for (start = lo; start <= hi; start += 5)
+    {
+        end = (hi - start >= 4) ? start + 4 : hi;
+        insertion_sort(a, start, end);
+        g = start + (end - start) / 2;
+        SWAP_DOUBLE(a[lo + groups], a[g]);
+        ++groups;
+    }
+
+    select_kth(a, lo, lo + groups - 1, lo + groups / 2, 0);
+    return a[lo + groups / 2];
+}
+
+// rearranges a[lo..hi] so that a[k] holds the value it would have if sorted,
+// with no larger values before it and no smaller ones after
+static void select_kth(double * a, size_t lo, size_t hi, const size_t k, int depth)
+{
+    while (hi - lo >= SELECT_CUTOFF)
+    {
+        double pivot;
+        size_t lt, gt, i;
+
+        if (depth > 0)
+        {
+            // median of three
+            double x = a[lo], y = a[lo + (hi - lo) / 2], z = a[hi];
+            --depth;
+
+            if (x > y) SWAP_DOUBLE(x, y);
+            if (y > z) SWAP_DOUBLE(y, z);
+            if (x > y) SWAP_DOUBLE(x, y);
+
+            pivot = y;
+        }
+        else
+            pivot = median_of_medians(a, lo, hi);
+
+        // three-way partition: [lo,lt) < pivot, [lt,gt] == pivot, (gt,hi] > pivot
+        lt = lo;
+        gt = hi;
+        i = lo;
+
+        while (i <= gt)
         {
-            if ((x >= 0) && (x <= m))
+            if (a[i] < pivot)
+            {
+                SWAP_DOUBLE(a[i], a[lt]);
+                ++lt;
+                ++i;
+            }
+            else if (a[i] > pivot)
             {
-                result[i] += data[x];
-                count += 1.0;
+                // the pivot value is in the range, so gt cannot pass below lo
+                SWAP_DOUBLE(a[i], a[gt]);
+                --gt;
             }
+            else
+                ++i;
         }
 
-        result[i] /= count;
+        if (k < lt)
+            hi = lt - 1;
+        else if (k > gt)
+            lo = gt + 1;
+        else
+            return;
+    }
+
+    insertion_sort(a, lo, hi);
+}
+
+// depth budget for quickselect before switching to median-of-medians pivots
+static int select_depth(size_t n)
+{
+    int depth = 0;
+
+    while (n > 1)
+    {
+        n >>= 1;
+        depth += 2;
+    }
+
+    return depth;
+}
+
+// position and fraction of a quantile, interpolating linearly between order statistics
+static size_t quantile_rank(const size_t n, const double q, double * fraction)
+{
+    double h = q * (double)(n - 1);
+    double k = floor(h);
+
+    *fraction = h - k;
+    return (size_t)k;
+}
+
+// smallest value in a[lo..hi]
+static double min_of(const double * a, size_t lo, const size_t hi)
+{
+    double result = a[lo];
+
+    for (++lo; lo <= hi; ++lo)
+    {
+        if (a[lo] < result)
+            result = a[lo];
     }
 
     return result;
 }
 
+// Quantile, by selection
+double brahe_quantile(double * data, const size_t n, const double q)
+{
+    size_t k;
+    double fraction, result;
+
+    if ((data == NULL) || (n == 0) || !(q >= 0.0) || !(q <= 1.0))
+#if defined(_MSC_VER)
+        return 0.0;
+#else
+        return NAN;
+#endif
+
+    BRAHE_METRIC_BEGIN(BRAHE_METRIC_QUANTILE, n);
+
+    k = quantile_rank(n, q, &fraction);
+    select_kth(data, 0, n - 1, k, select_depth(n));
+    result = data[k];
+
+    // the next order statistic is the smallest value above position k
+    if (fraction > 0.0)
+        result += fraction * (min_of(data, k + 1, n - 1) - result);
+
+    BRAHE_METRIC_END();
+    return result;
+}
+
+// Median, by selection
+double brahe_median(double * data, const size_t n)
+{
+    return brahe_quantile(data, n, 0.5);
+}
+
+static int compare_size(const void * a, const void * b)
+{
+    size_t x = *(const size_t *)a;
+    size_t y = *(const size_t *)b;
+    return (x > y) - (x < y);
+}
+
+// select every rank in ranks[first..last] (sorted) within a[lo..hi]
+static void multiselect(double * a, const size_t lo, const size_t hi,
+                        const size_t * ranks, const size_t first, const size_t last, const int depth)
+{
+    size_t mid = first + (last - first) / 2;
+    size_t k = ranks[mid];
+
+    select_kth(a, lo, hi, k, depth);
+
+    // values on each side of k are now confined to that side
+    if ((mid > first) && (k > lo))
+        multiselect(a, lo, k - 1, ranks, first, mid - 1, depth);
+
+    if ((mid < last) && (k < hi))
+        multiselect(a, k + 1, hi, ranks, mid + 1, last, depth);
+}
+
+// quantiles whose ranks fit on the stack
+#define QUANTILES_LOCAL 32
+
+// Several quantiles, partitioning the data once
+bool brahe_quantiles(double * data, const size_t n, const double * q, const size_t m, double * result)
+{
+    size_t i, count, unique, * ranks;
+    size_t local[2 * QUANTILES_LOCAL];
+    double fraction;
+
+    if ((data == NULL) || (n == 0) || (q == NULL) || (result == NULL))
+        return false;
+
+    for (i = 0; i < m; ++i)
+    {
+        if (!(q[i] >= 0.0) || !(q[i] <= 1.0))
+            return false;
+    }
+
+    if (m == 0)
+        return true;
+
+    BRAHE_METRIC_BEGIN(BRAHE_METRIC_QUANTILE, n);
+
+    // every order statistic needed, including the upper neighbor for interpolation
+    if (m <= QUANTILES_LOCAL)
+        ranks = local;
+    else
+    {
+        ranks = (size_t *)brahe_allocate(brahe_allocator(), sizeof(size_t) * 2 * m, BRAHE_DEFAULT_ALIGN);
+
+        if (ranks == NULL)
+        {
+            BRAHE_METRIC_END();
+            return false;
+        }
+    }
+
+    for (i = 0, count = 0; i < m; ++i)
+    {
+        size_t k = quantile_rank(n, q[i], &fraction);
+        ranks[count++] = k;
+
+        if (fraction > 0.0)
+            ranks[count++] = k + 1;
+    }
+
+    qsort(ranks, count, sizeof(size_t), compare_size);
+
+    // remove duplicates
+    for (i = 1, unique = 1; i < count; ++i)
+    {
+        if (ranks[i] != ranks[unique - 1])
+            ranks[unique++] = ranks[i];
+    }
+
+    multiselect(data, 0, n - 1, ranks, 0, unique - 1, select_depth(n));
+
+    for (i = 0; i < m; ++i)
+    {
+        size_t k = quantile_rank(n, q[i], &fraction);
+        result[i] = data[k];
+
+        if (fraction > 0.0)
+            result[i] += fraction * (data[k + 1] - data[k]);
+    }
+
+    if (ranks != local)
+        brahe_release(brahe_allocator(), ranks);
+
+    BRAHE_METRIC_END();
+    return true;
+}
+
+// Moving average, O(n) compensated running sum; written once for both
+// precisions, always summing in double
+#define DEFINE_MOVING_AVERAGE_INTO(name, real, metric)                                  \
+    bool name(const real * data, const size_t n, const size_t distance, real * result)  \
+    {                                                                                   \
+        size_t i, d, lo, hi;                                                            \
+        double sum = 0.0, comp = 0.0;                                                   \
+                                                                                        \
+        if ((data == NULL) || (result == NULL) || (n == 0))                             \
+            return false;                                                               \
+                                                                                        \
+        BRAHE_METRIC_BEGIN(metric, n);                                                  \
+                                                                                        \
+        /* a window wider than the array is the same as one covering it */              \
+        d = (distance < n) ? distance : n - 1;                                          \
+                                                                                        \
+        /* window for the first element */                                              \
+        for (hi = 0; hi <= d; ++hi)                                                     \
+            brahe_compensated_add(&sum,&comp,data[hi]);                                 \
+                                                                                        \
+        lo = 0;                                                                         \
+        hi = d;                                                                         \
+                                                                                        \
+        for (i = 0; i < n; ++i)                                                         \
+        {                                                                               \
+            result[i] = (real)((sum + comp) / (double)(hi - lo + 1));                   \
+                                                                                        \
+            /* slide the window one element to the right */                             \
+            if (hi + 1 < n)                                                             \
+                brahe_compensated_add(&sum,&comp,data[++hi]);                           \
+                                                                                        \
+            if (i >= d)                                                                 \
+                brahe_compensated_add(&sum,&comp,-data[lo++]);                          \
+        }                                                                               \
+                                                                                        \
+        BRAHE_METRIC_END();                                                             \
+        return true;                                                                    \
+    }
+
+DEFINE_MOVING_AVERAGE_INTO(brahe_moving_average_into, double, BRAHE_METRIC_MOVING_AVERAGE)
+DEFINE_MOVING_AVERAGE_INTO(brahe_moving_average_into_f, float, BRAHE_METRIC_MOVING_AVERAGE_F)
+
+// exact (compensated) sum of data[lo..hi]
+static double window_sum(const double * data, size_t lo, const size_t hi)
+{
+    double sum = 0.0, comp = 0.0;
+
+    for (; lo <= hi; ++lo)
+        brahe_compensated_add(&sum,&comp,data[lo]);
+
+    return sum + comp;
+}
+
+// inclusive prefix sum of a[0..n), starting from carry
+static void prefix_scan(double * a, const size_t n, double carry)
+{
+    size_t i = 0;
+
+#if defined(BRAHE_HAVE_SSE2)
+    __m128d c = _mm_set1_pd(carry);
+
+    for (; i + 2 <= n; i += 2)
+    {
+        // [x0, x1] -> [x0, x0 + x1], then add the running total
+        __m128d v = _mm_loadu_pd(a + i);
+        v = _mm_add_pd(v, _mm_castsi128_pd(_mm_slli_si128(_mm_castpd_si128(v), 8)));
+        v = _mm_add_pd(v, c);
+        _mm_storeu_pd(a + i, v);
+        c = _mm_unpackhi_pd(v, v);
+    }
+
+    carry = _mm_cvtsd_f64(c);
+#endif
+
+    for (; i < n; ++i)
+    {
+        carry += a[i];
+        a[i] = carry;
+    }
+}
+
+// minimum length of a prefix-scan block between exact resynchronizations
+#define MOVING_AVERAGE_BLOCK 1024
+
+// Moving average, as a vectorized prefix sum of window deltas
+bool brahe_moving_average_prefix_into(const double * data, const size_t n, const size_t distance, double * result)
+{
+    size_t i, d, start, end, block;
+
+    if ((data == NULL) || (result == NULL) || (n == 0))
+        return false;
+
+    BRAHE_METRIC_BEGIN(BRAHE_METRIC_MOVING_AVERAGE, n);
+
+    d = (distance < n) ? distance : n - 1;
+
+    // each block starts from an exactly computed window sum, so rounding
+    // error cannot drift beyond one block; blocks are long enough that the
+    // resynchronization adds at most a fraction of the work
+    block = 4 * (2 * d + 1);
+
+    if (block < MOVING_AVERAGE_BLOCK)
+        block = MOVING_AVERAGE_BLOCK;
+
+    for (start = 0; start < n; start = end)
+    {
+        end = (n - start > block) ? start + block : n;
+
+        // window sum for the first element of the block
+        result[start] = window_sum(data, (start > d) ? start - d : 0,
+                                   (start + d < n) ? start + d : n - 1);
+
+        // result[i] becomes the change in window sum from element i - 1 to i;
+        // first the element entering the window...
+        for (i = start + 1; (i < end) && (i < n - d); ++i)
+            result[i] = data[i + d];
+
+        for (; i < end; ++i)
+            result[i] = 0.0;
+
+        // ...then the element leaving it
+        for (i = (start > d) ? start + 1 : d + 1; i < end; ++i)
+            result[i] -= data[i - d - 1];
+
+        prefix_scan(result + start + 1, end - start - 1, result[start]);
+
+        // turn window sums into averages
+        for (i = start; i < end; ++i)
+        {
+            size_t lo = (i > d) ? i - d : 0;
+            size_t hi = (i + d < n) ? i + d : n - 1;
+            result[i] /= (double)(hi - lo + 1);
+        }
+    }
+
+    BRAHE_METRIC_END();
+    return true;
+}
+
+// elements per task of a parallel moving average, unless windows are wide
+#define MOVING_AVERAGE_GRAIN 65536
+
+typedef struct
+{
+    const double * m_data;
+    size_t         m_n;
+    size_t         m_distance; // no more than n - 1
+    double *       m_result;
+}
+average_job_t;
+
+// the running sum of brahe_moving_average_into, started from an exact
+// window sum at the beginning of the task
+static void average_task(void * context, const size_t begin, const size_t end, const size_t worker)
+{
+    const average_job_t * job = (const average_job_t *)context;
+    const double * data = job->m_data;
+    size_t i, n = job->m_n, d = job->m_distance;
+    size_t lo = (begin > d) ? begin - d : 0;
+    size_t hi = (begin + d < n) ? begin + d : n - 1;
+    double sum = 0.0, comp = 0.0;
+
+    (void)worker;
+
+    for (i = lo; i <= hi; ++i)
+        brahe_compensated_add(&sum,&comp,data[i]);
+
+    for (i = begin; i < end; ++i)
+    {
+        job->m_result[i] = (sum + comp) / (double)(hi - lo + 1);
+
+        if (hi + 1 < n)
+            brahe_compensated_add(&sum,&comp,data[++hi]);
+
+        if (i >= d)
+            brahe_compensated_add(&sum,&comp,-data[lo++]);
+    }
+}
+
+// Moving average, computed in parallel
+bool brahe_moving_average_into_exec(const brahe_exec_t * exec, const double * data, const size_t n, const size_t distance,
+                                    double * result)
+{
+    average_job_t job;
+    size_t grain;
+
+    if (exec == NULL)
+        return brahe_moving_average_into(data, n, distance, result);
+
+    if ((data == NULL) || (result == NULL) || (n == 0))
+        return false;
+
+    BRAHE_METRIC_BEGIN(BRAHE_METRIC_MOVING_AVERAGE, n);
+
+    job.m_data     = data;
+    job.m_n        = n;
+    job.m_distance = (distance < n) ? distance : n - 1;
+    job.m_result   = result;
+
+    // each task sums its first window from scratch; wide windows get
+    // longer tasks, so that costs at most a quarter of the work
+    grain = 4 * (2 * job.m_distance + 1);
+
+    if (grain < MOVING_AVERAGE_GRAIN)
+        grain = MOVING_AVERAGE_GRAIN;
+
+    brahe_exec_for(exec, n, grain, average_task, &job);
+
+    BRAHE_METRIC_END();
+    return true;
+}
+
+// Moving average
+double * brahe_moving_average(const double * data, const size_t n, const size_t distance)
+{
+    double * result = NULL;
+
+    if ((data != NULL) && (n > 0) && (n <= SIZE_MAX / sizeof(double)))
+    {
+        BRAHE_METRIC_BEGIN(BRAHE_METRIC_MOVING_AVERAGE, n);
+        result = (double *)brahe_allocate(brahe_allocator(), sizeof(double) * n, BRAHE_DEFAULT_ALIGN);
+
+        if (result != NULL)
+            brahe_moving_average_into(data,n,distance,result);
+
+        BRAHE_METRIC_END();
+    }
+
+    return result;
+}
+
+// Exponentially weighted moving average and variance for many series
+bool brahe_ewma_bank_init(brahe_ewma_bank_t * bank, const size_t n, const double alpha, const bool bias_correction)
+{
+    bool result = false;
+
+    if ((bank != NULL) && (n > 0) && (alpha > 0.0) && (alpha <= 1.0))
+    {
+        bank->m_allocator = *brahe_allocator();
+        bank->m_mean = (double *)brahe_allocate(&bank->m_allocator, sizeof(double) * n, BRAHE_SIMD_ALIGN);
+        bank->m_var  = (double *)brahe_allocate(&bank->m_allocator, sizeof(double) * n, BRAHE_SIMD_ALIGN);
+
+        if ((bank->m_mean != NULL) && (bank->m_var != NULL))
+        {
+            bank->m_n = n;
+            bank->m_alpha = alpha;
+            bank->m_bias_correction = bias_correction;
+            brahe_ewma_bank_reset(bank);
+            result = true;
+        }
+        else
+        {
+            brahe_release(&bank->m_allocator, bank->m_mean);
+            brahe_release(&bank->m_allocator, bank->m_var);
+            bank->m_mean = NULL;
+            bank->m_var  = NULL;
+        }
+    }
+
+    return result;
+}
+
+void brahe_ewma_bank_free(brahe_ewma_bank_t * bank)
+{
+    if (bank != NULL)
+    {
+        brahe_release(&bank->m_allocator, bank->m_mean);
+        brahe_release(&bank->m_allocator, bank->m_var);
+        bank->m_mean = NULL;
+        bank->m_var  = NULL;
+        bank->m_n = 0;
+    }
+}
+
+void brahe_ewma_bank_reset(brahe_ewma_bank_t * bank)
+{
+    size_t i;
+
+    if ((bank != NULL) && (bank->m_mean != NULL))
+    {
+        for (i = 0; i < bank->m_n; ++i)
+        {
+            bank->m_mean[i] = 0.0;
+            bank->m_var[i]  = 0.0;
+        }
+
+        bank->m_updates = 0;
+        bank->m_weight = 0.0;
+    }
+}
+
+void brahe_ewma_bank_update(brahe_ewma_bank_t * bank, const double * x)
+{
+    size_t i = 0;
+    double a, b;
+    double * mean;
+    double * var;
+
+    if ((bank == NULL) || (bank->m_mean == NULL) || (x == NULL))
+        return;
+
+    mean = bank->m_mean;
+    var  = bank->m_var;
+
+    // The weight given to the new sample is shared by every series. Bias
+    // correction normalizes by the total weight of the samples seen so far,
+    // W = 1 + (1 - alpha) + (1 - alpha)^2 + ...; folding that into the weight
+    // makes the stored values the corrected estimates, so nothing is needed
+    // when reading them. The weight is 1 for the first sample and approaches
+    // alpha as W approaches 1 / alpha.
+    ++bank->m_updates;
+
+    if (bank->m_bias_correction)
+    {
+        bank->m_weight = 1.0 + (1.0 - bank->m_alpha) * bank->m_weight;
+        a = 1.0 / bank->m_weight;
+
+        if (a < bank->m_alpha)
+            a = bank->m_alpha;
+    }
+    else
+        a = (bank->m_updates == 1) ? 1.0 : bank->m_alpha;
+
+    b = 1.0 - a;
+
+#if defined(BRAHE_HAVE_SSE2)
+    {
+        __m128d va = _mm_set1_pd(a);
+        __m128d vb = _mm_set1_pd(b);
+
+        for (; i + 2 <= bank->m_n; i += 2)
+        {
+            __m128d m = _mm_load_pd(mean + i);
+            __m128d d = _mm_sub_pd(_mm_loadu_pd(x + i), m);
+            __m128d inc = _mm_mul_pd(va, d);
+            _mm_store_pd(mean + i, _mm_add_pd(m, inc));
+            _mm_store_pd(var + i, _mm_mul_pd(vb, _mm_add_pd(_mm_load_pd(var + i), _mm_mul_pd(d, inc))));
+        }
+    }
+#endif
+
+    for (; i < bank->m_n; ++i)
+    {
+        double d = x[i] - mean[i];
+        double inc = a * d;
+        mean[i] += inc;
+        var[i] = b * (var[i] + d * inc);
+    }
+}
+
+const double * brahe_ewma_bank_means(const brahe_ewma_bank_t * bank)
+{
+    return (bank != NULL) ? bank->m_mean : NULL;
+}
+
+const double * brahe_ewma_bank_variances(const brahe_ewma_bank_t * bank)
+{
+    return (bank != NULL) ? bank->m_var : NULL;
+}
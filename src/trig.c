@@ -51,21 +51,463 @@
 */
 
 #include "mathtools.h"
+#include "internal.h"
+#include <string.h>
+
+/*
+    The inverse hyperbolic functions follow the range reductions used by
+    fdlibm: each is written as log1p of an argument that is computed without
+    cancellation near zero and without overflow for large values.
+*/
+
+// ln(2), and split into high and low parts so that k * LN2_HI is exact
+static const double LN2    = 6.93147180559945286227e-01;
+static const double LN2_HI = 6.93147180369123816490e-01;
+static const double LN2_LO = 1.90821492927058770002e-10;
+
+// above this, x and sqrt(x*x + 1) are equal in double precision
+static const double HUGE_ARG = 268435456.0;
+
+// below this, asinh(x) and atanh(x) round to x
+static const double TINY_ARG = 3.7252902984e-09;
 
 // hyperbolic arcsine
 double brahe_asinh(const double x)
 {
-    return log(x + sqrt(x * x + 1.0));
+    double t = fabs(x);
+    double result;
+
+    // also keeps the sign of zero
+    if (t < TINY_ARG)
+        return x;
+
+    if (t > HUGE_ARG)
+        result = log(t) + LN2;
+    else if (t > 2.0)
+        result = log(2.0 * t + 1.0 / (sqrt(t * t + 1.0) + t));
+    else
+        result = log1p(t + t * t / (1.0 + sqrt(1.0 + t * t)));
+
+    return (x < 0.0) ? -result : result;
 }
 
 //  hyperbolic arccosine
 double brahe_acosh(const double x)
 {
-    return log(x + sqrt(x * x - 1.0));
+    double t;
+
+    if (x < 1.0)
+#if defined(_MSC_VER)
+        return 0.0;
+#else
+        return NAN;
+#endif
+
+    if (x > HUGE_ARG)
+        return log(x) + LN2;
+
+    if (x > 2.0)
+        return log(2.0 * x - 1.0 / (x + sqrt(x * x - 1.0)));
+
+    t = x - 1.0;
+    return log1p(t + sqrt(2.0 * t + t * t));
 }
 
 //  hyperbolic arctangent
 double brahe_atanh(const double x)
 {
-    return log((1.0 + x) / (1.0 - x)) / 2.0;
+    double t = fabs(x);
+    double result;
+
+    if (t > 1.0)
+#if defined(_MSC_VER)
+        return 0.0;
+#else
+        return NAN;
+#endif
+
+    if (t < TINY_ARG)
+        return x;
+
+    if (t < 0.5)
+        result = 0.5 * log1p(2.0 * t + 2.0 * t * t / (1.0 - t));
+    else
+        result = 0.5 * log1p(2.0 * t / (1.0 - t));
+
+    return (x < 0.0) ? -result : result;
+}
+
+/*
+    Array versions. Each lane computes every candidate argument and selects
+    the right one with masks, so a single log1p evaluation serves the whole
+    range. The log1p kernel is fdlibm's: reduce 1 + u to 2^k * m with m in
+    [sqrt(2)/2, sqrt(2)), evaluate log(m) with a minimax polynomial in
+    s = (m - 1) / (m + 1), and correct for the rounding of 1 + u. Arguments
+    are never negative, and infinities and NaN pass through.
+*/
+
+#if defined(BRAHE_HAVE_SSE2)
+
+static const double LG1 = 6.666666666666735130e-01;
+static const double LG2 = 3.999999999940941908e-01;
+static const double LG3 = 2.857142874366239149e-01;
+static const double LG4 = 2.222219843214978396e-01;
+static const double LG5 = 1.818357216161805012e-01;
+static const double LG6 = 1.531383769920937332e-01;
+static const double LG7 = 1.479819860511658591e-01;
+
+// a quiet NaN, for compilers without NAN
+BRAHE_INLINE __m128d nan_pd()
+{
+    return _mm_castsi128_pd(_mm_set_epi32(0x7ff80000, 0, 0x7ff80000, 0));
+}
+
+// select a where mask is set, b elsewhere
+BRAHE_INLINE __m128d select_pd(const __m128d mask, const __m128d a, const __m128d b)
+{
+    return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+}
+
+// log1p for u >= 0, or +inf, or NaN
+static __m128d log1p_pd(const __m128d u)
+{
+    const __m128d one = _mm_set1_pd(1.0);
+    __m128d y, e, m, f, k, d, q, s, c, z, w, r, hfsq;
+    __m128i hx;
+
+    // rounding error of 1 + u
+    y = _mm_add_pd(one, u);
+    e = _mm_sub_pd(u, _mm_sub_pd(y, one));
+
+    // split y into exponent and mantissa, working on the high words only
+    hx = _mm_add_epi32(_mm_castpd_si128(y), _mm_set_epi32(0x3ff00000 - 0x3fe6a09e, 0, 0x3ff00000 - 0x3fe6a09e, 0));
+    k  = _mm_cvtepi32_pd(_mm_sub_epi32(_mm_shuffle_epi32(_mm_srli_epi32(hx, 20), _MM_SHUFFLE(3, 1, 3, 1)), _mm_set1_epi32(0x3ff)));
+    hx = _mm_and_si128(hx, _mm_set_epi32(0x000fffff, -1, 0x000fffff, -1));
+    hx = _mm_add_epi32(hx, _mm_set_epi32(0x3fe6a09e, 0, 0x3fe6a09e, 0));
+    m  = _mm_castsi128_pd(hx);
+    f  = _mm_sub_pd(m, one);
+
+    // s = f / (2 + f) and c = e / y share one division; the extra rounding
+    // only touches terms far below the leading f
+    d = _mm_add_pd(_mm_set1_pd(2.0), f);
+    q = _mm_div_pd(one, _mm_mul_pd(d, y));
+    s = _mm_mul_pd(_mm_mul_pd(f, y), q);
+    c = _mm_mul_pd(_mm_mul_pd(e, d), q);
+
+    // log(m) = f - f*f/2 + s * (f*f/2 + R(s*s))
+    hfsq = _mm_mul_pd(_mm_set1_pd(0.5), _mm_mul_pd(f, f));
+    z = _mm_mul_pd(s, s);
+    w = _mm_mul_pd(z, z);
+    r = _mm_add_pd(_mm_mul_pd(w, _mm_add_pd(_mm_set1_pd(LG2), _mm_mul_pd(w, _mm_add_pd(_mm_set1_pd(LG4), _mm_mul_pd(w, _mm_set1_pd(LG6)))))),
+                   _mm_mul_pd(z, _mm_add_pd(_mm_set1_pd(LG1), _mm_mul_pd(w, _mm_add_pd(_mm_set1_pd(LG3),
+                                 _mm_mul_pd(w, _mm_add_pd(_mm_set1_pd(LG5), _mm_mul_pd(w, _mm_set1_pd(LG7)))))))));
+
+    // k * ln2 + log(m) + c, smallest terms first
+    r = _mm_add_pd(_mm_mul_pd(s, _mm_add_pd(hfsq, r)), _mm_add_pd(_mm_mul_pd(k, _mm_set1_pd(LN2_LO)), c));
+    r = _mm_sub_pd(_mm_mul_pd(k, _mm_set1_pd(LN2_HI)), _mm_sub_pd(_mm_sub_pd(hfsq, r), f));
+
+    // infinity and NaN are their own logarithms
+    return select_pd(_mm_cmplt_pd(u, _mm_set1_pd(HUGE_VAL)), r, u);
+}
+
+static __m128d asinh_pd(const __m128d x)
+{
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d sign = _mm_set1_pd(-0.0);
+    __m128d t = _mm_andnot_pd(sign, x);
+    __m128d t2 = _mm_mul_pd(t, t);
+    __m128d root = _mm_sqrt_pd(_mm_add_pd(t2, one));
+    __m128d is_mid = _mm_cmpgt_pd(t, _mm_set1_pd(2.0));
+    __m128d is_big = _mm_cmpgt_pd(t, _mm_set1_pd(HUGE_ARG));
+
+    // small: t + t*t / (1 + root); mid: 2t - 1 + 1 / (root + t)
+    __m128d q = _mm_div_pd(select_pd(is_mid, one, t2), _mm_add_pd(root, select_pd(is_mid, t, one)));
+    __m128d arg = _mm_add_pd(select_pd(is_mid, _mm_sub_pd(_mm_add_pd(t, t), one), t), q);
+    __m128d r;
+
+    arg = select_pd(is_big, _mm_sub_pd(t, one), arg);
+    r = _mm_add_pd(log1p_pd(arg), _mm_and_pd(is_big, _mm_set1_pd(LN2)));
+
+    return _mm_or_pd(r, _mm_and_pd(sign, x));
+}
+
+static __m128d acosh_pd(const __m128d x)
+{
+    const __m128d one = _mm_set1_pd(1.0);
+    __m128d t = _mm_sub_pd(x, one);
+    __m128d is_mid = _mm_cmpgt_pd(x, _mm_set1_pd(2.0));
+    __m128d is_big = _mm_cmpgt_pd(x, _mm_set1_pd(HUGE_ARG));
+
+    // small: t + sqrt(2t + t*t); mid: 2x - 1 - 1 / (x + sqrt(x*x - 1))
+    __m128d root = _mm_sqrt_pd(select_pd(is_mid, _mm_sub_pd(_mm_mul_pd(x, x), one), _mm_add_pd(_mm_add_pd(t, t), _mm_mul_pd(t, t))));
+    __m128d mid = _mm_sub_pd(_mm_sub_pd(_mm_add_pd(x, x), one), _mm_div_pd(one, _mm_add_pd(x, root)));
+    __m128d arg = select_pd(is_mid, select_pd(is_big, t, mid), _mm_add_pd(t, root));
+    __m128d r = _mm_add_pd(log1p_pd(arg), _mm_and_pd(is_big, _mm_set1_pd(LN2)));
+
+    // below the domain
+    return select_pd(_mm_cmplt_pd(x, one), nan_pd(), r);
+}
+
+static __m128d atanh_pd(const __m128d x)
+{
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d sign = _mm_set1_pd(-0.0);
+    __m128d t = _mm_andnot_pd(sign, x);
+    __m128d t2 = _mm_add_pd(t, t);
+    __m128d q = _mm_div_pd(t2, _mm_sub_pd(one, t));
+
+    // small: 2t + 2t*t / (1 - t); large: 2t / (1 - t)
+    __m128d arg = select_pd(_mm_cmplt_pd(t, _mm_set1_pd(0.5)), _mm_add_pd(t2, _mm_mul_pd(q, t)), q);
+    __m128d r = _mm_mul_pd(_mm_set1_pd(0.5), log1p_pd(arg));
+
+    // outside the domain
+    r = select_pd(_mm_cmpgt_pd(t, one), nan_pd(), r);
+    return _mm_or_pd(r, _mm_and_pd(sign, x));
+}
+
+// apply a two-lane kernel to an array, padding the odd element
+#define APPLY_PD(kernel, in, out, n)                              \
+    {                                                             \
+        size_t i;                                                 \
+        double pad[2];                                            \
+                                                                  \
+        for (i = 0; i + 2 <= n; i += 2)                           \
+            _mm_storeu_pd(out + i, kernel(_mm_loadu_pd(in + i))); \
+                                                                  \
+        if (i < n)                                                \
+        {                                                         \
+            pad[0] = in[i];                                       \
+            pad[1] = in[i];                                       \
+            _mm_storeu_pd(pad, kernel(_mm_loadu_pd(pad)));        \
+            out[i] = pad[0];                                      \
+        }                                                         \
+    }
+
+/*
+    Single precision, four lanes at a time, with the same reductions. The
+    log1p kernel uses the float polynomial of musl's logf; the constants
+    below are rounded for float.
+*/
+
+static const float LN2F      = 6.9314718056e-01f;
+static const float LN2F_HI   = 6.9313812256e-01f;
+static const float LN2F_LO   = 9.0580006145e-06f;
+static const float HUGE_ARGF = 4096.0f;
+
+static const float LG1F = 0.66666662693f;
+static const float LG2F = 0.40000972152f;
+static const float LG3F = 0.28498786688f;
+static const float LG4F = 0.24279078841f;
+
+BRAHE_INLINE __m128 nan_ps()
+{
+    return _mm_castsi128_ps(_mm_set1_epi32(0x7fc00000));
+}
+
+BRAHE_INLINE __m128 select_ps(const __m128 mask, const __m128 a, const __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// log1p for u >= 0, or +inf, or NaN
+static __m128 log1p_ps(const __m128 u)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 y, e, m, f, k, d, q, s, c, z, w, r, hfsq;
+    __m128i hx;
+
+    // rounding error of 1 + u
+    y = _mm_add_ps(one, u);
+    e = _mm_sub_ps(u, _mm_sub_ps(y, one));
+
+    // split y into exponent and mantissa
+    hx = _mm_add_epi32(_mm_castps_si128(y), _mm_set1_epi32(0x3f800000 - 0x3f3504f3));
+    k  = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(hx, 23), _mm_set1_epi32(0x7f)));
+    hx = _mm_add_epi32(_mm_and_si128(hx, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f3504f3));
+    m  = _mm_castsi128_ps(hx);
+    f  = _mm_sub_ps(m, one);
+
+    // s = f / (2 + f) and c = e / y share one division
+    d = _mm_add_ps(_mm_set1_ps(2.0f), f);
+    q = _mm_div_ps(one, _mm_mul_ps(d, y));
+    s = _mm_mul_ps(_mm_mul_ps(f, y), q);
+    c = _mm_mul_ps(_mm_mul_ps(e, d), q);
+
+    // log(m) = f - f*f/2 + s * (f*f/2 + R(s*s))
+    hfsq = _mm_mul_ps(_mm_set1_ps(0.5f), _mm_mul_ps(f, f));
+    z = _mm_mul_ps(s, s);
+    w = _mm_mul_ps(z, z);
+    r = _mm_add_ps(_mm_mul_ps(w, _mm_add_ps(_mm_set1_ps(LG2F), _mm_mul_ps(w, _mm_set1_ps(LG4F)))),
+                   _mm_mul_ps(z, _mm_add_ps(_mm_set1_ps(LG1F), _mm_mul_ps(w, _mm_set1_ps(LG3F)))));
+
+    // k * ln2 + log(m) + c, smallest terms first
+    r = _mm_add_ps(_mm_mul_ps(s, _mm_add_ps(hfsq, r)), _mm_add_ps(_mm_mul_ps(k, _mm_set1_ps(LN2F_LO)), c));
+    r = _mm_sub_ps(_mm_mul_ps(k, _mm_set1_ps(LN2F_HI)), _mm_sub_ps(_mm_sub_ps(hfsq, r), f));
+
+    // infinity and NaN are their own logarithms
+    return select_ps(_mm_cmplt_ps(u, _mm_set1_ps(HUGE_VALF)), r, u);
+}
+
+static __m128 asinh_ps(const __m128 x)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    __m128 t = _mm_andnot_ps(sign, x);
+    __m128 t2 = _mm_mul_ps(t, t);
+    __m128 root = _mm_sqrt_ps(_mm_add_ps(t2, one));
+    __m128 is_mid = _mm_cmpgt_ps(t, _mm_set1_ps(2.0f));
+    __m128 is_big = _mm_cmpgt_ps(t, _mm_set1_ps(HUGE_ARGF));
+
+    // small: t + t*t / (1 + root); mid: 2t - 1 + 1 / (root + t)
+    __m128 q = _mm_div_ps(select_ps(is_mid, one, t2), _mm_add_ps(root, select_ps(is_mid, t, one)));
+    __m128 arg = _mm_add_ps(select_ps(is_mid, _mm_sub_ps(_mm_add_ps(t, t), one), t), q);
+    __m128 r;
+
+    arg = select_ps(is_big, _mm_sub_ps(t, one), arg);
+    r = _mm_add_ps(log1p_ps(arg), _mm_and_ps(is_big, _mm_set1_ps(LN2F)));
+
+    return _mm_or_ps(r, _mm_and_ps(sign, x));
+}
+
+static __m128 acosh_ps(const __m128 x)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 t = _mm_sub_ps(x, one);
+    __m128 is_mid = _mm_cmpgt_ps(x, _mm_set1_ps(2.0f));
+    __m128 is_big = _mm_cmpgt_ps(x, _mm_set1_ps(HUGE_ARGF));
+
+    // small: t + sqrt(2t + t*t); mid: 2x - 1 - 1 / (x + sqrt(x*x - 1))
+    __m128 root = _mm_sqrt_ps(select_ps(is_mid, _mm_sub_ps(_mm_mul_ps(x, x), one), _mm_add_ps(_mm_add_ps(t, t), _mm_mul_ps(t, t))));
+    __m128 mid = _mm_sub_ps(_mm_sub_ps(_mm_add_ps(x, x), one), _mm_div_ps(one, _mm_add_ps(x, root)));
+    __m128 arg = select_ps(is_mid, select_ps(is_big, t, mid), _mm_add_ps(t, root));
+    __m128 r = _mm_add_ps(log1p_ps(arg), _mm_and_ps(is_big, _mm_set1_ps(LN2F)));
+
+    // below the domain
+    return select_ps(_mm_cmplt_ps(x, one), nan_ps(), r);
+}
+
+static __m128 atanh_ps(const __m128 x)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    __m128 t = _mm_andnot_ps(sign, x);
+    __m128 t2 = _mm_add_ps(t, t);
+    __m128 q = _mm_div_ps(t2, _mm_sub_ps(one, t));
+
+    // small: 2t + 2t*t / (1 - t); large: 2t / (1 - t)
+    __m128 arg = select_ps(_mm_cmplt_ps(t, _mm_set1_ps(0.5f)), _mm_add_ps(t2, _mm_mul_ps(q, t)), q);
+    __m128 r = _mm_mul_ps(_mm_set1_ps(0.5f), log1p_ps(arg));
+
+    // outside the domain
+    r = select_ps(_mm_cmpgt_ps(t, one), nan_ps(), r);
+    return _mm_or_ps(r, _mm_and_ps(sign, x));
+}
+
+// apply a four-lane kernel to an array, padding the last few elements
+#define APPLY_PS(kernel, in, out, n)                              \
+    {                                                             \
+        size_t i, j;                                              \
+        float pad[4];                                             \
+                                                                  \
+        for (i = 0; i + 4 <= n; i += 4)                           \
+            _mm_storeu_ps(out + i, kernel(_mm_loadu_ps(in + i))); \
+                                                                  \
+        if (i < n)                                                \
+        {                                                         \
+            for (j = 0; j < 4; ++j)                               \
+                pad[j] = in[(i + j < n) ? i + j : i];             \
+                                                                  \
+            _mm_storeu_ps(pad, kernel(_mm_loadu_ps(pad)));        \
+                                                                  \
+            for (j = 0; i + j < n; ++j)                           \
+                out[i + j] = pad[j];                              \
+        }                                                         \
+    }
+
+#else
+
+// without SSE2, the array versions are loops over the scalar functions
+#define APPLY_PD(kernel, in, out, n)                              \
+    {                                                             \
+        size_t i;                                                 \
+                                                                  \
+        for (i = 0; i < n; ++i)                                   \
+            out[i] = kernel(in[i]);                               \
+    }
+
+#define asinh_pd brahe_asinh
+#define acosh_pd brahe_acosh
+#define atanh_pd brahe_atanh
+
+#define APPLY_PS APPLY_PD
+#define asinh_ps(x) (float)brahe_asinh(x)
+#define acosh_ps(x) (float)brahe_acosh(x)
+#define atanh_ps(x) (float)brahe_atanh(x)
+
+#endif
+
+bool brahe_asinh_v(const double * in, double * out, const size_t n)
+{
+    if ((in == NULL) || (out == NULL))
+        return false;
+
+    BRAHE_METRIC_BEGIN(BRAHE_METRIC_INVERSE_HYPERBOLIC, n);
+    APPLY_PD(asinh_pd, in, out, n);
+    BRAHE_METRIC_END();
+    return true;
+}
+
+bool brahe_acosh_v(const double * in, double * out, const size_t n)
+{
+    if ((in == NULL) || (out == NULL))
+        return false;
+
+    BRAHE_METRIC_BEGIN(BRAHE_METRIC_INVERSE_HYPERBOLIC, n);
+    APPLY_PD(acosh_pd, in, out, n);
+    BRAHE_METRIC_END();
+    return true;
+}
+
+bool brahe_atanh_v(const double * in, double * out, const size_t n)
+{
+    if ((in == NULL) || (out == NULL))
+        return false;
+
+    BRAHE_METRIC_BEGIN(BRAHE_METRIC_INVERSE_HYPERBOLIC, n);
+    APPLY_PD(atanh_pd, in, out, n);
+    BRAHE_METRIC_END();
+    return true;
+}
+
+bool brahe_asinh_v_f(const float * in, float * out, const size_t n)
+{
+    if ((in == NULL) || (out == NULL))
+        return false;
+
+    BRAHE_METRIC_BEGIN(BRAHE_METRIC_INVERSE_HYPERBOLIC_F, n);
+    APPLY_PS(asinh_ps, in, out, n);
+    BRAHE_METRIC_END();
+    return true;
+}
+
+bool brahe_acosh_v_f(const float * in, float * out, const size_t n)
+{
+    if ((in == NULL) || (out == NULL))
+        return false;
+
+    BRAHE_METRIC_BEGIN(BRAHE_METRIC_INVERSE_HYPERBOLIC_F, n);
+    APPLY_PS(acosh_ps, in, out, n);
+    BRAHE_METRIC_END();
+    return true;
+}
+
+bool brahe_atanh_v_f(const float * in, float * out, const size_t n)
+{
+    if ((in == NULL) || (out == NULL))
+        return false;
+
+    BRAHE_METRIC_BEGIN(BRAHE_METRIC_INVERSE_HYPERBOLIC_F, n);
+    APPLY_PS(atanh_ps, in, out, n);
+    BRAHE_METRIC_END();
+    return true;
 }
@@ -0,0 +1,744 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+/*
+    Micro-benchmarks for the library, reported as JSON.
+
+        brahe_bench [-r repetitions] [-n elements] [filter ...]
+
+    Each benchmark runs on prepared input until warm, then is timed for a
+    number of repetitions with a monotonic clock. Results give the spread
+    of those repetitions as percentiles, and the median cost per element
+    in nanoseconds and, on x86, in time-stamp-counter cycles. Only
+    benchmarks whose names contain one of the filters are run.
+*/
+
+#include "../src/mathtools.h"
+#include "../src/prng.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define BENCH_HAVE_TSC
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC
+#endif
+
+// keeps a result alive, so the work that made it cannot be optimized away
+#if defined(__GNUC__)
+#define BENCH_KEEP(p) __asm__ __volatile__("" : : "g"(p) : "memory")
+#else
+static const void * volatile bench_sink;
+#define BENCH_KEEP(p) (bench_sink = (const void *)(p))
+#endif
+
+// time spent running a benchmark before measuring it
+static const double WARMUP_SECONDS = 0.05;
+
+//-----------------------------------------------------------------------------
+// clock
+//-----------------------------------------------------------------------------
+
+static double now_ns(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER count, freq;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&freq);
+    return (double)count.QuadPart * 1.0e9 / (double)freq.QuadPart;
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec * 1.0e9 + (double)t.tv_nsec;
+#endif
+}
+
+static uint64_t now_tsc(void)
+{
+#if defined(BENCH_HAVE_TSC)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// shared input and output
+//-----------------------------------------------------------------------------
+
+typedef struct
+{
+    size_t    m_n;          // elements per run
+    int       m_param;      // benchmark-specific: algorithm, format, ...
+    double *  m_data;       // n signal-like doubles
+    double *  m_work;       // scratch copy of m_data
+    double *  m_out;        // n doubles of output
+    float *   m_fdata;      // m_data rounded to float
+    float *   m_fout;       // n floats of output
+    float *   m_fwork;      // 8n floats of scratch, enough for an FFT
+    uint64_t * m_ints;      // n random 64-bit values
+    uint64_t * m_odd;       // n random odd values, for number theory
+    uint64_t * m_int_out;   // n 64-bit results
+    bool *    m_flags;      // n boolean results
+    uint32_t * m_words;     // n 32-bit outputs
+    char *    m_arena;      // room for n pretty-printed values
+    size_t *  m_offsets;    // n + 1 offsets into m_arena
+    size_t    m_arena_len;
+    brahe_prng_state_t m_prng;
+    double    m_result;     // scalar results land here
+}
+bench_context_t;
+
+typedef void (*bench_fn)(bench_context_t * c);
+
+typedef struct
+{
+    const char * m_name;
+    int          m_param;
+    size_t       m_n;       // elements per run; 0 uses the default
+    bench_fn     m_prepare; // untimed, before every run; may be NULL
+    bench_fn     m_run;
+}
+bench_t;
+
+static bool context_init(bench_context_t * c, const size_t n)
+{
+    size_t i;
+    uint64_t s = 0x9E3779B97F4A7C15ULL;
+
+    memset(c, 0, sizeof(bench_context_t));
+    c->m_n = n;
+    c->m_data = (double *)malloc(n * sizeof(double));
+    c->m_work = (double *)malloc(n * sizeof(double));
+    c->m_out = (double *)malloc(n * sizeof(double));
+    c->m_fdata = (float *)malloc(n * sizeof(float));
+    c->m_fout = (float *)malloc(n * sizeof(float));
+    c->m_fwork = (float *)malloc(8 * n * sizeof(float));
+    c->m_ints = (uint64_t *)malloc(n * sizeof(uint64_t));
+    c->m_odd = (uint64_t *)malloc(n * sizeof(uint64_t));
+    c->m_int_out = (uint64_t *)malloc(n * sizeof(uint64_t));
+    c->m_flags = (bool *)malloc(n * sizeof(bool));
+    c->m_words = (uint32_t *)malloc(n * sizeof(uint32_t));
+    c->m_offsets = (size_t *)malloc((n + 1) * sizeof(size_t));
+
+    if ((c->m_data == NULL) || (c->m_work == NULL) || (c->m_out == NULL) || (c->m_ints == NULL) || (c->m_odd == NULL)
+        || (c->m_fdata == NULL) || (c->m_fout == NULL) || (c->m_fwork == NULL)
+        || (c->m_int_out == NULL) || (c->m_flags == NULL) || (c->m_words == NULL) || (c->m_offsets == NULL))
+        return false;
+
+    for (i = 0; i < n; ++i)
+    {
+        s ^= s << 13;
+        s ^= s >> 7;
+        s ^= s << 17;
+
+        c->m_ints[i] = s;
+        c->m_odd[i] = s | 1;
+        c->m_data[i] = 100.0 * sin((double)i * 0.01) + (double)(s >> 11) * (1.0 / 9007199254740992.0);
+        c->m_fdata[i] = (float)c->m_data[i];
+    }
+
+    c->m_arena_len = brahe_pretty_int_array_size((const int64_t *)c->m_ints, n, BRAHE_PRETTY_TEXT);
+    c->m_arena = (char *)malloc(c->m_arena_len);
+
+    brahe_prng_init(&c->m_prng, BRAHE_PRNG_KISS, 12345);
+
+    return (c->m_arena != NULL);
+}
+
+static void context_free(bench_context_t * c)
+{
+    free(c->m_data);
+    free(c->m_work);
+    free(c->m_out);
+    free(c->m_fdata);
+    free(c->m_fout);
+    free(c->m_fwork);
+    free(c->m_ints);
+    free(c->m_odd);
+    free(c->m_int_out);
+    free(c->m_flags);
+    free(c->m_words);
+    free(c->m_arena);
+    free(c->m_offsets);
+    brahe_prng_free(&c->m_prng);
+}
+
+//-----------------------------------------------------------------------------
+// benchmarks
+//-----------------------------------------------------------------------------
+
+static void prepare_copy(bench_context_t * c)
+{
+    memcpy(c->m_work, c->m_data, c->m_n * sizeof(double));
+}
+
+static void prepare_prng(bench_context_t * c)
+{
+    brahe_prng_free(&c->m_prng);
+    brahe_prng_init(&c->m_prng, (brahe_prng_type_t)c->m_param, 12345);
+}
+
+static void run_prng_next(bench_context_t * c)
+{
+    size_t i;
+    uint32_t x = 0;
+
+    for (i = 0; i < c->m_n; ++i)
+        x ^= brahe_prng_next(&c->m_prng);
+
+    c->m_result = (double)x;
+    BENCH_KEEP(&c->m_result);
+}
+
+static void run_prng_real53(bench_context_t * c)
+{
+    size_t i;
+    double x = 0.0;
+
+    for (i = 0; i < c->m_n; ++i)
+        x += brahe_prng_real53(&c->m_prng);
+
+    c->m_result = x;
+    BENCH_KEEP(&c->m_result);
+}
+
+static void run_prng_fill(bench_context_t * c)
+{
+    brahe_prng_fill(&c->m_prng, c->m_words, c->m_n);
+    BENCH_KEEP(c->m_words);
+}
+
+static void run_fft(bench_context_t * c)
+{
+    double * result = brahe_simple_fft(c->m_data, c->m_n);
+    BENCH_KEEP(result);
+    brahe_free(result);
+}
+
+static void run_fft2(bench_context_t * c)
+{
+    double * result = brahe_simple_fft2(c->m_data, c->m_n);
+    BENCH_KEEP(result);
+    brahe_free(result);
+}
+
+static void run_fft_f(bench_context_t * c)
+{
+    brahe_simple_fft_into_f(c->m_fdata, c->m_n, c->m_fout, c->m_fwork);
+    BENCH_KEEP(c->m_fout);
+}
+
+static void run_statistics_f(bench_context_t * c)
+{
+    brahe_statistics stats = brahe_get_statistics_f(c->m_fdata, c->m_n);
+    c->m_result = stats.mean + stats.variance;
+    BENCH_KEEP(&c->m_result);
+}
+
+static void run_statistics(bench_context_t * c)
+{
+    brahe_statistics stats = brahe_get_statistics(c->m_data, c->m_n);
+    c->m_result = stats.mean + stats.variance;
+    BENCH_KEEP(&c->m_result);
+}
+
+static void run_median(bench_context_t * c)
+{
+    c->m_result = brahe_median(c->m_work, c->m_n);
+    BENCH_KEEP(&c->m_result);
+}
+
+static void run_quantiles(bench_context_t * c)
+{
+    static const double q[5] = { 0.01, 0.25, 0.5, 0.75, 0.99 };
+    double result[5];
+
+    brahe_quantiles(c->m_work, c->m_n, q, 5, result);
+    BENCH_KEEP(result);
+}
+
+static void run_quantile_sketch(bench_context_t * c)
+{
+    brahe_quantile_sketch_t sketch;
+
+    brahe_quantile_sketch_init(&sketch, 200);
+    brahe_quantile_sketch_add_n(&sketch, c->m_data, c->m_n);
+    c->m_result = brahe_quantile_sketch_query(&sketch, 0.5);
+    BENCH_KEEP(&c->m_result);
+    brahe_quantile_sketch_free(&sketch);
+}
+
+static void run_histogram(bench_context_t * c)
+{
+    brahe_histogram_t hist;
+
+    brahe_histogram_init_linear(&hist, -100.0, 100.0, 64);
+    brahe_histogram_add_n(&hist, c->m_data, c->m_n);
+    BENCH_KEEP(brahe_histogram_counts(&hist));
+    brahe_histogram_free(&hist);
+}
+
+static void run_moving_average(bench_context_t * c)
+{
+    brahe_moving_average_into(c->m_data, c->m_n, 16, c->m_out);
+    BENCH_KEEP(c->m_out);
+}
+
+static void run_moving_average_prefix(bench_context_t * c)
+{
+    brahe_moving_average_prefix_into(c->m_data, c->m_n, 16, c->m_out);
+    BENCH_KEEP(c->m_out);
+}
+
+static void run_moving_window(bench_context_t * c)
+{
+    brahe_moving_window_t window;
+    brahe_statistics stats;
+
+    brahe_moving_window_init(&window, 256);
+    brahe_moving_window_push_n(&window, c->m_data, c->m_n);
+    stats = brahe_moving_window_statistics(&window);
+    c->m_result = stats.mean;
+    BENCH_KEEP(&c->m_result);
+    brahe_moving_window_free(&window);
+}
+
+static void run_ewma_bank(bench_context_t * c)
+{
+    // 64 series, updated n / 64 times
+    brahe_ewma_bank_t bank;
+    size_t i;
+
+    brahe_ewma_bank_init(&bank, 64, 0.05, true);
+
+    for (i = 0; i + 64 <= c->m_n; i += 64)
+        brahe_ewma_bank_update(&bank, c->m_data + i);
+
+    BENCH_KEEP(brahe_ewma_bank_means(&bank));
+    brahe_ewma_bank_free(&bank);
+}
+
+static void run_sinusoid(bench_context_t * c)
+{
+    static const brahe_wave_factor_t factors[3] = { { 100.0, 1.0 }, { 33.0, 0.5 }, { 7.5, 0.25 } };
+
+    brahe_make_sinusoid_into(factors, 3, c->m_out, c->m_n);
+    BENCH_KEEP(c->m_out);
+}
+
+static void run_noise(bench_context_t * c)
+{
+    brahe_add_noise_r(&c->m_prng, c->m_work, c->m_n, (brahe_noise_type_t)c->m_param, 0.1);
+    BENCH_KEEP(c->m_work);
+}
+
+static void run_noise_seeded(bench_context_t * c)
+{
+    brahe_add_noise_seeded(c->m_work, c->m_n, BRAHE_NOISE_GAUSSIAN, 0.1, 12345, (size_t)c->m_param);
+    BENCH_KEEP(c->m_work);
+}
+
+static void run_signal(bench_context_t * c)
+{
+    static const brahe_wave_factor_t factors[2] = { { 100.0, 1.0 }, { 33.0, 0.5 } };
+    brahe_signal_t signal;
+
+    brahe_signal_init(&signal, 4, 12345);
+    brahe_signal_add_sine(&signal, &factors[0], 0.0);
+    brahe_signal_add_square(&signal, &factors[1], 0.25);
+    brahe_signal_set_noise(&signal, BRAHE_NOISE_GAUSSIAN, 0.1);
+    brahe_signal_generate(&signal, c->m_out, c->m_n);
+    BENCH_KEEP(c->m_out);
+    brahe_signal_free(&signal);
+}
+
+static void run_asinh(bench_context_t * c)
+{
+    size_t i;
+
+    for (i = 0; i < c->m_n; ++i)
+        c->m_out[i] = brahe_asinh(c->m_data[i]);
+
+    BENCH_KEEP(c->m_out);
+}
+
+static void run_asinh_v(bench_context_t * c)
+{
+    brahe_asinh_v(c->m_data, c->m_out, c->m_n);
+    BENCH_KEEP(c->m_out);
+}
+
+static void run_asinh_v_f(bench_context_t * c)
+{
+    brahe_asinh_v_f(c->m_fdata, c->m_fout, c->m_n);
+    BENCH_KEEP(c->m_fout);
+}
+
+static void run_acosh_v(bench_context_t * c)
+{
+    brahe_acosh_v(c->m_work, c->m_out, c->m_n);
+    BENCH_KEEP(c->m_out);
+}
+
+static void run_atanh_v(bench_context_t * c)
+{
+    brahe_atanh_v(c->m_work, c->m_out, c->m_n);
+    BENCH_KEEP(c->m_out);
+}
+
+// acosh needs x >= 1 and atanh needs |x| < 1
+static void prepare_acosh(bench_context_t * c)
+{
+    size_t i;
+
+    for (i = 0; i < c->m_n; ++i)
+        c->m_work[i] = 1.0 + fabs(c->m_data[i]);
+}
+
+static void prepare_atanh(bench_context_t * c)
+{
+    size_t i;
+
+    for (i = 0; i < c->m_n; ++i)
+        c->m_work[i] = c->m_data[i] / 101.0;
+}
+
+static void run_round_nearest_v(bench_context_t * c)
+{
+    brahe_round_nearest_v(c->m_data, c->m_out, c->m_n);
+    BENCH_KEEP(c->m_out);
+}
+
+static void run_sigdig(bench_context_t * c)
+{
+    size_t i;
+
+    for (i = 0; i < c->m_n; ++i)
+        c->m_out[i] = brahe_sigdig(c->m_data[i], 4);
+
+    BENCH_KEEP(c->m_out);
+}
+
+static void run_sigdig_v(bench_context_t * c)
+{
+    brahe_sigdig_v(c->m_data, c->m_out, c->m_n, 4);
+    BENCH_KEEP(c->m_out);
+}
+
+static void run_gcf(bench_context_t * c)
+{
+    size_t i;
+
+    for (i = 0; i + 1 < c->m_n; ++i)
+        c->m_int_out[i] = brahe_gcf(c->m_ints[i], c->m_ints[i + 1]);
+
+    BENCH_KEEP(c->m_int_out);
+}
+
+static void run_mulmod_array(bench_context_t * c)
+{
+    brahe_mulmod_array(c->m_ints, c->m_odd, c->m_n, 0xFFFFFFFFFFFFFFC5ULL, c->m_int_out);
+    BENCH_KEEP(c->m_int_out);
+}
+
+static void run_powmod_array(bench_context_t * c)
+{
+    brahe_powmod_array(c->m_ints, c->m_n, 65537, 0xFFFFFFFFFFFFFFC5ULL, c->m_int_out);
+    BENCH_KEEP(c->m_int_out);
+}
+
+static void run_is_prime_array(bench_context_t * c)
+{
+    brahe_is_prime_array(c->m_odd, c->m_n, c->m_flags);
+    BENCH_KEEP(c->m_flags);
+}
+
+static void run_pretty_int(bench_context_t * c)
+{
+    size_t i;
+    char buffer[256];
+
+    for (i = 0; i < c->m_n; ++i)
+    {
+        brahe_pretty_int_r((int64_t)c->m_ints[i], (brahe_pretty_format)c->m_param, buffer, sizeof(buffer));
+        BENCH_KEEP(buffer);
+    }
+}
+
+static void run_pretty_int_array(bench_context_t * c)
+{
+    brahe_pretty_int_array((const int64_t *)c->m_ints, c->m_n, (brahe_pretty_format)c->m_param, c->m_arena, c->m_arena_len, c->m_offsets);
+    BENCH_KEEP(c->m_arena);
+}
+
+static const bench_t benchmarks[] =
+{
+    { "prng_next/mt",             BRAHE_PRNG_MARSENNE_TWISTER, 0, prepare_prng, run_prng_next },
+    { "prng_next/kiss",           BRAHE_PRNG_KISS,             0, prepare_prng, run_prng_next },
+    { "prng_next/mwc1038",        BRAHE_PRNG_MWC1038,          0, prepare_prng, run_prng_next },
+    { "prng_next/cmwc4096",       BRAHE_PRNG_CMWC4096,         0, prepare_prng, run_prng_next },
+    { "prng_next/isaac",          BRAHE_PRNG_ISAAC,            0, prepare_prng, run_prng_next },
+    { "prng_fill/mt",             BRAHE_PRNG_MARSENNE_TWISTER, 0, prepare_prng, run_prng_fill },
+    { "prng_fill/kiss",           BRAHE_PRNG_KISS,             0, prepare_prng, run_prng_fill },
+    { "prng_fill/mwc1038",        BRAHE_PRNG_MWC1038,          0, prepare_prng, run_prng_fill },
+    { "prng_fill/cmwc4096",       BRAHE_PRNG_CMWC4096,         0, prepare_prng, run_prng_fill },
+    { "prng_fill/isaac",          BRAHE_PRNG_ISAAC,            0, prepare_prng, run_prng_fill },
+    { "prng_real53/kiss",         BRAHE_PRNG_KISS,             0, prepare_prng, run_prng_real53 },
+    { "simple_fft2/256",          0,                         256, NULL,         run_fft2 },
+    { "simple_fft2/4096",         0,                        4096, NULL,         run_fft2 },
+    { "simple_fft2/65536",        0,                       65536, NULL,         run_fft2 },
+    { "simple_fft/1000",          0,                        1000, NULL,         run_fft },
+    { "simple_fft_into_f/1000",   0,                        1000, NULL,         run_fft_f },
+    { "get_statistics",           0,                           0, NULL,         run_statistics },
+    { "get_statistics_f",         0,                           0, NULL,         run_statistics_f },
+    { "median",                   0,                           0, prepare_copy, run_median },
+    { "quantiles/5",              0,                           0, prepare_copy, run_quantiles },
+    { "quantile_sketch/k200",     0,                           0, NULL,         run_quantile_sketch },
+    { "histogram_add_n/linear64", 0,                           0, NULL,         run_histogram },
+    { "moving_average_into/16",   0,                           0, NULL,         run_moving_average },
+    { "moving_average_prefix/16", 0,                           0, NULL,         run_moving_average_prefix },
+    { "moving_window/256",        0,                           0, NULL,         run_moving_window },
+    { "ewma_bank/64",             0,                           0, NULL,         run_ewma_bank },
+    { "make_sinusoid_into/3",     0,                           0, NULL,         run_sinusoid },
+    { "add_noise_r/uniform",      BRAHE_NOISE_UNIFORM,         0, prepare_copy, run_noise },
+    { "add_noise_r/gaussian",     BRAHE_NOISE_GAUSSIAN,        0, prepare_copy, run_noise },
+    { "add_noise_seeded/1",       1,                           0, prepare_copy, run_noise_seeded },
+    { "add_noise_seeded/all",     0,                           0, prepare_copy, run_noise_seeded },
+    { "signal_generate",          0,                           0, NULL,         run_signal },
+    { "asinh",                    0,                           0, NULL,         run_asinh },
+    { "asinh_v",                  0,                           0, NULL,         run_asinh_v },
+    { "asinh_v_f",                0,                           0, NULL,         run_asinh_v_f },
+    { "acosh_v",                  0,                           0, prepare_acosh, run_acosh_v },
+    { "atanh_v",                  0,                           0, prepare_atanh, run_atanh_v },
+    { "round_nearest_v",          0,                           0, NULL,         run_round_nearest_v },
+    { "sigdig/4",                 0,                           0, NULL,         run_sigdig },
+    { "sigdig_v/4",               0,                           0, NULL,         run_sigdig_v },
+    { "gcf",                      0,                           0, NULL,         run_gcf },
+    { "mulmod_array",             0,                           0, NULL,         run_mulmod_array },
+    { "powmod_array/65537",       0,                           0, NULL,         run_powmod_array },
+    { "is_prime_array",           0,                           0, NULL,         run_is_prime_array },
+    { "pretty_int_r/comma",       BRAHE_PRETTY_COMMA,          0, NULL,         run_pretty_int },
+    { "pretty_int_r/text",        BRAHE_PRETTY_TEXT,           0, NULL,         run_pretty_int },
+    { "pretty_int_array/comma",   BRAHE_PRETTY_COMMA,          0, NULL,         run_pretty_int_array },
+    { "pretty_int_array/text",    BRAHE_PRETTY_TEXT,           0, NULL,         run_pretty_int_array }
+};
+
+//-----------------------------------------------------------------------------
+// measurement
+//-----------------------------------------------------------------------------
+
+static int compare_doubles(const void * a, const void * b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x < y) ? -1 : (x > y);
+}
+
+// nearest-rank percentile of sorted samples
+static double percentile(const double * sorted, const size_t n, const double p)
+{
+    size_t rank = (size_t)ceil(p / 100.0 * (double)n);
+    return sorted[(rank > 0) ? rank - 1 : 0];
+}
+
+static bool selected(const char * name, int argc, char * argv[], int first)
+{
+    int i;
+
+    if (first >= argc)
+        return true;
+
+    for (i = first; i < argc; ++i)
+    {
+        if (strstr(name, argv[i]) != NULL)
+            return true;
+    }
+
+    return false;
+}
+
+static void measure(const bench_t * b, bench_context_t * c, const size_t reps, double * ns, double * ticks, bool first)
+{
+    size_t i;
+    double start, warm;
+    uint64_t tsc;
+
+    c->m_param = b->m_param;
+
+    // warm caches, branch predictors, lazily built tables, and the clock
+    warm = now_ns();
+
+    do
+    {
+        if (b->m_prepare != NULL)
+            b->m_prepare(c);
+
+        b->m_run(c);
+    }
+    while (now_ns() - warm < WARMUP_SECONDS * 1.0e9);
+
+    for (i = 0; i < reps; ++i)
+    {
+        if (b->m_prepare != NULL)
+            b->m_prepare(c);
+
+        start = now_ns();
+        tsc = now_tsc();
+        b->m_run(c);
+        ticks[i] = (double)(now_tsc() - tsc);
+        ns[i] = now_ns() - start;
+    }
+
+    qsort(ns, reps, sizeof(double), compare_doubles);
+    qsort(ticks, reps, sizeof(double), compare_doubles);
+
+    printf("%s\n    {\n", first ? "" : ",");
+    printf("      \"name\": \"%s\",\n", b->m_name);
+    printf("      \"elements\": %lu,\n", (unsigned long)c->m_n);
+    printf("      \"ns\": { \"min\": %.0f, \"p50\": %.0f, \"p90\": %.0f, \"p99\": %.0f, \"max\": %.0f },\n",
+           ns[0], percentile(ns, reps, 50.0), percentile(ns, reps, 90.0), percentile(ns, reps, 99.0), ns[reps - 1]);
+    printf("      \"ns_per_element\": %.4g,\n", percentile(ns, reps, 50.0) / (double)c->m_n);
+
+#if defined(BENCH_HAVE_TSC)
+    printf("      \"cycles_per_element\": %.4g,\n", percentile(ticks, reps, 50.0) / (double)c->m_n);
+#else
+    printf("      \"cycles_per_element\": null,\n");
+#endif
+
+    printf("      \"elements_per_second\": %.4g\n    }", (double)c->m_n * 1.0e9 / percentile(ns, reps, 50.0));
+}
+
+int main(int argc, char * argv[])
+{
+    size_t reps = 31, n = 65536, i;
+    int first = 1;
+    bool any = false;
+    double * ns;
+    double * ticks;
+    bench_context_t c;
+
+    // options precede filters
+    while ((first + 1 < argc) && (argv[first][0] == '-'))
+    {
+        if (!strcmp(argv[first], "-r"))
+            reps = (size_t)strtoul(argv[first + 1], NULL, 10);
+        else if (!strcmp(argv[first], "-n"))
+            n = (size_t)strtoul(argv[first + 1], NULL, 10);
+        else
+            break;
+
+        first += 2;
+    }
+
+    if ((reps == 0) || (n < 64))
+    {
+        fprintf(stderr, "usage: %s [-r repetitions] [-n elements >= 64] [filter ...]\n", argv[0]);
+        return 1;
+    }
+
+    ns = (double *)malloc(reps * sizeof(double));
+    ticks = (double *)malloc(reps * sizeof(double));
+
+    if ((ns == NULL) || (ticks == NULL) || !context_init(&c, n))
+    {
+        fprintf(stderr, "%s: out of memory\n", argv[0]);
+        return 1;
+    }
+
+    printf("{\n");
+    printf("  \"timer\": \"%s\",\n",
+#if defined(_WIN32)
+           "QueryPerformanceCounter"
+#else
+           "CLOCK_MONOTONIC"
+#endif
+           );
+    printf("  \"cycles\": \"%s\",\n",
+#if defined(BENCH_HAVE_TSC)
+           "rdtsc"
+#else
+           "none"
+#endif
+           );
+    printf("  \"repetitions\": %lu,\n", (unsigned long)reps);
+    printf("  \"results\": [");
+
+    for (i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); ++i)
+    {
+        // fixed sizes larger than the prepared input are skipped
+        if (!selected(benchmarks[i].m_name, argc, argv, first) || (benchmarks[i].m_n > n))
+            continue;
+
+        c.m_n = (benchmarks[i].m_n != 0) ? benchmarks[i].m_n : n;
+        measure(&benchmarks[i], &c, reps, ns, ticks, !any);
+        any = true;
+        fflush(stdout);
+    }
+
+    printf("\n  ]\n}\n");
+
+    c.m_n = n;
+    context_free(&c);
+    free(ns);
+    free(ticks);
+
+    return 0;
+}
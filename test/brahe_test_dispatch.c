@@ -0,0 +1,311 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+#include "../src/prng.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+    The kernels bound here depend on the processor and on BRAHE_ISA; run
+    this with BRAHE_ISA set to each of scalar, sse2, avx2 and avx512 to
+    check every variant against the reference computations below.
+*/
+
+int test_isa(bool verbose)
+{
+    size_t i, errcnt = 0;
+    const char * name;
+    brahe_isa_t isa;
+    brahe_isa_t detected = brahe_isa_detected();
+    brahe_isa_t active = brahe_isa_active();
+
+    if (verbose)
+        printf("instruction set: detected %s, active %s\n", brahe_isa_name(detected), brahe_isa_name(active));
+
+    // BRAHE_ISA can only lower the active instruction set
+    if ((active != detected) && (active != BRAHE_ISA_SCALAR) && ((detected == BRAHE_ISA_NEON) || (active > detected)))
+        ++errcnt;
+
+    for (i = 0; brahe_kernel_info(i, &name, &isa); ++i)
+    {
+        if (verbose)
+            printf("    %-14s %s\n", name, brahe_isa_name(isa));
+
+        if ((name == NULL) || (isa > active))
+            ++errcnt;
+    }
+
+    if ((i == 0) || brahe_kernel_info(i, NULL, NULL))
+        ++errcnt;
+
+    if (strcmp(brahe_isa_name((brahe_isa_t)99), "unknown"))
+        ++errcnt;
+
+    return (int)errcnt;
+}
+
+int test_statistics(bool verbose)
+{
+    static const size_t MAX_SIZE = 1000;
+
+    size_t i, n, errcnt = 0;
+    double * data = (double *)malloc(sizeof(double) * MAX_SIZE);
+    brahe_statistics stats;
+
+    // every length through the vector widths and their tails
+    for (n = 2; n <= MAX_SIZE; n = (n < 70) ? n + 1 : n * 2)
+    {
+        double lo = 1.0e300, hi = -1.0e300, mean = 0.0, variance = 0.0;
+
+        for (i = 0; i < n; ++i)
+        {
+            data[i] = sin((double)i * 0.7) * 1000.0 + (double)(i % 13);
+
+            if (data[i] < lo) lo = data[i];
+            if (data[i] > hi) hi = data[i];
+            mean += data[i];
+        }
+
+        mean /= (double)n;
+
+        for (i = 0; i < n; ++i)
+            variance += (data[i] - mean) * (data[i] - mean);
+
+        variance /= (double)(n - 1);
+
+        stats = brahe_get_statistics(data, n);
+
+        if ((stats.min != lo) || (stats.max != hi)
+        ||  (fabs(stats.mean - mean) > 1.0e-12 * 1000.0)
+        ||  (fabs(stats.variance - variance) > 1.0e-12 * variance))
+        {
+            if (verbose)
+                printf("statistics wrong for %lu values\n", (unsigned long)n);
+
+            ++errcnt;
+        }
+    }
+
+    // all-negative data once reported a maximum of DBL_MIN
+    for (i = 0; i < 37; ++i)
+        data[i] = -1.0 - (double)i;
+
+    stats = brahe_get_statistics(data, 37);
+
+    if ((stats.max != -1.0) || (stats.min != -37.0))
+    {
+        if (verbose)
+            printf("statistics wrong for negative values: max %g, min %g\n", stats.max, stats.min);
+
+        ++errcnt;
+    }
+
+    if (verbose)
+        printf("statistics: %d error(s)\n", (int)errcnt);
+
+    free(data);
+    return (int)errcnt;
+}
+
+int test_fft(bool verbose)
+{
+    static const int MAX_SIZE = 1024;
+
+    int n, i, k, errcnt = 0;
+    double * data = (double *)malloc(sizeof(double) * MAX_SIZE);
+
+    for (i = 0; i < MAX_SIZE; ++i)
+        data[i] = cos((double)i * 0.3) + 0.5 * sin((double)i * 1.9) + (double)(i % 5) * 0.1;
+
+    // compare every power of two with a direct DFT
+    for (n = 2; n <= MAX_SIZE; n *= 2)
+    {
+        double worst = 0.0;
+        double * mag = brahe_simple_fft2(data, n);
+
+        for (k = 0; k < n / 2; ++k)
+        {
+            double re = 0.0, im = 0.0, expected;
+
+            for (i = 0; i < n; ++i)
+            {
+                re += data[i] * cos(BRAHE_TAU * (double)((long)i * k % n) / (double)n);
+                im -= data[i] * sin(BRAHE_TAU * (double)((long)i * k % n) / (double)n);
+            }
+
+            expected = sqrt(re * re + im * im) / (double)n * ((k == 0) ? 1.0 : 2.0);
+
+            if (fabs(mag[k] - expected) > worst)
+                worst = fabs(mag[k] - expected);
+        }
+
+        if (worst > 1.0e-12)
+        {
+            if (verbose)
+                printf("FFT of %d values: largest error %g\n", n, worst);
+
+            ++errcnt;
+        }
+
+        brahe_free(mag);
+    }
+
+    if (verbose)
+        printf("FFT: %d error(s)\n", errcnt);
+
+    free(data);
+    return errcnt;
+}
+
+int test_prng_fill(bool verbose)
+{
+    static const size_t sizes[] = { 1, 3, 620, 1, 624, 625, 5000, 7 };
+    static const size_t NUM_SIZES = sizeof(sizes) / sizeof(sizes[0]);
+
+    size_t i, j, errcnt = 0;
+    uint32_t * values = (uint32_t *)malloc(sizeof(uint32_t) * 5000);
+    brahe_prng_state_t bulk, single;
+
+    // the reference generator's first output for its default seed
+    brahe_prng_init(&single, BRAHE_PRNG_MARSENNE_TWISTER, 5489);
+
+    if (brahe_prng_next(&single) != 3499211612UL)
+        ++errcnt;
+
+    brahe_prng_free(&single);
+
+    // filling must continue the same sequence as drawing one at a time,
+    // whatever the position within the block of state
+    brahe_prng_init(&bulk, BRAHE_PRNG_MARSENNE_TWISTER, 20110428);
+    brahe_prng_init(&single, BRAHE_PRNG_MARSENNE_TWISTER, 20110428);
+
+    for (j = 0; j < NUM_SIZES; ++j)
+    {
+        brahe_prng_fill(&bulk, values, sizes[j]);
+
+        for (i = 0; i < sizes[j]; ++i)
+        {
+            if (values[i] != brahe_prng_next(&single))
+            {
+                ++errcnt;
+                break;
+            }
+        }
+
+        if (brahe_prng_next(&bulk) != brahe_prng_next(&single))
+            ++errcnt;
+    }
+
+    if (verbose)
+        printf("Mersenne Twister fill: %d error(s)\n", (int)errcnt);
+
+    brahe_prng_free(&bulk);
+    brahe_prng_free(&single);
+    free(values);
+    return (int)errcnt;
+}
+
+int test_round(bool verbose)
+{
+    static const size_t MAX_SIZE = 67;
+
+    size_t i, n, errcnt = 0;
+    double in[67], out[67];
+
+    for (i = 0; i < MAX_SIZE; ++i)
+        in[i] = ((double)i - 33.0) * 0.5 + ((i % 3 == 0) ? 0.0 : 1.0e-9 * (double)i);
+
+    in[5] = 4503599627370497.0;
+    in[6] = -0.0;
+    in[7] = 1.0e300;
+
+    for (n = 0; n <= MAX_SIZE; ++n)
+    {
+        memset(out, 0, sizeof(out));
+
+        if (!brahe_round_nearest_v(in, out, n))
+            ++errcnt;
+
+        for (i = 0; i < n; ++i)
+        {
+            double expected = brahe_round_nearest(in[i]);
+
+            if (memcmp(&out[i], &expected, sizeof(double)))
+            {
+                ++errcnt;
+                break;
+            }
+        }
+    }
+
+    if (verbose)
+        printf("rounding: %d error(s)\n", (int)errcnt);
+
+    return (int)errcnt;
+}
+
+int main(int argc, char * argv[])
+{
+    size_t errcnt = 0;
+
+    errcnt += test_isa(true);
+    errcnt += test_statistics(true);
+    errcnt += test_fft(true);
+    errcnt += test_prng_fill(true);
+    errcnt += test_round(true);
+
+    printf("found %d error(s)\n",(int)errcnt);
+
+    return errcnt;
+}
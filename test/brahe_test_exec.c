@@ -0,0 +1,345 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+#include "../src/prng.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+    Every parallel function must give the same result for any number of
+    threads, so each is run on the calling thread (one worker), on pools of
+    several sizes, and on a pinned pool, and the results compared exactly.
+*/
+
+#define TEST_SIZE 1000003
+#define NUM_CONTEXTS 4
+
+static brahe_exec_t contexts[NUM_CONTEXTS];
+static const char * const context_names[NUM_CONTEXTS] = { "1 thread", "2 threads", "7 threads", "pinned" };
+
+static bool start_contexts(void)
+{
+    return brahe_exec_init(&contexts[0], 1, 0)
+        && brahe_exec_init(&contexts[1], 2, 0)
+        && brahe_exec_init(&contexts[2], 7, 0)
+        && brahe_exec_init(&contexts[3], 0, BRAHE_EXEC_PIN_THREADS);
+}
+
+static void stop_contexts(void)
+{
+    size_t c;
+
+    for (c = 0; c < NUM_CONTEXTS; ++c)
+        brahe_exec_free(&contexts[c]);
+}
+
+static double * random_data(const uint32_t seed)
+{
+    size_t i;
+    double * data = (double *)malloc(sizeof(double) * TEST_SIZE);
+    brahe_prng_state_t prng;
+
+    brahe_prng_init(&prng, BRAHE_PRNG_KISS, seed);
+
+    for (i = 0; i < TEST_SIZE; ++i)
+        data[i] = 1000.0 + brahe_prng_real2(&prng) * 100.0;
+
+    brahe_prng_free(&prng);
+    return data;
+}
+
+int test_contexts(bool verbose)
+{
+    int errcnt = 0;
+    brahe_exec_t exec;
+
+    if ((brahe_exec_threads(NULL) != 1) || (brahe_exec_threads(&contexts[0]) != 1) || (brahe_exec_threads(&contexts[3]) == 0))
+        ++errcnt;
+
+    // a context can be started and stopped repeatedly
+    if (!brahe_exec_init(&exec, 3, 0))
+        ++errcnt;
+    else
+        brahe_exec_free(&exec);
+
+    if (brahe_exec_init(NULL, 2, 0))
+        ++errcnt;
+
+    if (verbose)
+        printf("contexts: %d, %d, %d and %d workers\n", (int)brahe_exec_threads(&contexts[0]), (int)brahe_exec_threads(&contexts[1]),
+               (int)brahe_exec_threads(&contexts[2]), (int)brahe_exec_threads(&contexts[3]));
+
+    return errcnt;
+}
+
+int test_statistics_exec(bool verbose)
+{
+    int errcnt = 0;
+    size_t c;
+    double * data = random_data(1);
+    brahe_statistics serial = brahe_get_statistics(data, TEST_SIZE);
+    brahe_statistics first = brahe_get_statistics_exec(&contexts[0], data, TEST_SIZE);
+    brahe_statistics stats;
+
+    if ((first.min != serial.min) || (first.max != serial.max)
+     || (fabs(first.mean - serial.mean) > 1.0e-12 * serial.mean)
+     || (fabs(first.variance - serial.variance) > 1.0e-9 * serial.variance))
+        ++errcnt;
+
+    for (c = 1; c < NUM_CONTEXTS; ++c)
+    {
+        stats = brahe_get_statistics_exec(&contexts[c], data, TEST_SIZE);
+
+        if (memcmp(&stats, &first, sizeof(stats)) != 0)
+        {
+            if (verbose)
+                printf("statistics differ with %s\n", context_names[c]);
+
+            ++errcnt;
+        }
+    }
+
+    if (verbose)
+        printf("parallel statistics: %d error(s)\n", errcnt);
+
+    free(data);
+    return errcnt;
+}
+
+int test_moving_average_exec(bool verbose)
+{
+    static const size_t distances[] = { 0, 3, 50000, TEST_SIZE };
+
+    int errcnt = 0;
+    size_t c, i, j;
+    double * data   = random_data(2);
+    double * serial = (double *)malloc(sizeof(double) * TEST_SIZE);
+    double * first  = (double *)malloc(sizeof(double) * TEST_SIZE);
+    double * result = (double *)malloc(sizeof(double) * TEST_SIZE);
+
+    for (j = 0; j < sizeof(distances) / sizeof(distances[0]); ++j)
+    {
+        double worst = 0.0;
+
+        brahe_moving_average_into(data, TEST_SIZE, distances[j], serial);
+        brahe_moving_average_into_exec(&contexts[0], data, TEST_SIZE, distances[j], first);
+
+        for (i = 0; i < TEST_SIZE; ++i)
+        {
+            if (fabs(first[i] - serial[i]) / serial[i] > worst)
+                worst = fabs(first[i] - serial[i]) / serial[i];
+        }
+
+        if (worst > 1.0e-14)
+            ++errcnt;
+
+        for (c = 1; c < NUM_CONTEXTS; ++c)
+        {
+            if (!brahe_moving_average_into_exec(&contexts[c], data, TEST_SIZE, distances[j], result)
+             || (memcmp(result, first, sizeof(double) * TEST_SIZE) != 0))
+                ++errcnt;
+        }
+
+        if (verbose)
+            printf("parallel moving average, distance %7lu: worst relative error %g\n", (unsigned long)distances[j], worst);
+    }
+
+    free(result);
+    free(first);
+    free(serial);
+    free(data);
+    return errcnt;
+}
+
+int test_fft_exec(bool verbose)
+{
+    static const size_t FFT_SIZE = 100000;
+
+    int errcnt = 0;
+    size_t c, i, half = 65536;
+    double * data   = random_data(3);
+    double * work   = (double *)malloc(sizeof(double) * brahe_simple_fft_work_size(FFT_SIZE));
+    double * serial = (double *)malloc(sizeof(double) * half);
+    double * first  = (double *)malloc(sizeof(double) * half);
+    double * result = (double *)malloc(sizeof(double) * half);
+    double worst = 0.0;
+
+    brahe_simple_fft_into(data, FFT_SIZE, serial, work);
+    brahe_simple_fft_into_exec(&contexts[0], data, FFT_SIZE, first, work);
+
+    for (i = 0; i < half; ++i)
+    {
+        if (fabs(first[i] - serial[i]) > worst)
+            worst = fabs(first[i] - serial[i]);
+    }
+
+    // magnitudes are of order 1000 at DC and 0.1 elsewhere
+    if (worst > 1.0e-9)
+        ++errcnt;
+
+    for (c = 1; c < NUM_CONTEXTS; ++c)
+    {
+        if (!brahe_simple_fft_into_exec(&contexts[c], data, FFT_SIZE, result, work)
+         || (memcmp(result, first, sizeof(double) * half) != 0))
+            ++errcnt;
+    }
+
+    if (verbose)
+        printf("parallel fft: largest difference %g, %d error(s)\n", worst, errcnt);
+
+    free(result);
+    free(first);
+    free(serial);
+    free(work);
+    free(data);
+    return errcnt;
+}
+
+int test_signal_exec(bool verbose)
+{
+    static const brahe_wave_factor_t factors[] = { { 100.0, 1.0 }, { 7.5, 0.25 }, { 33333.0, 3.0 } };
+    static const double phases[] = { 0.5, 1.0, 2.0 };
+
+    int errcnt = 0;
+    size_t c;
+    double * serial = (double *)malloc(sizeof(double) * TEST_SIZE);
+    double * result = (double *)malloc(sizeof(double) * TEST_SIZE);
+
+    brahe_make_sinusoid_phased_into(factors, phases, 3, serial, TEST_SIZE);
+
+    for (c = 0; c < NUM_CONTEXTS; ++c)
+    {
+        if (!brahe_make_sinusoid_phased_into_exec(&contexts[c], factors, phases, 3, result, TEST_SIZE)
+         || (memcmp(result, serial, sizeof(double) * TEST_SIZE) != 0))
+            ++errcnt;
+    }
+
+    // seeded noise matches the version that starts its own threads
+    brahe_add_noise_seeded(serial, TEST_SIZE, BRAHE_NOISE_GAUSSIAN, 0.1, 42, 3);
+
+    for (c = 0; c < NUM_CONTEXTS; ++c)
+    {
+        brahe_make_sinusoid_phased_into_exec(&contexts[c], factors, phases, 3, result, TEST_SIZE);
+
+        if (!brahe_add_noise_seeded_exec(&contexts[c], result, TEST_SIZE, BRAHE_NOISE_GAUSSIAN, 0.1, 42)
+         || (memcmp(result, serial, sizeof(double) * TEST_SIZE) != 0))
+            ++errcnt;
+    }
+
+    if (verbose)
+        printf("parallel sinusoid and noise: %d error(s)\n", errcnt);
+
+    free(result);
+    free(serial);
+    return errcnt;
+}
+
+int test_fill_exec(bool verbose)
+{
+    int errcnt = 0;
+    size_t c, i, same;
+    uint32_t * first  = (uint32_t *)malloc(sizeof(uint32_t) * TEST_SIZE);
+    uint32_t * result = (uint32_t *)malloc(sizeof(uint32_t) * TEST_SIZE);
+
+    if (!brahe_prng_fill_seeded(NULL, BRAHE_PRNG_MARSENNE_TWISTER, 7, first, TEST_SIZE))
+        ++errcnt;
+
+    for (c = 0; c < NUM_CONTEXTS; ++c)
+    {
+        if (!brahe_prng_fill_seeded(&contexts[c], BRAHE_PRNG_MARSENNE_TWISTER, 7, result, TEST_SIZE)
+         || (memcmp(result, first, sizeof(uint32_t) * TEST_SIZE) != 0))
+            ++errcnt;
+    }
+
+    // neighbouring segments are not copies of each other
+    for (i = 0, same = 0; i < 65536; ++i)
+    {
+        if (first[i] == first[i + 65536])
+            ++same;
+    }
+
+    if (same > 10)
+        ++errcnt;
+
+    if (verbose)
+        printf("parallel seeded fill: %d error(s)\n", errcnt);
+
+    free(result);
+    free(first);
+    return errcnt;
+}
+
+int main(int argc, char * argv[])
+{
+    size_t errcnt = 0;
+
+    if (!start_contexts())
+    {
+        printf("cannot start execution contexts\n");
+        return 1;
+    }
+
+    errcnt += test_contexts(true);
+    errcnt += test_statistics_exec(true);
+    errcnt += test_moving_average_exec(true);
+    errcnt += test_fft_exec(true);
+    errcnt += test_signal_exec(true);
+    errcnt += test_fill_exec(true);
+
+    stop_contexts();
+
+    printf("found %d error(s)\n",(int)errcnt);
+
+    return errcnt;
+}
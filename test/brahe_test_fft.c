@@ -63,6 +63,141 @@ brahe_wave_factor_t factors [] =
 };
 
 static const int TEST_SIZE2 = 1024;
+static const size_t SIGNAL_SIZE = 1000000;
+
+// compare the recurrence-based generator against direct evaluation
+static bool check_sinusoid()
+{
+    static const double phases[] = { 0.5, -1.25, 3.0 };
+
+    size_t i, n;
+    double worst = 0.0;
+    double * signal = (double *)malloc(sizeof(double) * SIGNAL_SIZE);
+
+    if (!brahe_make_sinusoid_phased_into(factors, phases, 3, signal, SIGNAL_SIZE))
+    {
+        free(signal);
+        return false;
+    }
+
+    for (i = 0; i < SIGNAL_SIZE; ++i)
+    {
+        double expected = 0.0;
+
+        for (n = 0; n < 3; ++n)
+            expected += sin(phases[n] + (double)i * BRAHE_PI / factors[n].wavelength) * factors[n].amplitude;
+
+        if (fabs(signal[i] - expected) > worst)
+            worst = fabs(signal[i] - expected);
+    }
+
+    printf("largest sinusoid error = %g\n", worst);
+
+    free(signal);
+
+    // the reference rounds i * PI / wavelength itself, so this is looser
+    // than the generator's own accuracy
+    return (worst < 1.0e-6);
+}
+
+// compare the caller-memory transforms with the allocating ones
+static bool check_fft_into(const double * signal)
+{
+    static const int sizes[] = { 2, 3, 1000, 1024 };
+
+    size_t i, j;
+    bool ok = true;
+    double * out = (double *)malloc(sizeof(double) * 512);
+    double * work = (double *)malloc(sizeof(double) * brahe_simple_fft_work_size(1024));
+
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+    {
+        double * expected = brahe_simple_fft(signal, sizes[i]);
+
+        if ((expected == NULL) || !brahe_simple_fft_into(signal, (size_t)sizes[i], out, work))
+            ok = false;
+        else
+        {
+            // half the padded length, a quarter of the doubles of work
+            for (j = 0; j < brahe_simple_fft_work_size((size_t)sizes[i]) / 8; ++j)
+            {
+                if (out[j] != expected[j])
+                    ok = false;
+            }
+        }
+
+        brahe_free(expected);
+    }
+
+    // lengths the transforms cannot take
+    if (brahe_simple_fft_into(signal, 1, out, work) || brahe_simple_fft2_into(signal, 1000, out, work)
+    ||  (brahe_simple_fft(signal, 1) != NULL) || (brahe_simple_fft2(signal, 1000) != NULL))
+        ok = false;
+
+    free(out);
+    free(work);
+    return ok;
+}
+
+// the float generator and transform against the double ones
+static bool check_single_precision(const double * signal)
+{
+    static const size_t N = 1000;
+
+    size_t i;
+    bool ok = true;
+    double peak = 0.0;
+    double * expected = brahe_simple_fft(signal, N);
+    float * in = (float *)malloc(sizeof(float) * N);
+    float * out = (float *)malloc(sizeof(float) * 512);
+    float * work = (float *)malloc(sizeof(float) * brahe_simple_fft_work_size(N));
+    float * wave = (float *)malloc(sizeof(float) * SIGNAL_SIZE);
+    double * dwave = (double *)malloc(sizeof(double) * SIGNAL_SIZE);
+
+    for (i = 0; i < N; ++i)
+        in[i] = (float)signal[i];
+
+    if ((expected == NULL) || !brahe_simple_fft_into_f(in, N, out, work))
+        ok = false;
+    else
+    {
+        for (i = 0; i < 512; ++i)
+        {
+            if (expected[i] > peak)
+                peak = expected[i];
+        }
+
+        // float butterflies: errors relative to the largest term
+        for (i = 0; i < 512; ++i)
+        {
+            if (fabs(out[i] - expected[i]) > 1.0e-5 * peak)
+                ok = false;
+        }
+    }
+
+    if (brahe_simple_fft_into_f(in, 1, out, work))
+        ok = false;
+
+    // each wave is rounded to float as it is added
+    if (!brahe_make_sinusoid_into_f(factors, 3, wave, SIGNAL_SIZE) || !brahe_make_sinusoid_into(factors, 3, dwave, SIGNAL_SIZE))
+        ok = false;
+    else
+    {
+        for (i = 0; i < SIGNAL_SIZE; ++i)
+        {
+            if (fabs(wave[i] - dwave[i]) > 2.0e-5)
+                ok = false;
+        }
+    }
+
+    brahe_free(expected);
+    free(dwave);
+    free(wave);
+    free(work);
+    free(out);
+    free(in);
+    return ok;
+}
 
 int main(int argc, char * argv[])
 {
@@ -92,7 +227,24 @@ int main(int argc, char * argv[])
     else
         printf("FFT produced wrong data -- ERROR\n");
 
+    // check the generator itself over a long signal
+    if (check_sinusoid())
+        printf("Good sinusoid... success!\n");
+    else
+        printf("sinusoid generator produced wrong data -- ERROR\n");
+
+    // the caller-memory version must match, without allocating
+    if (check_fft_into(signal))
+        printf("Good FFT into caller memory... success!\n");
+    else
+        printf("FFT into caller memory produced wrong data -- ERROR\n");
+
+    if (check_single_precision(signal))
+        printf("Good single-precision FFT and sinusoid... success!\n");
+    else
+        printf("single-precision FFT or sinusoid produced wrong data -- ERROR\n");
+
     // cleanup
-    free(fft);
-    free(signal);
+    brahe_free(fft);
+    brahe_free(signal);
 }
@@ -51,10 +51,27 @@
 */
 
 #include "../src/mathtools.h"
+#include "../src/prng.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+// classic Euclid, as a reference
+static uint64_t euclid(uint64_t x, uint64_t y)
+{
+    uint64_t temp;
+
+    while (y != 0)
+    {
+        temp = x % y;
+        x = y;
+        y = temp;
+    }
+
+    return x;
+}
+
 int test_lcm(bool verbose)
 {
     // test data
@@ -141,12 +158,317 @@ int test_gcf(bool verbose)
     return errcnt;
 }
 
+int test_gcf_random(bool verbose)
+{
+    static const size_t TEST_SIZE = 1000000;
+
+    size_t i, errcnt = 0;
+    uint64_t x, y, f;
+    brahe_prng_state_t prng;
+
+    brahe_prng_init(&prng, BRAHE_PRNG_KISS, 8128);
+
+    // random values sharing random factors, including powers of two
+    for (i = 0; i < TEST_SIZE; ++i)
+    {
+        f = ((uint64_t)brahe_prng_next(&prng) >> brahe_prng_range(&prng, 0, 31)) << brahe_prng_range(&prng, 0, 8);
+        x = ((uint64_t)brahe_prng_next(&prng) << 20 | brahe_prng_next(&prng)) >> brahe_prng_range(&prng, 0, 52);
+        y = ((uint64_t)brahe_prng_next(&prng) << 20 | brahe_prng_next(&prng)) >> brahe_prng_range(&prng, 0, 52);
+
+        if ((i & 1) && (f != 0) && (x < UINT64_MAX / f) && (y < UINT64_MAX / f))
+        {
+            x *= f;
+            y *= f;
+        }
+
+        if (brahe_gcf(x, y) != euclid(x, y))
+            ++errcnt;
+    }
+
+    if (brahe_gcf(UINT64_MAX, UINT64_MAX - 1) != 1)
+        ++errcnt;
+
+    if (brahe_gcf((uint64_t)1 << 63, (uint64_t)3 << 62) != (uint64_t)1 << 62)
+        ++errcnt;
+
+    if (verbose)
+        printf("gcf of random pairs: %d error(s)\n", (int)errcnt);
+
+    brahe_prng_free(&prng);
+
+    return errcnt;
+}
+
+int test_arrays(bool verbose)
+{
+    // scheduling periods, in microseconds
+    static const uint64_t periods[] = { 1000, 2500, 4000, 10000, 12000, 50000 };
+    static const uint64_t primes[] = { 1000003, 1000033, 1000037, 1000039 };
+    static const uint64_t evens[] = { 0, 48, 180, 0, 600 };
+
+    size_t errcnt = 0;
+    uint64_t result;
+
+    if (brahe_gcf_array(periods, 6) != 500)
+        ++errcnt;
+
+    if ((brahe_gcf_array(evens, 5) != 12) || (brahe_gcf_array(evens, 1) != 0) || (brahe_gcf_array(evens, 0) != 0))
+        ++errcnt;
+
+    if (!brahe_lcm_array(periods, 6, &result) || (result != 300000))
+        ++errcnt;
+
+    if (!brahe_lcm_array(evens, 5, &result) || (result != 0))
+        ++errcnt;
+
+    // the product of four primes near 10^6 does not fit in 64 bits
+    if (!brahe_lcm_array(primes, 3, &result) || (result != (uint64_t)1000003 * 1000033 * 1000037))
+        ++errcnt;
+
+    if (brahe_lcm_array(primes, 4, &result) || (result != 0))
+        ++errcnt;
+
+    if (!brahe_lcm_checked(UINT64_MAX, UINT64_MAX, &result) || (result != UINT64_MAX))
+        ++errcnt;
+
+    if (brahe_lcm_checked(UINT64_MAX, UINT64_MAX - 1, &result))
+        ++errcnt;
+
+    if (verbose)
+        printf("gcf and lcm of arrays: %d error(s)\n", (int)errcnt);
+
+    return errcnt;
+}
+
+// shift-and-add modular multiplication, as a reference
+static uint64_t slow_mulmod(uint64_t a, uint64_t b, const uint64_t m)
+{
+    uint64_t result = 0;
+
+    a %= m;
+
+    while (b != 0)
+    {
+        if (b & 1)
+            result = (result >= m - a) ? result - (m - a) : result + a;
+
+        a = (a >= m - a) ? a - (m - a) : a + a;
+        b >>= 1;
+    }
+
+    return result;
+}
+
+static uint64_t random64(brahe_prng_state_t * prng)
+{
+    uint64_t x = ((uint64_t)brahe_prng_next(prng) << 32) | brahe_prng_next(prng);
+    return x >> brahe_prng_range(prng, 0, 62);
+}
+
+int test_modular(bool verbose)
+{
+    static const size_t TEST_SIZE = 200000;
+
+    size_t i, errcnt = 0;
+    int64_t a, b, g, x, y;
+    uint64_t m, u, v, inv, expected, base, e, exponent;
+    brahe_montgomery_t mont;
+    brahe_barrett_t barrett;
+    brahe_prng_state_t prng;
+
+    brahe_prng_init(&prng, BRAHE_PRNG_KISS, 65537);
+
+    for (i = 0; i < TEST_SIZE; ++i)
+    {
+        // extended Euclid, on values small enough to check the identity
+        a = (int64_t)(brahe_prng_next(&prng) >> 1) * ((i & 1) ? 1 : -1);
+        b = (int64_t)(brahe_prng_next(&prng) >> brahe_prng_range(&prng, 1, 31)) * ((i & 2) ? 1 : -1);
+        g = brahe_xgcd(a, b, &x, &y);
+
+        if ((a * x + b * y != g) || ((uint64_t)g != brahe_gcf((uint64_t)(a < 0 ? -a : a), (uint64_t)(b < 0 ? -b : b))))
+            ++errcnt;
+
+        // multiplication and inverses for moduli of every size, odd and even
+        m = random64(&prng) | 2;
+        u = random64(&prng) << brahe_prng_range(&prng, 0, 1);
+        v = random64(&prng);
+
+        if (brahe_mulmod(u, v, m) != slow_mulmod(u, v, m))
+            ++errcnt;
+
+        if (brahe_modinv(u, m, &inv))
+        {
+            if ((brahe_gcf(u % m, m) != 1) || (inv >= m) || (slow_mulmod(u, inv, m) != 1))
+                ++errcnt;
+        }
+        else if (brahe_gcf(u % m, m) == 1)
+            ++errcnt;
+
+        // exponentiation, against repeated squaring with the reference
+        base = u;
+        exponent = v >> brahe_prng_range(&prng, 0, 63);
+        e = exponent;
+        expected = 1 % m;
+
+        while (e != 0)
+        {
+            if (e & 1)
+                expected = slow_mulmod(expected, base, m);
+
+            base = slow_mulmod(base, base, m);
+            e >>= 1;
+        }
+
+        if ((brahe_powmod(u, exponent, m) != expected) || (brahe_powmod(u, exponent, m | 1) != brahe_powmod(u % (m | 1), exponent, m | 1)))
+            ++errcnt;
+
+        m |= 1;
+
+        if (m > 1)
+        {
+            brahe_montgomery_init(&mont, m);
+
+            if ((brahe_montgomery_from(&mont, brahe_montgomery_to(&mont, u)) != u % m)
+            ||  (brahe_montgomery_from(&mont, brahe_montgomery_mul(&mont, brahe_montgomery_to(&mont, u), brahe_montgomery_to(&mont, v))) != slow_mulmod(u, v, m)))
+                ++errcnt;
+        }
+
+        // Barrett, for 32-bit moduli
+        brahe_barrett_init(&barrett, (uint32_t)(m >> 32) | 2);
+
+        if ((brahe_barrett_reduce(&barrett, u) != u % barrett.m_modulus)
+        ||  (brahe_barrett_mul(&barrett, (uint32_t)u, (uint32_t)v) != ((uint64_t)(uint32_t)u * (uint32_t)v) % barrett.m_modulus))
+            ++errcnt;
+    }
+
+    // known values
+    if ((brahe_powmod(2, 10, 1000) != 24) || (brahe_powmod(3, 0, 7) != 1) || (brahe_powmod(5, 3, 1) != 0))
+        ++errcnt;
+
+    if ((brahe_powmod(2, UINT64_MAX - 58 - 1, UINT64_MAX - 58) != 1))
+        ++errcnt;
+
+    if (brahe_modinv(4, 8, &inv) || !brahe_modinv(3, 7, &inv) || (inv != 5))
+        ++errcnt;
+
+    if (brahe_mulmod(5, 7, 0) != 0)
+        ++errcnt;
+
+    // extended Euclid at the edge of the signed range
+    if ((brahe_xgcd(INT64_MIN, -1, &x, &y) != 1) || (x != 0) || (y != -1)
+    ||  (brahe_xgcd(-1, INT64_MIN, &x, &y) != 1) || (x != -1) || (y != 0)
+    ||  (brahe_xgcd(INT64_MIN, 1, &x, &y) != 1) || (x != 0) || (y != 1)
+    ||  (brahe_xgcd(INT64_MIN, -6, &x, &y) != 2) || ((uint64_t)INT64_MIN * (uint64_t)x - 6 * (uint64_t)y != 2))
+        ++errcnt;
+
+    if ((brahe_xgcd(INT64_MIN, 0, &x, &y) != 0) || (x != 0) || (y != 0)
+    ||  (brahe_xgcd(INT64_MIN, INT64_MIN, &x, &y) != 0) || (x != 0) || (y != 0)
+    ||  (brahe_xgcd(0, 0, &x, &y) != 0))
+        ++errcnt;
+
+    if (verbose)
+        printf("modular arithmetic: %d error(s)\n", (int)errcnt);
+
+    brahe_prng_free(&prng);
+
+    return errcnt;
+}
+
+int test_primes(bool verbose)
+{
+    static const size_t SIEVE_SIZE = 1000000;
+
+    // primes, and composites that fool weaker tests
+    static const uint64_t primes[] = { 2147483647ULL, 2305843009213693951ULL, 18446744073709551557ULL, 1000000007ULL };
+    static const uint64_t composites[] = { 561ULL, 3215031751ULL, 3825123056546413051ULL, 4759123141ULL,
+                                           18446744073709551615ULL, 1000000007ULL * 998244353ULL };
+
+    size_t i, j, errcnt = 0;
+    bool * composite = (bool *)calloc(SIEVE_SIZE, sizeof(bool));
+    bool * found = (bool *)malloc(sizeof(bool) * SIEVE_SIZE);
+    uint64_t * values = (uint64_t *)malloc(sizeof(uint64_t) * SIEVE_SIZE);
+    uint64_t * inverses = (uint64_t *)malloc(sizeof(uint64_t) * SIEVE_SIZE);
+
+    composite[0] = composite[1] = true;
+
+    for (i = 2; i * i < SIEVE_SIZE; ++i)
+    {
+        if (!composite[i])
+        {
+            for (j = i * i; j < SIEVE_SIZE; j += i)
+                composite[j] = true;
+        }
+    }
+
+    for (i = 0; i < SIEVE_SIZE; ++i)
+        values[i] = i;
+
+    brahe_is_prime_array(values, SIEVE_SIZE, found);
+
+    for (i = 0; i < SIEVE_SIZE; ++i)
+    {
+        if (found[i] == composite[i])
+            ++errcnt;
+    }
+
+    for (i = 0; i < sizeof(primes) / sizeof(primes[0]); ++i)
+    {
+        if (!brahe_is_prime(primes[i]))
+            ++errcnt;
+    }
+
+    for (i = 0; i < sizeof(composites) / sizeof(composites[0]); ++i)
+    {
+        if (brahe_is_prime(composites[i]))
+            ++errcnt;
+    }
+
+    // batch inversion modulo a prime, of 1..n-1
+    if (!brahe_modinv_array(values + 1, SIEVE_SIZE - 1, 1000003, inverses))
+        ++errcnt;
+
+    for (i = 1; i < SIEVE_SIZE; ++i)
+    {
+        if ((values[i] * inverses[i - 1]) % 1000003 != 1)
+            ++errcnt;
+    }
+
+    // zero has no inverse, so neither does an array containing it
+    if (brahe_modinv_array(values, 10, 1000003, inverses))
+        ++errcnt;
+
+    // batch products and powers against the single forms
+    brahe_powmod_array(values, 1000, 65537, 1000003, inverses);
+    brahe_mulmod_array(values, values + 1000, 1000, 1000002, inverses + 1000);
+
+    for (i = 0; i < 1000; ++i)
+    {
+        if ((inverses[i] != brahe_powmod(values[i], 65537, 1000003))
+        ||  (inverses[1000 + i] != (values[i] * values[1000 + i]) % 1000002))
+            ++errcnt;
+    }
+
+    if (verbose)
+        printf("primes: %d error(s)\n", (int)errcnt);
+
+    free(inverses);
+    free(values);
+    free(found);
+    free(composite);
+
+    return errcnt;
+}
+
 int main(int argc, char * argv[])
 {
     size_t errcnt = 0;
 
     errcnt += test_lcm(true);
     errcnt += test_gcf(true);
+    errcnt += test_gcf_random(true);
+    errcnt += test_arrays(true);
+    errcnt += test_modular(true);
+    errcnt += test_primes(true);
 
     printf("found %d error(s)\n",errcnt);
 
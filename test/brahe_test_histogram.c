@@ -0,0 +1,358 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+#include "../src/prng.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const size_t TEST_SIZE = 100000;
+
+// verify that every counted value lies within its bin, and that bulk and single adds agree
+static size_t check_layout(brahe_histogram_t * single, brahe_histogram_t * bulk, const double * data, const size_t n)
+{
+    size_t i, errcnt = 0;
+    const uint64_t * counts;
+    const uint64_t * bulk_counts;
+    uint64_t sum = 0;
+
+    brahe_histogram_add_n(bulk, data, n);
+
+    for (i = 0; i < n; ++i)
+        brahe_histogram_add(single, data[i]);
+
+    counts = brahe_histogram_counts(single);
+    bulk_counts = brahe_histogram_counts(bulk);
+
+    for (i = 0; i < single->m_bins; ++i)
+    {
+        if (counts[i] != bulk_counts[i])
+            ++errcnt;
+
+        sum += counts[i];
+    }
+
+    if ((brahe_histogram_underflow(single) != brahe_histogram_underflow(bulk))
+    ||  (brahe_histogram_overflow(single) != brahe_histogram_overflow(bulk))
+    ||  (brahe_histogram_total(bulk) != n)
+    ||  (sum + brahe_histogram_underflow(single) + brahe_histogram_overflow(single) != n))
+        ++errcnt;
+
+    // recount by searching the bin edges
+    {
+        uint64_t * expected = (uint64_t *)calloc(single->m_bins + 2, sizeof(uint64_t));
+
+        for (i = 0; i < n; ++i)
+        {
+            size_t lo = 0, hi = single->m_bins;
+
+            if (!(data[i] < brahe_histogram_edge(single, single->m_bins)))
+            {
+                ++expected[single->m_bins + 1];
+                continue;
+            }
+
+            if (data[i] < brahe_histogram_edge(single, 0))
+            {
+                ++expected[0];
+                continue;
+            }
+
+            while (hi - lo > 1)
+            {
+                size_t mid = (lo + hi) / 2;
+
+                if (data[i] < brahe_histogram_edge(single, mid))
+                    hi = mid;
+                else
+                    lo = mid;
+            }
+
+            ++expected[lo + 1];
+        }
+
+        // computed edges may round differently from the binning arithmetic,
+        // so allow a value to land in an adjacent bin
+        for (i = 0; i < single->m_bins + 2; ++i)
+        {
+            uint64_t actual = single->m_slots[i];
+            uint64_t diff = (actual > expected[i]) ? actual - expected[i] : expected[i] - actual;
+
+            if (diff > n / 10000)
+                ++errcnt;
+        }
+
+        free(expected);
+    }
+
+    return errcnt;
+}
+
+int test_layouts(bool verbose)
+{
+    size_t i, errcnt = 0;
+    double * data = (double *)malloc(sizeof(double) * TEST_SIZE);
+    brahe_histogram_t single, bulk;
+    brahe_prng_state_t prng;
+
+    brahe_prng_init(&prng, BRAHE_PRNG_KISS, 8675309);
+
+    // linear, with values on both sides of the range and a few NaNs
+    for (i = 0; i < TEST_SIZE; ++i)
+        data[i] = brahe_prng_real2(&prng) * 120.0 - 10.0;
+
+    data[17] = data[1234] = NAN;
+
+    brahe_histogram_init_linear(&single, 0.0, 100.0, 37);
+    brahe_histogram_init_linear(&bulk, 0.0, 100.0, 37);
+    errcnt += check_layout(&single, &bulk, data, TEST_SIZE);
+
+    if (brahe_histogram_overflow(&single) < 2)
+        ++errcnt;
+
+    brahe_histogram_free(&single);
+    brahe_histogram_free(&bulk);
+
+    // logarithmic and HDR, over values spanning several decades
+    for (i = 0; i < TEST_SIZE; ++i)
+        data[i] = exp(brahe_prng_real2(&prng) * 20.0 - 3.0);
+
+    brahe_histogram_init_log(&single, 0.1, 1.0e6, 50);
+    brahe_histogram_init_log(&bulk, 0.1, 1.0e6, 50);
+    errcnt += check_layout(&single, &bulk, data, TEST_SIZE);
+    brahe_histogram_free(&single);
+    brahe_histogram_free(&bulk);
+
+    brahe_histogram_init_hdr(&single, 0.1, 1.0e6, 5);
+    brahe_histogram_init_hdr(&bulk, 0.1, 1.0e6, 5);
+    errcnt += check_layout(&single, &bulk, data, TEST_SIZE);
+
+    // every HDR bin is within the requested relative width
+    for (i = 0; i < single.m_bins; ++i)
+    {
+        double lo = brahe_histogram_edge(&single, i);
+        double hi = brahe_histogram_edge(&single, i + 1);
+
+        if (!(hi > lo) || ((hi - lo) / lo > 1.0 / 32.0 + 1e-15))
+            ++errcnt;
+    }
+
+    brahe_histogram_free(&single);
+    brahe_histogram_free(&bulk);
+
+    // zero and negative values lie below any logarithmic range
+    brahe_histogram_init_log(&single, 1.0, 100.0, 10);
+    brahe_histogram_add(&single, -5.0);
+    brahe_histogram_add(&single, 0.0);
+    brahe_histogram_add(&single, 0.5);
+
+    if ((brahe_histogram_underflow(&single) != 3) || (brahe_histogram_overflow(&single) != 0))
+        ++errcnt;
+
+    brahe_histogram_free(&single);
+
+    // invalid layouts
+    if (brahe_histogram_init_linear(&single, 1.0, 1.0, 10)
+    ||  brahe_histogram_init_log(&single, 0.0, 1.0, 10)
+    ||  brahe_histogram_init_hdr(&single, -1.0, 1.0, 4))
+        ++errcnt;
+
+    if (verbose)
+        printf("histogram layouts: %d error(s)\n", (int)errcnt);
+
+    brahe_prng_free(&prng);
+    free(data);
+
+    return errcnt;
+}
+
+// hand-built linear layouts over [0, 1): magic, type, bins, lo, hi, shift, nonzero, slots
+static const uint8_t oversized[] =
+{
+    'B', 'H', '1', 0,
+    0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01,     // UINT64_MAX - 1 bins
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0x3F,
+    0, 1, 0, 1
+};
+
+static const uint8_t crowded[] =
+{
+    'B', 'H', '1', 0, 4,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0x3F,
+    0, 0xE8, 0x07, 0, 1, 0, 1                                   // 1000 nonzero slots of 6
+};
+
+static const uint8_t short_slots[] =
+{
+    'B', 'H', '1', 0, 0xE8, 0x07,                               // 1000 bins
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF0, 0x3F,
+    0, 0xF4, 0x03, 0, 1, 0, 1                                   // 500 nonzero slots, 2 present
+};
+
+int test_merge_and_quantiles(bool verbose)
+{
+    size_t i, errcnt = 0, len;
+    double q, estimate, worst = 0.0;
+    double * data = (double *)malloc(sizeof(double) * TEST_SIZE);
+    uint8_t * buffer;
+    brahe_histogram_t whole, first, second, copy;
+    brahe_prng_state_t prng;
+
+    brahe_prng_init(&prng, BRAHE_PRNG_KISS, 1618033);
+
+    for (i = 0; i < TEST_SIZE; ++i)
+        data[i] = brahe_prng_real2(&prng) * 1000.0;
+
+    brahe_histogram_init_hdr(&whole, 1.0, 1000.0, 7);
+    brahe_histogram_init_hdr(&first, 1.0, 1000.0, 7);
+    brahe_histogram_init_hdr(&second, 1.0, 1000.0, 7);
+
+    brahe_histogram_add_n(&whole, data, TEST_SIZE);
+    brahe_histogram_add_n(&first, data, TEST_SIZE / 3);
+    brahe_histogram_add_n(&second, data + TEST_SIZE / 3, TEST_SIZE - TEST_SIZE / 3);
+
+    if (!brahe_histogram_merge(&first, &second))
+        ++errcnt;
+
+    if (memcmp(first.m_slots, whole.m_slots, sizeof(uint64_t) * (whole.m_bins + 2)) != 0)
+        ++errcnt;
+
+    // uniform data, so the q-quantile should be near 1000 q
+    for (q = 0.05; q < 1.0; q += 0.05)
+    {
+        double err;
+
+        estimate = brahe_histogram_quantile(&whole, q);
+        err = fabs(estimate - 1000.0 * q) / (1000.0 * q);
+
+        if (err > worst)
+            worst = err;
+    }
+
+    if (worst > 0.02)
+        ++errcnt;
+
+    if (!isnan(brahe_histogram_quantile(&whole, 1.5)))
+        ++errcnt;
+
+    // round trip through the serialized form
+    len = brahe_histogram_serialize(&whole, NULL, 0);
+    buffer = (uint8_t *)malloc(len);
+
+    if ((brahe_histogram_serialize(&whole, buffer, len) != len)
+    ||  !brahe_histogram_deserialize(&copy, buffer, len))
+        ++errcnt;
+    else
+    {
+        if ((copy.m_type != whole.m_type) || (copy.m_bins != whole.m_bins)
+        ||  (copy.m_total != whole.m_total)
+        ||  (memcmp(copy.m_slots, whole.m_slots, sizeof(uint64_t) * (whole.m_bins + 2)) != 0))
+            ++errcnt;
+
+        brahe_histogram_free(&copy);
+    }
+
+    // truncated data must be rejected
+    for (i = 0; i < len; ++i)
+    {
+        if (brahe_histogram_deserialize(&copy, buffer, i))
+        {
+            ++errcnt;
+            brahe_histogram_free(&copy);
+        }
+    }
+
+    // so must headers claiming more bins or slots than can exist
+    if (brahe_histogram_deserialize(&copy, oversized, sizeof(oversized))
+    ||  brahe_histogram_deserialize(&copy, crowded, sizeof(crowded))
+    ||  brahe_histogram_deserialize(&copy, short_slots, sizeof(short_slots)))
+    {
+        ++errcnt;
+        brahe_histogram_free(&copy);
+    }
+
+    // layouts that differ cannot be merged
+    brahe_histogram_free(&second);
+    brahe_histogram_init_hdr(&second, 1.0, 1000.0, 6);
+
+    if (brahe_histogram_merge(&first, &second))
+        ++errcnt;
+
+    if (verbose)
+        printf("histogram merge and quantiles: worst relative error %g, %lu bytes serialized\n",
+               worst, (unsigned long)len);
+
+    free(buffer);
+    brahe_histogram_free(&second);
+    brahe_histogram_free(&first);
+    brahe_histogram_free(&whole);
+    brahe_prng_free(&prng);
+    free(data);
+
+    return errcnt;
+}
+
+int main(int argc, char * argv[])
+{
+    size_t errcnt = 0;
+
+    errcnt += test_layouts(true);
+    errcnt += test_merge_and_quantiles(true);
+
+    printf("found %d error(s)\n",(int)errcnt);
+
+    return errcnt;
+}
@@ -0,0 +1,309 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+#include "../src/prng.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+    The sample files are large enough to span several mapped windows, so
+    the tests cross window boundaries in the middle of a computation.
+*/
+
+#define TEST_SIZE 400000
+
+static const char * const IN_PATH  = "brahe_test_mapped.in";
+static const char * const OUT_PATH = "brahe_test_mapped.out";
+
+// write samples as a little-endian file, returning them as the file holds them
+static bool write_samples(const char * path, const brahe_sample_type_t type, double * data, const size_t n)
+{
+    size_t i;
+    int b;
+    FILE * f = fopen(path, "wb");
+
+    if (f == NULL)
+        return false;
+
+    for (i = 0; i < n; ++i)
+    {
+        uint8_t bytes[8];
+        uint64_t u;
+
+        if (type == BRAHE_SAMPLE_FLOAT64)
+        {
+            memcpy(&u, &data[i], 8);
+
+            for (b = 0; b < 8; ++b, u >>= 8)
+                bytes[b] = (uint8_t)u;
+
+            fwrite(bytes, 1, 8, f);
+        }
+        else if (type == BRAHE_SAMPLE_FLOAT32)
+        {
+            float x = (float)data[i];
+            uint32_t v;
+            data[i] = x;
+            memcpy(&v, &x, 4);
+
+            for (b = 0; b < 4; ++b, v >>= 8)
+                bytes[b] = (uint8_t)v;
+
+            fwrite(bytes, 1, 4, f);
+        }
+        else
+        {
+            int16_t x = (int16_t)floor(data[i] + 0.5);
+            data[i] = x;
+            bytes[0] = (uint8_t)((uint16_t)x);
+            bytes[1] = (uint8_t)((uint16_t)x >> 8);
+            fwrite(bytes, 1, 2, f);
+        }
+    }
+
+    return fclose(f) == 0;
+}
+
+static double relative_error(const double a, const double b)
+{
+    double scale = fabs(b) > 1.0 ? fabs(b) : 1.0;
+    return fabs(a - b) / scale;
+}
+
+static bool same_statistics(const brahe_statistics * a, const brahe_statistics * b)
+{
+    return (a->min == b->min) && (a->max == b->max)
+        && (relative_error(a->mean, b->mean) < 1.0e-12)
+        && (relative_error(a->variance, b->variance) < 1.0e-10);
+}
+
+int test_statistics_file(bool verbose)
+{
+    static const brahe_sample_type_t types[] = { BRAHE_SAMPLE_FLOAT64, BRAHE_SAMPLE_FLOAT32, BRAHE_SAMPLE_INT16 };
+    static const char * const names[] = { "float64", "float32", "int16" };
+
+    size_t i, t, errcnt = 0;
+    double * data = (double *)malloc(sizeof(double) * TEST_SIZE);
+    brahe_prng_state_t prng;
+    brahe_statistics expected, actual;
+
+    brahe_prng_init(&prng, BRAHE_PRNG_KISS, 2011);
+
+    for (t = 0; t < sizeof(types) / sizeof(types[0]); ++t)
+    {
+        // an offset exposes cancellation in the merged variance
+        for (i = 0; i < TEST_SIZE; ++i)
+            data[i] = 10000.0 + brahe_prng_real2(&prng) * 2000.0;
+
+        if (!write_samples(IN_PATH, types[t], data, TEST_SIZE))
+        {
+            ++errcnt;
+            break;
+        }
+
+        expected = brahe_get_statistics(data, TEST_SIZE);
+
+        if (!brahe_get_statistics_file(IN_PATH, types[t], 0, 0, &actual) || !same_statistics(&actual, &expected))
+        {
+            if (verbose)
+                printf("statistics of %s file differ: mean %.17g, expected %.17g\n", names[t], actual.mean, expected.mean);
+
+            ++errcnt;
+        }
+
+        // a range that starts and ends inside windows
+        expected = brahe_get_statistics(data + 1001, TEST_SIZE - 3000);
+
+        if (!brahe_get_statistics_file(IN_PATH, types[t], 1001, TEST_SIZE - 3000, &actual) || !same_statistics(&actual, &expected))
+        {
+            if (verbose)
+                printf("statistics of part of %s file differ\n", names[t]);
+
+            ++errcnt;
+        }
+    }
+
+    // ranges past the end of the file, and missing files, fail
+    if (brahe_get_statistics_file(IN_PATH, BRAHE_SAMPLE_INT16, TEST_SIZE, 0, &actual)
+     || brahe_get_statistics_file(IN_PATH, BRAHE_SAMPLE_INT16, 1, TEST_SIZE, &actual)
+     || brahe_get_statistics_file(OUT_PATH, BRAHE_SAMPLE_INT16, 0, 0, &actual))
+        ++errcnt;
+
+    if (verbose)
+        printf("statistics from files: %s\n", (errcnt == 0) ? "pass" : "FAIL");
+
+    remove(IN_PATH);
+    brahe_prng_free(&prng);
+    free(data);
+    return (int)errcnt;
+}
+
+int test_moving_average_file(bool verbose)
+{
+    static const size_t distances[] = { 0, 5, 70000, TEST_SIZE };
+
+    size_t i, j, errcnt = 0;
+    double * data   = (double *)malloc(sizeof(double) * TEST_SIZE);
+    double * result = (double *)malloc(sizeof(double) * TEST_SIZE);
+    double * output = (double *)malloc(sizeof(double) * TEST_SIZE);
+    brahe_statistics stats;
+    FILE * f;
+
+    for (i = 0; i < TEST_SIZE; ++i)
+        data[i] = 1.0e6 + sin((double)i * 0.01) * 100.0 + (double)(i % 17);
+
+    if (!write_samples(IN_PATH, BRAHE_SAMPLE_FLOAT64, data, TEST_SIZE))
+        ++errcnt;
+
+    for (j = 0; j < sizeof(distances) / sizeof(distances[0]); ++j)
+    {
+        bool same = brahe_moving_average_file(IN_PATH, BRAHE_SAMPLE_FLOAT64, distances[j], OUT_PATH, BRAHE_SAMPLE_FLOAT64);
+
+        brahe_moving_average_into(data, TEST_SIZE, distances[j], result);
+        f = fopen(OUT_PATH, "rb");
+
+        // this host's byte order is only assumed for the comparison
+        same = same && (f != NULL) && (fread(output, sizeof(double), TEST_SIZE, f) == TEST_SIZE) && (fgetc(f) == EOF);
+
+        for (i = 0; same && (i < TEST_SIZE); ++i)
+            same = (output[i] == result[i]);
+
+        if (f != NULL)
+            fclose(f);
+
+        if (verbose)
+            printf("moving average of file, distance %6lu: %s\n", (unsigned long)distances[j], same ? "pass" : "FAIL");
+
+        if (!same)
+            ++errcnt;
+    }
+
+    // int16 output is rounded and saturated
+    if (!brahe_moving_average_file(IN_PATH, BRAHE_SAMPLE_FLOAT64, 3, OUT_PATH, BRAHE_SAMPLE_INT16)
+     || !brahe_get_statistics_file(OUT_PATH, BRAHE_SAMPLE_INT16, 0, 0, &stats)
+     || (stats.min != 32767.0) || (stats.max != 32767.0))
+        ++errcnt;
+
+    // writing over the input is refused
+    if (brahe_moving_average_file(IN_PATH, BRAHE_SAMPLE_FLOAT64, 3, IN_PATH, BRAHE_SAMPLE_FLOAT64)
+     || !brahe_get_statistics_file(IN_PATH, BRAHE_SAMPLE_FLOAT64, 0, 0, &stats))
+        ++errcnt;
+
+    remove(IN_PATH);
+    remove(OUT_PATH);
+    free(output);
+    free(result);
+    free(data);
+    return (int)errcnt;
+}
+
+int test_fft_file(bool verbose)
+{
+    static const size_t FFT_SIZE  = 3000;
+    static const size_t FFT_FIRST = 123457;
+
+    size_t i, errcnt = 0;
+    double * data = (double *)malloc(sizeof(double) * TEST_SIZE);
+    double * work = (double *)malloc(sizeof(double) * brahe_simple_fft_work_size(FFT_SIZE));
+    double * expected = (double *)malloc(sizeof(double) * FFT_SIZE);
+    double * actual   = (double *)malloc(sizeof(double) * FFT_SIZE);
+    double worst = 0.0;
+
+    for (i = 0; i < TEST_SIZE; ++i)
+        data[i] = 1000.0 * sin((double)i * 0.3) + 200.0 * cos((double)i * 0.05);
+
+    if (!write_samples(IN_PATH, BRAHE_SAMPLE_FLOAT32, data, TEST_SIZE)
+     || !brahe_simple_fft_into(data + FFT_FIRST, FFT_SIZE, expected, work)
+     || !brahe_simple_fft_file(IN_PATH, BRAHE_SAMPLE_FLOAT32, FFT_FIRST, FFT_SIZE, actual, work))
+        ++errcnt;
+    else
+    {
+        // 4096 / 2 terms
+        for (i = 0; i < 2048; ++i)
+        {
+            if (fabs(actual[i] - expected[i]) > worst)
+                worst = fabs(actual[i] - expected[i]);
+        }
+
+        if (worst != 0.0)
+            ++errcnt;
+    }
+
+    // a section past the end of the file fails
+    if (brahe_simple_fft_file(IN_PATH, BRAHE_SAMPLE_FLOAT32, TEST_SIZE - FFT_SIZE + 1, FFT_SIZE, actual, work))
+        ++errcnt;
+
+    if (verbose)
+        printf("fft of file section: largest difference %g\n", worst);
+
+    remove(IN_PATH);
+    free(actual);
+    free(expected);
+    free(work);
+    free(data);
+    return (int)errcnt;
+}
+
+int main(int argc, char * argv[])
+{
+    size_t errcnt = 0;
+
+    errcnt += test_statistics_file(true);
+    errcnt += test_moving_average_file(true);
+    errcnt += test_fft_file(true);
+
+    printf("found %d error(s)\n",(int)errcnt);
+
+    return errcnt;
+}
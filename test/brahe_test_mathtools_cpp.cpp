@@ -0,0 +1,254 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+#include "../src/mathtools.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <span>
+#include <vector>
+
+static_assert(brahe::real_range<std::vector<double>>, "vectors are accepted");
+static_assert(brahe::real_range<std::span<const double>>, "const spans are accepted");
+static_assert(brahe::real_range<double[4]>, "built-in arrays are accepted");
+static_assert(brahe::real_range<std::vector<float>>, "float as well as double");
+static_assert(!brahe::real_range<std::vector<int>>, "integers are not");
+static_assert(!brahe::mutable_real_range<const std::vector<double> &>, "selection needs mutable data");
+
+static const std::size_t TEST_SIZE = 10007;
+
+static std::vector<double> make_data(std::size_t n)
+{
+    std::vector<double> data(n);
+
+    for (std::size_t i = 0; i < n; ++i)
+        data[i] = 10.0 * std::sin(0.01 * (double)i) + 0.37 * (double)(i % 17) - 3.0;
+
+    return data;
+}
+
+static bool same(const double * a, const double * b, std::size_t n)
+{
+    return std::memcmp(a, b, n * sizeof(double)) == 0;
+}
+
+// same results as the C functions, from views of the caller's data
+int test_statistics(bool verbose)
+{
+    int errcnt = 0;
+    const std::vector<double> data = make_data(TEST_SIZE);
+    std::vector<double> expected(TEST_SIZE), result(TEST_SIZE);
+
+    brahe_statistics a = brahe_get_statistics(data.data(), data.size());
+    brahe_statistics b = brahe::get_statistics(data);
+
+    if ((a.min != b.min) || (a.max != b.max) || (a.mean != b.mean) || (a.variance != b.variance))
+        ++errcnt;
+
+    // a subspan covers part of the array, without copying
+    a = brahe_get_statistics(data.data() + 100, 500);
+    b = brahe::get_statistics(std::span(data).subspan(100, 500));
+
+    if (a.mean != b.mean)
+        ++errcnt;
+
+    brahe_moving_average_into(data.data(), data.size(), 7, expected.data());
+
+    if (!brahe::moving_average(data, 7, result) || !same(expected.data(), result.data(), TEST_SIZE))
+        ++errcnt;
+
+    // too short an output is refused
+    if (brahe::moving_average(data, 7, std::span(result).first(TEST_SIZE - 1)))
+        ++errcnt;
+
+    std::vector<double> copy(data);
+    double median = brahe::median(copy);
+    copy = data;
+
+    if (median != brahe_median(copy.data(), copy.size()))
+        ++errcnt;
+
+    const std::array<double, 3> q = { 0.1, 0.5, 0.9 };
+    std::array<double, 3> qr;
+
+    if (!brahe::quantiles(copy, q, qr) || (qr[1] != median))
+        ++errcnt;
+
+    if (verbose)
+        std::printf("statistics: %d error(s)\n", errcnt);
+
+    return errcnt;
+}
+
+int test_fft(bool verbose)
+{
+    int errcnt = 0;
+    const std::vector<double> data = make_data(1000);
+    const std::size_t size = brahe::simple_fft_size(data.size());
+    std::vector<double> work(brahe::simple_fft_work_size<double>(data.size()));
+    std::vector<double> out(size);
+
+    double * expected = brahe_simple_fft(data.data(), data.size());
+
+    if ((size != 512) || (expected == NULL))
+        ++errcnt;
+    else
+    {
+        if (!brahe::simple_fft(data, out, work) || !same(expected, out.data(), size))
+            ++errcnt;
+
+        if (brahe::simple_fft(data, std::span(out).first(size - 1), work))
+            ++errcnt;
+
+        if (brahe::simple_fft(data, out, std::span(work).first(work.size() - 1)))
+            ++errcnt;
+    }
+
+    brahe_free(expected);
+
+    if ((brahe::simple_fft_size(1) != 0) || (brahe::simple_fft_size(4) != 2) || (brahe::simple_fft_size(5) != 4))
+        ++errcnt;
+
+    if (verbose)
+        std::printf("fft: %d error(s)\n", errcnt);
+
+    return errcnt;
+}
+
+int test_elementwise(bool verbose)
+{
+    int errcnt = 0;
+    double raw[] = { -2.5, -0.75, 0.25, 0.5, 1.5, 2.5, 3.75, 1.0e6 + 0.5 };
+    const std::size_t n = sizeof(raw) / sizeof(raw[0]);
+    double expected[n], result[n];
+
+    brahe_round_nearest_v(raw, expected, n);
+
+    if (!brahe::round_nearest(raw, result) || !same(expected, result, n))
+        ++errcnt;
+
+    brahe_sigdig_v(raw, expected, n, 2);
+
+    if (!brahe::sigdig(raw, result, 2) || !same(expected, result, n))
+        ++errcnt;
+
+    brahe_asinh_v(raw, expected, n);
+
+    if (!brahe::asinh(raw, result) || !same(expected, result, n))
+        ++errcnt;
+
+    // in place
+    brahe_atanh_v(raw, expected, n);
+
+    if (!brahe::atanh(raw, raw) || !same(expected, raw, n))
+        ++errcnt;
+
+    if (brahe::acosh(raw, std::span(result).first(n - 1)))
+        ++errcnt;
+
+    if (verbose)
+        std::printf("elementwise: %d error(s)\n", errcnt);
+
+    return errcnt;
+}
+
+// float ranges reach the single-precision functions
+int test_single(bool verbose)
+{
+    int errcnt = 0;
+    const std::vector<double> source = make_data(1000);
+    std::vector<float> data(source.begin(), source.end());
+    std::vector<float> expected(data.size()), result(data.size());
+    std::vector<float> work(brahe::simple_fft_work_size<float>(data.size()));
+
+    brahe_statistics a = brahe_get_statistics_f(data.data(), data.size());
+    brahe_statistics b = brahe::get_statistics(data);
+
+    if ((a.mean != b.mean) || (a.variance != b.variance))
+        ++errcnt;
+
+    brahe_moving_average_into_f(data.data(), data.size(), 3, expected.data());
+
+    if (!brahe::moving_average(data, 3, result) || (std::memcmp(expected.data(), result.data(), sizeof(float) * data.size()) != 0))
+        ++errcnt;
+
+    brahe_simple_fft_into_f(data.data(), data.size(), expected.data(), work.data());
+
+    if (!brahe::simple_fft(data, std::span(result), work) || (std::memcmp(expected.data(), result.data(), sizeof(float) * 512) != 0))
+        ++errcnt;
+
+    brahe_asinh_v_f(data.data(), expected.data(), data.size());
+
+    if (!brahe::asinh(data, result) || (std::memcmp(expected.data(), result.data(), sizeof(float) * data.size()) != 0))
+        ++errcnt;
+
+    if (verbose)
+        std::printf("single precision: %d error(s)\n", errcnt);
+
+    return errcnt;
+}
+
+int main()
+{
+    int errcnt = 0;
+
+    errcnt += test_statistics(true);
+    errcnt += test_fft(true);
+    errcnt += test_elementwise(true);
+    errcnt += test_single(true);
+
+    std::printf("found %d error(s)\n", errcnt);
+
+    return errcnt;
+}
@@ -0,0 +1,255 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+#include "../src/prng.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/*
+    Metrics are only gathered when the library is configured with
+    --enable-instrumentation; otherwise this checks that none are reported.
+*/
+
+#define MAX_METRICS 64
+
+// a metric from a fresh snapshot, or zeroes if there is none by that name
+static brahe_metric_t find_metric(const char * name)
+{
+    brahe_metric_t metrics[MAX_METRICS], result;
+    size_t i, n = brahe_metrics_snapshot(metrics, MAX_METRICS);
+
+    memset(&result, 0, sizeof(result));
+
+    for (i = 0; (i < n) && (i < MAX_METRICS); ++i)
+    {
+        if (strcmp(metrics[i].name, name) == 0)
+            result = metrics[i];
+    }
+
+    return result;
+}
+
+int test_snapshot(bool verbose)
+{
+    size_t i, n, errcnt = 0;
+    brahe_metric_t metrics[MAX_METRICS];
+
+    n = brahe_metrics_snapshot(NULL, 0);
+
+    if (verbose)
+        printf("metrics: instrumented %s, %d metric(s)\n", brahe_metrics_enabled() ? "yes" : "no", (int)n);
+
+    if (!brahe_metrics_enabled())
+        return (n == 0) ? 0 : 1;
+
+    if ((n == 0) || (n > MAX_METRICS) || (brahe_metrics_snapshot(metrics, MAX_METRICS) != n))
+        return 1;
+
+    // every metric is named, once
+    for (i = 0; i < n; ++i)
+    {
+        if ((metrics[i].name == NULL) || (find_metric(metrics[i].name).name != metrics[i].name))
+            ++errcnt;
+
+        if (verbose)
+            printf("    %-24s %8lu call(s)\n", metrics[i].name, (unsigned long)metrics[i].calls);
+    }
+
+    return (int)errcnt;
+}
+
+int test_counts(bool verbose)
+{
+    static const size_t TEST_SIZE = 1000;
+
+    size_t i, errcnt = 0;
+    brahe_metric_t m;
+    brahe_prng_state_t prng;
+    double * data = (double *)malloc(sizeof(double) * TEST_SIZE);
+    double * mag;
+
+    if (!brahe_metrics_enabled())
+    {
+        free(data);
+        return 0;
+    }
+
+    for (i = 0; i < TEST_SIZE; ++i)
+        data[i] = (double)(i % 13);
+
+    brahe_metrics_reset();
+
+    brahe_get_statistics(data, TEST_SIZE);
+    brahe_get_statistics(data, TEST_SIZE);
+    m = find_metric("get_statistics");
+
+    if ((m.calls != 2) || (m.elements != 2 * TEST_SIZE) || (m.bytes_allocated != 0))
+        ++errcnt;
+
+    // work space and result are allocated; calls rejecting their arguments are not counted
+    mag = brahe_simple_fft(data, TEST_SIZE);
+    brahe_simple_fft(NULL, TEST_SIZE);
+    m = find_metric("simple_fft");
+
+    if ((m.calls != 1) || (m.elements != TEST_SIZE) || (m.bytes_allocated != sizeof(double) * (512 + 4 * 1024)))
+        ++errcnt;
+
+    free(mag);
+
+    // the generator brahe_add_noise uses is part of its call
+    brahe_add_noise(data, TEST_SIZE, 0.1);
+
+    if ((find_metric("add_noise").calls != 1) || (find_metric("prng_init").calls != 0))
+        ++errcnt;
+
+    if (brahe_prng_init(&prng, BRAHE_PRNG_MARSENNE_TWISTER, 1))
+    {
+        m = find_metric("prng_init");
+
+        if ((m.calls != 1) || (m.bytes_allocated == 0))
+            ++errcnt;
+
+        brahe_prng_free(&prng);
+    }
+    else
+        ++errcnt;
+
+    // reset only moves the starting point
+    brahe_metrics_reset();
+
+    if ((find_metric("get_statistics").calls != 0) || (find_metric("simple_fft").bytes_allocated != 0))
+        ++errcnt;
+
+    free(data);
+
+    if (verbose)
+        printf("metrics, counts: %d error(s)\n", (int)errcnt);
+
+    return (int)errcnt;
+}
+
+#define THREADS 4
+#define THREAD_CALLS 100
+
+static void * statistics_worker(void * arg)
+{
+    const double * data = (const double *)arg;
+    int i;
+
+    for (i = 0; i < THREAD_CALLS; ++i)
+        brahe_get_statistics(data, 1000);
+
+    return NULL;
+}
+
+int test_threads(bool verbose)
+{
+    static const size_t NOISE_SIZE = (size_t)1 << 18;
+
+    size_t i, errcnt = 0;
+    pthread_t ids[THREADS];
+    brahe_metric_t m;
+    double * data = (double *)malloc(sizeof(double) * NOISE_SIZE);
+
+    if (!brahe_metrics_enabled())
+    {
+        free(data);
+        return 0;
+    }
+
+    for (i = 0; i < NOISE_SIZE; ++i)
+        data[i] = 1.0;
+
+    brahe_metrics_reset();
+
+    for (i = 0; i < THREADS; ++i)
+        pthread_create(&ids[i], NULL, statistics_worker, data);
+
+    for (i = 0; i < THREADS; ++i)
+        pthread_join(ids[i], NULL);
+
+    // the counts of threads that have exited are kept
+    m = find_metric("get_statistics");
+
+    if ((m.calls != THREADS * THREAD_CALLS) || (m.elements != THREADS * THREAD_CALLS * 1000))
+        ++errcnt;
+
+    // work handed to the library's own threads belongs to the call
+    brahe_add_noise_seeded(data, NOISE_SIZE, BRAHE_NOISE_UNIFORM, 0.1, 12345, THREADS);
+    m = find_metric("add_noise");
+
+    if ((m.calls != 1) || (m.elements != NOISE_SIZE) || (find_metric("prng_init").calls != 0))
+        ++errcnt;
+
+    free(data);
+
+    if (verbose)
+        printf("metrics, threads: %d error(s)\n", (int)errcnt);
+
+    return (int)errcnt;
+}
+
+int main(int argc, char * argv[])
+{
+    size_t errcnt = 0;
+
+    errcnt += test_snapshot(true);
+    errcnt += test_counts(true);
+    errcnt += test_threads(true);
+
+    printf("found %d error(s)\n",(int)errcnt);
+
+    return errcnt;
+}
@@ -54,25 +54,412 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define N 10
 int64_t x[] = { 0, -1, 2, 11, 500, 97, -10263, 1768372193, 0xA1B2C3D4E5F6, 1223372036854775808 };
 
-int main(int argc, char * argv[])
+int test_samples(bool verbose)
 {
+    static const char * expected_comma[N] =
+    {
+        "0", "-1", "2", "11", "500", "97", "-10,263", "1,768,372,193",
+        "177,789,161,760,246", "1,223,372,036,854,775,808"
+    };
+
+    static const char * expected_text[N] =
+    {
+        "zero", "negative one", "two", "eleven", "five hundred", "ninety-seven",
+        "negative ten thousand, two hundred sixty-three",
+        "one billion, seven hundred sixty-eight million, three hundred seventy-two thousand, one hundred ninety-three",
+        "one hundred seventy-seven trillion, seven hundred eighty-nine billion, one hundred sixty-one million, seven hundred sixty thousand, two hundred forty-six",
+        "one quintillion, two hundred twenty-three quadrillion, three hundred seventy-two trillion, thirty-six billion, eight hundred fifty-four million, seven hundred seventy-five thousand, eight hundred eight"
+    };
+
+    int i, errcnt = 0;
     char * c;
     char * t;
 
-    for (int i = 0; i < N; ++i)
+    for (i = 0; i < N; ++i)
     {
         c = brahe_pretty_int(x[i], BRAHE_PRETTY_COMMA);
         t = brahe_pretty_int(x[i], BRAHE_PRETTY_TEXT);
 
-        printf("\n%ld\n%s\n%s\n",x[i], c, t);
+        if (verbose)
+            printf("\n%ld\n%s\n%s\n",x[i], c, t);
+
+        if ((c == NULL) || strcmp(c, expected_comma[i]))
+            ++errcnt;
+
+        if ((t == NULL) || strcmp(t, expected_text[i]))
+            ++errcnt;
+
+        brahe_free(t);
+        brahe_free(c);
+    }
+
+    return errcnt;
+}
+
+int test_buffer(bool verbose)
+{
+    static const brahe_pretty_format fmts[2] = { BRAHE_PRETTY_COMMA, BRAHE_PRETTY_TEXT };
+
+    int i, f, errcnt = 0;
+    size_t len, size;
+    char * full;
+    char buffer[16];
+
+    // measuring, exact fit, and truncation must all agree with the allocating form
+    for (f = 0; f < 2; ++f)
+    {
+        for (i = 0; i < N; ++i)
+        {
+            full = brahe_pretty_int(x[i], fmts[f]);
+            len = strlen(full);
+
+            if (brahe_pretty_int_r(x[i], fmts[f], NULL, 0) != len)
+                ++errcnt;
+
+            for (size = 1; size <= sizeof(buffer); ++size)
+            {
+                memset(buffer, 'x', sizeof(buffer));
+
+                if (brahe_pretty_int_r(x[i], fmts[f], buffer, size) != len)
+                    ++errcnt;
+
+                if ((strlen(buffer) != ((len < size) ? len : size - 1)) || strncmp(buffer, full, size - 1))
+                    ++errcnt;
+
+                // nothing may be written past the end
+                if ((size < sizeof(buffer)) && (buffer[size] != 'x'))
+                    ++errcnt;
+            }
+
+            brahe_free(full);
+        }
+    }
+
+    // a zero-length buffer is left alone
+    buffer[0] = 'x';
+
+    if ((brahe_pretty_int_r(1000, BRAHE_PRETTY_COMMA, buffer, 0) != 5) || (buffer[0] != 'x'))
+        ++errcnt;
+
+    // unknown formats produce nothing
+    if ((brahe_pretty_int_r(1000, (brahe_pretty_format)99, buffer, sizeof(buffer)) != 0) || (buffer[0] != 0))
+        ++errcnt;
+
+    if (brahe_pretty_int(1000, (brahe_pretty_format)99) != NULL)
+        ++errcnt;
+
+    if (verbose)
+        printf("\nbuffered formatting: %d error(s)\n", errcnt);
+
+    return errcnt;
+}
+
+int test_extremes(bool verbose)
+{
+    static const char * min_text =
+        "negative nine quintillion, two hundred twenty-three quadrillion, three hundred seventy-two trillion, "
+        "thirty-six billion, eight hundred fifty-four million, seven hundred seventy-five thousand, eight hundred eight";
+
+    int errcnt = 0;
+    char buffer[256];
+
+    brahe_pretty_int_r(INT64_MIN, BRAHE_PRETTY_COMMA, buffer, sizeof(buffer));
+
+    if (verbose)
+        printf("\n%s\n", buffer);
+
+    if (strcmp(buffer, "-9,223,372,036,854,775,808"))
+        ++errcnt;
+
+    brahe_pretty_int_r(INT64_MIN, BRAHE_PRETTY_TEXT, buffer, sizeof(buffer));
+
+    if (verbose)
+        printf("%s\n", buffer);
+
+    if (strcmp(buffer, min_text))
+        ++errcnt;
+
+    brahe_pretty_int_r(INT64_MAX, BRAHE_PRETTY_COMMA, buffer, sizeof(buffer));
+
+    if (strcmp(buffer, "9,223,372,036,854,775,807"))
+        ++errcnt;
+
+    brahe_pretty_int_r(1000000, BRAHE_PRETTY_TEXT, buffer, sizeof(buffer));
+
+    if (strcmp(buffer, "one million"))
+        ++errcnt;
+
+    brahe_pretty_int_r(1001000, BRAHE_PRETTY_TEXT, buffer, sizeof(buffer));
+
+    if (strcmp(buffer, "one million, one thousand"))
+        ++errcnt;
 
-        free(t);
-        free(c);
+    return errcnt;
+}
+
+int test_array(bool verbose)
+{
+    static const brahe_pretty_format fmts[2] = { BRAHE_PRETTY_COMMA, BRAHE_PRETTY_TEXT };
+    static const size_t VALUES = 1000;
+
+    int f, errcnt = 0;
+    size_t i, size, count, start;
+    int64_t values[1000];
+    size_t offsets[1001];
+    char * arena;
+    char * single;
+    char small[4];
+    uint64_t s = 0x9E3779B97F4A7C15ULL;
+
+    // every magnitude, both signs, and the extremes
+    for (i = 0; i < VALUES; ++i)
+    {
+        s ^= s << 13;
+        s ^= s >> 7;
+        s ^= s << 17;
+        values[i] = (int64_t)(s >> (i % 64));
+
+        if (i & 1)
+            values[i] = -values[i];
     }
 
-    return 0;
+    values[0] = INT64_MIN;
+    values[1] = INT64_MAX;
+    values[2] = 0;
+    values[3] = 999;
+    values[4] = -1000;
+
+    for (f = 0; f < 2; ++f)
+    {
+        size = brahe_pretty_int_array_size(values, VALUES, fmts[f]);
+        arena = (char *)malloc(size);
+
+        // everything fits in an arena of the reported size
+        if (brahe_pretty_int_array(values, VALUES, fmts[f], arena, size, offsets) != VALUES)
+            ++errcnt;
+
+        if (offsets[VALUES] != size)
+            ++errcnt;
+
+        for (i = 0; i < VALUES; ++i)
+        {
+            single = brahe_pretty_int(values[i], fmts[f]);
+
+            if (strcmp(arena + offsets[i], single))
+                ++errcnt;
+
+            brahe_free(single);
+        }
+
+        if (verbose)
+            printf("\narray, format %d: %lu bytes, last \"%s\"\n", f, (unsigned long)size, arena + offsets[VALUES - 1]);
+
+        // a small arena is drained in pieces that match the whole
+        single = (char *)malloc(size);
+        start = 0;
+
+        for (i = 0; i < VALUES; i += count)
+        {
+            count = brahe_pretty_int_array(values + i, VALUES - i, fmts[f], single, 700, offsets);
+
+            if ((count == 0) || memcmp(single, arena + start, offsets[count]))
+            {
+                ++errcnt;
+                break;
+            }
+
+            start += offsets[count];
+        }
+
+        if (start != size)
+            ++errcnt;
+
+        free(single);
+        free(arena);
+    }
+
+    // an arena too small for the first value writes nothing
+    if ((brahe_pretty_int_array(values, VALUES, BRAHE_PRETTY_COMMA, small, sizeof(small), offsets) != 0) || (offsets[0] != 0))
+        ++errcnt;
+
+    if (brahe_pretty_int_array_size(values, VALUES, (brahe_pretty_format)99) != 0)
+        ++errcnt;
+
+    return errcnt;
+}
+
+int test_locales(bool verbose)
+{
+    // Indian English, grouped 3;2
+    static const brahe_pretty_words_t indian_words =
+    {
+        "zero",
+        "minus",
+        "hundred",
+        {
+            "", "one", "two", "three", "four", "five",
+            "six", "seven", "eight", "nine", "ten",
+            "eleven", "twelve", "thirteen", "fourteen", "fifteen",
+            "sixteen", "seventeen", "eighteen", "nineteen"
+        },
+        {
+            "twenty", "thirty", "forty", "fifty",
+            "sixty", "seventy", "eighty", "ninety"
+        },
+        "-",
+        " ",
+        {
+            "thousand", "lakh", "crore", "arab", "kharab", "nil", "padma", "shankh"
+        }
+    };
+
+    static const struct
+    {
+        const char * separator;
+        const char * grouping;
+        int64_t      value;
+        const char * expected;
+    }
+    grouped[] =
+    {
+        { ".",            "3",     -1234567,            "-1.234.567" },
+        { "\xE2\x80\xAF", "3",     1234567,             "1\xE2\x80\xAF" "234\xE2\x80\xAF" "567" },
+        { ",",            "3;2",   1234567,             "12,34,567" },
+        { ",",            "3;2",   INT64_MIN,           "-92,23,37,20,36,85,47,75,808" },
+        { ",",            "3;2",   100000,              "1,00,000" },
+        { ",",            "3;2",   999,                 "999" },
+        { "'",            "4",     123456789,           "1'2345'6789" },
+        { " ",            "1;2;3", 1234567,             "1 234 56 7" },
+        { ",",            "",      INT64_MAX,           "9223372036854775807" },
+        { "--",           "2",     -10203,              "-1--02--03" },
+        { ",",            "3",     0,                   "0" }
+    };
+
+    static const char * bad_patterns[] = { "0", "3;", ";3", "3;x", "33", "3,2" };
+
+    int errcnt = 0;
+    size_t i, count, size;
+    brahe_pretty_locale_t loc;
+    brahe_pretty_words_t short_words;
+    char buffer[256];
+    int64_t values[3] = { 1234567, -12345, 7 };
+    size_t offsets[4];
+
+    for (i = 0; i < sizeof(grouped) / sizeof(grouped[0]); ++i)
+    {
+        if (!brahe_pretty_locale_init(&loc, grouped[i].separator, grouped[i].grouping, NULL))
+        {
+            ++errcnt;
+            continue;
+        }
+
+        size = brahe_pretty_int_l(grouped[i].value, BRAHE_PRETTY_COMMA, &loc, buffer, sizeof(buffer));
+
+        if (verbose)
+            printf("\n\"%s\" \"%s\": %s", grouped[i].separator, grouped[i].grouping, buffer);
+
+        if (strcmp(buffer, grouped[i].expected) || (size != strlen(grouped[i].expected)))
+            ++errcnt;
+
+        // no words, no text
+        if (brahe_pretty_int_l(grouped[i].value, BRAHE_PRETTY_TEXT, &loc, buffer, sizeof(buffer)) != 0)
+            ++errcnt;
+    }
+
+    for (i = 0; i < sizeof(bad_patterns) / sizeof(bad_patterns[0]); ++i)
+    {
+        if (brahe_pretty_locale_init(&loc, ",", bad_patterns[i], NULL))
+            ++errcnt;
+    }
+
+    if (brahe_pretty_locale_init(&loc, "123456789", "3", NULL))
+        ++errcnt;
+
+    // a multibyte separator truncates at the byte, like everything else
+    brahe_pretty_locale_init(&loc, "\xE2\x80\xAF", "3", NULL);
+
+    if ((brahe_pretty_int_l(1234, BRAHE_PRETTY_COMMA, &loc, buffer, 3) != 7) || strcmp(buffer, "1\xE2"))
+        ++errcnt;
+
+    // the longest separator between every digit, whole and truncated
+    brahe_pretty_locale_init(&loc, "12345678", "1", NULL);
+
+    if ((brahe_pretty_int_l(INT64_MIN, BRAHE_PRETTY_COMMA, &loc, buffer, sizeof(buffer)) != 164)
+        || (strlen(buffer) != 164) || strncmp(buffer, "-9123456782123456782123456783", 29) || strcmp(buffer + 154, "0123456788"))
+        ++errcnt;
+
+    memset(buffer, 'X', sizeof(buffer));
+
+    if ((brahe_pretty_int_l(INT64_MIN, BRAHE_PRETTY_COMMA, &loc, buffer, 16) != 164) || strcmp(buffer, "-91234567821234"))
+        ++errcnt;
+
+    // lakh and crore
+    brahe_pretty_locale_init(&loc, ",", "3;2", &indian_words);
+    brahe_pretty_int_l(-1234567, BRAHE_PRETTY_TEXT, &loc, buffer, sizeof(buffer));
+
+    if (verbose)
+        printf("\n%s\n", buffer);
+
+    if (strcmp(buffer, "minus twelve lakh thirty-four thousand five hundred sixty-seven"))
+        ++errcnt;
+
+    brahe_pretty_int_l(300000005, BRAHE_PRETTY_TEXT, &loc, buffer, sizeof(buffer));
+
+    if (strcmp(buffer, "thirty crore five"))
+        ++errcnt;
+
+    // every group needs a name before text is allowed
+    short_words = indian_words;
+    short_words.powers[7] = NULL;
+    brahe_pretty_locale_init(&loc, ",", "3;2", &short_words);
+
+    if (brahe_pretty_int_l(1234567, BRAHE_PRETTY_TEXT, &loc, buffer, sizeof(buffer)) != 0)
+        ++errcnt;
+
+    // English words with another separator match the built-in text
+    brahe_pretty_locale_init(&loc, ".", "3", brahe_pretty_words_english());
+    brahe_pretty_int_l(INT64_MIN, BRAHE_PRETTY_TEXT, &loc, buffer, sizeof(buffer));
+
+    if (strncmp(buffer, "negative nine quintillion, two hundred", 38))
+        ++errcnt;
+
+    // groups too wide to spell out
+    brahe_pretty_locale_init(&loc, ",", "4", brahe_pretty_words_english());
+
+    if (brahe_pretty_int_l(12345, BRAHE_PRETTY_TEXT, &loc, buffer, sizeof(buffer)) != 0)
+        ++errcnt;
+
+    // arrays follow the locale
+    brahe_pretty_locale_init(&loc, ",", "3;2", NULL);
+    size = brahe_pretty_int_array_size_l(values, 3, BRAHE_PRETTY_COMMA, &loc);
+    count = brahe_pretty_int_array_l(values, 3, BRAHE_PRETTY_COMMA, &loc, buffer, sizeof(buffer), offsets);
+
+    if ((count != 3) || (size != offsets[3]) || (size != 10 + 8 + 2)
+        || strcmp(buffer + offsets[0], "12,34,567") || strcmp(buffer + offsets[1], "-12,345") || strcmp(buffer + offsets[2], "7"))
+        ++errcnt;
+
+    if (verbose)
+        printf("locales: %d error(s)\n", errcnt);
+
+    return errcnt;
+}
+
+int main(int argc, char * argv[])
+{
+    int errcnt = 0;
+
+    errcnt += test_samples(true);
+    errcnt += test_buffer(true);
+    errcnt += test_extremes(true);
+    errcnt += test_array(true);
+    errcnt += test_locales(true);
+
+    printf("found %d error(s)\n",errcnt);
+
+    return errcnt;
 }
@@ -53,21 +53,23 @@
 #include "../src/prng.h"
 
 #include <stdio.h>
-#include <time.h>
+#include <stdlib.h>
 
 static const size_t TEST_SIZE = 100000000;
 static const size_t NUM_BUCKETS = 13;
+#define BLOCK_SIZE 4096
 
-double test_prng(brahe_prng_type_t prng_type)
+// timing lives in brahe_bench; this checks ranges and distribution
+int test_prng(brahe_prng_type_t prng_type)
 {
-    uint32_t total, dummy;
+    int errcnt = 0;
     size_t i;
     double n, l, s;
-    int counts[NUM_BUCKETS];
+    double block[BLOCK_SIZE];
+    const uint64_t * counts;
+    brahe_histogram_t hist;
     brahe_prng_state_t prng_state;
 
-    struct timespec start, stop;
-
     switch (prng_type)
     {
         case BRAHE_PRNG_MARSENNE_TWISTER:
@@ -110,6 +112,9 @@ double test_prng(brahe_prng_type_t prng_type)
 
     printf("    largest = %15.14f\n   smallest = %15.14f\n", l, s);
 
+    if ((s < 0.0) || (l > 1.0))
+        ++errcnt;
+
     //  each real function
     printf("\nrand_real2 - interval [0,1)\n");
 
@@ -126,6 +131,9 @@ double test_prng(brahe_prng_type_t prng_type)
 
     printf("    largest = %15.14f\n   smallest = %15.14f\n", l, s);
 
+    if ((s < 0.0) || (l >= 1.0))
+        ++errcnt;
+
     //  each real function
     printf("\nrand_real3 - interval (0,1)\n");
 
@@ -142,6 +150,9 @@ double test_prng(brahe_prng_type_t prng_type)
 
     printf("    largest = %15.14f\n   smallest = %15.14f\n", l, s);
 
+    if ((s <= 0.0) || (l >= 1.0))
+        ++errcnt;
+
     //  each real function
     printf("\nrand_real53 - interval [0,1) - 53-bit precision\n");
 
@@ -158,57 +169,124 @@ double test_prng(brahe_prng_type_t prng_type)
 
     printf("    largest = %15.14f\n   smallest = %15.14f\n", l, s);
 
+    if ((s < 0.0) || (l >= 1.0))
+        ++errcnt;
+
     //  check ranges
-    for (i = 0; i < NUM_BUCKETS; ++i)
-        counts[i] = 0;
+    brahe_histogram_init_linear(&hist, 0.0, (double)NUM_BUCKETS, NUM_BUCKETS);
 
-    for (i = 0; i < TEST_SIZE; ++i)
-        ++counts[brahe_prng_index(&prng_state,NUM_BUCKETS)];
+    for (i = 0; i < TEST_SIZE; i += BLOCK_SIZE)
+    {
+        size_t j, len = (TEST_SIZE - i < BLOCK_SIZE) ? TEST_SIZE - i : BLOCK_SIZE;
+
+        for (j = 0; j < len; ++j)
+            block[j] = (double)brahe_prng_index(&prng_state,NUM_BUCKETS);
+
+        brahe_histogram_add_n(&hist, block, len);
+    }
 
     printf("\n");
 
-    total = 0;
+    counts = brahe_histogram_counts(&hist);
 
     for (i = 0; i < NUM_BUCKETS; ++i)
-    {
-        printf("counts %3d  = %10d\n", i, counts[i]);
-        total += counts[i];
-    }
-
-    printf("      total = %10d\n", total);
+        printf("counts %3d  = %10d\n", (int)i, (int)counts[i]);
 
-    // get starting time
-    clock_gettime(CLOCK_REALTIME,&start);
+    printf("  out of range = %7d\n", (int)(brahe_histogram_underflow(&hist) + brahe_histogram_overflow(&hist)));
+    printf("      total = %10d\n", (int)brahe_histogram_total(&hist));
 
-    // test generation speed
-    for (i = 0; i < TEST_SIZE; ++i)
-        dummy = brahe_prng_next(&prng_state);
+    if ((brahe_histogram_underflow(&hist) + brahe_histogram_overflow(&hist) != 0) || (brahe_histogram_total(&hist) != TEST_SIZE))
+        ++errcnt;
 
-    // calculate run time
-    clock_gettime(CLOCK_REALTIME,&stop);
+    brahe_histogram_free(&hist);
 
     // free resources
     brahe_prng_free(&prng_state);
 
     // done
-    return ((stop.tv_sec - start.tv_sec) + (double)(stop.tv_nsec - start.tv_nsec) / 1000000000.0);
+    return errcnt;
 }
 
-int main()
+// counts the allocations made through it
+static size_t live_allocations = 0;
+
+static void * counting_alloc(const size_t size, const size_t alignment, void * context)
+{
+    ++live_allocations;
+    return malloc(size);
+}
+
+static void counting_free(void * p, void * context)
+{
+    --live_allocations;
+    free(p);
+}
+
+// a generator in caller memory must match one in allocated memory
+int test_init_into(brahe_prng_type_t prng_type)
 {
-    double mtwister_time = test_prng(BRAHE_PRNG_MARSENNE_TWISTER);
-    double kissrng_time  = test_prng(BRAHE_PRNG_KISS);
-    double mwc1038_time  = test_prng(BRAHE_PRNG_MWC1038);
-    double cmwc4096_time = test_prng(BRAHE_PRNG_CMWC4096);
-    double isaac_time    = test_prng(BRAHE_PRNG_ISAAC);
-
-    printf("\nALGORITHM TIMING (random numbers / second)\n\n");
-    printf("  Marsenne Twister = %5.2f (%10.0f/sec)\n", mtwister_time, ((double)TEST_SIZE / mtwister_time));
-    printf("              KISS = %5.2f (%10.0f/sec)\n", kissrng_time,  ((double)TEST_SIZE / kissrng_time));
-    printf("           MWC1038 = %5.2f (%10.0f/sec)\n", mwc1038_time,  ((double)TEST_SIZE / mwc1038_time));
-    printf("          CMWC4096 = %5.2f (%10.0f/sec)\n", cmwc4096_time, ((double)TEST_SIZE / cmwc4096_time));
-    printf("             ISAAC = %5.2f (%10.0f/sec)\n", isaac_time,    ((double)TEST_SIZE / isaac_time));
-
-    return 0;
+    static const brahe_allocator_t counting = { counting_alloc, counting_free, NULL };
+
+    int errcnt = 0;
+    size_t i, size = brahe_prng_state_size(prng_type);
+    uint32_t * buffer = (uint32_t *)malloc(size);
+    brahe_prng_state_t allocated, supplied;
+
+    brahe_set_allocator(&counting);
+
+    if (!brahe_prng_init(&allocated, prng_type, 12345) || (live_allocations != 1))
+        ++errcnt;
+
+    // too small a buffer is refused
+    if (brahe_prng_init_into(&supplied, prng_type, 12345, buffer, size - 1))
+        ++errcnt;
+
+    if (!brahe_prng_init_into(&supplied, prng_type, 12345, buffer, size) || (live_allocations != 1))
+        ++errcnt;
+
+    for (i = 0; i < 10000; ++i)
+    {
+        if (brahe_prng_next(&allocated) != brahe_prng_next(&supplied))
+        {
+            ++errcnt;
+            break;
+        }
+    }
+
+    // the allocated state goes back to its allocator, the buffer stays
+    brahe_set_allocator(NULL);
+    brahe_prng_free(&allocated);
+    brahe_prng_free(&supplied);
+
+    if (live_allocations != 0)
+        ++errcnt;
+
+    printf("init into caller memory (%lu bytes): %d error(s)\n", (unsigned long)size, errcnt);
+
+    free(buffer);
+    return errcnt;
 }
 
+int main()
+{
+    int errcnt = 0;
+
+    errcnt += test_prng(BRAHE_PRNG_MARSENNE_TWISTER);
+    errcnt += test_prng(BRAHE_PRNG_KISS);
+    errcnt += test_prng(BRAHE_PRNG_MWC1038);
+    errcnt += test_prng(BRAHE_PRNG_CMWC4096);
+    errcnt += test_prng(BRAHE_PRNG_ISAAC);
+
+    errcnt += test_init_into(BRAHE_PRNG_MARSENNE_TWISTER);
+    errcnt += test_init_into(BRAHE_PRNG_KISS);
+    errcnt += test_init_into(BRAHE_PRNG_MWC1038);
+    errcnt += test_init_into(BRAHE_PRNG_CMWC4096);
+    errcnt += test_init_into(BRAHE_PRNG_ISAAC);
+
+    if (brahe_prng_state_size((brahe_prng_type_t)99) != 0)
+        ++errcnt;
+
+    printf("found %d error(s)\n",errcnt);
+
+    return errcnt;
+}
@@ -0,0 +1,196 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+#include "../src/prng.hpp"
+#include "../src/prng.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// the UniformRandomBitGenerator requirements, and move-only ownership
+template <typename Engine>
+constexpr bool check_traits()
+{
+    static_assert(std::is_unsigned<typename Engine::result_type>::value, "unsigned result_type");
+    static_assert(Engine::min() < Engine::max(), "min() below max()");
+    static_assert(std::is_same<decltype(std::declval<Engine &>()()), typename Engine::result_type>::value, "operator() yields result_type");
+    static_assert(!std::is_copy_constructible<Engine>::value, "not copyable");
+    static_assert(!std::is_copy_assignable<Engine>::value, "not copy-assignable");
+    static_assert(std::is_nothrow_move_constructible<Engine>::value, "movable");
+    static_assert(std::is_nothrow_move_assignable<Engine>::value, "move-assignable");
+    return true;
+}
+
+static_assert(check_traits<brahe::mt>(), "");
+static_assert(check_traits<brahe::kiss>(), "");
+static_assert(check_traits<brahe::mwc1038>(), "");
+static_assert(check_traits<brahe::cmwc4096>(), "");
+static_assert(check_traits<brahe::isaac>(), "");
+
+// same stream as the C library, across several buffer refills
+template <typename Engine>
+int test_engine(const char * name, brahe_prng_type_t prng_type)
+{
+    static const std::uint32_t seeds[] = { 1, 5489, 12345, 0xDEADBEEF };
+    static const std::size_t   COUNT   = 20000;
+
+    int errcnt = 0;
+
+    for (std::uint32_t seed : seeds)
+    {
+        brahe_prng_state_t state;
+        Engine engine(seed);
+
+        if (!brahe_prng_init(&state, prng_type, seed))
+        {
+            ++errcnt;
+            continue;
+        }
+
+        for (std::size_t i = 0; i < COUNT; ++i)
+        {
+            if (engine() != brahe_prng_next(&state))
+            {
+                ++errcnt;
+                break;
+            }
+        }
+
+        // reseeding restarts the stream; a moved-to engine continues it
+        brahe_prng_free(&state);
+        brahe_prng_init(&state, prng_type, seed);
+        engine.seed(seed);
+        engine.discard(100);
+
+        for (std::size_t i = 0; i < 100; ++i)
+            brahe_prng_next(&state);
+
+        Engine moved(std::move(engine));
+
+        if (moved() != brahe_prng_next(&state))
+            ++errcnt;
+
+        brahe_prng_free(&state);
+    }
+
+    std::printf("%s matches the C stream: %d error(s)\n", name, errcnt);
+    return errcnt;
+}
+
+// works with the standard distributions and algorithms
+template <typename Engine>
+int test_standard(const char * name)
+{
+    int errcnt = 0;
+    Engine engine(2011);
+    std::uniform_int_distribution<int> dist(1, 6);
+    std::vector<int> deck(52);
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        int roll = dist(engine);
+
+        if ((roll < 1) || (roll > 6))
+        {
+            ++errcnt;
+            break;
+        }
+    }
+
+    std::iota(deck.begin(), deck.end(), 0);
+    std::shuffle(deck.begin(), deck.end(), engine);
+    std::sort(deck.begin(), deck.end());
+
+    for (int i = 0; i < 52; ++i)
+    {
+        if (deck[i] != i)
+        {
+            ++errcnt;
+            break;
+        }
+    }
+
+    std::printf("%s with <random> and std::shuffle: %d error(s)\n", name, errcnt);
+    return errcnt;
+}
+
+int main()
+{
+    int errcnt = 0;
+
+    errcnt += test_engine<brahe::mt>("mt", BRAHE_PRNG_MARSENNE_TWISTER);
+    errcnt += test_engine<brahe::kiss>("kiss", BRAHE_PRNG_KISS);
+    errcnt += test_engine<brahe::mwc1038>("mwc1038", BRAHE_PRNG_MWC1038);
+    errcnt += test_engine<brahe::cmwc4096>("cmwc4096", BRAHE_PRNG_CMWC4096);
+    errcnt += test_engine<brahe::isaac>("isaac", BRAHE_PRNG_ISAAC);
+
+    errcnt += test_standard<brahe::mt>("mt");
+    errcnt += test_standard<brahe::kiss>("kiss");
+    errcnt += test_standard<brahe::mwc1038>("mwc1038");
+    errcnt += test_standard<brahe::cmwc4096>("cmwc4096");
+    errcnt += test_standard<brahe::isaac>("isaac");
+
+    // zero still means an unpredictable seed
+    brahe::kiss a(0), b(0);
+
+    if ((a() == b()) && (a() == b()))
+        ++errcnt;
+
+    std::printf("found %d error(s)\n", errcnt);
+
+    return errcnt;
+}
@@ -51,11 +51,130 @@
 */
 
 #include "../src/mathtools.h"
+#include "../src/prng.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const size_t TEST_SIZE = 1000000;
+
+static double seconds(const struct timespec * start, const struct timespec * stop)
+{
+    return (stop->tv_sec - start->tv_sec) + (double)(stop->tv_nsec - start->tv_nsec) / 1000000000.0;
+}
+
+// count results that differ in any bit from the scalar function
+static int compare_bits(const double * expected, const double * actual, const size_t n)
+{
+    size_t i;
+    int errcnt = 0;
+
+    for (i = 0; i < n; ++i)
+    {
+        if (memcmp(&expected[i], &actual[i], sizeof(double)) != 0)
+            ++errcnt;
+    }
+
+    return errcnt;
+}
+
+int test_arrays(bool verbose)
+{
+    static const double specials[] = { 0.0, -0.0, 0.5, -0.5, 1.5, 2.5, -2.5, 4503599627370495.5, 4503599627370497.0,
+                                       1.0e-310, -1.0e-320, 1000.0, 999.9999999999999, 1.0e-5, 0.00009999999999999999,
+                                       DBL_MAX, DBL_MIN, HUGE_VAL, -HUGE_VAL, NAN };
+    static const size_t NUM_SPECIALS = sizeof(specials) / sizeof(specials[0]);
+
+    size_t i;
+    uint16_t digits;
+    int errcnt = 0, e;
+    double * in       = (double *)malloc(sizeof(double) * TEST_SIZE);
+    double * expected = (double *)malloc(sizeof(double) * TEST_SIZE);
+    double * actual   = (double *)malloc(sizeof(double) * TEST_SIZE);
+    double scalar_time, array_time;
+    brahe_prng_state_t prng;
+    struct timespec start, stop;
+
+    brahe_prng_init(&prng, BRAHE_PRNG_KISS, 1234567);
+
+    // report-like values, awkward values, and exact powers of ten and their neighbours
+    for (i = 0; i < TEST_SIZE; ++i)
+    {
+        double sign = (brahe_prng_next(&prng) & 1) ? 1.0 : -1.0;
+
+        switch (i % 4)
+        {
+            case 0:
+                in[i] = sign * brahe_prng_real53(&prng) * 1.0e6;
+                break;
+
+            case 1:
+                in[i] = sign * (double)brahe_prng_range(&prng, 0, 100000) / 8.0;
+                break;
+
+            case 2:
+                in[i] = sign * pow(10.0, brahe_prng_real53(&prng) * 600.0 - 300.0);
+                break;
+
+            default:
+                e = (int)brahe_prng_range(&prng, 0, 600) - 300;
+                in[i] = nextafter(pow(10.0, (double)e), (double)(int)brahe_prng_range(&prng, 0, 2) - 1.0);
+        }
+    }
+
+    memcpy(in, specials, sizeof(specials));
+
+    // round to nearest
+    for (i = 0; i < TEST_SIZE; ++i)
+        expected[i] = brahe_round_nearest(in[i]);
+
+    brahe_round_nearest_v(in, actual, TEST_SIZE);
+    errcnt += compare_bits(expected, actual, TEST_SIZE);
+
+    // significant digits, for every precision, and in place
+    for (digits = 0; digits <= DBL_DIG + 1; ++digits)
+    {
+        for (i = 0; i < TEST_SIZE; ++i)
+            expected[i] = brahe_sigdig(in[i], digits);
+
+        memcpy(actual, in, sizeof(double) * TEST_SIZE);
+        brahe_sigdig_v(actual, actual, TEST_SIZE, digits);
+        errcnt += compare_bits(expected, actual, TEST_SIZE);
+    }
+
+    // speed, on report-like values
+    for (i = 0; i < NUM_SPECIALS; ++i)
+        in[i] = (double)i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (i = 0; i < TEST_SIZE; ++i)
+        expected[i] = brahe_sigdig(in[i], 6);
+
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    scalar_time = seconds(&start, &stop);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    brahe_sigdig_v(in, actual, TEST_SIZE, 6);
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    array_time = seconds(&start, &stop);
+
+    if (verbose)
+        printf("rounding arrays: %d mismatch(es); sigdig array %.1fx faster\n", errcnt, scalar_time / array_time);
+
+    brahe_prng_free(&prng);
+    free(actual);
+    free(expected);
+    free(in);
+
+    return errcnt;
+}
 
 int main(int argc, char * argv[])
 {
+    int errcnt;
     const double pi = 3.14159265358979;
     const double e  = 27182.8182845905;
     const double c  = 299792.4562;
@@ -86,7 +205,11 @@ int main(int argc, char * argv[])
     printf("sigdig(6.5,2)    = %15.8f (should be      6.50000000)\n", brahe_sigdig(6.5,2));
     printf("sigdig(-6.5,2)   = %15.8f (should be     -6.50000000)\n", brahe_sigdig(-6.5,2));
     printf("sigdig(17.5,2)   = %15.8f (should be     18.00000000)\n", brahe_sigdig(17.5,2));
-    printf("sigdig(-17.5,2)  = %15.8f (should be    -18.00000000)\n", brahe_sigdig(-17.5,2));
+    printf("sigdig(-17.5,2)  = %15.8f (should be    -18.00000000)\n\n", brahe_sigdig(-17.5,2));
+
+    errcnt = test_arrays(true);
+
+    printf("found %d error(s)\n", errcnt);
 
-    return 0;
+    return errcnt;
 }
@@ -0,0 +1,272 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+#include "../src/mathtools.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const size_t TEST_SIZE = 100000;
+
+static brahe_wave_factor_t factors [] =
+{
+    {  100.0, 20.0 },
+    {   50.0, 40.0 },
+    {    5.0, 100.0 }
+};
+
+// largest absolute difference between two arrays
+static double difference(const double * a, const double * b, const size_t n)
+{
+    size_t i;
+    double worst = 0.0;
+
+    for (i = 0; i < n; ++i)
+    {
+        if (fabs(a[i] - b[i]) > worst)
+            worst = fabs(a[i] - b[i]);
+    }
+
+    return worst;
+}
+
+int test_sines(bool verbose)
+{
+    static const double phases[] = { 0.5, -1.25, 3.0 };
+    static const size_t chunks[] = { 1, 7, 256, 1000, 4099 };
+
+    size_t i, c, errcnt = 0;
+    double worst = 0.0;
+    double * expected = (double *)malloc(sizeof(double) * TEST_SIZE);
+    double * actual   = (double *)malloc(sizeof(double) * TEST_SIZE);
+    brahe_signal_t signal;
+
+    brahe_make_sinusoid_phased_into(factors, phases, 3, expected, TEST_SIZE);
+
+    // the same signal, however it is divided into chunks
+    for (c = 0; c < sizeof(chunks) / sizeof(chunks[0]); ++c)
+    {
+        brahe_signal_init(&signal, 3, 1);
+
+        for (i = 0; i < 3; ++i)
+            brahe_signal_add_sine(&signal, &factors[i], phases[i]);
+
+        for (i = 0; i < TEST_SIZE; i += chunks[c])
+            brahe_signal_generate(&signal, actual + i, (TEST_SIZE - i < chunks[c]) ? TEST_SIZE - i : chunks[c]);
+
+        if (brahe_signal_position(&signal) != TEST_SIZE)
+            ++errcnt;
+
+        if (difference(expected, actual, TEST_SIZE) > worst)
+            worst = difference(expected, actual, TEST_SIZE);
+
+        brahe_signal_free(&signal);
+    }
+
+    // the two generators round the phase differently
+    if (worst > 1.0e-8)
+        ++errcnt;
+
+    // too many terms
+    brahe_signal_init(&signal, 1, 1);
+
+    if (!brahe_signal_add_sine(&signal, &factors[0], 0.0) || brahe_signal_add_sine(&signal, &factors[1], 0.0))
+        ++errcnt;
+
+    brahe_signal_free(&signal);
+
+    if (verbose)
+        printf("signal sines: worst difference %g\n", worst);
+
+    free(actual);
+    free(expected);
+
+    return errcnt;
+}
+
+int test_shapes(bool verbose)
+{
+    static const brahe_wave_factor_t slow = { 8.0, 2.0 };
+    static const size_t SWEEP = 5000;
+
+    size_t i, errcnt = 0;
+    double p, cycles, worst = 0.0;
+    double * actual = (double *)malloc(sizeof(double) * TEST_SIZE);
+    brahe_signal_t signal;
+
+    // a wavelength of 8 is a period of 16 samples: eight high, eight low
+    brahe_signal_init(&signal, 1, 1);
+    brahe_signal_add_square(&signal, &slow, 0.0);
+    brahe_signal_generate(&signal, actual, TEST_SIZE);
+
+    for (i = 0; i < TEST_SIZE; ++i)
+    {
+        if (actual[i] != (((i % 16) < 8) ? 2.0 : -2.0))
+            ++errcnt;
+    }
+
+    brahe_signal_free(&signal);
+
+    // the sawtooth rises by 1/4 every sample
+    brahe_signal_init(&signal, 1, 1);
+    brahe_signal_add_saw(&signal, &slow, BRAHE_PI);
+    brahe_signal_generate(&signal, actual, TEST_SIZE);
+
+    for (i = 0; i < TEST_SIZE; ++i)
+    {
+        p = fmod(0.5 + (double)i / 16.0, 1.0);
+
+        if (fabs(actual[i] - 2.0 * (2.0 * p - 1.0)) > 1.0e-9)
+            ++errcnt;
+    }
+
+    brahe_signal_free(&signal);
+
+    // chirp, checked against its phase computed directly
+    brahe_signal_init(&signal, 1, 1);
+    brahe_signal_add_chirp(&signal, 3.0, 100.0, 4.0, SWEEP);
+    brahe_signal_generate(&signal, actual, TEST_SIZE);
+
+    cycles = 0.0;
+
+    for (i = 0; i < TEST_SIZE; ++i)
+    {
+        size_t j = i % SWEEP;
+        double step = 0.5 / 100.0 + (0.5 / 4.0 - 0.5 / 100.0) * (double)j / (double)SWEEP;
+
+        if (fabs(actual[i] - 3.0 * sin(2.0 * BRAHE_PI * cycles)) > worst)
+            worst = fabs(actual[i] - 3.0 * sin(2.0 * BRAHE_PI * cycles));
+
+        cycles = fmod(cycles + step, 1.0);
+    }
+
+    if (worst > 1.0e-9)
+        ++errcnt;
+
+    brahe_signal_free(&signal);
+
+    if (verbose)
+        printf("signal shapes: worst chirp difference %g, %d error(s)\n", worst, (int)errcnt);
+
+    free(actual);
+
+    return errcnt;
+}
+
+int test_noise_and_speed(bool verbose)
+{
+    static const size_t CHUNK = 4096;
+    static const size_t CHUNKS = 10000;
+
+    size_t i, errcnt = 0;
+    double elapsed;
+    double * a = (double *)malloc(sizeof(double) * CHUNK);
+    double * b = (double *)malloc(sizeof(double) * CHUNK);
+    brahe_signal_t first, second;
+    struct timespec start, stop;
+
+    // the same seed gives the same noisy signal
+    brahe_signal_init(&first, 4, 42);
+    brahe_signal_init(&second, 4, 42);
+
+    for (i = 0; i < 3; ++i)
+    {
+        brahe_signal_add_sine(&first, &factors[i], 0.0);
+        brahe_signal_add_sine(&second, &factors[i], 0.0);
+    }
+
+    brahe_signal_add_chirp(&first, 10.0, 50.0, 3.0, 100000);
+    brahe_signal_add_chirp(&second, 10.0, 50.0, 3.0, 100000);
+    brahe_signal_set_noise(&first, BRAHE_NOISE_GAUSSIAN, 1.0);
+    brahe_signal_set_noise(&second, BRAHE_NOISE_GAUSSIAN, 1.0);
+
+    brahe_signal_generate(&first, a, CHUNK);
+    brahe_signal_generate(&second, b, CHUNK);
+
+    if (memcmp(a, b, sizeof(double) * CHUNK) != 0)
+        ++errcnt;
+
+    // throughput for a long feed
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (i = 0; i < CHUNKS; ++i)
+        brahe_signal_generate(&first, a, CHUNK);
+
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    elapsed = (stop.tv_sec - start.tv_sec) + (double)(stop.tv_nsec - start.tv_nsec) / 1000000000.0;
+
+    if (verbose)
+        printf("signal feed: %.0f MB/s with four waves and Gaussian noise\n",
+               (double)(CHUNK * CHUNKS * sizeof(double)) / elapsed / 1.0e6);
+
+    brahe_signal_free(&second);
+    brahe_signal_free(&first);
+    free(b);
+    free(a);
+
+    return errcnt;
+}
+
+int main(int argc, char * argv[])
+{
+    size_t errcnt = 0;
+
+    errcnt += test_sines(true);
+    errcnt += test_shapes(true);
+    errcnt += test_noise_and_speed(true);
+
+    printf("found %d error(s)\n",(int)errcnt);
+
+    return errcnt;
+}
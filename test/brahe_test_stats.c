@@ -0,0 +1,715 @@
+/*
+    Brahe is a heterogenous collection of mathematical tools,  written in Standard C.
+
+    Copyright 2011 Scott Robert Ladd. All rights reserved.
+
+    Brahe is user-supported open source software. Its continued development is dependent
+    on financial support from the community. You can provide funding by visiting the Brahe
+    website at:
+
+        http://www.coyotegulch.com
+
+    You may license Brahe in one of two fashions:
+
+    1) Simplified BSD License (FreeBSD License)
+
+    Redistribution and use in source and binary forms, with or without modification, are
+    permitted provided that the following conditions are met:
+
+    1.  Redistributions of source code must retain the above copyright notice, this list of
+        conditions and the following disclaimer.
+
+    2.  Redistributions in binary form must reproduce the above copyright notice, this list
+        of conditions and the following disclaimer in the documentation and/or other materials
+        provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY SCOTT ROBERT LADD ``AS IS'' AND ANY EXPRESS OR IMPLIED
+    WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND
+    FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SCOTT ROBERT LADD OR
+    CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+    ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+    NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+    ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+    The views and conclusions contained in the software and documentation are those of the
+    authors and should not be interpreted as representing official policies, either expressed
+    or implied, of Scott Robert Ladd.
+
+    2) Closed-Source Proprietary License
+
+    If your project is a closed-source or proprietary project, the Simplified BSD License may
+    not be appropriate or desirable. In such cases, contact the Brahe copyright holder to
+    arrange your purchase of an appropriate license.
+
+    The author can be contacted at:
+
+          scott.ladd@coyotegulch.com
+          scott.ladd@gmail.com
+          http:www.coyotegulch.com
+*/
+
+#include "../src/prng.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// reference moving average, computed the slow way
+static double naive_average(const double * data, const size_t n, const size_t distance, const size_t i)
+{
+    size_t x;
+    size_t lo = (i > distance) ? i - distance : 0;
+    size_t hi = (i + distance < n) ? i + distance : n - 1;
+    double sum = 0.0;
+
+    for (x = lo; x <= hi; ++x)
+        sum += data[x];
+
+    return sum / (double)(hi - lo + 1);
+}
+
+int test_moving_average(bool verbose)
+{
+    static const size_t TEST_SIZE = 5000;
+    static const size_t distances[] = { 0, 1, 7, 100, 2499, 4999, 100000 };
+    static const size_t NUM_DISTANCES = sizeof(distances) / sizeof(distances[0]);
+
+    size_t i, j, errcnt = 0;
+    double * data   = (double *)malloc(sizeof(double) * TEST_SIZE);
+    double * result = (double *)malloc(sizeof(double) * TEST_SIZE);
+    double * prefix = (double *)malloc(sizeof(double) * TEST_SIZE);
+
+    // a signal with a large offset, to expose cancellation in running sums
+    for (i = 0; i < TEST_SIZE; ++i)
+        data[i] = 1.0e6 + sin((double)i * 0.01) * 100.0 + (double)(i % 17);
+
+    for (j = 0; j < NUM_DISTANCES; ++j)
+    {
+        double worst = 0.0;
+
+        brahe_moving_average_into(data, TEST_SIZE, distances[j], result);
+        brahe_moving_average_prefix_into(data, TEST_SIZE, distances[j], prefix);
+
+        for (i = 0; i < TEST_SIZE; ++i)
+        {
+            double expected = naive_average(data, TEST_SIZE, distances[j], i);
+            double e1 = fabs(result[i] - expected) / expected;
+            double e2 = fabs(prefix[i] - expected) / expected;
+
+            if (e1 > worst) worst = e1;
+            if (e2 > worst) worst = e2;
+        }
+
+        if (verbose)
+            printf("moving average, distance %6lu: worst relative error %g\n", (unsigned long)distances[j], worst);
+
+        if (worst > 1.0e-12)
+            ++errcnt;
+    }
+
+    // the allocating version must agree with the running sum
+    {
+        double * allocated = brahe_moving_average(data, TEST_SIZE, 7);
+
+        brahe_moving_average_into(data, TEST_SIZE, 7, result);
+
+        for (i = 0; i < TEST_SIZE; ++i)
+        {
+            if (allocated[i] != result[i])
+            {
+                ++errcnt;
+                break;
+            }
+        }
+
+        free(allocated);
+    }
+
+    free(prefix);
+    free(result);
+    free(data);
+
+    return errcnt;
+}
+
+int test_moving_window(bool verbose)
+{
+    static const size_t TEST_SIZE = 20000;
+    static const size_t lengths[] = { 1, 2, 16, 1000 };
+    static const size_t NUM_LENGTHS = sizeof(lengths) / sizeof(lengths[0]);
+
+    size_t i, j, k, errcnt = 0;
+    double * data = (double *)malloc(sizeof(double) * TEST_SIZE);
+    brahe_moving_window_t window;
+
+    // offset, trend, and a little jitter
+    for (i = 0; i < TEST_SIZE; ++i)
+        data[i] = 1.0e4 + (double)i * 0.25 + sin((double)i * 1.7) * 50.0;
+
+    for (j = 0; j < NUM_LENGTHS; ++j)
+    {
+        double worst = 0.0;
+        size_t wrong = 0;
+
+        brahe_moving_window_init(&window, lengths[j]);
+
+        // feed the first half one sample at a time, the rest in odd-sized chunks
+        for (i = 0; i < TEST_SIZE; )
+        {
+            size_t chunk = (i < TEST_SIZE / 2) ? 1 : 37;
+            brahe_statistics stats, expected;
+            size_t first, count;
+
+            if (chunk > TEST_SIZE - i)
+                chunk = TEST_SIZE - i;
+
+            brahe_moving_window_push_n(&window, data + i, chunk);
+            i += chunk;
+
+            count = (i < lengths[j]) ? i : lengths[j];
+            first = i - count;
+            stats = brahe_moving_window_statistics(&window);
+
+            expected.min = expected.max = data[first];
+            expected.mean = expected.variance = 0.0;
+
+            for (k = first; k < i; ++k)
+            {
+                if (data[k] < expected.min) expected.min = data[k];
+                if (data[k] > expected.max) expected.max = data[k];
+                expected.mean += data[k];
+            }
+
+            expected.mean /= (double)count;
+
+            for (k = first; k < i; ++k)
+                expected.variance += (data[k] - expected.mean) * (data[k] - expected.mean);
+
+            if (count > 1)
+                expected.variance /= (double)(count - 1);
+
+            if ((brahe_moving_window_count(&window) != count)
+            ||  (stats.min != expected.min)
+            ||  (stats.max != expected.max))
+                ++wrong;
+
+            if (fabs(stats.mean - expected.mean) / expected.mean > worst)
+                worst = fabs(stats.mean - expected.mean) / expected.mean;
+
+            if ((count > 1) && (fabs(stats.variance - expected.variance) > 1.0e-6 * (expected.variance + 1.0)))
+                ++wrong;
+        }
+
+        if (verbose)
+            printf("moving window, length %4lu: %lu wrong, worst relative error in mean %g\n",
+                   (unsigned long)lengths[j], (unsigned long)wrong, worst);
+
+        if ((wrong > 0) || (worst > 1.0e-12))
+            ++errcnt;
+
+        brahe_moving_window_free(&window);
+    }
+
+    free(data);
+
+    return errcnt;
+}
+
+int test_ewma_bank(bool verbose)
+{
+    static const size_t SERIES = 13;
+    static const size_t STEPS = 200;
+    static const double ALPHA = 0.05;
+
+    size_t i, t, k, errcnt = 0;
+    double worst = 0.0;
+    double * x = (double *)malloc(sizeof(double) * SERIES * STEPS);
+    brahe_ewma_bank_t bank;
+
+    for (t = 0; t < STEPS; ++t)
+        for (i = 0; i < SERIES; ++i)
+            x[t * SERIES + i] = 100.0 * (double)i + cos((double)(t * (i + 1)) * 0.3) * 10.0;
+
+    brahe_ewma_bank_init(&bank, SERIES, ALPHA, true);
+
+    for (t = 0; t < STEPS; ++t)
+    {
+        const double * mean;
+        const double * var;
+
+        brahe_ewma_bank_update(&bank, x + t * SERIES);
+        mean = brahe_ewma_bank_means(&bank);
+        var = brahe_ewma_bank_variances(&bank);
+
+        // with bias correction, the bank must match a normalized weighted average
+        for (i = 0; i < SERIES; ++i)
+        {
+            double w, wsum = 0.0, m = 0.0, v = 0.0;
+
+            for (k = 0, w = 1.0; k <= t; ++k, w *= 1.0 - ALPHA)
+            {
+                wsum += w;
+                m += w * x[(t - k) * SERIES + i];
+            }
+
+            m /= wsum;
+
+            for (k = 0, w = 1.0; k <= t; ++k, w *= 1.0 - ALPHA)
+                v += w * (x[(t - k) * SERIES + i] - m) * (x[(t - k) * SERIES + i] - m);
+
+            v /= wsum;
+
+            if (fabs(mean[i] - m) / (fabs(m) + 1.0) > worst) worst = fabs(mean[i] - m) / (fabs(m) + 1.0);
+            if (fabs(var[i] - v) / (v + 1.0) > worst) worst = fabs(var[i] - v) / (v + 1.0);
+        }
+    }
+
+    if (verbose)
+        printf("ewma bank, %lu series: worst relative error %g\n", (unsigned long)SERIES, worst);
+
+    if (worst > 1.0e-12)
+        ++errcnt;
+
+    // without bias correction, the first sample seeds the mean
+    brahe_ewma_bank_free(&bank);
+    brahe_ewma_bank_init(&bank, SERIES, ALPHA, false);
+    brahe_ewma_bank_update(&bank, x);
+    brahe_ewma_bank_update(&bank, x + SERIES);
+
+    for (i = 0; i < SERIES; ++i)
+    {
+        double m = x[i] + ALPHA * (x[SERIES + i] - x[i]);
+
+        if (fabs(brahe_ewma_bank_means(&bank)[i] - m) > 1.0e-12)
+            ++errcnt;
+    }
+
+    brahe_ewma_bank_free(&bank);
+    free(x);
+
+    return errcnt;
+}
+
+static int compare_double(const void * a, const void * b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+int test_quantiles(bool verbose)
+{
+    static const size_t sizes[] = { 1, 2, 5, 16, 17, 100, 1001, 100000 };
+    static const size_t NUM_SIZES = sizeof(sizes) / sizeof(sizes[0]);
+    static const double q[] = { 0.5, 0.0, 1.0, 0.25, 0.9, 0.99, 0.001 };
+    static const size_t NUM_Q = sizeof(q) / sizeof(q[0]);
+
+    size_t i, j, k, pass, wrong = 0, errcnt = 0;
+    brahe_prng_state_t prng;
+
+    brahe_prng_init(&prng, BRAHE_PRNG_KISS, 12345);
+
+    // random values, then heavy duplication, then already sorted
+    for (pass = 0; pass < 3; ++pass)
+    {
+        for (j = 0; j < NUM_SIZES; ++j)
+        {
+            size_t n = sizes[j];
+            double * data   = (double *)malloc(sizeof(double) * n);
+            double * sorted = (double *)malloc(sizeof(double) * n);
+            double * work   = (double *)malloc(sizeof(double) * n);
+            double result[sizeof(q) / sizeof(q[0])];
+
+            for (i = 0; i < n; ++i)
+            {
+                if (pass == 0)
+                    data[i] = brahe_prng_real2(&prng) * 1000.0 - 500.0;
+                else if (pass == 1)
+                    data[i] = (double)brahe_prng_index(&prng, 4);
+                else
+                    data[i] = (double)i;
+
+                sorted[i] = data[i];
+            }
+
+            qsort(sorted, n, sizeof(double), compare_double);
+
+            for (k = 0; k < NUM_Q; ++k)
+            {
+                double h = q[k] * (double)(n - 1);
+                size_t lo = (size_t)floor(h);
+                double expected = sorted[lo];
+
+                if (lo + 1 < n)
+                    expected += (h - (double)lo) * (sorted[lo + 1] - sorted[lo]);
+
+                for (i = 0; i < n; ++i)
+                    work[i] = data[i];
+
+                if (fabs(brahe_quantile(work, n, q[k]) - expected) > 1.0e-9)
+                    ++wrong;
+            }
+
+            for (i = 0; i < n; ++i)
+                work[i] = data[i];
+
+            if (fabs(brahe_median(work, n) - ((n % 2 == 1) ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2.0)) > 1.0e-9)
+                ++wrong;
+
+            for (i = 0; i < n; ++i)
+                work[i] = data[i];
+
+            brahe_quantiles(work, n, q, NUM_Q, result);
+
+            for (k = 0; k < NUM_Q; ++k)
+            {
+                double h = q[k] * (double)(n - 1);
+                size_t lo = (size_t)floor(h);
+                double expected = sorted[lo];
+
+                if (lo + 1 < n)
+                    expected += (h - (double)lo) * (sorted[lo + 1] - sorted[lo]);
+
+                if (fabs(result[k] - expected) > 1.0e-9)
+                    ++wrong;
+            }
+
+            free(work);
+            free(sorted);
+            free(data);
+        }
+    }
+
+    if (verbose)
+        printf("quantiles by selection: %lu wrong\n", (unsigned long)wrong);
+
+    if (wrong > 0)
+        ++errcnt;
+
+    brahe_prng_free(&prng);
+
+    return errcnt;
+}
+
+int test_quantile_sketch(bool verbose)
+{
+    static const size_t TEST_SIZE = 1000000;
+    static const double q[] = { 0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99 };
+    static const size_t NUM_Q = sizeof(q) / sizeof(q[0]);
+
+    size_t i, k, errcnt = 0;
+    double worst = 0.0, worst_merged = 0.0;
+    brahe_quantile_sketch_t whole, first, second;
+    brahe_prng_state_t prng;
+
+    brahe_prng_init(&prng, BRAHE_PRNG_KISS, 54321);
+    brahe_quantile_sketch_init(&whole, 200);
+    brahe_quantile_sketch_init(&first, 200);
+    brahe_quantile_sketch_init(&second, 200);
+
+    // a shuffled permutation of 0..TEST_SIZE-1, so the rank of v is v
+    for (i = 0; i < TEST_SIZE; ++i)
+    {
+        double x = (double)((i * 7919) % TEST_SIZE);
+
+        brahe_quantile_sketch_add(&whole, x);
+        brahe_quantile_sketch_add((brahe_prng_next(&prng) & 1) ? &first : &second, x);
+    }
+
+    brahe_quantile_sketch_merge(&first, &second);
+
+    if ((brahe_quantile_sketch_count(&whole) != TEST_SIZE) || (brahe_quantile_sketch_count(&first) != TEST_SIZE))
+        ++errcnt;
+
+    for (k = 0; k < NUM_Q; ++k)
+    {
+        double e1 = fabs(brahe_quantile_sketch_query(&whole, q[k]) / (double)TEST_SIZE - q[k]);
+        double e2 = fabs(brahe_quantile_sketch_query(&first, q[k]) / (double)TEST_SIZE - q[k]);
+
+        if (e1 > worst) worst = e1;
+        if (e2 > worst_merged) worst_merged = e2;
+    }
+
+    if ((brahe_quantile_sketch_query(&whole, 0.0) != 0.0)
+    ||  (brahe_quantile_sketch_query(&whole, 1.0) != (double)(TEST_SIZE - 1)))
+        ++errcnt;
+
+    if (verbose)
+        printf("quantile sketch: worst rank error %g, %g after merge, %lu items retained\n",
+               worst, worst_merged, (unsigned long)whole.m_size);
+
+    if ((worst > 0.02) || (worst_merged > 0.02))
+        ++errcnt;
+
+    brahe_quantile_sketch_free(&second);
+    brahe_quantile_sketch_free(&first);
+    brahe_quantile_sketch_free(&whole);
+    brahe_prng_free(&prng);
+
+    return errcnt;
+}
+
+int test_noise(bool verbose)
+{
+    static const size_t TEST_SIZE = 1000000;
+
+    size_t i, errcnt = 0;
+    double mean, var, worst = 0.0;
+    double * a = (double *)malloc(sizeof(double) * TEST_SIZE);
+    double * b = (double *)malloc(sizeof(double) * TEST_SIZE);
+    brahe_prng_state_t prng;
+    brahe_statistics stats;
+
+    // uniform noise on zero has mean 0 and variance noise^2 / 3
+    memset(a, 0, sizeof(double) * TEST_SIZE);
+    brahe_prng_init(&prng, BRAHE_PRNG_KISS, 271828);
+    brahe_add_noise_r(&prng, a, TEST_SIZE, BRAHE_NOISE_UNIFORM, 2.0);
+    stats = brahe_get_statistics(a, TEST_SIZE);
+
+    if ((fabs(stats.mean) > 0.01) || (fabs(stats.variance - 4.0 / 3.0) > 0.01)
+    ||  (stats.min < -2.0) || (stats.max >= 2.0))
+        ++errcnt;
+
+    // Gaussian noise has variance noise^2, and an odd length uses half a pair
+    memset(a, 0, sizeof(double) * TEST_SIZE);
+    brahe_add_noise_r(&prng, a, TEST_SIZE - 1, BRAHE_NOISE_GAUSSIAN, 3.0);
+    stats = brahe_get_statistics(a, TEST_SIZE - 1);
+
+    if ((fabs(stats.mean) > 0.02) || (fabs(stats.variance - 9.0) > 0.1) || (a[TEST_SIZE - 1] != 0.0))
+        ++errcnt;
+
+    // multiplicative noise stays within the requested percentage
+    for (i = 0; i < TEST_SIZE; ++i)
+        a[i] = 100.0;
+
+    brahe_add_noise(a, TEST_SIZE, 0.1);
+
+    for (i = 0; i < TEST_SIZE; ++i)
+    {
+        if ((a[i] < 90.0) || (a[i] > 110.0))
+            ++errcnt;
+    }
+
+    // seeded noise does not depend on the number of threads
+    memset(a, 0, sizeof(double) * TEST_SIZE);
+    memset(b, 0, sizeof(double) * TEST_SIZE);
+
+    if (!brahe_add_noise_seeded(a, TEST_SIZE, BRAHE_NOISE_GAUSSIAN, 1.0, 12345, 1)
+    ||  !brahe_add_noise_seeded(b, TEST_SIZE, BRAHE_NOISE_GAUSSIAN, 1.0, 12345, 0))
+        ++errcnt;
+
+    if (memcmp(a, b, sizeof(double) * TEST_SIZE) != 0)
+        ++errcnt;
+
+    mean = 0.0;
+    var = 0.0;
+
+    for (i = 0; i < TEST_SIZE; ++i)
+    {
+        mean += a[i];
+        var += a[i] * a[i];
+    }
+
+    mean /= (double)TEST_SIZE;
+    var = var / (double)TEST_SIZE - mean * mean;
+    worst = fabs(var - 1.0);
+
+    if ((fabs(mean) > 0.01) || (worst > 0.01))
+        ++errcnt;
+
+    if (verbose)
+        printf("noise: seeded mean %g, variance error %g, %d error(s)\n", mean, worst, (int)errcnt);
+
+    brahe_prng_free(&prng);
+    free(b);
+    free(a);
+
+    return errcnt;
+}
+
+// the float functions against the double ones on the same (widened) values
+int test_single_precision(bool verbose)
+{
+    static const size_t TEST_SIZE = 100003;
+
+    size_t i, errcnt = 0;
+    float  * f  = (float *)malloc(sizeof(float) * TEST_SIZE);
+    float  * fr = (float *)malloc(sizeof(float) * TEST_SIZE);
+    double * d  = (double *)malloc(sizeof(double) * TEST_SIZE);
+    double * dr = (double *)malloc(sizeof(double) * TEST_SIZE);
+    brahe_prng_state_t p1, p2;
+    brahe_statistics sf, sd;
+
+    for (i = 0; i < TEST_SIZE; ++i)
+    {
+        f[i] = (float)(1000.0 + sin((double)i * 0.01) * 100.0 + (double)(i % 17));
+        d[i] = f[i];
+    }
+
+    // statistics accumulate in double, so only the order of summation differs
+    sf = brahe_get_statistics_f(f, TEST_SIZE);
+    sd = brahe_get_statistics(d, TEST_SIZE);
+
+    if ((sf.min != sd.min) || (sf.max != sd.max)
+    ||  (fabs(sf.mean - sd.mean) > 1.0e-12 * sd.mean) || (fabs(sf.variance - sd.variance) > 1.0e-9 * sd.variance))
+        ++errcnt;
+
+    // the running sum is the same double sum, rounded once
+    brahe_moving_average_into_f(f, TEST_SIZE, 50, fr);
+    brahe_moving_average_into(d, TEST_SIZE, 50, dr);
+
+    for (i = 0; i < TEST_SIZE; ++i)
+    {
+        if (fr[i] != (float)dr[i])
+        {
+            ++errcnt;
+            break;
+        }
+    }
+
+    if (brahe_moving_average_into_f(NULL, TEST_SIZE, 50, fr) || brahe_moving_average_into_f(f, 0, 50, fr))
+        ++errcnt;
+
+    // noise draws the same variates for either precision
+    memset(f, 0, sizeof(float) * TEST_SIZE);
+    memset(d, 0, sizeof(double) * TEST_SIZE);
+
+    if (!brahe_add_noise_seeded_f(f, TEST_SIZE, BRAHE_NOISE_GAUSSIAN, 2.0, 4242, 0)
+    ||  !brahe_add_noise_seeded(d, TEST_SIZE, BRAHE_NOISE_GAUSSIAN, 2.0, 4242, 0))
+        ++errcnt;
+
+    brahe_prng_init(&p1, BRAHE_PRNG_KISS, 777);
+    brahe_prng_init(&p2, BRAHE_PRNG_KISS, 777);
+
+    if (!brahe_add_noise_r_f(&p1, f, TEST_SIZE, BRAHE_NOISE_UNIFORM, 0.5)
+    ||  !brahe_add_noise_r(&p2, d, TEST_SIZE, BRAHE_NOISE_UNIFORM, 0.5))
+        ++errcnt;
+
+    for (i = 0; i < TEST_SIZE; ++i)
+    {
+        if (fabs(f[i] - d[i]) > 1.0e-6 * (fabs(d[i]) + 1.0))
+        {
+            ++errcnt;
+            break;
+        }
+    }
+
+    if (verbose)
+        printf("single precision: %d error(s)\n", (int)errcnt);
+
+    brahe_prng_free(&p2);
+    brahe_prng_free(&p1);
+    free(dr);
+    free(d);
+    free(fr);
+    free(f);
+
+    return errcnt;
+}
+
+// an allocator that counts live blocks and honors alignment by over-allocating
+typedef struct
+{
+    size_t m_live;
+    size_t m_total;
+}
+counting_t;
+
+static void * counting_alloc(const size_t size, const size_t alignment, void * context)
+{
+    counting_t * counts = (counting_t *)context;
+    size_t align = (alignment < sizeof(void *)) ? sizeof(void *) : alignment;
+    char * raw = (char *)malloc(size + align + sizeof(void *));
+    char * p;
+
+    if (raw == NULL)
+        return NULL;
+
+    p = raw + sizeof(void *);
+    p += (align - (size_t)p % align) % align;
+    ((void **)p)[-1] = raw;
+
+    ++counts->m_live;
+    ++counts->m_total;
+    return p;
+}
+
+static void counting_free(void * p, void * context)
+{
+    --((counting_t *)context)->m_live;
+    free(((void **)p)[-1]);
+}
+
+int test_allocator(bool verbose)
+{
+    size_t i, errcnt = 0;
+    double data[1000], * average;
+    counting_t counts = { 0, 0 };
+    brahe_allocator_t counting = { counting_alloc, counting_free, &counts };
+    brahe_allocator_t missing = { counting_alloc, NULL, &counts };
+    brahe_quantile_sketch_t sketch;
+    brahe_moving_window_t window;
+    brahe_ewma_bank_t bank;
+
+    for (i = 0; i < 1000; ++i)
+        data[i] = (double)((i * 7919) % 1000);
+
+    if (brahe_set_allocator(&missing) || !brahe_set_allocator(&counting))
+        ++errcnt;
+
+    // objects keep the allocator they were initialized with
+    if (!brahe_quantile_sketch_init(&sketch, 16) || !brahe_moving_window_init(&window, 32)
+    ||  !brahe_ewma_bank_init(&bank, 100, 0.1, true))
+        ++errcnt;
+
+    for (i = 0; i < 1000; ++i)
+    {
+        brahe_quantile_sketch_add(&sketch, data[i]);
+        brahe_moving_window_push(&window, data[i]);
+    }
+
+    brahe_ewma_bank_update(&bank, data);
+
+    average = brahe_moving_average(data, 1000, 5);
+    brahe_free(average);
+
+    if (brahe_get_allocator().context != &counts)
+        ++errcnt;
+
+    brahe_set_allocator(NULL);
+
+    if (brahe_get_allocator().context != NULL)
+        ++errcnt;
+
+    brahe_quantile_sketch_free(&sketch);
+    brahe_moving_window_free(&window);
+    brahe_ewma_bank_free(&bank);
+
+    if ((counts.m_live != 0) || (counts.m_total < 5))
+        ++errcnt;
+
+    if (verbose)
+        printf("allocator: %lu allocations, %d error(s)\n", (unsigned long)counts.m_total, (int)errcnt);
+
+    return (int)errcnt;
+}
+
+int main(int argc, char * argv[])
+{
+    size_t errcnt = 0;
+
+    errcnt += test_moving_average(true);
+    errcnt += test_moving_window(true);
+    errcnt += test_ewma_bank(true);
+    errcnt += test_quantiles(true);
+    errcnt += test_quantile_sketch(true);
+    errcnt += test_noise(true);
+    errcnt += test_single_precision(true);
+    errcnt += test_allocator(true);
+
+    printf("found %d error(s)\n",(int)errcnt);
+
+    return errcnt;
+}
@@ -51,12 +51,189 @@
 */
 
 #include "../src/mathtools.h"
+#include "../src/prng.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static const size_t TEST_SIZE = 1000000;
+
+typedef double (*scalar_fn)(const double);
+typedef long double (*reference_fn)(long double);
+typedef bool (*array_fn)(const double *, double *, const size_t);
+
+// error of a result in units in the last place of the correctly rounded value
+static double ulp_error(const double result, const long double reference)
+{
+    double rounded = (double)reference;
+    double ulp;
+
+    if (isnan(rounded) || isinf(rounded))
+        return (isnan(rounded) == isnan(result)) && (result == rounded || isnan(result)) ? 0.0 : HUGE_VAL;
+
+    ulp = nextafter(fabs(rounded), HUGE_VAL) - fabs(rounded);
+    return (double)(fabsl((long double)result - reference) / ulp);
+}
+
+static double seconds(const struct timespec * start, const struct timespec * stop)
+{
+    return (stop->tv_sec - start->tv_sec) + (double)(stop->tv_nsec - start->tv_nsec) / 1000000000.0;
+}
+
+static int check_function(const char * name, scalar_fn scalar, reference_fn reference, array_fn array,
+                          const double * in, const size_t n, const double bound, bool verbose)
+{
+    size_t i;
+    int errcnt = 0;
+    double err, worst_scalar = 0.0, worst_array = 0.0, scalar_time, array_time;
+    double * out = (double *)malloc(sizeof(double) * n);
+    struct timespec start, stop;
+
+    // fault in the output before timing anything
+    for (i = 0; i < n; ++i)
+        out[i] = 0.0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    array(in, out, n);
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    array_time = seconds(&start, &stop);
+
+    for (i = 0; i < n; ++i)
+    {
+        long double ref = reference((long double)in[i]);
+
+        err = ulp_error(out[i], ref);
+
+        if (err > worst_array)
+            worst_array = err;
+
+        err = ulp_error(scalar(in[i]), ref);
+
+        if (err > worst_scalar)
+            worst_scalar = err;
+    }
+
+    // time the scalar function as a plain loop
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (i = 0; i < n; ++i)
+        out[i] = scalar(in[i]);
+
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    scalar_time = seconds(&start, &stop);
+
+    if ((worst_scalar > bound) || (worst_array > bound))
+        ++errcnt;
+
+    if (verbose)
+        printf("%s: worst error %.3f ULP scalar, %.3f ULP array; array %.1fx faster\n",
+               name, worst_scalar, worst_array, scalar_time / array_time);
+
+    free(out);
+    return errcnt;
+}
+
+typedef bool (*array_f_fn)(const float *, float *, const size_t);
+
+// error of a float result in units in the last place of the correctly rounded value
+static double ulp_error_f(const float result, const long double reference)
+{
+    float rounded = (float)reference;
+    double ulp;
+
+    if (isnan(rounded) || isinf(rounded))
+        return (isnan(rounded) == isnan(result)) && (result == rounded || isnan(result)) ? 0.0 : HUGE_VAL;
+
+    ulp = (double)(nextafterf(fabsf(rounded), HUGE_VALF) - fabsf(rounded));
+    return (double)(fabsl((long double)result - reference) / ulp);
+}
+
+static int check_function_f(const char * name, reference_fn reference, array_f_fn array,
+                            const double * source, const size_t n, const double bound, bool verbose)
+{
+    size_t i;
+    int errcnt = 0;
+    double err, worst = 0.0;
+    float * in  = (float *)malloc(sizeof(float) * n);
+    float * out = (float *)malloc(sizeof(float) * n);
+
+    for (i = 0; i < n; ++i)
+        in[i] = (float)source[i];
+
+    // an odd length exercises the padded tail
+    if (!array(in, out, n - 1))
+        ++errcnt;
+
+    for (i = 0; i < n - 1; ++i)
+    {
+        err = ulp_error_f(out[i], reference((long double)in[i]));
+
+        if (err > worst)
+            worst = err;
+    }
+
+    if (worst > bound)
+        ++errcnt;
+
+    if (verbose)
+        printf("%s (float): worst error %.3f ULP array\n", name, worst);
+
+    free(out);
+    free(in);
+    return errcnt;
+}
+
+int test_accuracy(bool verbose)
+{
+    static const double specials[] = { 0.0, -0.0, 1.0, -1.0, 2.0, 1.0e-310, 268435456.0, 1.0e300, HUGE_VAL, -HUGE_VAL, NAN };
+    static const size_t NUM_SPECIALS = sizeof(specials) / sizeof(specials[0]);
+
+    size_t i;
+    int errcnt = 0;
+    double * wide   = (double *)malloc(sizeof(double) * TEST_SIZE);
+    double * above  = (double *)malloc(sizeof(double) * TEST_SIZE);
+    double * within = (double *)malloc(sizeof(double) * TEST_SIZE);
+    brahe_prng_state_t prng;
+
+    brahe_prng_init(&prng, BRAHE_PRNG_KISS, 314159);
+
+    // magnitudes spread evenly over many decades, plus awkward values
+    for (i = 0; i < TEST_SIZE; ++i)
+    {
+        double sign = (brahe_prng_next(&prng) & 1) ? 1.0 : -1.0;
+
+        wide[i]   = sign * pow(10.0, brahe_prng_real53(&prng) * 40.0 - 20.0);
+        above[i]  = 1.0 + pow(10.0, brahe_prng_real53(&prng) * 24.0 - 16.0);
+        within[i] = sign * brahe_prng_real53(&prng);
+    }
+
+    for (i = 0; i < NUM_SPECIALS; ++i)
+    {
+        wide[i]   = specials[i];
+        above[i]  = specials[i];
+        within[i] = specials[i];
+    }
+
+    errcnt += check_function("asinh", brahe_asinh, asinhl, brahe_asinh_v, wide, TEST_SIZE, 2.0, verbose);
+    errcnt += check_function("acosh", brahe_acosh, acoshl, brahe_acosh_v, above, TEST_SIZE, 2.5, verbose);
+    errcnt += check_function("atanh", brahe_atanh, atanhl, brahe_atanh_v, within, TEST_SIZE, 2.0, verbose);
+
+    errcnt += check_function_f("asinh", asinhl, brahe_asinh_v_f, wide, TEST_SIZE, 2.0, verbose);
+    errcnt += check_function_f("acosh", acoshl, brahe_acosh_v_f, above, TEST_SIZE, 2.0, verbose);
+    errcnt += check_function_f("atanh", atanhl, brahe_atanh_v_f, within, TEST_SIZE, 2.0, verbose);
+
+    brahe_prng_free(&prng);
+    free(within);
+    free(above);
+    free(wide);
+
+    return errcnt;
+}
 
 int main(int argc, char * argv[])
 {
-    int i;
+    int i, errcnt = 0;
     double a [] = { 1.0, 1.33333333333333333, 1.5 };
 
     for (i = 0; i < 3; ++i)
@@ -69,5 +246,9 @@ int main(int argc, char * argv[])
         printf("acosh(cosh(%11.8f)) = %11.8f\n", -a[i], brahe_acosh(cosh(-a[i])));
     }
 
-    return 0;
+    errcnt += test_accuracy(true);
+
+    printf("found %d error(s)\n", errcnt);
+
+    return errcnt;
 }